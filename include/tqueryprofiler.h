@@ -0,0 +1 @@
+#include "../src/tqueryprofiler.h"
@@ -0,0 +1 @@
+#include "../src/tsqlasync.h"
@@ -0,0 +1 @@
+#include "../src/tsqlkeysetcursor.h"
@@ -0,0 +1 @@
+#include "../src/tsqlormapperstream.h"
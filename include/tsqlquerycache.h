@@ -0,0 +1 @@
+#include "../src/tsqlquerycache.h"
@@ -0,0 +1 @@
+#include "../src/tviewbuffer.h"
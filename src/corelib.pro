@@ -113,8 +113,17 @@ HEADERS += tsqlobject.h
 SOURCES += tsqlobject.cpp
 HEADERS += tsqlormapperiterator.h
 SOURCES += tsqlormapperiterator.cpp
+HEADERS += tsqlormapperstream.h
+HEADERS += tsqlkeysetcursor.h
+SOURCES += tsqlkeysetcursor.cpp
 HEADERS += tsqlquery.h
 SOURCES += tsqlquery.cpp
+HEADERS += tsqlquerycache.h
+SOURCES += tsqlquerycache.cpp
+HEADERS += tsqlasync.h
+SOURCES += tsqlasync.cpp
+HEADERS += tqueryprofiler.h
+SOURCES += tqueryprofiler.cpp
 HEADERS += tsqlqueryormapper.h
 SOURCES += tsqlqueryormapper.cpp
 HEADERS += tsqlqueryormapperiterator.h
@@ -139,6 +148,8 @@ HEADERS += tcontentheader.h
 SOURCES += tcontentheader.cpp
 HEADERS += thttputility.h
 SOURCES += thttputility.cpp
+HEADERS += tescapekernel.h
+SOURCES += tescapekernel.cpp
 HEADERS += thtmlattribute.h
 SOURCES += thtmlattribute.cpp
 HEADERS += ttextview.h
@@ -149,6 +160,8 @@ HEADERS += tactionhelper.h
 SOURCES += tactionhelper.cpp
 HEADERS += tviewhelper.h
 SOURCES += tviewhelper.cpp
+HEADERS += tviewbuffer.h
+SOURCES += tviewbuffer.cpp
 HEADERS += tprototypeajaxhelper.h
 SOURCES += tprototypeajaxhelper.cpp
 HEADERS += toption.h
@@ -173,6 +186,8 @@ HEADERS += tsessionmongostore.h
 SOURCES += tsessionmongostore.cpp
 HEADERS += tsessioncookiestore.h
 SOURCES += tsessioncookiestore.cpp
+HEADERS += tsessioncookiecodec.h
+SOURCES += tsessioncookiecodec.cpp
 HEADERS += tsessionfilestore.h
 SOURCES += tsessionfilestore.cpp
 HEADERS += tsessionredisstore.h
@@ -243,6 +258,8 @@ HEADERS += tredisdriver.h
 SOURCES += tredisdriver.cpp
 HEADERS += tredis.h
 SOURCES += tredis.cpp
+HEADERS += tredispipeline.h
+SOURCES += tredispipeline.cpp
 HEADERS += tfileaiologger.h
 SOURCES += tfileaiologger.cpp
 HEADERS += tfileaiowriter.h
@@ -251,6 +268,8 @@ HEADERS += tscheduler.h
 SOURCES += tscheduler.cpp
 HEADERS += tapplicationscheduler.h
 SOURCES += tapplicationscheduler.cpp
+HEADERS += tgcscheduler.h
+SOURCES += tgcscheduler.cpp
 HEADERS += tappsettings.h
 SOURCES += tappsettings.cpp
 HEADERS += tabstractwebsocket.h
@@ -269,6 +288,8 @@ HEADERS += tpublisher.h
 SOURCES += tpublisher.cpp
 HEADERS += tsystembus.h
 SOURCES += tsystembus.cpp
+HEADERS += tpublisherredisbridge.h
+SOURCES += tpublisherredisbridge.cpp
 HEADERS += tprocessinfo.h
 SOURCES += tprocessinfo.cpp
 HEADERS += tbasictimer.h
@@ -301,6 +322,8 @@ HEADERS += tdebug.h
 SOURCES += tdebug.cpp
 HEADERS += tjsonutil.h
 SOURCES += tjsonutil.cpp
+HEADERS += tjsonwriter.h
+SOURCES += tjsonwriter.cpp
 HEADERS += tjsloader.h
 SOURCES += tjsloader.cpp
 HEADERS += tjsmodule.h
@@ -371,6 +394,8 @@ linux-* {
   SOURCES += tepollwebsocket.cpp
   SOURCES += tprocessinfo_linux.cpp
   SOURCES += tthreadapplicationserver_linux.cpp
+  HEADERS += tsystembusring.h
+  SOURCES += tsystembusring_linux.cpp
 }
 macx {
   SOURCES += tprocessinfo_macx.cpp
@@ -7,6 +7,7 @@
 
 #include <TAbstractModel>
 #include <TModelObject>
+#include <TJsonWriter>
 
 /*!
   \class TAbstractModel
@@ -155,11 +156,24 @@ QJsonObject TAbstractModel::toJsonObject() const
     return QJsonObject::fromVariantMap(toVariantMap());
 }
 
+/*!
+  Writes the model as a JSON object to the \a writer, as toJsonObject()
+  converts it, so that the properties hidden by a reimplementation of
+  toVariantMap() or toJsonObject() are not written. A model that writes
+  all the properties can reimplement this function to call
+  TJsonWriter::writeProperties(), which reads them without the
+  intermediate objects.
+ */
+void TAbstractModel::writeJson(TJsonWriter &writer) const
+{
+    writer.value(toJsonObject());
+}
+
 
 #if QT_VERSION >= 0x050c00  // 5.12.0
 
 /*!
-  Converts all the properies to CBOR using QCborValue::fromVariant() and
+  Converts all the properties to CBOR using QCborValue::fromVariant() and
   returns the map composed of those elements.
  */
 QCborMap TAbstractModel::toCborMap() const
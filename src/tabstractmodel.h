@@ -6,6 +6,7 @@
 #include <TGlobal>
 
 class TModelObject;
+class TJsonWriter;
 
 
 class T_CORE_EXPORT TAbstractModel
@@ -22,6 +23,7 @@ public:
     virtual void setProperties(const QVariantMap &properties);
     virtual QVariantMap toVariantMap() const;
     virtual QJsonObject toJsonObject() const;
+    virtual void writeJson(TJsonWriter &writer) const;
 #if QT_VERSION >= 0x050c00  // 5.12.0
     virtual QCborMap toCborMap() const;
 #endif
@@ -184,7 +184,20 @@ void TActionContext::execute(THttpRequest &request, int sid)
 
                     // Session store
                     if (currController->sessionEnabled()) {
-                        bool stored = TSessionManager::instance().store(currController->session());
+                        TSession &session = currController->session();
+                        bool stored = true;
+                        bool written = true;
+
+                        if (session.isModified()) {
+                            stored = TSessionManager::instance().store(session);
+                        } else if (TSessionManager::instance().isRefreshRequired(session)) {
+                            // Extends the expiration only
+                            stored = TSessionManager::instance().touch(session);
+                        } else {
+                            // Unmodified and refreshed recently
+                            written = false;
+                        }
+
                         if (Q_LIKELY(stored)) {
                             static const int SessionCookieMaxAge = ([]() -> int {
                                 QString maxagestr = Tf::appSettings()->value(Tf::SessionCookieMaxAge).toString().trimmed();
@@ -195,8 +208,10 @@ void TActionContext::execute(THttpRequest &request, int sid)
                                 }
                             }());
 
-                            currController->addCookie(TSession::sessionName(), currController->session().id(), SessionCookieMaxAge,
-                                                      SessionCookiePath, SessionCookieDomain, false, true, SessionCookieSameSite);
+                            if (written) {
+                                currController->addCookie(TSession::sessionName(), session.id(), SessionCookieMaxAge,
+                                                          SessionCookiePath, SessionCookieDomain, false, true, SessionCookieSameSite);
+                            }
 
                             // Commits a transaction for session
                             commitTransactions();
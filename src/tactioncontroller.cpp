@@ -198,12 +198,16 @@ void TActionController::setSession(const TSession &session)
 
 /*!
   Sets CSRF protection informaion into \a session. Internal use.
+  The value already set is kept so that the cookie of an unmodified
+  session need not be encoded again.
 */
 void TActionController::setCsrfProtectionInto(TSession &session)
 {
     if (Tf::appSettings()->value(Tf::SessionStoreType).toString().toLower() == QLatin1String("cookie")) {
         QString key = Tf::appSettings()->value(Tf::SessionCsrfProtectionKey).toString();
-        session.insert(key, TSessionManager::instance().generateId());  // it's just a random value
+        if (!session.contains(key)) {
+            session.insert(key, TSessionManager::instance().generateId());  // it's just a random value
+        }
     }
 }
 
@@ -472,6 +476,13 @@ QString TActionController::getRenderingData(const QString &templateName, const Q
     return view->toString();
 }
 
+// Converts the UTF-8 output of a view to the encoding for HTTP output
+static QByteArray encodeForHttpOutput(const QByteArray &utf8)
+{
+    QTextCodec *codec = Tf::app()->codecForHttpOutput();
+    return (codec->mibEnum() == 106) ? utf8 : codec->fromUnicode(QString::fromUtf8(utf8));  // 106: UTF-8
+}
+
 /*!
   Renders the \a view view.
 */
@@ -487,7 +498,7 @@ QByteArray TActionController::renderView(TActionView *view)
     if (!layoutEnabled()) {
         // Renders without layout
         tSystemDebug("Renders without layout");
-        return Tf::app()->codecForHttpOutput()->fromUnicode(view->toString());
+        return encodeForHttpOutput(view->toUtf8());
     }
 
     // Displays with layout
@@ -505,7 +516,7 @@ QByteArray TActionController::renderView(TActionView *view)
             layoutView = defLayoutDispatcher.object();
             if (!layoutView) {
                 tSystemDebug("Not found default layout. Renders without layout.");
-                return Tf::app()->codecForHttpOutput()->fromUnicode(view->toString());
+                return encodeForHttpOutput(view->toUtf8());
             }
         }
     }
@@ -514,7 +525,7 @@ QByteArray TActionController::renderView(TActionView *view)
     layoutView->setVariantMap(allVariants());
     layoutView->setController(this);
     layoutView->setSubActionView(view);
-    return Tf::app()->codecForHttpOutput()->fromUnicode(layoutView->toString());
+    return encodeForHttpOutput(layoutView->toUtf8());
 }
 
 /*!
@@ -9,6 +9,7 @@
 #include <TSession>
 #include <TCookieJar>
 #include <TAccessValidator>
+#include <TJsonWriter>
 #include <QtCore>
 #include <QHostAddress>
 #include <QDomDocument>
@@ -80,6 +81,8 @@ protected:
     bool renderJson(const QVariantMap &map);
     bool renderJson(const QVariantList &list);
     bool renderJson(const QStringList &list);
+    bool renderJson(const TJsonWriter &writer);
+    template <class T> bool renderJson(const QList<T> &list);
     bool renderAndStoreInCache(const QByteArray &key, int seconds, const QString &action = QString(), const QString &layout = QString());
     bool renderFromCache(const QByteArray &key);
     void removeFromCache(const QByteArray &key);
@@ -212,6 +215,19 @@ inline QByteArray TActionController::contentType() const
     return response.header().contentType();
 }
 
+/*!
+  Renders the \a list as a JSON array, writing each element directly
+  with TJsonWriter. A list of models is written model by model, without
+  an intermediate array.
+*/
+template <class T>
+inline bool TActionController::renderJson(const QList<T> &list)
+{
+    TJsonWriter writer;
+    writer.value(list);
+    return renderJson(writer);
+}
+
 inline void TActionController::setContentType(const QByteArray &type)
 {
     response.header().setContentType(type);
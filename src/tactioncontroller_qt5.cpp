@@ -65,6 +65,15 @@ bool TActionController::renderJson(const QStringList &list)
     return renderJson(QJsonArray::fromStringList(list));
 }
 
+/*!
+  Renders the JSON document written by the \a writer as HTTP response,
+  without converting it again.
+*/
+bool TActionController::renderJson(const TJsonWriter &writer)
+{
+    return sendData(writer.data(), "application/json; charset=utf-8");
+}
+
 #if QT_VERSION >= 0x050c00  // 5.12.0
 bool TActionController::renderCbor(const QVariant &variant, QCborValue::EncodingOptions opt)
 {
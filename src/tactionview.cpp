@@ -11,10 +11,18 @@
 #include <THttpUtility>
 #include <THtmlAttribute>
 #include <TReactComponent>
+#include <TAbstractModel>
+#include <TCache>
 #include "tsystemglobal.h"
 #include <QDir>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QCryptographicHash>
+
+// Prefix of the keys of fragments in the cache shared with the application
+constexpr auto FRAGMENT_KEY_PREFIX = "tf.fragment:";
+// Leading byte of a cached fragment, telling an empty fragment from a miss
+constexpr char FRAGMENT_MARKER = '=';
 
 /*!
   \class TActionView
@@ -33,11 +41,23 @@ TActionView::TActionView() :
 { }
 
 /*!
-  Returns a content processed by a action.
+  Returns a content processed by a action. The content is spliced into
+  the output of the layout without being transcoded.
+*/
+TViewBuffer TActionView::yield() const
+{
+    return (subView) ? TViewBuffer(subView->toUtf8()) : TViewBuffer();
+}
+
+/*!
+  Returns the output of the view encoded in UTF-8. This function is
+  reimplemented by the views generated by tmake to render into the
+  buffer of UTF-8 bytes directly; the default implementation encodes
+  the string returned by toString().
 */
-QString TActionView::yield() const
+QByteArray TActionView::toUtf8()
 {
-    return (subView) ? subView->toString() : QString();
+    return toString().toUtf8();
 }
 
 /*!
@@ -119,6 +139,82 @@ QString TActionView::eh(const QVariant &var)
     }
 }
 
+/*!
+  Begins the fragment cache of the \a key. If the fragment is found in
+  the cache, outputs it and returns false so that the code rendering
+  the fragment is skipped; otherwise returns true, and the output until
+  the corresponding endFragmentCache() is stored in the cache for
+  \a seconds. The blocks can be nested. The \a key is prefixed with
+  "tf.fragment:" in the cache.
+
+  The views generated by tmake call this function for the
+  <%# cache key, seconds %> tag.
+  \sa cacheKey()
+*/
+bool TActionView::beginFragmentCache(const QByteArray &key, int seconds)
+{
+    QByteArray fragment = Tf::cache()->get(FRAGMENT_KEY_PREFIX + key);
+    if (fragment.startsWith(FRAGMENT_MARKER)) {
+        responsebody += fragment.mid(1);
+        return false;
+    }
+
+    fragmentCaches << FragmentCache {key, seconds, responsebody.size()};
+    return true;
+}
+
+/*!
+  Ends the fragment cache begun by beginFragmentCache(), and stores the
+  output of the fragment in the cache.
+*/
+void TActionView::endFragmentCache()
+{
+    if (fragmentCaches.isEmpty()) {
+        tSystemError("No fragment cache begun  [%s:%d]", __FILE__, __LINE__);
+        return;
+    }
+
+    FragmentCache fc = fragmentCaches.takeLast();
+    QByteArray fragment = FRAGMENT_MARKER + responsebody.toUtf8().mid(fc.offset);
+    Tf::cache()->set(FRAGMENT_KEY_PREFIX + fc.key, fragment, fc.seconds);
+}
+
+
+QByteArray TActionView::cacheKeyPart(const TAbstractModel &model)
+{
+    const QVariantMap map = model.toVariantMap();
+    QByteArray part = map.value(QStringLiteral("id"), map.value(QStringLiteral("_id"))).toString().toUtf8();
+
+    for (auto &prop : {QStringLiteral("updatedAt"), QStringLiteral("modifiedAt")}) {
+        QDateTime updated = map.value(prop).toDateTime();
+        if (updated.isValid()) {
+            part += '-';
+            part += QByteArray::number(updated.toMSecsSinceEpoch());
+            break;
+        }
+    }
+    return part;
+}
+
+
+QByteArray TActionView::cacheKeyPart(const QVariant &value)
+{
+    return value.toString().toUtf8();
+}
+
+
+QByteArray TActionView::joinCacheKey(const QByteArrayList &parts)
+{
+    const int MaxKeyLength = 250;
+    QByteArray key = parts.join('/');
+
+    if (key.length() > MaxKeyLength) {
+        // Keeps the first part readable
+        key = parts.value(0).left(MaxKeyLength / 2) + '/' + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+    }
+    return key;
+}
+
 /*!
   Returns the requested HTTP message.
 */
@@ -153,6 +249,11 @@ const THttpRequest &TActionView::httpRequest() const
   Outputs the number \a d to a view template.
 */
 
+/*!
+  \fn QString TActionView::echo(const TViewBuffer &buffer)
+  Outputs the contents of the \a buffer to a view template.
+*/
+
 /*!
   \fn QString TActionView::eh(const QString &str)
   Outputs a escaped string of the \a str to a view template.
@@ -10,8 +10,10 @@
 #include <THttpRequest>
 #include <TPrototypeAjaxHelper>
 #include <THttpUtility>
+#include <TViewBuffer>
 
 class TActionController;
+class TAbstractModel;
 
 
 class T_CORE_EXPORT TActionView : public QObject, public TActionHelper, public TViewHelper, public TPrototypeAjaxHelper
@@ -21,7 +23,8 @@ public:
     virtual ~TActionView() { }
 
     virtual QString toString() = 0;
-    QString yield() const;
+    virtual QByteArray toUtf8();
+    TViewBuffer yield() const;
     QString renderPartial(const QString &templateName, const QVariantMap &vars = QVariantMap()) const;
     QString authenticityToken() const;
     QVariant variant(const QString &name) const;
@@ -45,10 +48,12 @@ protected:
     QString echo(const QJsonDocument &doc);
     QString echo(const THtmlAttribute &attr);
     QString echo(const QVariant &var);
+    QString echo(const TViewBuffer &buffer);
     QString eh(const QString &str);
     QString eh(const char *str);
     QString eh(const QByteArray &str);
     QString eh(int n, int base = 10);
+    QString eh(uint n, int base = 10);
     QString eh(long n, int base = 10);
     QString eh(ulong n, int base = 10);
     QString eh(qlonglong n, int base = 10);
@@ -60,7 +65,10 @@ protected:
     QString eh(const THtmlAttribute &attr);
     QString eh(const QVariant &var);
     QString renderReact(const QString &component);
-    QString responsebody;
+    bool beginFragmentCache(const QByteArray &key, int seconds);
+    void endFragmentCache();
+    template <typename... Args> static QByteArray cacheKey(const Args &... args);
+    TViewBuffer responsebody;
 
 private:
     T_DISABLE_COPY(TActionView)
@@ -70,10 +78,21 @@ private:
     void setController(TActionController *controller);
     void setSubActionView(TActionView *actionView);
     virtual const TActionView *actionView() const { return this; }
+    static QByteArray cacheKeyPart(const TAbstractModel &model);
+    static QByteArray cacheKeyPart(const QVariant &value);
+    template <typename T> static QByteArray cacheKeyPart(const QList<T> &list);
+    static QByteArray joinCacheKey(const QByteArrayList &parts);
+
+    struct FragmentCache {
+        QByteArray key;
+        int seconds;
+        int offset;
+    };
 
     TActionController *actionController {nullptr};
     TActionView *subView {nullptr};
     QVariantMap variantMap;
+    QList<FragmentCache> fragmentCaches;
 
     friend class TActionController;
     friend class TActionMailer;
@@ -119,49 +138,55 @@ inline QString TActionView::echo(const QString &str)
 
 inline QString TActionView::echo(const char *str)
 {
-    responsebody += QString(str);  // using codecForCStrings()
+    responsebody += str;  // UTF-8
     return QString();
 }
 
 inline QString TActionView::echo(const QByteArray &str)
 {
-    responsebody += QString(str);  // using codecForCStrings()
+    responsebody += str;  // UTF-8
+    return QString();
+}
+
+inline QString TActionView::echo(const TViewBuffer &buffer)
+{
+    responsebody += buffer;
     return QString();
 }
 
 inline QString TActionView::echo(int n, int base)
 {
-    responsebody += QString::number(n, base);
+    responsebody += QByteArray::number(n, base);
     return QString();
 }
 
 inline QString TActionView::echo(long n, int base)
 {
-    responsebody += QString::number(n, base);
+    responsebody += QByteArray::number(n, base);
     return QString();
 }
 
 inline QString TActionView::echo(ulong n, int base)
 {
-    responsebody += QString::number(n, base);
+    responsebody += QByteArray::number(n, base);
     return QString();
 }
 
 inline QString TActionView::echo(qlonglong n, int base)
 {
-    responsebody += QString::number(n, base);
+    responsebody += QByteArray::number(n, base);
     return QString();
 }
 
 inline QString TActionView::echo(qulonglong n, int base)
 {
-    responsebody += QString::number(n, base);
+    responsebody += QByteArray::number(n, base);
     return QString();
 }
 
 inline QString TActionView::echo(double d, char format, int precision)
 {
-    responsebody += QString::number(d, format, precision);
+    responsebody += QByteArray::number(d, format, precision);
     return QString();
 }
 
@@ -183,47 +208,56 @@ inline QString TActionView::echo(const QJsonDocument &doc)
 
 inline QString TActionView::eh(const QString &str)
 {
-    return echo(THttpUtility::htmlEscape(str));
+    responsebody.appendHtmlEscaped(str);
+    return QString();
 }
 
 inline QString TActionView::eh(const char *str)
 {
-    return echo(THttpUtility::htmlEscape(str));
+    responsebody.appendHtmlEscaped(QByteArray::fromRawData(str, qstrlen(str)));
+    return QString();
 }
 
 inline QString TActionView::eh(const QByteArray &str)
 {
-    return echo(THttpUtility::htmlEscape(str));
+    responsebody.appendHtmlEscaped(str);
+    return QString();
 }
 
+// Numbers have no characters to escape
 inline QString TActionView::eh(int n, int base)
 {
-    return echo(THttpUtility::htmlEscape(QString::number(n, base)));
+    return echo(n, base);
+}
+
+inline QString TActionView::eh(uint n, int base)
+{
+    return echo((ulong)n, base);
 }
 
 inline QString TActionView::eh(long n, int base)
 {
-    return echo(THttpUtility::htmlEscape(QString::number(n, base)));
+    return echo(n, base);
 }
 
 inline QString TActionView::eh(ulong n, int base)
 {
-    return echo(THttpUtility::htmlEscape(QString::number(n, base)));
+    return echo(n, base);
 }
 
 inline QString TActionView::eh(qlonglong n, int base)
 {
-    return echo(THttpUtility::htmlEscape(QString::number(n, base)));
+    return echo(n, base);
 }
 
 inline QString TActionView::eh(qulonglong n, int base)
 {
-    return echo(THttpUtility::htmlEscape(QString::number(n, base)));
+    return echo(n, base);
 }
 
 inline QString TActionView::eh(double d, char format, int precision)
 {
-    return echo(THttpUtility::htmlEscape(QString::number(d, format, precision)));
+    return echo(d, format, precision);
 }
 
 inline QString TActionView::eh(const QJsonObject &object)
@@ -238,7 +272,7 @@ inline QString TActionView::eh(const QJsonArray &array)
 
 inline QString TActionView::eh(const QJsonDocument &doc)
 {
-    return echo(THttpUtility::htmlEscape(doc.toJson(QJsonDocument::Compact)));
+    return eh(doc.toJson(QJsonDocument::Compact));
 }
 
 inline void TActionView::setController(TActionController *controller)
@@ -246,4 +280,25 @@ inline void TActionView::setController(TActionController *controller)
     actionController = controller;
 }
 
+/*!
+  Returns a key for a fragment cache composed of the \a args. A model
+  is represented by its ID and the time it was updated, and a list by
+  its elements, so that the key changes whenever a model is updated.
+*/
+template <typename... Args>
+inline QByteArray TActionView::cacheKey(const Args &... args)
+{
+    return joinCacheKey(QByteArrayList {cacheKeyPart(args)...});
+}
+
+template <typename T>
+inline QByteArray TActionView::cacheKeyPart(const QList<T> &list)
+{
+    QByteArrayList parts;
+    for (auto &item : list) {
+        parts << cacheKeyPart(item);
+    }
+    return parts.join(',');
+}
+
 #endif // TACTIONVIEW_H
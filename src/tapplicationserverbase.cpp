@@ -10,6 +10,7 @@
 #include <TDispatcher>
 #include <TActionController>
 #include "tapplicationserverbase.h"
+#include "tgcscheduler.h"
 #include <QLibrary>
 #include <QList>
 #include <QDir>
@@ -162,11 +163,17 @@ void TApplicationServerBase::invokeStaticInitialize()
     if (!dispatched) {
         tSystemWarn("No such method: staticInitialize() of ApplicationController");
     }
+
+    // Starts the background GC
+    TGcScheduler::startAll();
 }
 
 
 void TApplicationServerBase::invokeStaticRelease()
 {
+    TGcScheduler::stopAll();
+
+
     // Calls staticRelease()
     TDispatcher<TActionController> dispatcher("applicationcontroller");
     bool dispatched = dispatcher.invoke("staticRelease", QStringList(), Qt::DirectConnection);
@@ -82,6 +82,19 @@ public:
         insert(Tf::CacheBackend, "Cache.Backend");
         insert(Tf::CacheGcProbability, "Cache.GcProbability");
         insert(Tf::CacheEnableCompression, "Cache.EnableCompression");
+        insert(Tf::SystemBusRingBufferSize, "SystemBus.RingBufferSize");
+        insert(Tf::WebSocketRedisBridge, "WebSocket.RedisBridge");
+        insert(Tf::KvsPoolHealthCheckIdleTime, "KvsPool.HealthCheckIdleTime");
+        insert(Tf::KvsPoolReconnectMaxBackoff, "KvsPool.ReconnectMaxBackoff");
+        insert(Tf::CacheEnableQueryCache, "Cache.EnableQueryCache");
+        insert(Tf::SqlAsyncThreadCount, "SqlAsyncThreadCount");
+        insert(Tf::SqlQuerySlowLogFile, "SqlQuerySlowLogFile");
+        insert(Tf::SqlQuerySlowLogThreshold, "SqlQuerySlowLogThreshold");
+        insert(Tf::SqlQuerySlowLogExplain, "SqlQuerySlowLogExplain");
+        insert(Tf::SessionRefreshInterval, "Session.RefreshInterval");
+        insert(Tf::SessionGcInterval, "Session.GcInterval");
+        insert(Tf::CacheGcInterval, "Cache.GcInterval");
+        insert(Tf::SessionCookieMacAlgorithm, "Session.CookieMacAlgorithm");
     }
 };
 Q_GLOBAL_STATIC(AttributeMap, attributeMap)
@@ -10,6 +10,7 @@
 #include <TAppSettings>
 #include "tcachefactory.h"
 #include "tcachestore.h"
+#include "tgcscheduler.h"
 
 /*!
   \class TCache
@@ -19,7 +20,8 @@
 TCache::TCache()
 {
     static int CacheGcProbability = TAppSettings::instance()->value(Tf::CacheGcProbability, 0).toInt();
-    _gcDivisor = CacheGcProbability;
+    // Collected by TGcScheduler in the background if the interval is set
+    _gcDivisor = (TGcScheduler::interval(TGcScheduler::Cache) > 0) ? 0 : CacheGcProbability;
 
     if (Tf::app()->cacheEnabled()) {
         _cache = TCacheFactory::create(Tf::app()->cacheBackend());
@@ -93,6 +95,62 @@ void TCache::remove(const QByteArray &key)
     }
 }
 
+/*!
+  Returns the values associated with the \a keys, in the same order.
+  Backends that support it fetch all the keys in one round trip.
+ */
+QByteArrayList TCache::get(const QByteArrayList &keys)
+{
+    QByteArrayList values;
+
+    if (_cache) {
+        values = _cache->values(keys);
+        if (compressionEnabled()) {
+            for (auto &value : values) {
+                value = Tf::lz4Uncompress(value);
+            }
+        }
+    }
+    return values;
+}
+
+/*!
+  Stores all the \a values with their keys in the cache and sets the
+  timeout after a given number of \a seconds.
+ */
+bool TCache::set(const QMap<QByteArray, QByteArray> &values, int seconds)
+{
+    bool ret = false;
+
+    if (_cache) {
+        if (compressionEnabled()) {
+            QMap<QByteArray, QByteArray> compressed;
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+                compressed.insert(it.key(), Tf::lz4Compress(it.value()));
+            }
+            ret = _cache->setValues(compressed, seconds);
+        } else {
+            ret = _cache->setValues(values, seconds);
+        }
+
+        // GC
+        if (_gcDivisor > 0 && Tf::random(1, _gcDivisor) == 1) {
+            _cache->gc();
+        }
+    }
+    return ret;
+}
+
+/*!
+  Removes the items that have the \a keys from the cache.
+ */
+void TCache::remove(const QByteArrayList &keys)
+{
+    if (_cache) {
+        _cache->removeValues(keys);
+    }
+}
+
 /*!
   Removes all items from the cache.
  */
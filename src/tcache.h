@@ -2,6 +2,8 @@
 #define TCACHE_H
 
 #include <TGlobal>
+#include <QByteArrayList>
+#include <QMap>
 
 class TCacheStore;
 
@@ -15,6 +17,9 @@ public:
     bool set(const QByteArray &key, const QByteArray &value, int seconds);
     QByteArray get(const QByteArray &key);
     void remove(const QByteArray &key);
+    QByteArrayList get(const QByteArrayList &keys);
+    bool set(const QMap<QByteArray, QByteArray> &values, int seconds);
+    void remove(const QByteArrayList &keys);
     void clear();
 
     static bool compressionEnabled();
@@ -81,6 +81,28 @@ void TCacheMongoStore::gc()
 }
 
 
+int TCacheMongoStore::gcBatch(int maxCount)
+{
+    TMongoQuery mongo(Tf::KvsEngine::CacheKvs, COL);
+    qint64 current = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+    QVariantMap lte {{"t", QVariantMap {{"$lte", current}}}};
+    mongo.setLimit(maxCount);
+    mongo.find(lte, QVariantMap(), {"k"});
+
+    QVariantList keys;
+    while (mongo.next()) {
+        keys << mongo.value().value("k");
+    }
+
+    if (keys.isEmpty()) {
+        return 0;
+    }
+    QVariantMap cri {{"k", QVariantMap {{"$in", keys}}}};
+    return TMongoQuery(Tf::KvsEngine::CacheKvs, COL).remove(cri);
+}
+
+
 QMap<QString, QVariant> TCacheMongoStore::defaultSettings() const
 {
     QMap<QString, QVariant> settings {
@@ -20,6 +20,7 @@ public:
     bool remove(const QByteArray &key) override;
     void clear() override;
     void gc() override;
+    int gcBatch(int maxCount) override;
     QMap<QString, QVariant> defaultSettings() const override;
 
 protected:
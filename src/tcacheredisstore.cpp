@@ -7,6 +7,7 @@
 
 #include "tcacheredisstore.h"
 #include <TRedis>
+#include <TRedisPipeline>
 
 
 TCacheRedisStore::TCacheRedisStore()
@@ -55,6 +56,39 @@ void TCacheRedisStore::gc()
 { }
 
 
+QByteArrayList TCacheRedisStore::values(const QByteArrayList &keys)
+{
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    QByteArrayList ret = redis.mget(keys);
+    if (ret.count() != keys.count()) {
+        ret = QByteArrayList();
+        ret.reserve(keys.count());
+        for (int i = 0; i < keys.count(); i++) {
+            ret << QByteArray();
+        }
+    }
+    return ret;
+}
+
+
+bool TCacheRedisStore::setValues(const QMap<QByteArray, QByteArray> &values, int seconds)
+{
+    // SETEX for each key in one round trip, since MSET can not set a timeout
+    TRedisPipeline pipeline(TRedis(Tf::KvsEngine::CacheKvs));
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        pipeline << QByteArrayList({ "SETEX", it.key(), QByteArray::number(seconds), it.value() });
+    }
+    return pipeline.exec();
+}
+
+
+int TCacheRedisStore::removeValues(const QByteArrayList &keys)
+{
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    return (keys.isEmpty()) ? 0 : redis.del(keys);
+}
+
+
 QMap<QString, QVariant> TCacheRedisStore::defaultSettings() const
 {
     QMap<QString, QVariant> settings {
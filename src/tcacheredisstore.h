@@ -20,6 +20,9 @@ public:
     bool remove(const QByteArray &key) override;
     void clear() override;
     void gc() override;
+    QByteArrayList values(const QByteArrayList &keys) override;
+    bool setValues(const QMap<QByteArray, QByteArray> &values, int seconds) override;
+    int removeValues(const QByteArrayList &keys) override;
     QMap<QString, QVariant> defaultSettings() const override;
 
 protected:
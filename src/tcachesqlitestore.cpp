@@ -293,6 +293,27 @@ void TCacheSQLiteStore::gc()
 }
 
 
+int TCacheSQLiteStore::gcBatch(int maxCount)
+{
+    int cnt = -1;
+
+    TSqlQuery query(Tf::app()->databaseIdForCache());
+    QString sql = QStringLiteral("delete from %1 where rowid in (select rowid from %1 where %2<:ts limit :n)").arg(_table, TIMESTAMP_COLUMN);
+
+    query.prepare(sql);
+    query.bind(":ts", 1 + QDateTime::currentMSecsSinceEpoch() / 1000);
+    query.bind(":n", maxCount);
+    if (query.exec()) {
+        cnt = query.numRowsAffected();
+    } else {
+        if (lastError().isValid()) {
+            tSystemError("SQLite error : %s [%s:%d]", qPrintable(lastErrorString()), __FILE__, __LINE__);
+        }
+    }
+    return cnt;
+}
+
+
 QMap<QString, QVariant> TCacheSQLiteStore::defaultSettings() const
 {
     QMap<QString, QVariant> settings {
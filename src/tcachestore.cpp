@@ -1 +1,67 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
 #include "tcachestore.h"
+
+/*!
+  \class TCacheStore
+  \brief The TCacheStore class is the abstract base class of cache backends.
+*/
+
+/*!
+  Returns the values associated with the \a keys, in the same order.
+  The default implementation calls get() for each key; backends that can
+  fetch multiple keys at once reimplement it.
+*/
+QByteArrayList TCacheStore::values(const QByteArrayList &keys)
+{
+    QByteArrayList ret;
+    ret.reserve(keys.count());
+    for (auto &key : keys) {
+        ret << get(key);
+    }
+    return ret;
+}
+
+/*!
+  Stores all the \a values with their keys and sets the timeout after
+  a given number of \a seconds.
+*/
+bool TCacheStore::setValues(const QMap<QByteArray, QByteArray> &values, int seconds)
+{
+    bool ret = true;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        ret &= set(it.key(), it.value(), seconds);
+    }
+    return ret;
+}
+
+/*!
+  Removes the items that have the \a keys and returns the number of
+  items removed.
+*/
+int TCacheStore::removeValues(const QByteArrayList &keys)
+{
+    int cnt = 0;
+    for (auto &key : keys) {
+        cnt += remove(key) ? 1 : 0;
+    }
+    return cnt;
+}
+
+/*!
+  Removes at most \a maxCount expired values, and returns the number of
+  the removed values. The background GC calls this function repeatedly
+  while it returns \a maxCount. The default implementation calls gc() to
+  remove all of them at once, and returns 0.
+*/
+int TCacheStore::gcBatch(int maxCount)
+{
+    Q_UNUSED(maxCount);
+    gc();
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <TGlobal>
 #include <QMap>
 #include <QByteArray>
+#include <QByteArrayList>
 #include <QVariant>
 
 
@@ -26,6 +27,10 @@ public:
     virtual bool remove(const QByteArray &key) = 0;
     virtual void clear() = 0;
     virtual void gc() = 0;
+    virtual int gcBatch(int maxCount);
+    virtual QByteArrayList values(const QByteArrayList &keys);
+    virtual bool setValues(const QMap<QByteArray, QByteArray> &values, int seconds);
+    virtual int removeValues(const QByteArrayList &keys);
     virtual QMap<QString, QVariant> defaultSettings() const { return QMap<QString, QVariant>(); }
 };
 
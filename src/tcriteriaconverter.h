@@ -4,8 +4,8 @@
 #include <TGlobal>
 #include <TCriteria>
 #include <TSqlQuery>
+#include <TSqlObject>
 #include "tsystemglobal.h"
-#include <QMetaObject>
 #include <QVariant>
 
 namespace TSql
@@ -87,14 +87,13 @@ public:
     static QString getPropertyName(int property, const QSqlDriver *driver, const QString &aliasTableName = QString());
 
 protected:
-    static QString getPropertyName(const QMetaObject *metaObject, int property, const QSqlDriver *driver, const QString &aliasTableName);
+    static const TSqlColumn *column(int property);
     QString criteriaToString(const QVariant &cri) const;
     static QString criteriaToString(const QString &propertyName, QVariant::Type varType, TSql::ComparisonOperator op, const QVariant &val1, const QVariant &val2, const QSqlDatabase &database);
     static QString criteriaToString(const QString &propertyName, QVariant::Type varType, TSql::ComparisonOperator op1, TSql::ComparisonOperator op2, const QVariant &val, const QSqlDatabase &database);
     static QString concat(const QString &s1, TCriteria::LogicalOperator op, const QString &s2);
 
 private:
-    T obj;
     TCriteria criteria;
     QSqlDatabase database;
     QString tableAlias;
@@ -246,45 +245,64 @@ inline QString TCriteriaConverter<T>::criteriaToString(const QVariant &var) cons
 }
 
 
+/*!
+  Returns the descriptor of the column for the \a property of T, or
+  nullptr if not found. The descriptors are retrieved once per class.
+*/
 template <class T>
-inline QString TCriteriaConverter<T>::getPropertyName(const QMetaObject *metaObject, int property, const QSqlDriver *driver, const QString &aliasTableName)
+inline const TSqlColumn *TCriteriaConverter<T>::column(int property)
 {
-    if (property < 0) {
-        return QString();
+    static const TSqlColumnList columns = T().columns();
+
+    if (property < 0 || property >= columns.count()) {
+        return nullptr;
     }
 
-    QString name = (metaObject) ? metaObject->property(metaObject->propertyOffset() + property).name() : QString();
-    if (name.isEmpty()) {
-        return name;
+    const TSqlColumn *col = &columns.at(property);
+    if (Q_LIKELY(col->index == property)) {
+        return col;
     }
 
-    name = TSqlQuery::escapeIdentifier(name, QSqlDriver::FieldName, driver);
-    if (!aliasTableName.isEmpty()) {
-        name = aliasTableName + QLatin1Char('.') + name;
+    for (auto &c : columns) {
+        if (c.index == property) {
+            return &c;
+        }
     }
-    return name;
+    return nullptr;
 }
 
 
 template <class T>
 inline QString TCriteriaConverter<T>::propertyName(int property, const QSqlDriver *driver, const QString &aliasTableName) const
 {
-    return getPropertyName(obj.metaObject(), property, driver, aliasTableName);
+    return getPropertyName(property, driver, aliasTableName);
 }
 
 
 template <class T>
 inline QString TCriteriaConverter<T>::getPropertyName(int property, const QSqlDriver *driver, const QString &aliasTableName)
 {
-    return getPropertyName(T().metaObject(), property, driver, aliasTableName);
+    const TSqlColumn *col = column(property);
+    if (!col) {
+        return QString();
+    }
+
+    QString name = TSqlQuery::escapeIdentifier(QLatin1String(col->name), QSqlDriver::FieldName, driver);
+    if (!aliasTableName.isEmpty()) {
+        name = aliasTableName + QLatin1Char('.') + name;
+    }
+    return name;
 }
 
 
 template <class T>
 inline QVariant::Type TCriteriaConverter<T>::variantType(int property) const
 {
-    const QMetaObject *metaObject = obj.metaObject();
-    return (metaObject) ? metaObject->property(metaObject->propertyOffset() + property).type() : QVariant::Invalid;
+    const TSqlColumn *col = column(property);
+    if (!col) {
+        return QVariant::Invalid;
+    }
+    return (col->type < QMetaType::User) ? (QVariant::Type)col->type : QVariant::UserType;
 }
 
 
@@ -7,6 +7,23 @@
 
 #include <TCryptMac>
 #include <QMessageAuthenticationCode>
+#include <QThreadStorage>
+
+namespace {
+
+// HMAC-SHA256 keyed for each thread, not to set up the key for every MAC
+class HmacKey
+{
+public:
+    HmacKey() : hmac(QCryptographicHash::Sha256) { }
+
+    QByteArray key;
+    QMessageAuthenticationCode hmac;
+};
+
+QThreadStorage<HmacKey *> hmacKeyStorage;
+
+}
 
 /*!
   \class TCryptMac
@@ -22,3 +39,44 @@ QByteArray TCryptMac::hash(const QByteArray &data, const QByteArray &key, Algori
 {
     return QMessageAuthenticationCode::hash(data, key, (QCryptographicHash::Algorithm)method);
 }
+
+/*!
+  Returns the HMAC-SHA256 of the \a data with the \a key. The key is
+  kept for each thread, so that a MAC with the same key, such as the
+  secret of the application, is computed without setting it up again.
+*/
+QByteArray TCryptMac::hmacSha256(const QByteArray &data, const QByteArray &key)
+{
+    HmacKey *hk = hmacKeyStorage.localData();
+    if (!hk) {
+        hk = new HmacKey;
+        hmacKeyStorage.setLocalData(hk);
+    }
+
+    if (hk->key != key || hk->key.isNull()) {
+        hk->hmac.setKey(key);
+        hk->key = key;
+    } else {
+        hk->hmac.reset();
+    }
+    hk->hmac.addData(data);
+    return hk->hmac.result();
+}
+
+/*!
+  Returns true if \a a is equal to \a b. The bytes are compared in
+  constant time regardless of the first difference, to verify a MAC
+  without leaking it by the timing.
+*/
+bool TCryptMac::equals(const QByteArray &a, const QByteArray &b)
+{
+    if (a.length() != b.length()) {
+        return false;
+    }
+
+    uchar diff = 0;
+    for (int i = 0; i < a.length(); ++i) {
+        diff |= (uchar)(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
@@ -22,6 +22,8 @@ public:
     };
 
     static QByteArray hash(const QByteArray &data, const QByteArray &key, Algorithm method);
+    static QByteArray hmacSha256(const QByteArray &data, const QByteArray &key);
+    static bool equals(const QByteArray &a, const QByteArray &b);
 };
 
 #endif // TCRYPTMAC_H
@@ -8,6 +8,7 @@
 #include "tdatabasecontext.h"
 #include "tsqldatabasepool.h"
 #include "tkvsdatabasepool.h"
+#include "tsqlquerycache.h"
 #include "tsystemglobal.h"
 #include <TWebApplication>
 #include <TKvsDriver>
@@ -75,10 +76,44 @@ QSqlDatabase &TDatabaseContext::getSqlDatabase(int id)
 }
 
 
+/*!
+  Returns the database connection for read-only queries. A connection to
+  a read replica is returned if replicas are configured, unless a write
+  has been executed on the primary database or a transaction is active
+  on it in this context; in that case returns the connection to the
+  primary database so that the reads see the writes.
+*/
+QSqlDatabase &TDatabaseContext::getReadSqlDatabase(int id)
+{
+    if (id < 0 || id >= Tf::app()->sqlDatabaseSettingsCount()) {
+        return getSqlDatabase(id);
+    }
+
+    if (isTransactionActive(id) || writtenDatabases.contains(id)
+        || TSqlDatabasePool::instance()->replicaCount(id) == 0) {
+        return getSqlDatabase(id);
+    }
+
+    QSqlDatabase &db = replicaDatabases[id];
+    if (!db.isValid()) {
+        db = TSqlDatabasePool::instance()->replicaDatabase(id);
+    }
+
+    idleElapsed = (uint)std::time(nullptr);
+    return db;
+}
+
+
 void TDatabaseContext::releaseSqlDatabases()
 {
     rollbackTransactions();
     sqlDatabases.clear();
+
+    for (auto it = replicaDatabases.begin(); it != replicaDatabases.end(); ++it) {
+        TSqlDatabasePool::instance()->pool(it.value());
+    }
+    replicaDatabases.clear();
+    writtenDatabases.clear();
 }
 
 
@@ -132,6 +167,14 @@ void TDatabaseContext::commitTransactions()
         tx.commit();
         TSqlDatabasePool::instance()->pool(tx.database());
     }
+
+    if (!modifiedTables.isEmpty()) {
+        for (auto it = modifiedTables.constBegin(); it != modifiedTables.constEnd(); ++it) {
+            TSqlQueryCache::invalidate(it.key(), it.value());
+        }
+        modifiedTables.clear();
+        commitCacheTransaction();
+    }
 }
 
 
@@ -147,9 +190,28 @@ bool TDatabaseContext::commitTransaction(int id)
     TSqlTransaction &tx = sqlDatabases[id];
     res = tx.commit();
     TSqlDatabasePool::instance()->pool(sqlDatabases[id].database());
+    if (modifiedTables.contains(id)) {
+        TSqlQueryCache::invalidate(id, modifiedTables.take(id));
+        commitCacheTransaction();
+    }
     return res;
 }
 
+/*!
+  Commits the transaction on the SQL database of the cache, in which the
+  generations of the query cache are written after the commit of the
+  modified tables; otherwise they would be rolled back on release.
+*/
+void TDatabaseContext::commitCacheTransaction()
+{
+    const int id = Tf::app()->databaseIdForCache();
+    if (id >= 0 && isTransactionActive(id)) {
+        TSqlTransaction &tx = sqlDatabases[id];
+        tx.commit();
+        TSqlDatabasePool::instance()->pool(tx.database());
+    }
+}
+
 
 void TDatabaseContext::rollbackTransactions()
 {
@@ -158,6 +220,7 @@ void TDatabaseContext::rollbackTransactions()
         tx.rollback();
         TSqlDatabasePool::instance()->pool(tx.database(), true);
     }
+    modifiedTables.clear();
 }
 
 
@@ -171,9 +234,50 @@ bool TDatabaseContext::rollbackTransaction(int id)
     }
     res = sqlDatabases[id].rollback();
     TSqlDatabasePool::instance()->pool(sqlDatabases[id].database(), true);
+    modifiedTables.remove(id);
     return res;
 }
 
+/*!
+  Records that rows of the table \a tableName in the database \a id have
+  been modified. The query cache of the table is invalidated when the
+  transaction is committed, or immediately if no transaction is active.
+*/
+void TDatabaseContext::addModifiedTable(int id, const QString &tableName)
+{
+    auto it = sqlDatabases.find(id);
+    if (it != sqlDatabases.end() && it->isActive()) {
+        QStringList &tables = modifiedTables[id];
+        if (!tables.contains(tableName)) {
+            tables << tableName;
+        }
+    } else {
+        TSqlQueryCache::invalidate(id, QStringList(tableName));
+    }
+}
+
+
+/*!
+  Records that a write has been executed on the database \a id. The
+  following reads in this context are not routed to a read replica.
+  \sa getReadSqlDatabase()
+*/
+void TDatabaseContext::setDatabaseWritten(int id)
+{
+    writtenDatabases.insert(id);
+}
+
+
+/*!
+  Returns true if a transaction is active on the database \a id in this
+  context; otherwise returns false.
+*/
+bool TDatabaseContext::isTransactionActive(int id) const
+{
+    auto it = sqlDatabases.constFind(id);
+    return it != sqlDatabases.constEnd() && it->isActive();
+}
+
 
 int TDatabaseContext::idleTime() const
 {
@@ -2,6 +2,8 @@
 #define TDATABASECONTEXT_H
 
 #include <QMap>
+#include <QSet>
+#include <QStringList>
 #include <QSqlDatabase>
 #include <TSqlTransaction>
 #include <TKvsDatabase>
@@ -15,6 +17,7 @@ public:
     virtual ~TDatabaseContext();
 
     QSqlDatabase &getSqlDatabase(int id = 0);
+    QSqlDatabase &getReadSqlDatabase(int id = 0);
     TKvsDatabase &getKvsDatabase(Tf::KvsEngine engine);
 
     void setTransactionEnabled(bool enable, int id = 0);
@@ -23,6 +26,9 @@ public:
     bool commitTransaction(int id = 0);
     void rollbackTransactions();
     bool rollbackTransaction(int id = 0);
+    void addModifiedTable(int id, const QString &tableName);
+    void setDatabaseWritten(int id);
+    bool isTransactionActive(int id = 0) const;
     int idleTime() const;
     static TDatabaseContext *currentDatabaseContext();
     static void setCurrentDatabaseContext(TDatabaseContext *context);
@@ -30,8 +36,12 @@ public:
 protected:
     void releaseKvsDatabases();
     void releaseSqlDatabases();
+    void commitCacheTransaction();
 
     QMap<int, TSqlTransaction> sqlDatabases;
+    QMap<int, QSqlDatabase> replicaDatabases;
+    QMap<int, QStringList> modifiedTables;
+    QSet<int> writtenDatabases;
     QMap<int, TKvsDatabase> kvsDatabases;
 
 private:
@@ -0,0 +1,313 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tescapekernel.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define TF_HAVE_SSE2
+# include <emmintrin.h>
+# if defined(Q_CC_GNU)
+// Compiled for AVX2 and dispatched at runtime
+#  define TF_HAVE_AVX2
+#  define TF_AVX2_FUNCTION __attribute__((target("avx2")))
+#  include <immintrin.h>
+# elif defined(__AVX2__)
+#  define TF_HAVE_AVX2
+#  define TF_AVX2_FUNCTION
+#  include <immintrin.h>
+# endif
+#endif
+
+#if defined(Q_CC_MSVC)
+# include <intrin.h>
+#endif
+
+namespace {
+
+struct Kernel {
+    const char *name;
+    int (*find8)(const uchar *str, int length, ushort q1, ushort q2);
+    int (*find16)(const ushort *str, int length, ushort q1, ushort q2);
+};
+
+
+inline int countTrailingZeros(uint v)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_ctz(v);
+#elif defined(Q_CC_MSVC)
+    unsigned long idx;
+    _BitScanForward(&idx, v);
+    return (int)idx;
+#else
+    int n = 0;
+    for (; !(v & 1); v >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/*
+  Each kernel returns the index of the first '&', '<', '>', q1 or q2 in
+  the str, or the length if not found. The quotes not to be escaped are
+  given as '&' so that the kernels have a fixed set of five characters.
+*/
+template <typename Char>
+int findScalar(const Char *str, int length, ushort q1, ushort q2)
+{
+    for (int i = 0; i < length; ++i) {
+        ushort c = str[i];
+        if (c == '&' || c == '<' || c == '>' || c == q1 || c == q2) {
+            return i;
+        }
+    }
+    return length;
+}
+
+#ifdef TF_HAVE_SSE2
+
+int findSse2(const uchar *str, int length, ushort q1, ushort q2)
+{
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i c1 = _mm_set1_epi8((char)q1);
+    const __m128i c2 = _mm_set1_epi8((char)q2);
+    int i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, lt)),
+                                 _mm_or_si128(_mm_cmpeq_epi8(v, gt), _mm_or_si128(_mm_cmpeq_epi8(v, c1), _mm_cmpeq_epi8(v, c2))));
+        uint mask = (uint)_mm_movemask_epi8(m);
+        if (mask) {
+            return i + countTrailingZeros(mask);
+        }
+    }
+    return i + findScalar(str + i, length - i, q1, q2);
+}
+
+
+int findSse2(const ushort *str, int length, ushort q1, ushort q2)
+{
+    const __m128i amp = _mm_set1_epi16('&');
+    const __m128i lt = _mm_set1_epi16('<');
+    const __m128i gt = _mm_set1_epi16('>');
+    const __m128i c1 = _mm_set1_epi16((short)q1);
+    const __m128i c2 = _mm_set1_epi16((short)q2);
+    int i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, amp), _mm_cmpeq_epi16(v, lt)),
+                                 _mm_or_si128(_mm_cmpeq_epi16(v, gt), _mm_or_si128(_mm_cmpeq_epi16(v, c1), _mm_cmpeq_epi16(v, c2))));
+        uint mask = (uint)_mm_movemask_epi8(m);  // 2 bits per character
+        if (mask) {
+            return i + countTrailingZeros(mask) / 2;
+        }
+    }
+    return i + findScalar(str + i, length - i, q1, q2);
+}
+
+#endif // TF_HAVE_SSE2
+
+#ifdef TF_HAVE_AVX2
+
+TF_AVX2_FUNCTION int findAvx2(const uchar *str, int length, ushort q1, ushort q2)
+{
+    const __m256i amp = _mm256_set1_epi8('&');
+    const __m256i lt = _mm256_set1_epi8('<');
+    const __m256i gt = _mm256_set1_epi8('>');
+    const __m256i c1 = _mm256_set1_epi8((char)q1);
+    const __m256i c2 = _mm256_set1_epi8((char)q2);
+    int i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, amp), _mm256_cmpeq_epi8(v, lt)),
+                                    _mm256_or_si256(_mm256_cmpeq_epi8(v, gt), _mm256_or_si256(_mm256_cmpeq_epi8(v, c1), _mm256_cmpeq_epi8(v, c2))));
+        uint mask = (uint)_mm256_movemask_epi8(m);
+        if (mask) {
+            return i + countTrailingZeros(mask);
+        }
+    }
+    return i + findSse2(str + i, length - i, q1, q2);
+}
+
+
+TF_AVX2_FUNCTION int findAvx2(const ushort *str, int length, ushort q1, ushort q2)
+{
+    const __m256i amp = _mm256_set1_epi16('&');
+    const __m256i lt = _mm256_set1_epi16('<');
+    const __m256i gt = _mm256_set1_epi16('>');
+    const __m256i c1 = _mm256_set1_epi16((short)q1);
+    const __m256i c2 = _mm256_set1_epi16((short)q2);
+    int i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(str + i));
+        __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi16(v, amp), _mm256_cmpeq_epi16(v, lt)),
+                                    _mm256_or_si256(_mm256_cmpeq_epi16(v, gt), _mm256_or_si256(_mm256_cmpeq_epi16(v, c1), _mm256_cmpeq_epi16(v, c2))));
+        uint mask = (uint)_mm256_movemask_epi8(m);  // 2 bits per character
+        if (mask) {
+            return i + countTrailingZeros(mask) / 2;
+        }
+    }
+    return i + findSse2(str + i, length - i, q1, q2);
+}
+
+#endif // TF_HAVE_AVX2
+
+// In ascending order of preference
+const Kernel kernels[] = {
+    {"scalar", findScalar<uchar>, findScalar<ushort>},
+#ifdef TF_HAVE_SSE2
+    {"sse2", findSse2, findSse2},
+#endif
+#ifdef TF_HAVE_AVX2
+    {"avx2", findAvx2, findAvx2},
+#endif
+};
+
+
+bool isSupported(const Kernel &kernel)
+{
+#if defined(TF_HAVE_AVX2) && defined(Q_CC_GNU)
+    if (!std::strcmp(kernel.name, "avx2")) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#else
+    Q_UNUSED(kernel);
+#endif
+    return true;
+}
+
+
+const Kernel *&currentKernel()
+{
+    static const Kernel *kernel = []() {
+        for (int i = sizeof(kernels) / sizeof(kernels[0]) - 1; i > 0; --i) {
+            if (isSupported(kernels[i])) {
+                return &kernels[i];
+            }
+        }
+        return &kernels[0];
+    }();
+    return kernel;
+}
+
+
+inline void getQuotes(Tf::EscapeFlag flag, ushort *q1, ushort *q2)
+{
+    *q1 = (flag == Tf::Compatible || flag == Tf::Quotes) ? '"' : '&';
+    *q2 = (flag == Tf::Quotes) ? '\'' : '&';
+}
+
+}
+
+/*!
+  \class TEscapeKernel
+  \brief The TEscapeKernel class scans strings for the characters to be
+  escaped for HTML and JSON, 16 or 32 bytes at a time with SSE2 or AVX2
+  instructions, if available.
+
+  The kernel is selected at runtime according to the features of the
+  CPU, falling back to the scalar one.
+  \sa THttpUtility::htmlEscape(), THttpUtility::jsonEscape()
+*/
+
+/*!
+  Returns the index of the first character in the UTF-8 \a str of
+  \a length bytes that is escaped by THttpUtility::htmlEscape() with the
+  \a flag, or \a length if no such character is found. For JSON, specify
+  Tf::NoQuotes.
+*/
+int TEscapeKernel::indexOfSpecialChar(const char *str, int length, Tf::EscapeFlag flag)
+{
+    ushort q1, q2;
+    getQuotes(flag, &q1, &q2);
+    return currentKernel()->find8((const uchar *)str, length, q1, q2);
+}
+
+/*!
+  Returns the index of the first character in the UTF-16 \a str of
+  \a length characters that is escaped by THttpUtility::htmlEscape()
+  with the \a flag, or \a length if no such character is found.
+*/
+int TEscapeKernel::indexOfSpecialChar(const QChar *str, int length, Tf::EscapeFlag flag)
+{
+    ushort q1, q2;
+    getQuotes(flag, &q1, &q2);
+    return currentKernel()->find16((const ushort *)str, length, q1, q2);
+}
+
+/*!
+  Returns the HTML entity of the character \a ch, or nullptr if it is
+  not a special character.
+*/
+const char *TEscapeKernel::htmlEntity(ushort ch)
+{
+    switch (ch) {
+    case '&':
+        return "&amp;";
+    case '<':
+        return "&lt;";
+    case '>':
+        return "&gt;";
+    case '"':
+        return "&quot;";
+    case '\'':
+        return "&#039;";
+    default:
+        return nullptr;
+    }
+}
+
+/*!
+  Returns the JSON escape sequence of the character \a ch, or nullptr
+  if it is not a special character.
+*/
+const char *TEscapeKernel::jsonEntity(ushort ch)
+{
+    switch (ch) {
+    case '&':
+        return "\\u0026";
+    case '<':
+        return "\\u003C";
+    case '>':
+        return "\\u003E";
+    default:
+        return nullptr;
+    }
+}
+
+/*!
+  Returns the name of the current kernel; "avx2", "sse2" or "scalar".
+*/
+const char *TEscapeKernel::name()
+{
+    return currentKernel()->name;
+}
+
+/*!
+  Selects the kernel of the \a name if supported by the CPU, and returns
+  true; otherwise returns false. This function is for benchmarks and
+  tests, and is not thread-safe.
+*/
+bool TEscapeKernel::select(const char *name)
+{
+    for (const auto &kernel : kernels) {
+        if (!std::strcmp(kernel.name, name) && isSupported(kernel)) {
+            currentKernel() = &kernel;
+            return true;
+        }
+    }
+    return false;
+}
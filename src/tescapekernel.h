@@ -0,0 +1,23 @@
+#ifndef TESCAPEKERNEL_H
+#define TESCAPEKERNEL_H
+
+#include <QChar>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TEscapeKernel
+{
+public:
+    static int indexOfSpecialChar(const char *str, int length, Tf::EscapeFlag flag);
+    static int indexOfSpecialChar(const QChar *str, int length, Tf::EscapeFlag flag);
+    static const char *htmlEntity(ushort ch);
+    static const char *jsonEntity(ushort ch);
+    static const char *name();
+    static bool select(const char *name);
+
+private:
+    T_DISABLE_COPY(TEscapeKernel)
+    T_DISABLE_MOVE(TEscapeKernel)
+};
+
+#endif // TESCAPEKERNEL_H
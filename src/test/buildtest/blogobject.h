@@ -28,6 +28,46 @@ public:
     int autoValueIndex() const { return Id; }
     QString tableName() const { return QLatin1String("blog"); }
 
+    static TSqlColumnList columnList()
+    {
+        static constexpr TSqlColumn list[] = {
+            {Id, "id", QMetaType::Int, TSql::PrimaryKeyColumn | TSql::AutoValueColumn},
+            {Title, "title", QMetaType::QString, 0},
+            {Body, "body", QMetaType::QString, 0},
+            {CreatedAt, "created_at", QMetaType::QDateTime, TSql::CreatedAtColumn},
+            {UpdatedAt, "updated_at", QMetaType::QDateTime, TSql::UpdatedAtColumn},
+            {LockRevision, "lock_revision", QMetaType::Int, TSql::LockRevisionColumn},
+        };
+        return TSqlColumnList(list);
+    }
+    TSqlColumnList columns() const { return columnList(); }
+
+    QVariant columnValue(int index) const
+    {
+        switch (index) {
+        case Id: return QVariant::fromValue(id);
+        case Title: return QVariant::fromValue(title);
+        case Body: return QVariant::fromValue(body);
+        case CreatedAt: return QVariant::fromValue(created_at);
+        case UpdatedAt: return QVariant::fromValue(updated_at);
+        case LockRevision: return QVariant::fromValue(lock_revision);
+        default: return QVariant();
+        }
+    }
+
+    void setColumnValue(int index, const QVariant &value)
+    {
+        switch (index) {
+        case Id: id = value.value<int>(); break;
+        case Title: title = value.value<QString>(); break;
+        case Body: body = value.value<QString>(); break;
+        case CreatedAt: created_at = value.value<QDateTime>(); break;
+        case UpdatedAt: updated_at = value.value<QDateTime>(); break;
+        case LockRevision: lock_revision = value.value<int>(); break;
+        default: break;
+        }
+    }
+
 private:    /*** Don't modify below this line ***/
     Q_OBJECT
     Q_PROPERTY(int id READ getid WRITE setid)
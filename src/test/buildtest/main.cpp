@@ -53,6 +53,9 @@ void build_check_TSqlORMapper()
     mapper.limit(10).orderBy("hoge").find();
     mapper.begin();
     mapper.end();
+    mapper.orderBy(BlogObject::CreatedAt, Tf::DescendingOrder).limit(20).seek(QByteArray()).find();
+    mapper.setSeekCursor(mapper.nextCursor());
+    mapper.setSeekCursor(mapper.previousCursor());
 }
 
 void build_check_TSqlORMapperIterator()
@@ -169,6 +172,11 @@ void build_check_TMongoODMapper()
     mapper.removeAll(crt);
     mapper.limit(10).offset(1).orderBy("hoge").find();
     mapper.orderBy(1, Tf::DescendingOrder).findOne();
+
+    QList<FooObject> objects;
+    mapper.createAll(objects);
+    QList<QVariantMap> operations;
+    mapper.bulkWrite(operations, false);
 }
 
 void build_check_TModelUtil()
@@ -184,6 +192,11 @@ void build_check_TModelUtil()
     tfGetModelListByMongoCriteria<Foo, FooObject>(crt, 0, 0);
 
     QList<Blog> list;
+    auto lists = tfGetModelListsGroupedBy<Blog, BlogObject>(BlogObject::Id, QList<int>());
+    tfGetRelatedModelLists<Blog, BlogObject>(list, &Blog::id, BlogObject::Id);
+    tfGetRelatedModelLists<Blog, BlogObject>(lists, &Blog::id, BlogObject::Id, BlogObject::Title, Tf::DescendingOrder);
+    tfGetRelatedModels<Blog, BlogObject>(list, &Blog::id, BlogObject::Id);
+    tfGetRelatedModels<Blog, BlogObject>(lists, &Blog::id, BlogObject::Id);
     tfConvertToJsonArray(list);
 #if QT_VERSION >= 0x050c00  // 5.12.0
     tfConvertToCborArray(list);
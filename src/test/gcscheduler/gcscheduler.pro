@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = gcscheduler
+SOURCES = main.cpp
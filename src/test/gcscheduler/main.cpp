@@ -0,0 +1,169 @@
+#include <TfTest/TfTest>
+#include <TSession>
+#include "tgcscheduler.h"
+#include "tsessionmanager.h"
+#include "tsessionfilestore.h"
+#include "tcachefactory.h"
+#include "tcachesqlitestore.h"
+
+
+// Runs the jobs in the test thread
+class GcScheduler : public TGcScheduler
+{
+public:
+    GcScheduler(Target target) : TGcScheduler(target) { }
+    using TGcScheduler::job;
+    using TGcScheduler::acquireLease;
+};
+
+
+class TestGcScheduler : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void interval();
+    void leaseWithoutRedis();
+    void cacheGcBatch();
+    void collectCache();
+    void collectSessions();
+};
+
+
+static QString sessionFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + QLatin1String(id.left(2)) + QLatin1Char('/') + QLatin1String(id);
+}
+
+
+static QByteArray createSession(const QDateTime &modified)
+{
+    TSession session(TSessionManager::instance().generateId());
+    session.insert("name", "foo");
+    if (!TSessionManager::instance().store(session)) {
+        return QByteArray();
+    }
+
+    QFile file(sessionFilePath(session.id()));
+    if (!file.open(QIODevice::ReadWrite) || !file.setFileTime(modified, QFileDevice::FileModificationTime)) {
+        return QByteArray();
+    }
+    return session.id();
+}
+
+
+static void writeCache(TCacheSQLiteStore *store, int count, qint64 timestamp, const QByteArray &prefix)
+{
+    for (int i = 0; i < count; i++) {
+        QVERIFY(store->write(prefix + QByteArray::number(i), "value", timestamp));
+    }
+}
+
+
+void TestGcScheduler::initTestCase()
+{
+    QDir(TSessionFileStore::sessionDirPath()).removeRecursively();
+    QVERIFY(Tf::app()->cacheEnabled());
+    QCOMPARE(Tf::app()->cacheBackend(), QString("sqlite"));
+}
+
+
+void TestGcScheduler::interval()
+{
+    QCOMPARE(TGcScheduler::interval(TGcScheduler::Session), 300);
+    QCOMPARE(TGcScheduler::interval(TGcScheduler::Cache), 0);
+}
+
+
+void TestGcScheduler::leaseWithoutRedis()
+{
+    // Every host collects without a lease
+    QVERIFY(!Tf::app()->isKvsAvailable(Tf::KvsEngine::Redis));
+    GcScheduler scheduler(TGcScheduler::Session);
+    QVERIFY(scheduler.acquireLease());
+    QVERIFY(scheduler.acquireLease());
+}
+
+
+void TestGcScheduler::cacheGcBatch()
+{
+    TCacheStore *cache = TCacheFactory::create("sqlite");
+    auto *store = dynamic_cast<TCacheSQLiteStore *>(cache);
+    QVERIFY(store);
+    QVERIFY(store->open());
+    store->clear();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    writeCache(store, 25, now - 10, "expired");
+    writeCache(store, 5, now + 600, "alive");
+
+    QCOMPARE(store->gcBatch(10), 10);
+    QCOMPARE(store->count(), 20);
+    QCOMPARE(store->gcBatch(10), 10);
+    QCOMPARE(store->gcBatch(10), 5);
+    QCOMPARE(store->gcBatch(10), 0);
+    QCOMPARE(store->count(), 5);
+    QCOMPARE(store->get("alive0"), QByteArray("value"));
+
+    store->close();
+    TCacheFactory::destroy("sqlite", cache);
+}
+
+
+void TestGcScheduler::collectCache()
+{
+    TCacheStore *cache = TCacheFactory::create("sqlite");
+    auto *store = dynamic_cast<TCacheSQLiteStore *>(cache);
+    QVERIFY(store);
+    QVERIFY(store->open());
+    store->clear();
+
+    // More than a batch of 1000 values
+    const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+    writeCache(store, 2500, now - 10, "expired");
+    writeCache(store, 10, now + 600, "alive");
+
+    GcScheduler scheduler(TGcScheduler::Cache);
+    scheduler.job();
+    QCOMPARE(store->count(), 10);
+
+    store->close();
+    TCacheFactory::destroy("sqlite", cache);
+}
+
+
+void TestGcScheduler::collectSessions()
+{
+#if QT_VERSION < 0x050a00  // 5.10.0
+    QSKIP("QFileDevice::setFileTime() requires Qt 5.10 or later");
+#endif
+    // More than a batch of 1000 sessions
+    const QDateTime expired = QDateTime::currentDateTime().addSecs(-3600);
+    for (int i = 0; i < 1500; i++) {
+        QVERIFY(!createSession(expired).isEmpty());
+    }
+
+    QList<QByteArray> alive;
+    for (int i = 0; i < 5; i++) {
+        alive << createSession(QDateTime::currentDateTime());
+        QVERIFY(!alive.last().isEmpty());
+    }
+
+    GcScheduler scheduler(TGcScheduler::Session);
+    scheduler.job();
+
+    int count = 0;
+    QDirIterator it(TSessionFileStore::sessionDirPath(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        count++;
+    }
+    QCOMPARE(count, 5);
+
+    for (auto &id : alive) {
+        QCOMPARE(TSessionManager::instance().findSession(id).value("name").toString(), QString("foo"));
+    }
+}
+
+TF_TEST_MAIN(TestGcScheduler)
+#include "main.moc"
@@ -21,6 +21,7 @@ private slots:
     void hmacsha512();
 #endif
     void crammd5();
+    void equals();
 };
 
 
@@ -148,6 +149,10 @@ void TestHMAC::hmacsha256()
 
     QByteArray actual = TCryptMac::hash(text, key, TCryptMac::Hmac_Sha256);
     QCOMPARE(actual, result);
+
+    // With the key kept for the thread
+    QCOMPARE(TCryptMac::hmacSha256(text, key), result);
+    QCOMPARE(TCryptMac::hmacSha256(text, key), result);
 }
 
 
@@ -225,6 +230,15 @@ void TestHMAC::crammd5()
 }
 
 
+void TestHMAC::equals()
+{
+    QVERIFY(TCryptMac::equals(QByteArray(), QByteArray()));
+    QVERIFY(TCryptMac::equals("0123456789abcdef", "0123456789abcdef"));
+    QVERIFY(!TCryptMac::equals("0123456789abcdef", "0123456789abcdeF"));
+    QVERIFY(!TCryptMac::equals("0123456789abcdef", "0123456789abcde"));
+    QVERIFY(!TCryptMac::equals("0123456789abcdef", QByteArray()));
+}
+
 QTEST_APPLESS_MAIN(TestHMAC)
 #include "main.moc"
 
@@ -1,6 +1,7 @@
 #include <QtTest/QtTest>
 #include <QFile>
 #include <THttpUtility>
+#include "tescapekernel.h"
 
 
 class HtmlParser : public QObject
@@ -13,9 +14,54 @@ private slots:
     void escapeQuotes();
     void escapeNoQuotes_data();
     void escapeNoQuotes();
+    void jsonEscape_data();
+    void jsonEscape();
+    void escapeUtf8_data();
+    void escapeUtf8();
+    void kernels_data();
+    void kernels();
+    void benchEscape_data();
+    void benchEscape();
+    void benchEscapeUtf8_data();
+    void benchEscapeUtf8();
 };
 
 
+static const QList<QByteArray> kernelNames = {"scalar", "sse2", "avx2"};
+
+// Reference implementation of the escaping, character by character
+static QString referenceEscape(const QString &input, Tf::EscapeFlag flag)
+{
+    QString escaped;
+    for (auto c : input) {
+        if (c == QLatin1Char('&')) {
+            escaped += QLatin1String("&amp;");
+        } else if (c == QLatin1Char('<')) {
+            escaped += QLatin1String("&lt;");
+        } else if (c == QLatin1Char('>')) {
+            escaped += QLatin1String("&gt;");
+        } else if (c == QLatin1Char('"') && flag != Tf::NoQuotes) {
+            escaped += QLatin1String("&quot;");
+        } else if (c == QLatin1Char('\'') && flag == Tf::Quotes) {
+            escaped += QLatin1String("&#039;");
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// Text of the length given, with the characters of the alphabet at random
+static QString randomText(int length, const QString &alphabet)
+{
+    QString text;
+    for (int i = 0; i < length; ++i) {
+        text += alphabet.at(qrand() % alphabet.length());
+    }
+    return text;
+}
+
+
 void HtmlParser::escapeCompat_data()
 {
      QTest::addColumn<QString>("string");
@@ -85,5 +131,136 @@ void HtmlParser::escapeNoQuotes()
     QCOMPARE(actualStr, correct);
 }
 
+void HtmlParser::jsonEscape_data()
+{
+     QTest::addColumn<QString>("string");
+     QTest::addColumn<QString>("correct");
+
+     QTest::newRow("1") << tr(u8"こんにちは")
+                        << tr(u8"こんにちは");
+     QTest::newRow("2") << "{\"a\":\"<b>x & 'y'</b>\"}"
+                        << "{\"a\":\"\\u003Cb\\u003Ex \\u0026 'y'\\u003C/b\\u003E\"}";
+}
+
+void HtmlParser::jsonEscape()
+{
+    QFETCH(QString, string);
+    QFETCH(QString, correct);
+    QCOMPARE(THttpUtility::jsonEscape(string), correct);
+    QCOMPARE(THttpUtility::jsonEscapeUtf8(string.toUtf8()), correct.toUtf8());
+}
+
+void HtmlParser::escapeUtf8_data()
+{
+     QTest::addColumn<QString>("string");
+     QTest::addColumn<int>("flag");
+
+     QTest::newRow("1") << tr(u8"こんにちは") << (int)Tf::Quotes;
+     QTest::newRow("2") << tr(u8"<a href=\"hoge\">日本 & 'b'</a>") << (int)Tf::Compatible;
+     QTest::newRow("3") << tr(u8"<a href=\"hoge\">日本 & 'b'</a>") << (int)Tf::Quotes;
+     QTest::newRow("4") << tr(u8"<a href=\"hoge\">日本 & 'b'</a>") << (int)Tf::NoQuotes;
+}
+
+void HtmlParser::escapeUtf8()
+{
+    QFETCH(QString, string);
+    QFETCH(int, flag);
+    QByteArray actual = THttpUtility::htmlEscapeUtf8(string.toUtf8(), (Tf::EscapeFlag)flag);
+    QCOMPARE(actual, THttpUtility::htmlEscape(string, (Tf::EscapeFlag)flag).toUtf8());
+}
+
+void HtmlParser::kernels_data()
+{
+    QTest::addColumn<QByteArray>("kernel");
+    for (auto &name : kernelNames) {
+        QTest::newRow(name.data()) << name;
+    }
+}
+
+// Each kernel must escape the same as the reference, at any position
+// within and across the vectors of 16 and 32 bytes
+void HtmlParser::kernels()
+{
+    QFETCH(QByteArray, kernel);
+    QByteArray current = TEscapeKernel::name();
+    if (!TEscapeKernel::select(kernel.data())) {
+        QSKIP("Not supported by the CPU");
+    }
+
+    const QString alphabet = tr(u8"abcdefghij&<>\"'日本語");
+    qsrand(1);
+    for (int length = 0; length < 100; ++length) {
+        for (int n = 0; n < 20; ++n) {
+            const QString text = randomText(length, (n < 5) ? alphabet.left(10) : alphabet);
+            for (auto flag : {Tf::Compatible, Tf::Quotes, Tf::NoQuotes}) {
+                const QString correct = referenceEscape(text, flag);
+                QCOMPARE(THttpUtility::htmlEscape(text, flag), correct);
+                QCOMPARE(THttpUtility::htmlEscapeUtf8(text.toUtf8(), flag), correct.toUtf8());
+            }
+        }
+    }
+    TEscapeKernel::select(current.data());
+}
+
+static void addBenchData()
+{
+    QTest::addColumn<QByteArray>("kernel");
+    QTest::addColumn<QString>("string");
+
+    const QString ascii = QString("The quick brown fox jumps over the lazy dog. ").repeated(40);
+    const QString html = QString("<a href=\"/foo?a=1&b=2\">'link'</a> text ").repeated(40);
+    const QString japanese = QString(u8"吾輩は猫である。名前はまだ無い。").repeated(60);
+    for (auto &name : kernelNames) {
+        QTest::newRow((name + "-ascii").constData()) << name << ascii;
+        QTest::newRow((name + "-html").constData()) << name << html;
+        QTest::newRow((name + "-japanese").constData()) << name << japanese;
+    }
+}
+
+void HtmlParser::benchEscape_data()
+{
+    addBenchData();
+}
+
+void HtmlParser::benchEscape()
+{
+    QFETCH(QByteArray, kernel);
+    QFETCH(QString, string);
+    QByteArray current = TEscapeKernel::name();
+    if (!TEscapeKernel::select(kernel.data())) {
+        QSKIP("Not supported by the CPU");
+    }
+
+    int length = 0;
+    QBENCHMARK {
+        length += THttpUtility::htmlEscape(string).length();
+    }
+    QVERIFY(length > 0);
+    TEscapeKernel::select(current.data());
+}
+
+void HtmlParser::benchEscapeUtf8_data()
+{
+    addBenchData();
+}
+
+void HtmlParser::benchEscapeUtf8()
+{
+    QFETCH(QByteArray, kernel);
+    QFETCH(QString, string);
+    QByteArray current = TEscapeKernel::name();
+    if (!TEscapeKernel::select(kernel.data())) {
+        QSKIP("Not supported by the CPU");
+    }
+
+    const QByteArray utf8 = string.toUtf8();
+    int length = 0;
+    QBENCHMARK {
+        length += THttpUtility::htmlEscapeUtf8(utf8).length();
+    }
+    QVERIFY(length > 0);
+    TEscapeKernel::select(current.data());
+}
+
 QTEST_MAIN(HtmlParser)
 #include "main.moc"
@@ -1,6 +1,7 @@
 #include <TfTest/TfTest>
 #include <QJSEngine>
 #include <QJSValue>
+#include <thread>
 #include "../../tjsmodule.h"
 #include "../../tjsinstance.h"
 #include "../../tjsloader.h"
@@ -29,6 +30,10 @@ private slots:
     void callFunc1();
     void transform_data();
     void transform();
+    void compileJsx_data();
+    void compileJsx();
+    void contextPerThread();
+    void benchCompileJsx();
     void load_data();
     void load();
     void react_data();
@@ -217,6 +222,47 @@ void JSContext::transform()
 }
 
 
+void JSContext::compileJsx_data()
+{
+    transform_data();
+}
+
+
+void JSContext::compileJsx()
+{
+    QFETCH(QString, jsx);
+    QFETCH(QString, output);
+
+    QCOMPARE(TJSLoader::compileJsx(jsx), output);
+    QCOMPARE(TJSLoader::compileJsx(jsx), output);  // cached
+}
+
+
+void JSContext::contextPerThread()
+{
+    TJSModule *js = TJSLoader("./js/main.js").load();
+    QVERIFY(js);
+    QCOMPARE(TJSLoader("./js/main.js").load(), js);
+
+    TJSModule *other = nullptr;
+    QString output;
+    std::thread([&]() {
+        other = TJSLoader("./js/main.js").load();
+        output = other->evaluate("sub('world')").toString();
+    }).join();
+    QVERIFY(other != js);
+    QCOMPARE(output, QString("Hello world"));
+}
+
+
+void JSContext::benchCompileJsx()
+{
+    QBENCHMARK {
+        TJSLoader::compileJsx("<HelloWorld />");
+    }
+}
+
+
 void JSContext::benchmark()
 {
     TJSModule *js = TJSLoader("JSXTransformer", "JSXTransformer").load();
@@ -0,0 +1,285 @@
+#include <QTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <TModelObject>
+#include <TAbstractModel>
+#include <TJsonUtil>
+#include <TJsonWriter>
+
+
+class BlogObject : public TModelObject
+{
+    Q_OBJECT
+public:
+    int id {0};
+    QString title;
+    double score {0};
+    bool published {false};
+    QDateTime updated_at;
+    QVariant tags;
+
+    bool isNull() const override { return id <= 0; }
+    bool create() override { return true; }
+    bool update() override { return true; }
+    bool save() override { return true; }
+    bool remove() override { return true; }
+
+private:
+    Q_PROPERTY(int id READ getid WRITE setid)
+    T_DEFINE_PROPERTY(int, id)
+    Q_PROPERTY(QString title READ gettitle WRITE settitle)
+    T_DEFINE_PROPERTY(QString, title)
+    Q_PROPERTY(double score READ getscore WRITE setscore)
+    T_DEFINE_PROPERTY(double, score)
+    Q_PROPERTY(bool published READ getpublished WRITE setpublished)
+    T_DEFINE_PROPERTY(bool, published)
+    Q_PROPERTY(QDateTime updated_at READ getupdated_at WRITE setupdated_at)
+    T_DEFINE_PROPERTY(QDateTime, updated_at)
+    Q_PROPERTY(QVariant tags READ gettags WRITE settags)
+    T_DEFINE_PROPERTY(QVariant, tags)
+};
+
+
+class Blog : public TAbstractModel
+{
+public:
+    Blog(int id = 0, const QString &title = QString()) :
+        d(new BlogObject)
+    {
+        d->id = id;
+        d->title = title;
+        d->score = id * 0.25;
+        d->published = (id % 2);
+        d->updated_at = QDateTime(QDate(2019, 10, 1), QTime(12, 34, 56, 789), Qt::UTC);
+        d->tags = QStringList({"qt", "c++"});
+    }
+
+    // Writes all the properties directly
+    void writeJson(TJsonWriter &writer) const override { writer.writeProperties(modelData()); }
+
+private:
+    QSharedPointer<BlogObject> d;  // shared by the copies
+    TModelObject *modelData() override { return d.data(); }
+    const TModelObject *modelData() const override { return d.data(); }
+};
+
+
+class UserObject : public TModelObject
+{
+    Q_OBJECT
+public:
+    int id {0};
+    QString name;
+    QString password_hash;
+
+    bool isNull() const override { return id <= 0; }
+    bool create() override { return true; }
+    bool update() override { return true; }
+    bool save() override { return true; }
+    bool remove() override { return true; }
+
+private:
+    Q_PROPERTY(int id READ getid WRITE setid)
+    T_DEFINE_PROPERTY(int, id)
+    Q_PROPERTY(QString name READ getname WRITE setname)
+    T_DEFINE_PROPERTY(QString, name)
+    Q_PROPERTY(QString password_hash READ getpassword_hash WRITE setpassword_hash)
+    T_DEFINE_PROPERTY(QString, password_hash)
+};
+
+
+// Hides the password hash from the JSON
+class User : public TAbstractModel
+{
+public:
+    User(int id = 0, const QString &name = QString()) :
+        d(new UserObject)
+    {
+        d->id = id;
+        d->name = name;
+        d->password_hash = "secret";
+    }
+
+    QVariantMap toVariantMap() const override
+    {
+        QVariantMap map = TAbstractModel::toVariantMap();
+        map.remove("passwordHash");
+        return map;
+    }
+
+private:
+    QSharedPointer<UserObject> d;
+    TModelObject *modelData() override { return d.data(); }
+    const TModelObject *modelData() const override { return d.data(); }
+};
+
+
+// Adds a property to the JSON
+class Account : public User
+{
+public:
+    using User::User;
+
+    QJsonObject toJsonObject() const override
+    {
+        QJsonObject object = User::toJsonObject();
+        object.insert("role", "admin");
+        return object;
+    }
+};
+
+
+class JsonWriter : public QObject
+{
+    Q_OBJECT
+private slots:
+    void values_data();
+    void values();
+    void strings_data();
+    void strings();
+    void model();
+    void modelList();
+    void hiddenProperty();
+    void benchToJsonArray();
+    void benchWriter();
+};
+
+
+void JsonWriter::values_data()
+{
+    QTest::addColumn<QVariant>("value");
+
+    QTest::newRow("null") << QVariant();
+    QTest::newRow("bool") << QVariant(true);
+    QTest::newRow("int") << QVariant(-2147483647 - 1);
+    QTest::newRow("longlong") << QVariant(Q_INT64_C(9007199254740991));
+    QTest::newRow("double1") << QVariant(0.1);
+    QTest::newRow("double2") << QVariant(-1.5e300);
+    QTest::newRow("double3") << QVariant(12345.0);
+    QTest::newRow("string") << QVariant(QString(u8"日本語 \"quoted\"\n"));
+    QTest::newRow("list") << QVariant(QVariantList({1, "a", QVariantList({true})}));
+    QTest::newRow("map") << QVariant(QVariantMap({{"a", 1}, {"b", QVariantMap({{"c", "d"}})}}));
+}
+
+// Same as written by QJsonDocument
+void JsonWriter::values()
+{
+    QFETCH(QVariant, value);
+
+    TJsonWriter writer;
+    writer.beginArray().value(value).endArray();
+
+    QJsonArray array;
+    array.append(QJsonValue::fromVariant(value));
+    QCOMPARE(QJsonDocument::fromJson(writer.data()), QJsonDocument(array));
+    QCOMPARE(writer.data(), QJsonDocument(array).toJson(QJsonDocument::Compact));
+}
+
+
+void JsonWriter::strings_data()
+{
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("1") << QString();
+    QTest::newRow("2") << QString("Hello world");
+    QTest::newRow("3") << QString(u8"こんにちは\t世界");
+    QTest::newRow("4") << QString(u8"emoji \U0001F600 \\ / \x01\x1f");
+    QTest::newRow("5") << QString(u8"é߿ࠀ￿");
+}
+
+
+void JsonWriter::strings()
+{
+    QFETCH(QString, string);
+
+    TJsonWriter writer;
+    writer.beginObject().key(string).value(string).key("utf8").value(string.toUtf8()).endObject();
+
+    QJsonObject object;
+    object.insert(string, string);
+    object.insert("utf8", string);
+    QJsonDocument doc = QJsonDocument::fromJson(writer.data());
+    QCOMPARE(doc.object(), object);
+}
+
+
+void JsonWriter::model()
+{
+    Blog blog(1, "hello");
+    TJsonWriter writer;
+    writer.value(blog);
+    QCOMPARE(QJsonDocument::fromJson(writer.data()).object(), blog.toJsonObject());
+    QVERIFY(writer.data().contains("\"updatedAt\":"));
+}
+
+
+void JsonWriter::modelList()
+{
+    QList<Blog> list;
+    for (int i = 0; i < 10; ++i) {
+        list << Blog(i, QString::number(i));
+    }
+
+    QByteArray json = tfModelListToJson(list);
+    QCOMPARE(QJsonDocument::fromJson(json).array(), tfModelListToJsonArray(list));
+
+    TJsonWriter writer;
+    writer.value(QList<Blog>());
+    QCOMPARE(writer.data(), QByteArray("[]"));
+}
+
+
+void JsonWriter::hiddenProperty()
+{
+    // Written as toVariantMap() or toJsonObject() converts
+    User user(1, "foo");
+    TJsonWriter writer;
+    writer.value(user);
+    QCOMPARE(QJsonDocument::fromJson(writer.data()).object(), user.toJsonObject());
+    QVERIFY(!writer.data().contains("passwordHash"));
+    QVERIFY(!writer.data().contains("secret"));
+
+    QList<User> users {User(1, "foo"), User(2, "bar")};
+    QByteArray json = tfModelListToJson(users);
+    QCOMPARE(QJsonDocument::fromJson(json).array(), tfModelListToJsonArray(users));
+    QVERIFY(!json.contains("secret"));
+
+    Account account(3, "baz");
+    writer.clear();
+    writer.value(account);
+    QCOMPARE(QJsonDocument::fromJson(writer.data()).object(), account.toJsonObject());
+    QVERIFY(writer.data().contains("\"role\":\"admin\""));
+    QVERIFY(!writer.data().contains("secret"));
+}
+
+// Converts a list of models through QVariantMap and QJsonDocument
+void JsonWriter::benchToJsonArray()
+{
+    QList<Blog> list;
+    for (int i = 0; i < 1000; ++i) {
+        list << Blog(i, QString(u8"タイトル %1").arg(i));
+    }
+
+    QBENCHMARK {
+        QByteArray json = QJsonDocument(tfModelListToJsonArray(list)).toJson(QJsonDocument::Compact);
+        QVERIFY(!json.isEmpty());
+    }
+}
+
+// Writes the same directly into UTF-8 bytes
+void JsonWriter::benchWriter()
+{
+    QList<Blog> list;
+    for (int i = 0; i < 1000; ++i) {
+        list << Blog(i, QString(u8"タイトル %1").arg(i));
+    }
+
+    QBENCHMARK {
+        QByteArray json = tfModelListToJson(list);
+        QVERIFY(!json.isEmpty());
+    }
+}
+
+QTEST_APPLESS_MAIN(JsonWriter)
+#include "main.moc"
@@ -0,0 +1,162 @@
+#include <TfTest/TfTest>
+#include <TMongoQuery>
+
+// Benchmarks of writing documents to the mongod running on localhost,
+// which is configured in config/mongodb.ini. Skipped if not available.
+const QString Collection("bench_event");
+
+
+class MongoBulkWrite : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void insertMany();
+    void bulkWrite();
+    void benchInsertOne_data();
+    void benchInsertOne();
+    void benchInsertMany_data();
+    void benchInsertMany();
+    void benchBulkWrite_data();
+    void benchBulkWrite();
+};
+
+
+static QList<QVariantMap> events(int count)
+{
+    QList<QVariantMap> docs;
+    for (int i = 0; i < count; ++i) {
+        docs << QVariantMap({{"seq", i}, {"type", "click"}, {"at", QDateTime::currentDateTime()}});
+    }
+    return docs;
+}
+
+
+void MongoBulkWrite::initTestCase()
+{
+    TMongoQuery mongo(Collection);
+    if (mongo.count() < 0) {
+        QSKIP("mongod is not available");
+    }
+    mongo.remove(QVariantMap());
+}
+
+
+void MongoBulkWrite::cleanupTestCase()
+{
+    TMongoQuery mongo(Collection);
+    mongo.remove(QVariantMap());
+}
+
+
+void MongoBulkWrite::insertMany()
+{
+    TMongoQuery mongo(Collection);
+    auto docs = events(10);
+    QCOMPARE(mongo.insertMany(docs), 10);
+    QVERIFY(!docs[9].value("_id").toString().isEmpty());
+
+    // Duplicate key of the 3rd document
+    auto dups = events(5);
+    dups[2].insert("_id", docs[0].value("_id"));
+    QCOMPARE(mongo.insertMany(dups, false), -1);
+    QCOMPARE(mongo.count(), 14);  // unordered, the others inserted
+    QCOMPARE(mongo.remove(QVariantMap()), 14);
+}
+
+
+void MongoBulkWrite::bulkWrite()
+{
+    TMongoQuery mongo(Collection);
+    QList<QVariantMap> ops;
+    ops << QVariantMap({{"insertOne", QVariantMap({{"document", QVariantMap({{"seq", 1}})}})}});
+    ops << QVariantMap({{"insertOne", QVariantMap({{"document", QVariantMap({{"seq", 2}})}})}});
+    ops << QVariantMap({{"updateMany", QVariantMap({{"filter", QVariantMap()}, {"update", QVariantMap({{"$set", QVariantMap({{"type", "view"}})}})}})}});
+    ops << QVariantMap({{"deleteOne", QVariantMap({{"filter", QVariantMap({{"seq", 1}})}})}});
+
+    QVariantMap reply;
+    QCOMPARE(mongo.bulkWrite(ops, true, &reply), 5);
+    QCOMPARE(reply.value("nInserted").toInt(), 2);
+    QCOMPARE(reply.value("nModified").toInt(), 2);
+    QCOMPARE(reply.value("nRemoved").toInt(), 1);
+    QCOMPARE(mongo.count(QVariantMap({{"type", "view"}})), 1);
+
+    ops.clear();
+    ops << QVariantMap({{"dropAll", QVariantMap()}});
+    QCOMPARE(mongo.bulkWrite(ops), -1);
+    mongo.remove(QVariantMap());
+}
+
+
+void MongoBulkWrite::benchInsertOne_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+
+void MongoBulkWrite::benchInsertOne()
+{
+    QFETCH(int, count);
+    TMongoQuery mongo(Collection);
+
+    QBENCHMARK {
+        for (auto &doc : events(count)) {
+            mongo.insert(doc);
+        }
+    }
+    mongo.remove(QVariantMap());
+}
+
+
+void MongoBulkWrite::benchInsertMany_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("ordered");
+    QTest::newRow("100 ordered") << 100 << true;
+    QTest::newRow("1000 ordered") << 1000 << true;
+    QTest::newRow("1000 unordered") << 1000 << false;
+}
+
+
+void MongoBulkWrite::benchInsertMany()
+{
+    QFETCH(int, count);
+    QFETCH(bool, ordered);
+    TMongoQuery mongo(Collection);
+
+    QBENCHMARK {
+        auto docs = events(count);
+        mongo.insertMany(docs, ordered);
+    }
+    mongo.remove(QVariantMap());
+}
+
+
+void MongoBulkWrite::benchBulkWrite_data()
+{
+    benchInsertMany_data();
+}
+
+
+void MongoBulkWrite::benchBulkWrite()
+{
+    QFETCH(int, count);
+    QFETCH(bool, ordered);
+    TMongoQuery mongo(Collection);
+
+    QBENCHMARK {
+        QList<QVariantMap> ops;
+        for (auto &doc : events(count)) {
+            ops << QVariantMap({{"insertOne", QVariantMap({{"document", doc}})}});
+        }
+        ops << QVariantMap({{"updateMany", QVariantMap({{"filter", QVariantMap({{"type", "click"}})}, {"update", QVariantMap({{"$set", QVariantMap({{"type", "view"}})}})}})}});
+        mongo.bulkWrite(ops, ordered);
+    }
+    mongo.remove(QVariantMap());
+}
+
+TF_TEST_SQL_MAIN(MongoBulkWrite, false)
+#include "main.moc"
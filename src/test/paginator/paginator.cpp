@@ -22,6 +22,7 @@ private slots:
     void itemsCountChangesMakeCurrentPageInvalid();
     void limitChangesMakeCurrentPageInvalid_data();
     void limitChangesMakeCurrentPageInvalid();
+    void cursors();
 };
 
 void TestPaginator::constructor_data()
@@ -409,6 +410,26 @@ void TestPaginator::limitChangesMakeCurrentPageInvalid()
     QCOMPARE(pager.currentPage(), expectedCurrentPage);
 }
 
+void TestPaginator::cursors()
+{
+    TPaginator pager;
+    QVERIFY(!pager.hasPreviousCursor());
+    QVERIFY(!pager.hasNextCursor());
+
+    pager.setNextCursor("AQAAAAAC");
+    QVERIFY(!pager.hasPreviousCursor());
+    QVERIFY(pager.hasNextCursor());
+
+    pager.setPreviousCursor("AQEAAAAC");
+    TPaginator copy = pager;
+    QVERIFY(copy.hasPreviousCursor());
+    QCOMPARE(copy.previousCursor(), QByteArray("AQEAAAAC"));
+    QCOMPARE(copy.nextCursor(), QByteArray("AQAAAAAC"));
+
+    copy.setNextCursor(QByteArray());
+    QVERIFY(!copy.hasNextCursor());
+}
+
 #if QT_VERSION < 0x050000
 Q_DECLARE_METATYPE(QList<int>)
 #endif
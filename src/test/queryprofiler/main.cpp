@@ -0,0 +1,177 @@
+#include <TfTest/TfTest>
+#include "tqueryprofiler.h"
+#include "tsystemglobal.h"
+
+
+class QueryProfiler : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void normalize_data();
+    void normalize();
+    void bucketIndex_data();
+    void bucketIndex();
+    void elapsed();
+    void record();
+    void recordSlow();
+    void recordOthers();
+    void writeLog();
+};
+
+
+void QueryProfiler::initTestCase()
+{
+    QDir(Tf::app()->webRootPath()).mkpath("log");
+    QFile::remove(Tf::app()->sqlSlowQueryLogFilePath());
+    Tf::setupQueryLogger();
+    QVERIFY(TQueryProfiler::isEnabled());
+    QCOMPARE(TQueryProfiler::slowQueryThreshold(), 20);
+}
+
+
+void QueryProfiler::normalize_data()
+{
+    QTest::addColumn<QString>("statement");
+    QTest::addColumn<QString>("normalized");
+
+    QTest::newRow("1") << "SELECT * FROM blog WHERE id = 10"
+                       << "SELECT * FROM blog WHERE id = ?";
+    QTest::newRow("2") << "SELECT * FROM blog WHERE title = 'it''s'  AND\n  t0.id=3"
+                       << "SELECT * FROM blog WHERE title = ? AND t0.id=?";
+    QTest::newRow("3") << "SELECT * FROM blog WHERE id IN (1, 2, 3)"
+                       << "SELECT * FROM blog WHERE id IN (?...)";
+    QTest::newRow("4") << "SELECT * FROM blog WHERE id IN (4,5)"
+                       << "SELECT * FROM blog WHERE id IN (?...)";
+    QTest::newRow("5") << "UPDATE blog SET score = 1.5e3 WHERE id = ? AND rev IN (?, ?)"
+                       << "UPDATE blog SET score = ? WHERE id = ? AND rev IN (?...)";
+    QTest::newRow("6") << "INSERT INTO blog2 (id, title) VALUES ('a', 'b')"
+                       << "INSERT INTO blog2 (id, title) VALUES (?...)";
+    QTest::newRow("7") << "  mongodb.find blog  "
+                       << "mongodb.find blog";
+}
+
+
+void QueryProfiler::normalize()
+{
+    QFETCH(QString, statement);
+    QFETCH(QString, normalized);
+    QCOMPARE(TQueryProfiler::normalize(statement), normalized);
+}
+
+
+void QueryProfiler::bucketIndex_data()
+{
+    QTest::addColumn<qint64>("usecs");
+    QTest::addColumn<int>("index");
+
+    QTest::newRow("1") << 0LL << 0;
+    QTest::newRow("2") << 999LL << 0;
+    QTest::newRow("3") << 1000LL << 1;
+    QTest::newRow("4") << 1999LL << 1;
+    QTest::newRow("5") << 2000LL << 2;
+    QTest::newRow("6") << 1000000LL << 10;
+    QTest::newRow("7") << 16383999LL << 14;
+    QTest::newRow("8") << 16384000LL << 15;
+    QTest::newRow("9") << 3600000000LL << 15;
+}
+
+
+void QueryProfiler::bucketIndex()
+{
+    QFETCH(qint64, usecs);
+    QFETCH(int, index);
+    QCOMPARE(TQueryProfiler::bucketIndex(usecs), index);
+}
+
+
+void QueryProfiler::elapsed()
+{
+    TQueryProfiler profiler;
+    QTest::qSleep(20);
+    QVERIFY(profiler.elapsed() >= 20000);
+}
+
+
+void QueryProfiler::record()
+{
+    for (int i = 0; i < 3; ++i) {
+        TQueryProfiler profiler;
+        profiler.record(QString("SELECT * FROM blog WHERE id = %1").arg(i), 1);
+    }
+
+    auto hist = TQueryProfiler::histograms().value("SELECT * FROM blog WHERE id = ?");
+    QCOMPARE(hist.count, (quint64)3);
+    QCOMPARE(hist.buckets[0], (quint64)3);
+    QVERIFY(hist.maxTime < 1000);
+    QVERIFY(hist.totalTime >= hist.maxTime);
+}
+
+
+void QueryProfiler::recordSlow()
+{
+    TQueryProfiler profiler;
+    QTest::qSleep(25);
+    profiler.record("SELECT * FROM blog WHERE title = 'slow'", 2, {QVariant("slow")});
+
+    auto hist = TQueryProfiler::histograms().value("SELECT * FROM blog WHERE title = ?");
+    QCOMPARE(hist.count, (quint64)1);
+    QVERIFY(hist.maxTime >= 25000);
+    QCOMPARE(hist.buckets[TQueryProfiler::bucketIndex(hist.maxTime)], (quint64)1);
+
+    TQueryProfiler::recordDuration(3000, "mongodb.find blog", 10);
+    hist = TQueryProfiler::histograms().value("mongodb.find blog");
+    QCOMPARE(hist.count, (quint64)1);
+    QCOMPARE(hist.maxTime, (qint64)3000);
+    QCOMPARE(hist.buckets[2], (quint64)1);
+}
+
+
+void QueryProfiler::recordOthers()
+{
+    // Fills up the histograms over the limit of statements
+    int count = TQueryProfiler::histograms().count();
+    for (int i = count; i < 1010; ++i) {
+        TQueryProfiler::recordDuration(100, QString("SELECT * FROM t%1").arg(i), 0);
+    }
+
+    auto hists = TQueryProfiler::histograms();
+    QCOMPARE(hists.count(), 1001);
+    QCOMPARE(hists.value("(others)").count, (quint64)10);
+
+    // Accumulated, not reset by the following statements
+    TQueryProfiler::recordDuration(100, "SELECT * FROM t2000", 0);
+    TQueryProfiler::recordDuration(100, "SELECT * FROM t2001", 0);
+    hists = TQueryProfiler::histograms();
+    QCOMPARE(hists.count(), 1001);
+    QCOMPARE(hists.value("(others)").count, (quint64)12);
+    QVERIFY(!hists.contains("SELECT * FROM t2000"));
+
+    // Known statements keep their own histograms
+    TQueryProfiler::recordDuration(100, "SELECT * FROM blog WHERE id = 99", 0);
+    QCOMPARE(TQueryProfiler::histograms().value("SELECT * FROM blog WHERE id = ?").count, (quint64)4);
+}
+
+
+void QueryProfiler::writeLog()
+{
+    // Writes the histograms and closes the log
+    Tf::releaseQueryLogger();
+    QVERIFY(!TQueryProfiler::isEnabled());
+
+    QFile file(Tf::app()->sqlSlowQueryLogFilePath());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QString log = QString::fromLocal8Bit(file.readAll());
+
+    // Only the slow query is written with its parameters
+    QVERIFY(log.contains("| rows: 2 | - | SELECT * FROM blog WHERE title = 'slow' | params: [slow]"));
+    QVERIFY(!log.contains("| rows: 1 |"));
+    QVERIFY(log.contains("Histogram: count: 4 |"));
+    QVERIFY(log.contains(" <1ms:4 | SELECT * FROM blog WHERE id = ?"));
+    QVERIFY(log.contains(" <4ms:1 | mongodb.find blog"));
+    QVERIFY(log.contains("Histogram: count: 12 |"));
+    QVERIFY(log.contains("| (others)"));
+}
+
+TF_TEST_SQLLESS_MAIN(QueryProfiler)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = queryprofiler
+SOURCES = main.cpp
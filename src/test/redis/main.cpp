@@ -0,0 +1,351 @@
+#include <TfTest/TfTest>
+#include <QThread>
+#include <QElapsedTimer>
+#include <TRedis>
+#include <TRedisPipeline>
+#include <TCache>
+#include "tcachestore.h"
+#include "tcachefactory.h"
+#include "tkvsdatabasepool.h"
+#include "tsqlquerycache.h"
+#include "tgcscheduler.h"
+#include "../respstub.h"
+
+// Port of redis.ini and cache.ini
+constexpr quint16 STUB_PORT = 16379;
+
+
+// Cache store on a map, with the default implementations of the
+// multi-key API
+class MapCacheStore : public TCacheStore
+{
+public:
+    QString key() const override { return QLatin1String("map"); }
+    DbType dbType() const override { return KVS; }
+    bool open() override { return true; }
+    void close() override { }
+    QByteArray get(const QByteArray &key) override { return map.value(key); }
+    bool set(const QByteArray &key, const QByteArray &value, int) override { map.insert(key, value); return true; }
+    bool remove(const QByteArray &key) override { return map.remove(key) > 0; }
+    void clear() override { map.clear(); }
+    void gc() override { }
+
+    QMap<QByteArray, QByteArray> map;
+};
+
+
+// Exposes the lease of the GC
+class GcScheduler : public TGcScheduler
+{
+public:
+    GcScheduler(Target target) : TGcScheduler(target) { }
+    using TGcScheduler::acquireLease;
+};
+
+
+class TestRedis : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void msetMget();
+    void incrByExpire();
+    void pipeline();
+    void pipelineError();
+    void cacheStoreValues();
+    void redisCacheStoreValues();
+    void queryCacheGeneration();
+    void poolMetrics();
+    void poolHealthCheck();
+    void poolBackoff();
+    void gcLease();
+
+private:
+    RespStub *stub {nullptr};
+    QThread stubThread;
+};
+
+
+void TestRedis::initTestCase()
+{
+    stub = new RespStub(STUB_PORT);
+    stub->moveToThread(&stubThread);
+    stubThread.start();
+    QMetaObject::invokeMethod(stub, "start", Qt::BlockingQueuedConnection);
+    QCOMPARE(stub->serverPort(), STUB_PORT);
+}
+
+
+void TestRedis::cleanupTestCase()
+{
+    QMetaObject::invokeMethod(stub, "deleteLater");
+    stubThread.quit();
+    stubThread.wait();
+}
+
+
+void TestRedis::msetMget()
+{
+    TRedis redis;
+    QVERIFY(redis.isOpen());
+
+    QMap<QByteArray, QByteArray> values {{"a", "1"}, {"b", QByteArray("\0\r\n", 3)}, {"c", ""}};
+    QVERIFY(redis.mset(values));
+    QVERIFY(!redis.mset(QMap<QByteArray, QByteArray>()));
+
+    QByteArrayList res = redis.mget({"a", "nokey", "b", "c"});
+    QCOMPARE(res.count(), 4);
+    QCOMPARE(res[0], QByteArray("1"));
+    QVERIFY(res[1].isNull());
+    QCOMPARE(res[2], QByteArray("\0\r\n", 3));
+    QVERIFY(!res[3].isNull() && res[3].isEmpty());
+    QVERIFY(redis.mget(QByteArrayList()).isEmpty());
+}
+
+
+void TestRedis::incrByExpire()
+{
+    TRedis redis;
+    redis.del("counter");
+    QCOMPARE(redis.incrBy("counter", 5), (qint64)5);
+    QCOMPARE(redis.incrBy("counter", 5000000000LL), (qint64)5000000005LL);
+    QCOMPARE(redis.incrBy("counter", -10), (qint64)4999999995LL);
+
+    QVERIFY(redis.expire("counter", 60));
+    QVERIFY(!redis.expire("nokey", 60));
+}
+
+
+void TestRedis::pipeline()
+{
+    TRedisPipeline pipeline;
+    QVERIFY(pipeline.isEmpty());
+
+    pipeline << QByteArrayList({"SET", "x", "1"})
+             << QByteArrayList()  // ignored
+             << QByteArrayList({"INCRBY", "x", "2"})
+             << QByteArrayList({"GET", "x"})
+             << QByteArrayList({"GET", "nokey"});
+    QCOMPARE(pipeline.count(), 4);
+
+    int count = stub->commandCount();
+    QVERIFY(pipeline.exec());
+    QCOMPARE(stub->commandCount() - count, 4);
+    QVERIFY(pipeline.isEmpty());
+
+    QCOMPARE(pipeline.responses().count(), 4);
+    QCOMPARE(pipeline.response(1).value(0).toLongLong(), 3LL);
+    QCOMPARE(pipeline.response(2).value(0).toByteArray(), QByteArray("3"));
+    QVERIFY(pipeline.response(3).value(0).toByteArray().isNull());
+    QVERIFY(pipeline.response(4).isEmpty());  // out of range
+
+    pipeline.clear();
+    QVERIFY(pipeline.responses().isEmpty());
+    QVERIFY(pipeline.exec());  // nothing to send
+    QVERIFY(pipeline.responses().isEmpty());
+}
+
+
+void TestRedis::pipelineError()
+{
+    TRedisPipeline pipeline;
+    pipeline << QByteArrayList({"SET", "y", "1"}) << QByteArrayList({"UNKNOWN"}) << QByteArrayList({"GET", "y"});
+    QVERIFY(!pipeline.exec());
+
+    // The connection is still usable
+    TRedis redis;
+    QCOMPARE(redis.get("y"), QByteArray("1"));
+}
+
+
+void TestRedis::cacheStoreValues()
+{
+    MapCacheStore store;
+    QVERIFY(store.setValues({{"k1", "v1"}, {"k2", "v2"}}, 60));
+    QCOMPARE(store.map.count(), 2);
+    QCOMPARE(store.values({"k2", "nokey", "k1"}), QByteArrayList({"v2", QByteArray(), "v1"}));
+    QCOMPARE(store.removeValues({"k1", "nokey"}), 1);
+    QCOMPARE(store.map.keys(), QList<QByteArray>({"k2"}));
+}
+
+
+void TestRedis::redisCacheStoreValues()
+{
+    TCacheStore *cache = TCacheFactory::create("redis");
+    QVERIFY(cache);
+    QVERIFY(cache->open());
+    cache->clear();
+
+    QMap<QByteArray, QByteArray> values;
+    for (int i = 0; i < 100; i++) {
+        values.insert("key" + QByteArray::number(i), "value" + QByteArray::number(i));
+    }
+
+    int count = stub->commandCount();
+    QVERIFY(cache->setValues(values, 60));
+    QCOMPARE(stub->commandCount() - count, 100);  // SETEX each, pipelined
+
+    QByteArrayList res = cache->values({"key0", "nokey", "key99"});
+    QCOMPARE(res, QByteArrayList({"value0", QByteArray(), "value99"}));
+    QCOMPARE(cache->get("key50"), QByteArray("value50"));
+
+    QCOMPARE(cache->removeValues({"key0", "key1", "nokey"}), 2);
+    QVERIFY(cache->values({"key0", "key1"}) == QByteArrayList({QByteArray(), QByteArray()}));
+    QCOMPARE(cache->removeValues(QByteArrayList()), 0);
+
+    cache->clear();
+    cache->close();
+    TCacheFactory::destroy("redis", cache);
+}
+
+
+void TestRedis::queryCacheGeneration()
+{
+    QVERIFY(TSqlQueryCache::isEnabled());
+    const QString query = "SELECT * FROM blog";
+    const QStringList tables = {"blog"};
+    const QByteArray genKey = "tf.sqlcache.gen:0:blog";
+    auto cacheKey = [&]() { return TSqlQueryCache::cacheKey(0, query, tables); };
+
+    QVERIFY(TSqlQueryCache::set(cacheKey(), "result", 60));
+    QCOMPARE(TSqlQueryCache::get(cacheKey()), QByteArray("result"));
+    const QByteArray gen = Tf::cache()->get(genKey);
+    QVERIFY(!gen.isEmpty());
+
+    // Another host renews the generation in the store
+    QVERIFY(Tf::cache()->set(genKey, "renewed", 60));
+    QCOMPARE(TSqlQueryCache::get(cacheKey()), QByteArray("result"));  // held for a while
+    Tf::msleep(1100);
+    QVERIFY(TSqlQueryCache::get(cacheKey()).isEmpty());
+
+    // The generation evicted from the store is stored again
+    QVERIFY(TSqlQueryCache::set(cacheKey(), "result2", 60));
+    Tf::cache()->remove(genKey);
+    Tf::msleep(1100);
+    QCOMPARE(TSqlQueryCache::get(cacheKey()), QByteArray("result2"));
+    QCOMPARE(Tf::cache()->get(genKey), QByteArray("renewed"));
+
+    // Invalidated locally, only in the database
+    const QByteArray otherKey = TSqlQueryCache::cacheKey(1, query, tables);
+    TSqlQueryCache::invalidate(0, tables);
+    QVERIFY(TSqlQueryCache::get(cacheKey()).isEmpty());
+    QVERIFY(Tf::cache()->get(genKey) != QByteArray("renewed"));
+    QCOMPARE(TSqlQueryCache::cacheKey(1, query, tables), otherKey);
+}
+
+
+void TestRedis::poolMetrics()
+{
+    auto *pool = TKvsDatabasePool::instance();
+    const int inUse = pool->inUseCount(Tf::KvsEngine::Redis);
+
+    TKvsDatabase db1 = pool->database(Tf::KvsEngine::Redis);
+    TKvsDatabase db2 = pool->database(Tf::KvsEngine::Redis);
+    QVERIFY(db1.isOpen() && db2.isOpen());
+    QCOMPARE(pool->inUseCount(Tf::KvsEngine::Redis), inUse + 2);
+
+    const int idle = pool->idleCount(Tf::KvsEngine::Redis);
+    pool->pool(db1);
+    pool->pool(db2);
+    QVERIFY(!db1.isValid());
+    QCOMPARE(pool->inUseCount(Tf::KvsEngine::Redis), inUse);
+    QCOMPARE(pool->idleCount(Tf::KvsEngine::Redis), idle + 2);
+
+    // Not configured
+    QCOMPARE(pool->inUseCount(Tf::KvsEngine::MongoDB), 0);
+    QCOMPARE(pool->errorCount(Tf::KvsEngine::MongoDB), (quint64)0);
+}
+
+
+void TestRedis::poolHealthCheck()
+{
+    auto *pool = TKvsDatabasePool::instance();
+    TKvsDatabase db = pool->database(Tf::KvsEngine::Redis);
+    QVERIFY(db.isOpen());
+    pool->pool(db);
+    QVERIFY(pool->idleCount(Tf::KvsEngine::Redis) > 0);
+
+    // The idle connections are dead after a restart of the server
+    QMetaObject::invokeMethod(stub, "disconnectAll", Qt::BlockingQueuedConnection);
+    const quint64 errors = pool->errorCount(Tf::KvsEngine::Redis);
+    const quint64 reconnects = pool->reconnectCount(Tf::KvsEngine::Redis);
+
+    db = pool->database(Tf::KvsEngine::Redis);
+    QVERIFY(db.isOpen());
+    QVERIFY(db.ping());
+    QCOMPARE(pool->errorCount(Tf::KvsEngine::Redis), errors + 1);
+    QCOMPARE(pool->reconnectCount(Tf::KvsEngine::Redis), reconnects + 1);
+    QCOMPARE(pool->idleCount(Tf::KvsEngine::Redis), 0);  // all closed
+    pool->pool(db);
+}
+
+
+void TestRedis::poolBackoff()
+{
+    auto *pool = TKvsDatabasePool::instance();
+    QMetaObject::invokeMethod(stub, "stop", Qt::BlockingQueuedConnection);
+    const quint64 errors = pool->errorCount(Tf::KvsEngine::Redis);
+
+    // Fails to reconnect, and postpones the next try
+    TKvsDatabase db = pool->database(Tf::KvsEngine::Redis);
+    QVERIFY(!db.isValid());
+    QVERIFY(pool->errorCount(Tf::KvsEngine::Redis) > errors);
+
+    const quint64 errors2 = pool->errorCount(Tf::KvsEngine::Redis);
+    QElapsedTimer timer;
+    timer.start();
+    db = pool->database(Tf::KvsEngine::Redis);
+    QVERIFY(!db.isValid());
+    QVERIFY(timer.elapsed() < 50);  // fails fast
+    QCOMPARE(pool->errorCount(Tf::KvsEngine::Redis), errors2);
+
+    // Reconnects after the backoff
+    QMetaObject::invokeMethod(stub, "start", Qt::BlockingQueuedConnection);
+    const quint64 reconnects = pool->reconnectCount(Tf::KvsEngine::Redis);
+    Tf::msleep(500);  // longer than KvsPool.ReconnectMaxBackoff
+    db = pool->database(Tf::KvsEngine::Redis);
+    QVERIFY(db.isOpen());
+    QCOMPARE(pool->reconnectCount(Tf::KvsEngine::Redis), reconnects + 1);
+    pool->pool(db);
+}
+
+
+void TestRedis::gcLease()
+{
+    const QByteArray sessionKey = "_tf_gc_lease_session";
+    TRedis redis;
+    redis.del(sessionKey);
+
+    GcScheduler scheduler(TGcScheduler::Session);
+    QVERIFY(scheduler.acquireLease());
+    const QByteArray owner = redis.get(sessionKey);
+    QVERIFY(owner.endsWith(':' + QByteArray::number(QCoreApplication::applicationPid())));
+
+    // Expires within the interval, at least a second
+    QList<QVariantList> responses;
+    QVERIFY(redis.request({{"TTL", sessionKey}}, responses));
+    QCOMPARE(responses.value(0).value(0).toInt(), qMax(TGcScheduler::interval(TGcScheduler::Session) - 1, 1));
+
+    // Still held by this process
+    QVERIFY(scheduler.acquireLease());
+    QCOMPARE(redis.get(sessionKey), owner);
+
+    // Held by another host
+    QVERIFY(redis.set(sessionKey, "otherhost:1"));
+    QVERIFY(!scheduler.acquireLease());
+    QCOMPARE(redis.get(sessionKey), QByteArray("otherhost:1"));
+
+    // Leases of the targets are independent
+    GcScheduler cacheScheduler(TGcScheduler::Cache);
+    redis.del("_tf_gc_lease_cache");
+    QVERIFY(cacheScheduler.acquireLease());
+
+    redis.del(sessionKey);
+    QVERIFY(scheduler.acquireLease());
+    redis.del(sessionKey);
+    redis.del("_tf_gc_lease_cache");
+}
+
+TF_TEST_MAIN(TestRedis)
+#include "main.moc"
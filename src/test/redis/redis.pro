@@ -0,0 +1,4 @@
+include(../test.pri)
+TARGET = redis
+HEADERS = ../respstub.h
+SOURCES = main.cpp
@@ -0,0 +1,281 @@
+#include <QTest>
+#include <QThread>
+#include "tredisdriver.h"
+#include "../respstub.h"
+
+// Exposes the RESP parser
+class RespParser : public TRedisDriver
+{
+public:
+    using TRedisDriver::Element;
+    using TRedisDriver::parseElements;
+    using TRedisDriver::toVariant;
+    using TRedisDriver::toByteArray;
+};
+
+
+static QByteArray arrayReply(int count, const QByteArray &prefix)
+{
+    QByteArray reply = "*" + QByteArray::number(count) + CRLF;
+    for (int i = 0; i < count; i++) {
+        QByteArray str = prefix + QByteArray::number(i);
+        reply += "$" + QByteArray::number(str.length()) + CRLF + str + CRLF;
+    }
+    return reply;
+}
+
+
+class TestRedisDriver : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void parse_data();
+    void parse();
+    void parseIncomplete();
+    void request();
+    void pipeline();
+    void pubsub();
+    void bench_lrange_bytes();
+    void bench_lrange_variant();
+    void bench_hgetall_bytes();
+    void bench_hgetall_variant();
+
+private:
+    quint16 port {0};
+    RespStub *stub {nullptr};
+    QThread stubThread;
+};
+
+
+void TestRedisDriver::initTestCase()
+{
+    stub = new RespStub;
+    stub->moveToThread(&stubThread);
+    stubThread.start();
+    QMetaObject::invokeMethod(stub, "start", Qt::BlockingQueuedConnection);
+    port = stub->serverPort();
+    QVERIFY(port > 0);
+}
+
+
+void TestRedisDriver::cleanupTestCase()
+{
+    QMetaObject::invokeMethod(stub, "deleteLater");
+    stubThread.quit();
+    stubThread.wait();
+}
+
+
+void TestRedisDriver::parse_data()
+{
+    QTest::addColumn<QByteArray>("reply");
+    QTest::addColumn<QVariant>("result");
+
+    QTest::newRow("simple") << QByteArray("+OK\r\n") << QVariant(QByteArray("OK"));
+    QTest::newRow("integer") << QByteArray(":-1234567890123\r\n") << QVariant((qint64)-1234567890123LL);
+    QTest::newRow("bulk") << QByteArray("$5\r\nhel\r\n\r\n") << QVariant(QByteArray("hel\r\n"));
+    QTest::newRow("empty") << QByteArray("$0\r\n\r\n") << QVariant(QByteArray(""));
+    QTest::newRow("null") << QByteArray("$-1\r\n") << QVariant(QByteArray());
+    QTest::newRow("resp3null") << QByteArray("_\r\n") << QVariant();
+    QTest::newRow("bool") << QByteArray("#t\r\n") << QVariant(true);
+    QTest::newRow("double") << QByteArray(",1.5\r\n") << QVariant(1.5);
+    QTest::newRow("verbatim") << QByteArray("=8\r\ntxt:abcd\r\n") << QVariant(QByteArray("abcd"));
+    QTest::newRow("array") << QByteArray("*3\r\n$1\r\na\r\n:2\r\n*2\r\n$1\r\nb\r\n$-1\r\n")
+                           << QVariant(QVariantList({QByteArray("a"), (qint64)2, QVariantList({QByteArray("b"), QByteArray()})}));
+    QTest::newRow("emptyarray") << QByteArray("*0\r\n") << QVariant(QVariantList());
+    QTest::newRow("map") << QByteArray("%1\r\n+key\r\n:1\r\n") << QVariant(QVariantList({QByteArray("key"), (qint64)1}));
+}
+
+
+void TestRedisDriver::parse()
+{
+    QFETCH(QByteArray, reply);
+    QFETCH(QVariant, result);
+
+    QVector<RespParser::Element> elements;
+    QByteArray buffer = reply + "+NEXT\r\n";
+    int pos = 0;
+    bool ok;
+    QVERIFY(RespParser::parseElements(buffer, pos, elements, &ok));
+    QVERIFY(ok);
+    QCOMPARE(pos, reply.length());
+
+    int index = 0;
+    QVariant var = RespParser::toVariant(buffer, elements, index);
+    QCOMPARE(index, elements.count());
+    QCOMPARE(var, result);
+}
+
+
+void TestRedisDriver::parseIncomplete()
+{
+    QVector<RespParser::Element> elements;
+    const QByteArray reply("*2\r\n$3\r\nfoo\r\n:10\r\n");
+
+    for (int len = 0; len < reply.length(); len++) {
+        int pos = 0;
+        bool ok;
+        QVERIFY(RespParser::parseElements(reply.left(len), pos, elements, &ok));
+        QVERIFY(!ok);
+        QCOMPARE(pos, 0);
+    }
+
+    int pos = 0;
+    bool ok;
+    QVERIFY(!RespParser::parseElements("?foo\r\n", pos, elements, &ok));
+    QVERIFY(!RespParser::parseElements("$x\r\n", pos, elements, &ok));
+}
+
+
+void TestRedisDriver::request()
+{
+    TRedisDriver driver;
+    QVERIFY(driver.open(QString(), QString(), QString(), "127.0.0.1", port));
+
+    QVariantList resp;
+    QVERIFY(driver.request({"SET", "foo", "bar"}, resp));
+    QVERIFY(driver.request({"GET", "foo"}, resp));
+    QCOMPARE(resp.value(0).toByteArray(), QByteArray("bar"));
+
+    QByteArrayList bytes;
+    QVERIFY(driver.request({"GET", "foo"}, bytes));
+    QCOMPARE(bytes, QByteArrayList({"bar"}));
+    QVERIFY(driver.request({"GET", "nokey"}, bytes));
+    QVERIFY(bytes.value(0).isNull());
+    QVERIFY(!driver.request({"UNKNOWN"}, resp));
+    QVERIFY(driver.isOpen());
+    driver.close();
+}
+
+
+void TestRedisDriver::pipeline()
+{
+    TRedisDriver driver;
+    QVERIFY(driver.open(QString(), QString(), QString(), "127.0.0.1", port));
+
+    QList<QByteArrayList> commands;
+    for (int i = 0; i < 100; i++) {
+        commands << QByteArrayList({"SET", "key" + QByteArray::number(i), QByteArray::number(i * i)});
+    }
+    for (int i = 0; i < 100; i++) {
+        commands << QByteArrayList({"GET", "key" + QByteArray::number(i)});
+    }
+    commands << QByteArrayList({"DEL", "key0", "key1", "nokey"});
+
+    QList<QVariantList> responses;
+    QVERIFY(driver.request(commands, responses));
+    QCOMPARE(responses.count(), commands.count());
+    for (int i = 0; i < 100; i++) {
+        QCOMPARE(responses[100 + i].value(0).toByteArray(), QByteArray::number(i * i));
+    }
+    QCOMPARE(responses.last().value(0).toInt(), 2);
+    driver.close();
+}
+
+
+void TestRedisDriver::pubsub()
+{
+    TRedisDriver subscriber;
+    TRedisDriver publisher;
+    QVERIFY(subscriber.open(QString(), QString(), QString(), "127.0.0.1", port));
+    QVERIFY(publisher.open(QString(), QString(), QString(), "127.0.0.1", port));
+
+    QVariantList resp;
+    QVERIFY(subscriber.request({"PSUBSCRIBE", "topic:*"}, resp));
+    QVERIFY(!subscriber.waitForMessage(resp, 100));  // timeout
+    QVERIFY(subscriber.isOpen());
+
+    QList<QVariantList> responses;
+    QVERIFY(publisher.request({{"PUBLISH", "topic:a", "hello"}, {"PUBLISH", "topic:b", "world"}}, responses));
+    QCOMPARE(responses.value(0).value(0).toInt(), 1);
+
+    QVariantList message;
+    QVERIFY(subscriber.waitForMessage(message, 1000));
+    QCOMPARE(message.count(), 4);
+    QCOMPARE(message[0].toByteArray(), QByteArray("pmessage"));
+    QCOMPARE(message[2].toByteArray(), QByteArray("topic:a"));
+    QCOMPARE(message[3].toByteArray(), QByteArray("hello"));
+
+    QVERIFY(subscriber.waitForMessage(message, 1000));
+    QCOMPARE(message[2].toByteArray(), QByteArray("topic:b"));
+    QCOMPARE(message[3].toByteArray(), QByteArray("world"));
+}
+
+
+void TestRedisDriver::bench_lrange_bytes()
+{
+    const QByteArray reply = arrayReply(10000, "item:");
+    QVector<RespParser::Element> elements;
+
+    QBENCHMARK {
+        int pos = 0;
+        bool ok;
+        RespParser::parseElements(reply, pos, elements, &ok);
+        QByteArrayList list;
+        list.reserve(elements.count());
+        for (int i = 1; i < elements.count(); i++) {
+            list << RespParser::toByteArray(reply, elements[i]);
+        }
+    }
+}
+
+
+void TestRedisDriver::bench_lrange_variant()
+{
+    const QByteArray reply = arrayReply(10000, "item:");
+    QVector<RespParser::Element> elements;
+
+    QBENCHMARK {
+        int pos = 0;
+        int index = 0;
+        bool ok;
+        RespParser::parseElements(reply, pos, elements, &ok);
+        QVariantList list = RespParser::toVariant(reply, elements, index).toList();
+        QByteArrayList bytes;
+        for (auto &var : list) {
+            bytes << var.toByteArray();
+        }
+    }
+}
+
+
+void TestRedisDriver::bench_hgetall_bytes()
+{
+    const QByteArray reply = arrayReply(2000, "field:");
+    QVector<RespParser::Element> elements;
+
+    QBENCHMARK {
+        int pos = 0;
+        bool ok;
+        RespParser::parseElements(reply, pos, elements, &ok);
+        QList<QPair<QByteArray, QByteArray>> hash;
+        for (int i = 1; i + 1 < elements.count(); i += 2) {
+            hash << qMakePair(RespParser::toByteArray(reply, elements[i]), RespParser::toByteArray(reply, elements[i + 1]));
+        }
+    }
+}
+
+
+void TestRedisDriver::bench_hgetall_variant()
+{
+    const QByteArray reply = arrayReply(2000, "field:");
+    QVector<RespParser::Element> elements;
+
+    QBENCHMARK {
+        int pos = 0;
+        int index = 0;
+        bool ok;
+        RespParser::parseElements(reply, pos, elements, &ok);
+        QVariantList list = RespParser::toVariant(reply, elements, index).toList();
+        QList<QPair<QByteArray, QByteArray>> hash;
+        for (int i = 0; i + 1 < list.count(); i += 2) {
+            hash << qMakePair(list[i].toByteArray(), list[i + 1].toByteArray());
+        }
+    }
+}
+
+
+QTEST_GUILESS_MAIN(TestRedisDriver)
+#include "main.moc"
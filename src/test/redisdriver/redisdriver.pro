@@ -0,0 +1,4 @@
+include(../test.pri)
+TARGET = redisdriver
+HEADERS = ../respstub.h
+SOURCES = main.cpp
@@ -0,0 +1,201 @@
+#ifndef RESPSTUB_H
+#define RESPSTUB_H
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QMap>
+
+const QByteArray CRLF("\r\n");
+
+
+// In-tree RESP stub, which implements a few Redis commands
+class RespStub : public QTcpServer
+{
+    Q_OBJECT
+public:
+    RespStub(quint16 port = 0) : QTcpServer(), listenPort(port) { }
+
+    // Number of commands received
+    int commandCount() const { return count; }
+
+public slots:
+    void start()
+    {
+        connect(this, SIGNAL(newConnection()), this, SLOT(accept()), Qt::UniqueConnection);
+        listen(QHostAddress::LocalHost, listenPort);
+    }
+
+    // Drops the connections of all clients, as a restart of the server
+    void disconnectAll()
+    {
+        for (auto *socket : findChildren<QTcpSocket *>()) {
+            socket->abort();
+            socket->deleteLater();
+        }
+        buffers.clear();
+        subscribers.clear();
+    }
+
+    void stop()
+    {
+        close();
+        disconnectAll();
+    }
+
+protected slots:
+    void accept()
+    {
+        while (hasPendingConnections()) {
+            QTcpSocket *socket = nextPendingConnection();
+            connect(socket, SIGNAL(readyRead()), this, SLOT(read()));
+        }
+    }
+
+    void read()
+    {
+        auto *socket = qobject_cast<QTcpSocket *>(sender());
+        QByteArray &buf = buffers[socket];
+        buf += socket->readAll();
+
+        QByteArrayList command;
+        while (parseCommand(buf, command)) {
+            count++;
+            socket->write(execute(socket, command));
+        }
+        socket->flush();
+    }
+
+private:
+    static bool parseCommand(QByteArray &buf, QByteArrayList &command)
+    {
+        command.clear();
+        if (!buf.startsWith('*')) {
+            return false;
+        }
+
+        int pos = buf.indexOf(CRLF);
+        if (pos < 0) {
+            return false;
+        }
+
+        int count = buf.mid(1, pos - 1).toInt();
+        pos += 2;
+        for (int i = 0; i < count; i++) {
+            int idx = buf.indexOf(CRLF, pos);
+            if (idx < 0) {
+                return false;
+            }
+            int len = buf.mid(pos + 1, idx - pos - 1).toInt();
+            pos = idx + 2;
+            if (buf.length() < pos + len + 2) {
+                return false;
+            }
+            command << buf.mid(pos, len);
+            pos += len + 2;
+        }
+        buf.remove(0, pos);
+        return true;
+    }
+
+    static QByteArray bulk(const QByteArray &data)
+    {
+        if (data.isNull()) {
+            return QByteArray("$-1") + CRLF;
+        }
+        return "$" + QByteArray::number(data.length()) + CRLF + data + CRLF;
+    }
+
+    static QByteArray integer(qint64 n)
+    {
+        return ":" + QByteArray::number(n) + CRLF;
+    }
+
+    QByteArray execute(QTcpSocket *socket, const QByteArrayList &command)
+    {
+        const QByteArray cmd = command.value(0).toUpper();
+        if (cmd == "PING") {
+            return "+PONG" + CRLF;
+        } else if (cmd == "SET") {
+            // Options: NX and EX seconds
+            const QByteArrayList opts = command.mid(3);
+            for (auto &opt : opts) {
+                if (opt.toUpper() == "NX" && store.contains(command.value(1))) {
+                    return bulk(QByteArray());
+                }
+            }
+            store.insert(command.value(1), command.value(2));
+            ttl.remove(command.value(1));
+            for (int i = 0; i + 1 < opts.count(); i++) {
+                if (opts[i].toUpper() == "EX") {
+                    ttl.insert(command.value(1), opts[i + 1].toInt());
+                }
+            }
+            return "+OK" + CRLF;
+        } else if (cmd == "SETEX") {
+            store.insert(command.value(1), command.value(3));
+            ttl.insert(command.value(1), command.value(2).toInt());
+            return "+OK" + CRLF;
+        } else if (cmd == "GET") {
+            return bulk(store.value(command.value(1)));
+        } else if (cmd == "MGET") {
+            QByteArray reply = "*" + QByteArray::number(command.count() - 1) + CRLF;
+            for (int i = 1; i < command.count(); i++) {
+                reply += bulk(store.value(command[i]));
+            }
+            return reply;
+        } else if (cmd == "MSET") {
+            for (int i = 1; i + 1 < command.count(); i += 2) {
+                store.insert(command[i], command[i + 1]);
+            }
+            return "+OK" + CRLF;
+        } else if (cmd == "EXPIRE") {
+            if (!store.contains(command.value(1))) {
+                return integer(0);
+            }
+            ttl.insert(command.value(1), command.value(2).toInt());
+            return integer(1);
+        } else if (cmd == "TTL") {
+            return integer(ttl.value(command.value(1), -1));
+        } else if (cmd == "INCRBY") {
+            qint64 n = store.value(command.value(1)).toLongLong() + command.value(2).toLongLong();
+            store.insert(command.value(1), QByteArray::number(n));
+            return integer(n);
+        } else if (cmd == "DEL") {
+            int n = 0;
+            for (int i = 1; i < command.count(); i++) {
+                n += store.remove(command[i]);
+                ttl.remove(command[i]);
+            }
+            return integer(n);
+        } else if (cmd == "FLUSHDB") {
+            store.clear();
+            ttl.clear();
+            return "+OK" + CRLF;
+        } else if (cmd == "PSUBSCRIBE") {
+            subscribers.insert(socket, command.value(1));
+            return "*3" + CRLF + bulk("psubscribe") + bulk(command.value(1)) + integer(1);
+        } else if (cmd == "PUBLISH") {
+            int n = 0;
+            for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+                QByteArray prefix = it.value();
+                prefix.chop(1);  // removes '*'
+                if (command.value(1).startsWith(prefix)) {
+                    it.key()->write("*4" + CRLF + bulk("pmessage") + bulk(it.value()) + bulk(command.value(1)) + bulk(command.value(2)));
+                    it.key()->flush();
+                    n++;
+                }
+            }
+            return integer(n);
+        }
+        return "-ERR unknown command '" + command.value(0) + "'" + CRLF;
+    }
+
+    quint16 listenPort {0};
+    int count {0};
+    QMap<QTcpSocket *, QByteArray> buffers;
+    QMap<QTcpSocket *, QByteArray> subscribers;
+    QMap<QByteArray, QByteArray> store;
+    QMap<QByteArray, int> ttl;
+};
+
+#endif // RESPSTUB_H
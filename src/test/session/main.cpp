@@ -0,0 +1,156 @@
+#include <TfTest/TfTest>
+#include <TSession>
+#include "tsessionmanager.h"
+#include "tsessionfilestore.h"
+
+
+class TestSession : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void isModified();
+    void touch();
+    void touchRemoved();
+    void isRefreshRequired();
+};
+
+
+static QString sessionFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + QLatin1String(id.left(2)) + QLatin1Char('/') + QLatin1String(id);
+}
+
+
+static bool setModifiedTime(const QByteArray &id, const QDateTime &time)
+{
+    QFile file(sessionFilePath(id));
+    return file.open(QIODevice::ReadWrite) && file.setFileTime(time, QFileDevice::FileModificationTime);
+}
+
+
+static TSession createSession()
+{
+    TSession session(TSessionManager::instance().generateId());
+    session.insert("name", "foo");
+    TSessionManager::instance().store(session);
+    return session;
+}
+
+
+void TestSession::initTestCase()
+{
+    QCOMPARE(TSessionManager::instance().storeType(), QString("file"));
+    QDir(TSessionFileStore::sessionDirPath()).removeRecursively();
+}
+
+
+void TestSession::isModified()
+{
+    TSession session(TSessionManager::instance().generateId());
+    QVERIFY(session.isModified());  // not stored yet
+    session.insert("name", "foo");
+    QVERIFY(TSessionManager::instance().store(session));
+
+    TSession found = TSessionManager::instance().findSession(session.id());
+    QCOMPARE(found.id(), session.id());
+    QCOMPARE(found.value("name").toString(), QString("foo"));
+    QVERIFY(!found.isModified());
+
+    // Compared by the values
+    found.insert("name", "foo");
+    QVERIFY(!found.isModified());
+    found.insert("name", "bar");
+    QVERIFY(found.isModified());
+    found.insert("name", "foo");
+    QVERIFY(!found.isModified());
+    found.insert("age", 20);
+    QVERIFY(found.isModified());
+    found.remove("age");
+    QVERIFY(!found.isModified());
+    found.take("name");
+    QVERIFY(found.isModified());
+
+    // Copies keep the found data
+    found.insert("name", "foo");
+    TSession copy = found;
+    QVERIFY(!copy.isModified());
+    copy.insert("name", "baz");
+    QVERIFY(copy.isModified());
+    QVERIFY(!found.isModified());
+
+    // Not found
+    QVERIFY(TSessionManager::instance().findSession(TSessionManager::instance().generateId()).id().isEmpty());
+}
+
+
+void TestSession::touch()
+{
+#if QT_VERSION < 0x050a00  // 5.10.0
+    QSKIP("QFileDevice::setFileTime() requires Qt 5.10 or later");
+#endif
+    TSession session = createSession();
+    const QDateTime old = QDateTime::currentDateTime().addSecs(-600);
+    QVERIFY(setModifiedTime(session.id(), old));
+
+    QFile file(sessionFilePath(session.id()));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    file.close();
+
+    TSession found = TSessionManager::instance().findSession(session.id());
+    QVERIFY(!found.isModified());
+    QVERIFY(TSessionManager::instance().touch(found));
+
+    // Only the modification time is updated
+    QVERIFY(QFileInfo(sessionFilePath(session.id())).lastModified() > old.addSecs(590));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), data);
+    file.close();
+
+    found = TSessionManager::instance().findSession(session.id());
+    QCOMPARE(found.value("name").toString(), QString("foo"));
+}
+
+
+void TestSession::touchRemoved()
+{
+    TSession session = createSession();
+    TSession found = TSessionManager::instance().findSession(session.id());
+    QVERIFY(TSessionManager::instance().remove(session.id()));
+    QVERIFY(!QFileInfo::exists(sessionFilePath(session.id())));
+
+    // Stored again by the fallback of touch()
+    QVERIFY(TSessionManager::instance().touch(found));
+    found = TSessionManager::instance().findSession(session.id());
+    QCOMPARE(found.id(), session.id());
+    QCOMPARE(found.value("name").toString(), QString("foo"));
+}
+
+
+void TestSession::isRefreshRequired()
+{
+#if QT_VERSION < 0x050a00  // 5.10.0
+    QSKIP("QFileDevice::setFileTime() requires Qt 5.10 or later");
+#endif
+    auto &manager = TSessionManager::instance();
+
+    // Unknown time of the last write
+    TSession session = createSession();
+    QVERIFY(manager.isRefreshRequired(session));
+
+    // Within Session.RefreshInterval of 60 seconds
+    QVERIFY(!manager.isRefreshRequired(manager.findSession(session.id())));
+    QVERIFY(setModifiedTime(session.id(), QDateTime::currentDateTime().addSecs(-30)));
+    QVERIFY(!manager.isRefreshRequired(manager.findSession(session.id())));
+
+    // Past the interval
+    QVERIFY(setModifiedTime(session.id(), QDateTime::currentDateTime().addSecs(-120)));
+    TSession found = manager.findSession(session.id());
+    QVERIFY(manager.isRefreshRequired(found));
+    QVERIFY(manager.touch(found));
+    QVERIFY(!manager.isRefreshRequired(manager.findSession(session.id())));
+}
+
+TF_TEST_SQLLESS_MAIN(TestSession)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = session
+SOURCES = main.cpp
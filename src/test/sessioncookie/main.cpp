@@ -0,0 +1,264 @@
+#include <QTest>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <TGlobal>
+#include <cctype>
+#include "tsessioncookiecodec.h"
+
+
+class SessionCookie : public QObject
+{
+    Q_OBJECT
+private slots:
+    void encode_data();
+    void encode();
+    void decodeBroken();
+    void sipHash();
+    void cookie_data();
+    void cookie();
+    void tamperedCookie();
+    void benchLegacy_data() { benchData(); }
+    void benchLegacy();
+    void benchHmacSha256_data() { benchData(); }
+    void benchHmacSha256();
+    void benchSipHash_data() { benchData(); }
+    void benchSipHash();
+
+private:
+    void benchData();
+};
+
+static const QByteArray Secret("0123456789abcdefghijklmnopqrstuvwxyz");
+
+
+// Session of about the size, the values of common types
+static QVariantMap sampleSession(int size)
+{
+    QVariantMap map;
+    map.insert("_csrfId", QByteArray("8e0bbdbbd0e3efd0d3bc4a4e0fa0e3cd"));
+    map.insert("userId", 12345);
+    map.insert("loggedIn", true);
+    map.insert("lastAccess", QDateTime::fromMSecsSinceEpoch(1546300800000LL, Qt::UTC));
+
+    for (int i = 0; i < size / 40; ++i) {
+        map.insert(QString("item%1").arg(i), QString(u8"value of item %1 日本語").arg(i));
+    }
+    return map;
+}
+
+
+void SessionCookie::encode_data()
+{
+    QTest::addColumn<QVariantMap>("map");
+
+    QVariantMap nested;
+    nested.insert("a", QVariantList {1, QString("x"), QVariant()});
+    nested.insert("b", QStringList {"foo", "bar"});
+
+    QVariantMap map;
+    map.insert("invalid", QVariant());
+    map.insert("bool", false);
+    map.insert("int", -123456);
+    map.insert("uint", 4000000000u);
+    map.insert("longlong", Q_INT64_C(-1234567890123));
+    map.insert("ulonglong", Q_UINT64_C(18446744073709551615));
+    map.insert("double", 3.14159);
+    map.insert("string", QString(u8"こんにちは"));
+    map.insert("bytearray", QByteArray("\0\x01\xff", 3));
+    map.insert("map", nested);
+    map.insert("utc", QDateTime::fromMSecsSinceEpoch(-1000, Qt::UTC));
+    map.insert("local", QDateTime(QDate(2019, 1, 2), QTime(3, 4, 5, 6)));
+    map.insert("offset", QDateTime(QDate(2019, 1, 2), QTime(3, 4, 5), Qt::OffsetFromUTC, 3600));
+    map.insert("date", QDate(2019, 1, 2));  // by QDataStream
+
+    QTest::newRow("empty") << QVariantMap();
+    QTest::newRow("types") << map;
+    QTest::newRow("sample") << sampleSession(1024);
+}
+
+
+void SessionCookie::encode()
+{
+    QFETCH(QVariantMap, map);
+
+    QByteArray data = TSessionCookieCodec::encode(map);
+    QVERIFY(!data.isNull());
+
+    QVariantMap res;
+    QVERIFY(TSessionCookieCodec::decode(data.constData(), data.length(), res));
+    QCOMPARE(res, map);
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        QCOMPARE(res[it.key()].userType(), it.value().userType());
+    }
+}
+
+
+void SessionCookie::decodeBroken()
+{
+    QByteArray data = TSessionCookieCodec::encode(sampleSession(256));
+    QVariantMap res;
+
+    // Truncated at every byte
+    for (int i = 0; i < data.length(); ++i) {
+        QVERIFY(!TSessionCookieCodec::decode(data.constData(), i, res));
+    }
+    // Trailing garbage
+    QByteArray ba = data + '\0';
+    QVERIFY(!TSessionCookieCodec::decode(ba.constData(), ba.length(), res));
+    // Huge count
+    ba = QByteArray::fromHex("ffffffffffffffff7f");
+    QVERIFY(!TSessionCookieCodec::decode(ba.constData(), ba.length(), res));
+}
+
+
+void SessionCookie::sipHash()
+{
+    // Test vector of the reference implementation
+    uchar key[16];
+    char msg[15];
+    for (int i = 0; i < 16; ++i) {
+        key[i] = i;
+    }
+    for (int i = 0; i < 15; ++i) {
+        msg[i] = i;
+    }
+    QCOMPARE(TSessionCookieCodec::sipHash(msg, sizeof(msg), key), Q_UINT64_C(0xa129ca6149be45e5));
+    QCOMPARE(TSessionCookieCodec::sipHash(msg, 0, key), Q_UINT64_C(0x726fdb47dd0e0e31));
+    QCOMPARE(TSessionCookieCodec::sipHash(msg, 8, key), Q_UINT64_C(0x93f5f5799a932462));
+}
+
+
+void SessionCookie::cookie_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("algorithm");
+
+    QTest::newRow("small hmac") << 100 << (int)TSessionCookieCodec::HmacSha256;
+    QTest::newRow("small siphash") << 100 << (int)TSessionCookieCodec::SipHash;
+    QTest::newRow("large hmac") << 4096 << (int)TSessionCookieCodec::HmacSha256;
+    QTest::newRow("large siphash") << 4096 << (int)TSessionCookieCodec::SipHash;
+}
+
+
+void SessionCookie::cookie()
+{
+    QFETCH(int, size);
+    QFETCH(int, algorithm);
+
+    auto alg = (TSessionCookieCodec::MacAlgorithm)algorithm;
+    QVariantMap map = sampleSession(size);
+    QByteArray cookie = TSessionCookieCodec::encodeCookie(map, Secret, alg);
+    QVERIFY(!cookie.isEmpty());
+
+    // Cookie-safe characters only
+    for (char c : cookie) {
+        QVERIFY(isalnum((uchar)c) || c == '-' || c == '_' || c == '.');
+    }
+
+    QVariantMap res;
+    QVERIFY(TSessionCookieCodec::decodeCookie(cookie, Secret, alg, res));
+    QCOMPARE(res, map);
+
+    // Other secret
+    res.clear();
+    QVERIFY(!TSessionCookieCodec::decodeCookie(cookie, Secret + "x", alg, res));
+}
+
+
+void SessionCookie::tamperedCookie()
+{
+    const auto alg = TSessionCookieCodec::HmacSha256;
+    const auto options = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+    QByteArray cookie = TSessionCookieCodec::encodeCookie(sampleSession(100), Secret, alg);
+    QByteArrayList parts = cookie.split('.');
+    QCOMPARE(parts.count(), 2);
+    QVariantMap res;
+
+    // Flips a bit of every byte of the payload and the tag
+    for (int p = 0; p < 2; ++p) {
+        const QByteArray data = QByteArray::fromBase64(parts[p], options);
+        for (int i = 0; i < data.length(); ++i) {
+            QByteArray ba = data;
+            ba[i] = ba[i] ^ 0x01;
+            QByteArrayList tampered = parts;
+            tampered[p] = ba.toBase64(options);
+            QVERIFY(!TSessionCookieCodec::decodeCookie(tampered.join('.'), Secret, alg, res));
+        }
+    }
+
+    QVERIFY(!TSessionCookieCodec::decodeCookie(parts[0], Secret, alg, res));
+    QVERIFY(!TSessionCookieCodec::decodeCookie(parts[0] + '.', Secret, alg, res));
+    QVERIFY(!TSessionCookieCodec::decodeCookie(cookie, Secret, TSessionCookieCodec::SipHash, res));
+}
+
+
+void SessionCookie::benchData()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("100B") << 100;
+    QTest::newRow("1KB") << 1024;
+    QTest::newRow("4KB") << 4096;
+}
+
+// Encodes and decodes in the way of the cookie store before; QDataStream,
+// LZ4 and SHA-1 of the data with the secret appended
+void SessionCookie::benchLegacy()
+{
+    QFETCH(int, size);
+    QVariantMap map = sampleSession(size);
+    QVariantMap res;
+
+    QBENCHMARK {
+        QByteArray ba;
+        QDataStream ds(&ba, QIODevice::WriteOnly);
+        ds << map;
+        ba = Tf::lz4Compress(ba);
+        QByteArray digest = QCryptographicHash::hash(ba + Secret, QCryptographicHash::Sha1);
+        QByteArray cookie = ba.toBase64() + "_" + digest.toBase64();
+
+        QByteArrayList balst = cookie.split('_');
+        QByteArray data = QByteArray::fromBase64(balst[0]);
+        if (QCryptographicHash::hash(data + Secret, QCryptographicHash::Sha1) == QByteArray::fromBase64(balst[1])) {
+            data = Tf::lz4Uncompress(data);
+            QDataStream ds2(&data, QIODevice::ReadOnly);
+            ds2 >> res;
+        }
+    }
+    QCOMPARE(res, map);
+}
+
+
+void SessionCookie::benchHmacSha256()
+{
+    QFETCH(int, size);
+    QVariantMap map = sampleSession(size);
+    QVariantMap res;
+
+    QBENCHMARK {
+        QByteArray cookie = TSessionCookieCodec::encodeCookie(map, Secret, TSessionCookieCodec::HmacSha256);
+        res.clear();
+        TSessionCookieCodec::decodeCookie(cookie, Secret, TSessionCookieCodec::HmacSha256, res);
+    }
+    QCOMPARE(res, map);
+}
+
+
+void SessionCookie::benchSipHash()
+{
+    QFETCH(int, size);
+    QVariantMap map = sampleSession(size);
+    QVariantMap res;
+
+    QBENCHMARK {
+        QByteArray cookie = TSessionCookieCodec::encodeCookie(map, Secret, TSessionCookieCodec::SipHash);
+        res.clear();
+        TSessionCookieCodec::decodeCookie(cookie, Secret, TSessionCookieCodec::SipHash, res);
+    }
+    QCOMPARE(res, map);
+}
+
+QTEST_APPLESS_MAIN(SessionCookie)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sessioncookie
+SOURCES = main.cpp
@@ -0,0 +1,166 @@
+#include <TfTest/TfTest>
+#include <TSession>
+#include "tsessionfilestore.h"
+
+
+class TestSessionFileStore : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void shard();
+    void legacyLayout();
+    void invalidId_data();
+    void invalidId();
+    void gcBatch();
+};
+
+
+static QString shardFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + QLatin1String(id.left(2)) + QLatin1Char('/') + QLatin1String(id);
+}
+
+
+static QString legacyFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + QLatin1String(id);
+}
+
+
+static bool storeSession(TSessionFileStore &store, const QByteArray &id)
+{
+    TSession session(id);
+    session.insert("name", "foo");
+    return store.store(session);
+}
+
+
+void TestSessionFileStore::init()
+{
+    QDir(TSessionFileStore::sessionDirPath()).removeRecursively();
+}
+
+
+void TestSessionFileStore::shard()
+{
+    TSessionFileStore store;
+    QVERIFY(storeSession(store, "ab0123456789"));
+    QVERIFY(storeSession(store, "cd0123456789"));
+
+    QVERIFY(QFileInfo::exists(shardFilePath("ab0123456789")));
+    QVERIFY(QFileInfo::exists(shardFilePath("cd0123456789")));
+    QVERIFY(!QFileInfo::exists(legacyFilePath("ab0123456789")));
+    QCOMPARE(store.find("ab0123456789").value("name").toString(), QString("foo"));
+
+    QVERIFY(store.remove("ab0123456789"));
+    QVERIFY(!QFileInfo::exists(shardFilePath("ab0123456789")));
+    QVERIFY(store.find("ab0123456789").id().isEmpty());
+    QVERIFY(!store.remove("ab0123456789"));
+}
+
+
+void TestSessionFileStore::legacyLayout()
+{
+    const QByteArray id = "ef0123456789";
+    TSessionFileStore store;
+
+    // Moves a stored file to the flat layout before sharding
+    QVERIFY(storeSession(store, id));
+    QVERIFY(QFile::rename(shardFilePath(id), legacyFilePath(id)));
+
+    TSession session = store.find(id);
+    QCOMPARE(session.id(), id);
+    QCOMPARE(session.value("name").toString(), QString("foo"));
+
+    // Migrated to the shard by touch()
+    QVERIFY(store.touch(session));
+    QVERIFY(QFileInfo::exists(shardFilePath(id)));
+    QVERIFY(!QFileInfo::exists(legacyFilePath(id)));
+    QCOMPARE(store.find(id).value("name").toString(), QString("foo"));
+
+    // Migrated by store() as well
+    QVERIFY(QFile::rename(shardFilePath(id), legacyFilePath(id)));
+    session.insert("name", "bar");
+    QVERIFY(store.store(session));
+    QVERIFY(!QFileInfo::exists(legacyFilePath(id)));
+    QCOMPARE(store.find(id).value("name").toString(), QString("bar"));
+
+    // Removed from both layouts
+    QVERIFY(QFile::copy(shardFilePath(id), legacyFilePath(id)));
+    QVERIFY(store.remove(id));
+    QVERIFY(!QFileInfo::exists(shardFilePath(id)));
+    QVERIFY(!QFileInfo::exists(legacyFilePath(id)));
+}
+
+
+void TestSessionFileStore::invalidId_data()
+{
+    QTest::addColumn<QByteArray>("id");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("short") << QByteArray("ab");
+    QTest::newRow("parent") << QByteArray("../secret");
+    QTest::newRow("slash") << QByteArray("ab/../../etc");
+    QTest::newRow("backslash") << QByteArray("ab\\..\\etc");
+    QTest::newRow("dot") << QByteArray("ab.0123");
+    QTest::newRow("nul") << QByteArray("ab01\0" "23", 7);
+}
+
+
+void TestSessionFileStore::invalidId()
+{
+    QFETCH(QByteArray, id);
+    TSessionFileStore store;
+
+    QVERIFY(!storeSession(store, id));
+    QVERIFY(store.find(id).id().isEmpty());
+    QVERIFY(!store.remove(id));
+
+    TSession session(id);
+    QVERIFY(!store.touch(session));
+    QVERIFY(QDir(TSessionFileStore::sessionDirPath()).entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty());
+}
+
+
+void TestSessionFileStore::gcBatch()
+{
+    TSessionFileStore store;
+    // Every file is older than this
+    const QDateTime expire = QDateTime::currentDateTime().addSecs(60);
+
+    // Starts from the first shard
+    QCOMPARE(store.gcBatch(expire, 1000), 0);
+
+    const QByteArrayList shards = {"aa", "bb", "cc"};
+    for (auto &shard : shards) {
+        for (int i = 0; i < 3; i++) {
+            QVERIFY(storeSession(store, shard + QByteArray::number(i).rightJustified(8, '0')));
+        }
+    }
+
+    // Stops in the middle of the shard 'bb'
+    QCOMPARE(store.gcBatch(expire, 4), 4);
+    QCOMPARE(QDir(TSessionFileStore::sessionDirPath() + "aa").entryList(QDir::Files).count(), 0);
+    QCOMPARE(QDir(TSessionFileStore::sessionDirPath() + "bb").entryList(QDir::Files).count(), 2);
+
+    // Resumes from 'bb', not from the first shard
+    QVERIFY(storeSession(store, "aa99999999"));
+    QCOMPARE(store.gcBatch(expire, 2), 2);
+    QCOMPARE(QDir(TSessionFileStore::sessionDirPath() + "bb").entryList(QDir::Files).count(), 0);
+    QVERIFY(QFileInfo::exists(shardFilePath("aa99999999")));
+
+    // Wraps around to the first shards
+    QCOMPARE(store.gcBatch(expire, 1000), 4);
+    QCOMPARE(QDir(TSessionFileStore::sessionDirPath() + "cc").entryList(QDir::Files).count(), 0);
+    QVERIFY(!QFileInfo::exists(shardFilePath("aa99999999")));
+
+    // Sessions not expired are kept
+    QVERIFY(storeSession(store, "dd00000000"));
+    QCOMPARE(store.gcBatch(QDateTime::currentDateTime().addSecs(-60), 1000), 0);
+    QVERIFY(QFileInfo::exists(shardFilePath("dd00000000")));
+    QCOMPARE(store.gc(expire), 1);
+}
+
+TF_TEST_SQLLESS_MAIN(TestSessionFileStore)
+#include "main.moc"
@@ -0,0 +1,44 @@
+#include <QTest>
+#include <QSet>
+#include "../../tsessionmanager.h"
+
+
+class SessionId : public QObject
+{
+    Q_OBJECT
+private slots:
+    void generateId();
+    void unique();
+    void benchGenerateId();
+};
+
+
+void SessionId::generateId()
+{
+    QByteArray id = TSessionManager::instance().generateId();
+    QCOMPARE(id.length(), 32);  // 128 bits in hex
+    for (char c : id) {
+        QVERIFY(isxdigit((uchar)c));
+    }
+}
+
+
+void SessionId::unique()
+{
+    QSet<QByteArray> ids;
+    for (int i = 0; i < 100000; ++i) {
+        ids << TSessionManager::instance().generateId();
+    }
+    QCOMPARE(ids.count(), 100000);
+}
+
+
+void SessionId::benchGenerateId()
+{
+    QBENCHMARK {
+        TSessionManager::instance().generateId();
+    }
+}
+
+QTEST_APPLESS_MAIN(SessionId)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sessionid
+SOURCES = main.cpp
@@ -0,0 +1,165 @@
+#include <TfTest/TfTest>
+#include <TSqlQuery>
+#include <TSqlAsync>
+#include <TDatabaseContext>
+#include "tsqlquerycache.h"
+
+const int NUM = 100;
+
+
+class SqlAsync : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void execAsync();
+    void execAsyncBind();
+    void execAsyncError();
+    void transactionAffinity();
+    void queryCacheInvalidate();
+    void bench_exec();
+    void bench_execAsync();
+};
+
+
+static int count(std::future<QList<QSqlRecord>> &future)
+{
+    return future.get().value(0).value(0).toInt();
+}
+
+
+void SqlAsync::initTestCase()
+{
+    TSqlQuery query;
+    QVERIFY(query.exec("DROP TABLE IF EXISTS item"));
+    QVERIFY(query.exec("CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT, score INTEGER)"));
+
+    for (int i = 0; i < NUM; ++i) {
+        query.prepare("INSERT INTO item (name, score) VALUES (?, ?)");
+        query.addBind(QString("item%1").arg(i)).addBind(i % 10);
+        QVERIFY(query.exec());
+    }
+}
+
+
+void SqlAsync::cleanupTestCase()
+{
+    TSqlQuery query;
+    query.exec("DROP TABLE IF EXISTS item");
+}
+
+
+void SqlAsync::execAsync()
+{
+    // Fan out independent queries and join them
+    auto f1 = TSqlQuery::execAsync("SELECT COUNT(*) FROM item");
+    auto f2 = TSqlQuery::execAsync("SELECT COUNT(*) FROM item WHERE score = 0");
+    auto f3 = TSqlQuery::execAsync("SELECT name FROM item ORDER BY id");
+
+    QCOMPARE(count(f1), NUM);
+    QCOMPARE(count(f2), NUM / 10);
+
+    auto records = f3.get();
+    QCOMPARE(records.count(), NUM);
+    QCOMPARE(records.first().value("name").toString(), QString("item0"));
+    QCOMPARE(records.last().value("name").toString(), QString("item%1").arg(NUM - 1));
+}
+
+
+void SqlAsync::execAsyncBind()
+{
+    auto f = TSqlQuery::execAsync("SELECT COUNT(*) FROM item WHERE score >= ? AND score < ?", {5, 8});
+    QCOMPARE(count(f), NUM * 3 / 10);
+}
+
+
+void SqlAsync::execAsyncError()
+{
+    auto f = TSqlQuery::execAsync("SELECT COUNT(*) FROM no_such_table");
+    QVERIFY_EXCEPTION_THROWN(f.get(), SqlException);
+}
+
+
+void SqlAsync::transactionAffinity()
+{
+    TDatabaseContext *context = Tf::currentDatabaseContext();
+    context->setTransactionEnabled(true);
+
+    TSqlQuery query;  // begins a transaction
+    QVERIFY(context->isTransactionActive());
+    QVERIFY(TSqlAsync::isTransactionBound(0));
+    QVERIFY(query.exec("INSERT INTO item (name, score) VALUES ('uncommitted', 0)"));
+
+    // Executed on the owning context, so the uncommitted row is seen
+    auto f1 = TSqlQuery::execAsync("SELECT COUNT(*) FROM item");
+    QCOMPARE(count(f1), NUM + 1);
+
+    QVERIFY(context->rollbackTransaction(0));
+    QVERIFY(!TSqlAsync::isTransactionBound(0));
+    context->setTransactionEnabled(false);
+
+    auto f2 = TSqlQuery::execAsync("SELECT COUNT(*) FROM item");
+    QCOMPARE(count(f2), NUM);
+}
+
+
+void SqlAsync::queryCacheInvalidate()
+{
+    QVERIFY(TSqlQueryCache::isEnabled());
+    const QString sql = "SELECT * FROM item";
+    const QByteArray key = TSqlQueryCache::cacheKey(0, sql, {"item"});
+    const QByteArray otherKey = TSqlQueryCache::cacheKey(1, sql, {"item"});
+    QVERIFY(key != otherKey);
+    QVERIFY(TSqlQueryCache::set(key, "result", 60));
+    QCOMPARE(TSqlQueryCache::get(key), QByteArray("result"));
+
+    // Committed on a database I/O thread, not an action thread
+    auto f = TSqlAsync::run<bool>(0, []() {
+        TSqlQuery query;
+        bool res = query.exec("INSERT INTO item (name, score) VALUES ('cached', 0)");
+        TSqlQueryCache::tableModified(0, "item");
+        return res;
+    });
+    QVERIFY(f.get());
+
+    // Invalidated after the commit of the task
+    QTRY_VERIFY(TSqlQueryCache::cacheKey(0, sql, {"item"}) != key);
+    QCOMPARE(TSqlQueryCache::get(key), QByteArray("result"));  // never hit again
+    QVERIFY(TSqlQueryCache::get(TSqlQueryCache::cacheKey(0, sql, {"item"})).isEmpty());
+
+    // The table of the same name in another database is not invalidated
+    QCOMPARE(TSqlQueryCache::cacheKey(1, sql, {"item"}), otherKey);
+
+    TSqlQuery query;
+    QVERIFY(query.exec("DELETE FROM item WHERE name = 'cached'"));
+}
+
+
+void SqlAsync::bench_exec()
+{
+    QBENCHMARK {
+        for (int i = 0; i < 10; ++i) {
+            TSqlQuery query;
+            query.exec(QString("SELECT COUNT(*) FROM item WHERE score = %1").arg(i));
+            query.next();
+        }
+    }
+}
+
+
+void SqlAsync::bench_execAsync()
+{
+    QBENCHMARK {
+        std::vector<std::future<QList<QSqlRecord>>> futures;
+        for (int i = 0; i < 10; ++i) {
+            futures.push_back(TSqlQuery::execAsync(QString("SELECT COUNT(*) FROM item WHERE score = %1").arg(i)));
+        }
+        for (auto &f : futures) {
+            f.wait();
+        }
+    }
+}
+
+TF_TEST_SQL_MAIN(SqlAsync, false)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sqlasync
+SOURCES = main.cpp
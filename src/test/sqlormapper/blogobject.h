@@ -0,0 +1,87 @@
+#ifndef BLOGOBJECT_H
+#define BLOGOBJECT_H
+
+#include <TSqlObject>
+#include <QSharedData>
+
+
+class T_MODEL_EXPORT BlogObject : public TSqlObject, public QSharedData
+{
+public:
+    int id;
+    QString title;
+    QString body;
+    QDateTime created_at;
+    QDateTime updated_at;
+    int lock_revision;
+
+    enum PropertyIndex {
+        Id = 0,
+        Title,
+        Body,
+        CreatedAt,
+        UpdatedAt,
+        LockRevision,
+    };
+
+    int primaryKeyIndex() const { return Id; }
+    int autoValueIndex() const { return Id; }
+    QString tableName() const { return QLatin1String("blog"); }
+
+    static TSqlColumnList columnList()
+    {
+        static constexpr TSqlColumn list[] = {
+            {Id, "id", QMetaType::Int, TSql::PrimaryKeyColumn | TSql::AutoValueColumn},
+            {Title, "title", QMetaType::QString, 0},
+            {Body, "body", QMetaType::QString, 0},
+            {CreatedAt, "created_at", QMetaType::QDateTime, TSql::CreatedAtColumn},
+            {UpdatedAt, "updated_at", QMetaType::QDateTime, TSql::UpdatedAtColumn},
+            {LockRevision, "lock_revision", QMetaType::Int, TSql::LockRevisionColumn},
+        };
+        return TSqlColumnList(list);
+    }
+    TSqlColumnList columns() const { return columnList(); }
+
+    QVariant columnValue(int index) const
+    {
+        switch (index) {
+        case Id: return QVariant::fromValue(id);
+        case Title: return QVariant::fromValue(title);
+        case Body: return QVariant::fromValue(body);
+        case CreatedAt: return QVariant::fromValue(created_at);
+        case UpdatedAt: return QVariant::fromValue(updated_at);
+        case LockRevision: return QVariant::fromValue(lock_revision);
+        default: return QVariant();
+        }
+    }
+
+    void setColumnValue(int index, const QVariant &value)
+    {
+        switch (index) {
+        case Id: id = value.value<int>(); break;
+        case Title: title = value.value<QString>(); break;
+        case Body: body = value.value<QString>(); break;
+        case CreatedAt: created_at = value.value<QDateTime>(); break;
+        case UpdatedAt: updated_at = value.value<QDateTime>(); break;
+        case LockRevision: lock_revision = value.value<int>(); break;
+        default: break;
+        }
+    }
+
+private:    /*** Don't modify below this line ***/
+    Q_OBJECT
+    Q_PROPERTY(int id READ getid WRITE setid)
+    T_DEFINE_PROPERTY(int, id)
+    Q_PROPERTY(QString title READ gettitle WRITE settitle)
+    T_DEFINE_PROPERTY(QString, title)
+    Q_PROPERTY(QString body READ getbody WRITE setbody)
+    T_DEFINE_PROPERTY(QString, body)
+    Q_PROPERTY(QDateTime created_at READ getcreated_at WRITE setcreated_at)
+    T_DEFINE_PROPERTY(QDateTime, created_at)
+    Q_PROPERTY(QDateTime updated_at READ getupdated_at WRITE setupdated_at)
+    T_DEFINE_PROPERTY(QDateTime, updated_at)
+    Q_PROPERTY(int lock_revision READ getlock_revision WRITE setlock_revision)
+    T_DEFINE_PROPERTY(int, lock_revision)
+};
+
+#endif // BLOGOBJECT_H
@@ -0,0 +1,596 @@
+#include <TfTest/TfTest>
+#include <TSqlORMapper>
+#include <TSqlQuery>
+#include <TCriteria>
+#include <TfException>
+#include <TModelUtil>
+#include "tsqldriverextension.h"
+#include "tsqlkeysetcursor.h"
+#include "blogobject.h"
+#include "legacyblogobject.h"
+
+const int NUM = 500;
+
+
+class TestSqlORMapper : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void init();
+    void findStream();
+    void findStreamCriteria();
+    void findStreamEmpty();
+    void bulkInsertStatement();
+    void insertAll();
+    void upsertAll();
+    void upsertAllLockRevision();
+    void modelListsGroupedBy();
+    void modelListsGroupedByChunks();
+    void relatedModelLists();
+    void criteriaPropertyName();
+    void criteriaFind();
+    void keysetCursor();
+    void keysetRowValue();
+    void keysetMixedOrder();
+    void keysetBackwardAtStart();
+    void keysetInvalidCursor();
+};
+
+
+static void createBlogs(int num)
+{
+    for (int i = 0; i < num; i++) {
+        BlogObject blog;
+        blog.title = QString("title%1").arg(i);
+        blog.body = QString("body%1").arg(i);
+        QVERIFY(blog.create());
+    }
+}
+
+// Parent model in a one-to-many relation keyed by the title
+class Topic
+{
+public:
+    Topic(const QString &title = QString()) : _title(title) {}
+    QString title() const { return _title; }
+
+private:
+    QString _title;
+};
+
+
+static void createBlogsWithTitles(const QStringList &titles)
+{
+    for (auto &title : titles) {
+        BlogObject blog;
+        blog.title = title;
+        QVERIFY(blog.create());
+    }
+}
+
+
+static QList<int> blogIds(TSqlORMapper<BlogObject> &mapper)
+{
+    QList<int> ids;
+    for (auto &blog : mapper) {
+        ids << blog.id;
+    }
+    return ids;
+}
+
+// Ids sorted by the title and the id as the tie-breaker
+static QList<int> sortedIds(Tf::SortOrder titleOrder, Tf::SortOrder idOrder)
+{
+    TSqlORMapper<BlogObject> mapper;
+    mapper.orderBy(BlogObject::Title, titleOrder).orderBy(BlogObject::Id, idOrder);
+    mapper.find();
+    return blogIds(mapper);
+}
+
+
+void TestSqlORMapper::initTestCase()
+{
+    TSqlQuery query;
+    bool res = query.exec("CREATE TABLE blog (id INTEGER PRIMARY KEY AUTOINCREMENT, title VARCHAR(20), body VARCHAR(200), created_at TIMESTAMP, updated_at TIMESTAMP, lock_revision INTEGER)");
+    QVERIFY(res);
+}
+
+
+void TestSqlORMapper::init()
+{
+    TSqlQuery query;
+    QVERIFY(query.exec("DELETE FROM blog"));
+}
+
+
+void TestSqlORMapper::findStream()
+{
+    createBlogs(NUM);
+
+    TSqlORMapper<BlogObject> mapper;
+    mapper.setSortOrder(BlogObject::Id, Tf::AscendingOrder);
+    auto stream = mapper.findStream();
+    QVERIFY(stream.isActive());
+
+    int cnt = 0;
+    int lastId = 0;
+    for (auto &blog : stream) {
+        QVERIFY(blog.id > lastId);
+        QCOMPARE(blog.title, QString("title%1").arg(cnt));
+        QCOMPARE(blog.body, QString("body%1").arg(cnt));
+        QCOMPARE(blog.lock_revision, 1);
+        lastId = blog.id;
+        cnt++;
+    }
+    QCOMPARE(cnt, NUM);
+    QVERIFY(!stream.lastError().isValid());
+
+    // The rows are not cached in the mapper
+    QCOMPARE(mapper.rowCount(), 0);
+
+    // A stream is iterated only once
+    int again = 0;
+    for (auto &blog : stream) {
+        Q_UNUSED(blog);
+        again++;
+    }
+    QCOMPARE(again, 0);
+}
+
+
+void TestSqlORMapper::findStreamCriteria()
+{
+    createBlogs(NUM);
+
+    TSqlQuery query;
+    QVERIFY(query.exec("SELECT MIN(id) FROM blog") && query.next());
+    int firstId = query.value(0).toInt();
+    QVERIFY(firstId > 0);
+
+    TSqlORMapper<BlogObject> mapper;
+
+    // Same result as find()
+    TCriteria crit(BlogObject::Id, TSql::GreaterThan, firstId + 100);
+    mapper.setLimit(10);
+    mapper.setSortOrder(BlogObject::Id, Tf::DescendingOrder);
+    mapper.find(crit);
+    QList<int> expected;
+    for (auto &blog : mapper) {
+        expected << blog.id;
+    }
+    QCOMPARE(expected.count(), 10);
+
+    TSqlORMapper<BlogObject> mapper2;
+    mapper2.setLimit(10);
+    mapper2.setSortOrder(BlogObject::Id, Tf::DescendingOrder);
+    auto stream = mapper2.findStream(crit);
+    QList<int> actual;
+    while (stream.next()) {
+        actual << stream.value().id;
+    }
+    QCOMPARE(actual, expected);
+    QCOMPARE(actual.first(), firstId + NUM - 1);
+}
+
+
+void TestSqlORMapper::findStreamEmpty()
+{
+    createBlogs(10);
+
+    TSqlORMapper<BlogObject> mapper;
+    auto stream = mapper.findStream(TCriteria(BlogObject::Title, QString("none")));
+    QVERIFY(stream.isActive());
+    QVERIFY(stream.begin() == stream.end());
+    QVERIFY(!stream.next());
+}
+
+
+void TestSqlORMapper::bulkInsertStatement()
+{
+    const QSqlDriver *driver = Tf::currentSqlDatabase(0).driver();
+    QStringList fields = { "id", "title" };
+
+    QString ins = TSqlDriverExtension::bulkInsertStatement("order", fields, 2, driver);
+    QCOMPARE(ins, QString("INSERT INTO \"order\" (\"id\", \"title\") VALUES (?,?),(?,?)"));
+    ins = TSqlDriverExtension::bulkInsertStatement("order", fields, 1, driver, "t0");
+    QCOMPARE(ins, QString("INSERT INTO \"order\" AS t0 (\"id\", \"title\") VALUES (?,?)"));
+    QVERIFY(TSqlDriverExtension::bulkInsertStatement("order", QStringList(), 1, driver).isEmpty());
+}
+
+
+void TestSqlORMapper::insertAll()
+{
+    // Leaves a gap in the ids
+    createBlogs(10);
+    TSqlQuery query;
+    QVERIFY(query.exec("DELETE FROM blog WHERE id % 3 = 0"));
+    TSqlORMapper<BlogObject> mapper;
+    const int remaining = mapper.findCount();
+
+    QList<BlogObject> blogs;
+    for (int i = 0; i < 1200; i++) {
+        BlogObject blog;
+        blog.title = QString("bulk%1").arg(i);
+        blogs << blog;
+    }
+
+    QCOMPARE(mapper.insertAll(blogs), 1200);
+
+    QSet<int> ids;
+    for (auto &blog : blogs) {
+        QVERIFY(blog.id > 0);
+        QCOMPARE(blog.lock_revision, 1);
+        ids << blog.id;
+
+        BlogObject stored = mapper.findByPrimaryKey(blog.id);
+        QCOMPARE(stored.title, blog.title);
+    }
+    QCOMPARE(ids.count(), 1200);
+    QCOMPARE(mapper.findCount(), remaining + 1200);
+}
+
+
+void TestSqlORMapper::upsertAll()
+{
+    createBlogs(3);
+
+    TSqlORMapper<BlogObject> mapper;
+    mapper.setSortOrder(BlogObject::Id, Tf::AscendingOrder);
+    mapper.find();
+    QList<BlogObject> blogs;
+    for (auto &blog : mapper) {
+        blogs << blog;
+    }
+    QCOMPARE(blogs.count(), 3);
+    blogs[0].title = "updated";
+
+    BlogObject blog;
+    blog.title = "new";
+    blogs << blog;
+
+    QCOMPARE(mapper.upsertAll(blogs), 4);
+    QCOMPARE(mapper.findCount(), 4);
+
+    BlogObject updated = mapper.findByPrimaryKey(blogs[0].id);
+    QCOMPARE(updated.title, QString("updated"));
+    QCOMPARE(updated.lock_revision, 2);
+    QCOMPARE(mapper.findCount(TCriteria(BlogObject::Title, QString("new"))), 1);
+}
+
+
+void TestSqlORMapper::upsertAllLockRevision()
+{
+    createBlogs(1);
+
+    TSqlORMapper<BlogObject> mapper;
+    BlogObject stale = mapper.findFirst();
+    BlogObject other = mapper.findFirst();
+    QCOMPARE(stale.lock_revision, 1);
+
+    // Another transaction updates the row
+    other.title = "other";
+    QVERIFY(other.update());
+    QCOMPARE(other.lock_revision, 2);
+
+    QList<BlogObject> blogs;
+    stale.title = "stale";
+    blogs << stale;
+    QVERIFY_EXCEPTION_THROWN(mapper.upsertAll(blogs), SqlException);
+
+    BlogObject stored = mapper.findFirst();
+    QCOMPARE(stored.title, QString("other"));
+    QCOMPARE(stored.lock_revision, 2);
+}
+
+
+void TestSqlORMapper::modelListsGroupedBy()
+{
+    createBlogsWithTitles({"a", "b", "a", "x", "a", "b"});
+
+    QStringList keys = {"a", "b", "c", "a"};
+    auto groups = tfGetModelListsGroupedBy<BlogObject, BlogObject>(BlogObject::Title, keys, BlogObject::Id, Tf::DescendingOrder);
+    QCOMPARE(groups.count(), 3);
+    QCOMPARE(groups["a"].count(), 3);
+    QCOMPARE(groups["b"].count(), 2);
+    QVERIFY(groups.contains("c"));
+    QVERIFY(groups["c"].isEmpty());
+    QVERIFY(!groups.contains("x"));
+
+    // Sorted in each group
+    auto &list = groups["a"];
+    QVERIFY(list[0].id > list[1].id);
+    QVERIFY(list[1].id > list[2].id);
+    for (auto &blog : list) {
+        QCOMPARE(blog.title, QString("a"));
+    }
+
+    // No keys, no query
+    QVERIFY(tfGetModelListsGroupedBy<BlogObject, BlogObject>(BlogObject::Title, QStringList()).isEmpty());
+}
+
+
+void TestSqlORMapper::modelListsGroupedByChunks()
+{
+    // More keys than an IN clause holds, with matches in every chunk
+    const int num = TF_EAGER_LOAD_IN_VALUES_MAX * 2 + 100;
+    QList<BlogObject> blogs;
+    for (int i = 0; i < num; i++) {
+        BlogObject blog;
+        blog.title = QString("t%1").arg(i);
+        blogs << blog;
+    }
+    TSqlORMapper<BlogObject> mapper;
+    QCOMPARE(mapper.insertAll(blogs), num);
+
+    QStringList keys;
+    for (int i = 0; i < num + 500; i++) {
+        keys << QString("t%1").arg(i);
+    }
+
+    auto groups = tfGetModelListsGroupedBy<BlogObject, BlogObject>(BlogObject::Title, keys);
+    QCOMPARE(groups.count(), keys.count());
+    for (int i = 0; i < keys.count(); i++) {
+        const auto &list = groups[keys[i]];
+        if (i < num) {
+            QCOMPARE(list.count(), 1);
+            QCOMPARE(list.first().id, blogs[i].id);
+        } else {
+            QVERIFY(list.isEmpty());
+        }
+    }
+}
+
+
+void TestSqlORMapper::relatedModelLists()
+{
+    createBlogsWithTitles({"a", "b", "a", "b", "b"});
+
+    QList<Topic> topics = {Topic("a"), Topic("b"), Topic("z")};
+    auto groups = tfGetRelatedModelLists<BlogObject, BlogObject>(topics, &Topic::title, BlogObject::Title);
+    QCOMPARE(groups.count(), 3);
+    QCOMPARE(groups["a"].count(), 2);
+    QCOMPARE(groups["b"].count(), 3);
+    QVERIFY(groups["z"].isEmpty());
+
+    // Nested relation from the result of a previous eager loading
+    QHash<int, QList<Topic>> nested;
+    nested.insert(1, {Topic("a")});
+    nested.insert(2, {Topic("b"), Topic("z")});
+    auto groups2 = tfGetRelatedModelLists<BlogObject, BlogObject>(nested, &Topic::title, BlogObject::Title);
+    QCOMPARE(groups2.keys().toSet(), groups.keys().toSet());
+    QCOMPARE(groups2["b"].count(), 3);
+}
+
+
+void TestSqlORMapper::criteriaPropertyName()
+{
+    const QSqlDriver *driver = Tf::currentSqlDatabase(0).driver();
+
+    // Same names by the descriptors and by the meta-object
+    for (int i = BlogObject::Id; i <= BlogObject::LockRevision; i++) {
+        QString name = TCriteriaConverter<BlogObject>::getPropertyName(i, driver, "t0");
+        QVERIFY(!name.isEmpty());
+        QCOMPARE(name, TCriteriaConverter<LegacyBlogObject>::getPropertyName(i, driver, "t0"));
+    }
+    QCOMPARE(TCriteriaConverter<BlogObject>::getPropertyName(BlogObject::CreatedAt, driver, "t0"), QString("t0.\"created_at\""));
+    QCOMPARE(TCriteriaConverter<BlogObject>::getPropertyName(BlogObject::Title, nullptr), QString("title"));
+    QVERIFY(TCriteriaConverter<BlogObject>::getPropertyName(-1, driver).isEmpty());
+    QVERIFY(TCriteriaConverter<BlogObject>::getPropertyName(BlogObject::LockRevision + 1, driver).isEmpty());
+
+    TCriteriaConverter<BlogObject> conv(TCriteria(), Tf::currentSqlDatabase(0));
+    QCOMPARE(conv.variantType(BlogObject::Id), QVariant::Int);
+    QCOMPARE(conv.variantType(BlogObject::Title), QVariant::String);
+    QCOMPARE(conv.variantType(BlogObject::CreatedAt), QVariant::DateTime);
+    QCOMPARE(conv.variantType(BlogObject::LockRevision + 1), QVariant::Invalid);
+
+    TCriteriaConverter<LegacyBlogObject> legacyConv(TCriteria(), Tf::currentSqlDatabase(0));
+    for (int i = BlogObject::Id; i <= BlogObject::LockRevision; i++) {
+        QCOMPARE(conv.variantType(i), legacyConv.variantType(i));
+    }
+}
+
+
+void TestSqlORMapper::criteriaFind()
+{
+    createBlogsWithTitles({"a", "b", "c", "b"});
+
+    TCriteria cri(BlogObject::Title, TSql::In, QVariantList({"b", "c"}));
+    cri.add(BlogObject::LockRevision, 1);
+
+    TSqlORMapper<BlogObject> mapper;
+    mapper.setSortOrder(BlogObject::Title, Tf::DescendingOrder);
+    QCOMPARE(mapper.find(cri), 3);
+    QStringList titles;
+    for (auto &blog : mapper) {
+        titles << blog.title;
+    }
+    QCOMPARE(titles, QStringList({"c", "b", "b"}));
+
+    TSqlORMapper<LegacyBlogObject> legacyMapper;
+    legacyMapper.setSortOrder(LegacyBlogObject::Title, Tf::DescendingOrder);
+    QCOMPARE(legacyMapper.find(cri), 3);
+    QStringList legacyTitles;
+    for (auto &blog : legacyMapper) {
+        legacyTitles << blog.title;
+    }
+    QCOMPARE(legacyTitles, titles);
+
+    // Grouped by the column value read through columnValue()
+    auto groups = tfGetModelListsGroupedBy<BlogObject, BlogObject>(BlogObject::Title, QStringList({"b", "c"}));
+    auto legacyGroups = tfGetModelListsGroupedBy<LegacyBlogObject, LegacyBlogObject>(LegacyBlogObject::Title, QStringList({"b", "c"}));
+    QCOMPARE(groups["b"].count(), 2);
+    QCOMPARE(legacyGroups["b"].count(), 2);
+    QCOMPARE(legacyGroups["c"].count(), 1);
+}
+
+
+void TestSqlORMapper::keysetCursor()
+{
+    const QStringList columns = {"title", "created_at", "id"};
+    QVariantList values = {QString("it's"), QDateTime(QDate(2019, 4, 1), QTime(12, 30), Qt::UTC), 12345LL};
+
+    QByteArray cursor = TSqlKeysetCursor::encode(columns, values, true);
+    QVariantList decoded;
+    bool backward = false;
+    QVERIFY(TSqlKeysetCursor::decode(cursor, columns, decoded, backward));
+    QVERIFY(backward);
+    QCOMPARE(decoded, values);
+
+    // Made for other columns
+    QVERIFY(!TSqlKeysetCursor::decode(cursor, {"title", "id"}, decoded, backward));
+    QVERIFY(decoded.isEmpty());
+    QVERIFY(!backward);
+
+    // Tampered payload and signature
+    QByteArray tampered = cursor;
+    tampered[2] = (tampered[2] == 'A') ? 'B' : 'A';
+    QVERIFY(!TSqlKeysetCursor::decode(tampered, columns, decoded, backward));
+    QVERIFY(!TSqlKeysetCursor::decode(cursor.left(cursor.indexOf('.') + 1), columns, decoded, backward));
+    QVERIFY(!TSqlKeysetCursor::decode(cursor.left(cursor.indexOf('.')), columns, decoded, backward));
+
+    // Unsigned cursor serialized by QDataStream
+    QByteArray buf;
+    QDataStream ds(&buf, QIODevice::WriteOnly);
+    ds << (quint8)1 << false << columns << values;
+    QVERIFY(!TSqlKeysetCursor::decode(buf.toBase64(QByteArray::Base64UrlEncoding), columns, decoded, backward));
+
+    // Too long
+    QVERIFY(!TSqlKeysetCursor::decode(QByteArray(5000, 'A') + "." + cursor.mid(cursor.indexOf('.') + 1), columns, decoded, backward));
+}
+
+
+void TestSqlORMapper::keysetRowValue()
+{
+    createBlogsWithTitles({"c", "a", "b", "a", "d", "b", "c", "a", "e", "b"});
+    const QList<int> expected = sortedIds(Tf::AscendingOrder, Tf::AscendingOrder);
+    QCOMPARE(expected.count(), 10);
+
+    // First page
+    TSqlORMapper<BlogObject> mapper;
+    mapper.orderBy(BlogObject::Title).limit(4).seek(QByteArray());
+    QCOMPARE(mapper.find(), 4);
+    QCOMPARE(blogIds(mapper), expected.mid(0, 4));
+    QVERIFY(mapper.previousCursor().isEmpty());
+    QByteArray next = mapper.nextCursor();
+    QVERIFY(!next.isEmpty());
+
+    // Second page by the row value comparison
+    TSqlORMapper<BlogObject> mapper2;
+    mapper2.orderBy(BlogObject::Title).limit(4).seek(next);
+    QCOMPARE(mapper2.find(), 4);
+    QCOMPARE(blogIds(mapper2), expected.mid(4, 4));
+    QVERIFY(mapper2.query().lastQuery().contains(")>("));
+    QVERIFY(!mapper2.query().lastQuery().contains(" OR "));
+
+    // Last page
+    TSqlORMapper<BlogObject> mapper3;
+    mapper3.orderBy(BlogObject::Title).limit(4).seek(mapper2.nextCursor());
+    QCOMPARE(mapper3.find(), 2);
+    QCOMPARE(blogIds(mapper3), expected.mid(8, 2));
+    QVERIFY(mapper3.nextCursor().isEmpty());
+    QByteArray prev = mapper3.previousCursor();
+    QVERIFY(!prev.isEmpty());
+
+    // Back to the second page by the subquery in reverse order
+    TSqlORMapper<BlogObject> mapper4;
+    mapper4.orderBy(BlogObject::Title).limit(4).seek(prev);
+    QCOMPARE(mapper4.find(), 4);
+    QCOMPARE(blogIds(mapper4), expected.mid(4, 4));
+    QVERIFY(mapper4.query().lastQuery().startsWith("SELECT * FROM ("));
+    QVERIFY(mapper4.query().lastQuery().contains(")<("));
+    QVERIFY(!mapper4.nextCursor().isEmpty());
+    QVERIFY(!mapper4.previousCursor().isEmpty());
+
+    // Forward again from the backward page
+    TSqlORMapper<BlogObject> mapper5;
+    mapper5.orderBy(BlogObject::Title).limit(4).seek(mapper4.nextCursor());
+    QCOMPARE(mapper5.find(), 2);
+    QCOMPARE(blogIds(mapper5), expected.mid(8, 2));
+}
+
+
+void TestSqlORMapper::keysetMixedOrder()
+{
+    createBlogsWithTitles({"c", "a", "b", "a", "d", "b", "c", "a", "e", "b"});
+    const QList<int> expected = sortedIds(Tf::DescendingOrder, Tf::AscendingOrder);
+
+    TSqlORMapper<BlogObject> mapper;
+    mapper.orderBy(BlogObject::Title, Tf::DescendingOrder).orderBy(BlogObject::Id, Tf::AscendingOrder).limit(3).seek(QByteArray());
+    QCOMPARE(mapper.find(), 3);
+    QCOMPARE(blogIds(mapper), expected.mid(0, 3));
+
+    // Expanded into OR terms for the different directions
+    TSqlORMapper<BlogObject> mapper2;
+    mapper2.orderBy(BlogObject::Title, Tf::DescendingOrder).orderBy(BlogObject::Id, Tf::AscendingOrder).limit(3).seek(mapper.nextCursor());
+    QCOMPARE(mapper2.find(), 3);
+    QCOMPARE(blogIds(mapper2), expected.mid(3, 3));
+    QVERIFY(mapper2.query().lastQuery().contains(" OR "));
+
+    TSqlORMapper<BlogObject> mapper3;
+    mapper3.orderBy(BlogObject::Title, Tf::DescendingOrder).orderBy(BlogObject::Id, Tf::AscendingOrder).limit(3).seek(mapper2.previousCursor());
+    QCOMPARE(mapper3.find(), 3);
+    QCOMPARE(blogIds(mapper3), expected.mid(0, 3));
+    QVERIFY(mapper3.query().lastQuery().contains(" OR "));
+    QVERIFY(!mapper3.nextCursor().isEmpty());
+}
+
+
+void TestSqlORMapper::keysetBackwardAtStart()
+{
+    createBlogsWithTitles({"c", "a", "b", "a", "d", "b", "c", "a", "e", "b"});
+    const QList<int> expected = sortedIds(Tf::AscendingOrder, Tf::AscendingOrder);
+
+    // Second page of 2 rows
+    TSqlORMapper<BlogObject> mapper;
+    mapper.orderBy(BlogObject::Title).limit(2).seek(QByteArray());
+    mapper.find();
+    TSqlORMapper<BlogObject> mapper2;
+    mapper2.orderBy(BlogObject::Title).limit(2).seek(mapper.nextCursor());
+    QCOMPARE(mapper2.find(), 2);
+    QCOMPARE(blogIds(mapper2), expected.mid(2, 2));
+
+    // Backward by 4 rows reaches the start with a short page
+    TSqlORMapper<BlogObject> mapper3;
+    mapper3.orderBy(BlogObject::Title).limit(4).seek(mapper2.previousCursor());
+    QCOMPARE(mapper3.find(), 2);
+    QCOMPARE(blogIds(mapper3), expected.mid(0, 2));
+    QVERIFY(mapper3.previousCursor().isEmpty());  // first page
+
+    QByteArray next = mapper3.nextCursor();
+    QVERIFY(!next.isEmpty());
+    TSqlORMapper<BlogObject> mapper4;
+    mapper4.orderBy(BlogObject::Title).limit(4).seek(next);
+    QCOMPARE(mapper4.find(), 4);
+    QCOMPARE(blogIds(mapper4), expected.mid(2, 4));
+}
+
+
+void TestSqlORMapper::keysetInvalidCursor()
+{
+    createBlogsWithTitles({"c", "a", "b", "a", "d"});
+    const QList<int> expected = sortedIds(Tf::AscendingOrder, Tf::AscendingOrder);
+
+    TSqlORMapper<BlogObject> mapper;
+    mapper.orderBy(BlogObject::Title).limit(2).seek(QByteArray());
+    mapper.find();
+    QByteArray next = mapper.nextCursor();
+
+    // Tampered cursor is ignored, then the first page is retrieved
+    QByteArray tampered = next;
+    tampered[3] = (tampered[3] == 'A') ? 'B' : 'A';
+    TSqlORMapper<BlogObject> mapper2;
+    mapper2.orderBy(BlogObject::Title).limit(2).seek(tampered);
+    QCOMPARE(mapper2.find(), 2);
+    QCOMPARE(blogIds(mapper2), expected.mid(0, 2));
+    QVERIFY(mapper2.previousCursor().isEmpty());
+
+    // Cursor for another sort order
+    TSqlORMapper<BlogObject> mapper3;
+    mapper3.orderBy(BlogObject::Body).limit(2).seek(next);
+    QCOMPARE(mapper3.find(), 2);
+    QVERIFY(!mapper3.query().lastQuery().contains("WHERE"));
+}
+
+TF_TEST_MAIN(TestSqlORMapper)
+#include "main.moc"
@@ -0,0 +1,4 @@
+include(../test.pri)
+TARGET = sqlormapper
+HEADERS = blogobject.h legacyblogobject.h
+SOURCES = main.cpp
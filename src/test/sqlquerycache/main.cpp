@@ -0,0 +1,85 @@
+#include <QTest>
+#include <QtSql>
+#include "tsqlquerycache.h"
+
+
+class SqlQueryCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void serialize_data();
+    void serialize();
+    void serializeEmpty();
+    void deserializeBroken();
+};
+
+
+static QSqlRecord makeRecord(int id, const QString &title, const QDateTime &createdAt)
+{
+    QSqlRecord rec;
+    rec.append(QSqlField("id", QVariant::Int));
+    rec.append(QSqlField("title", QVariant::String));
+    rec.append(QSqlField("created_at", QVariant::DateTime));
+    rec.setValue(0, id);
+    rec.setValue(1, title);
+    rec.setValue(2, createdAt);
+    return rec;
+}
+
+
+void SqlQueryCache::serialize_data()
+{
+    QTest::addColumn<int>("rows");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("3") << 100;
+    QTest::newRow("4") << 5000;
+}
+
+
+void SqlQueryCache::serialize()
+{
+    QFETCH(int, rows);
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QList<QSqlRecord> records;
+    for (int i = 0; i < rows; ++i) {
+        records << makeRecord(i, QString("title %1").arg(i), now.addSecs(i));
+    }
+    records[0].setNull(1);
+
+    auto res = TSqlQueryCache::deserialize(TSqlQueryCache::serialize(records));
+    QCOMPARE(res.count(), rows);
+    for (int i = 0; i < rows; ++i) {
+        QCOMPARE(res[i].count(), 3);
+        QCOMPARE(res[i].fieldName(1), QString("title"));
+        QCOMPARE(res[i].value("id").toInt(), i);
+        QCOMPARE(res[i].value("title"), records[i].value("title"));
+        QCOMPARE(res[i].value("created_at").toDateTime(), now.addSecs(i));
+    }
+    QVERIFY(res[0].isNull("title"));
+}
+
+
+void SqlQueryCache::serializeEmpty()
+{
+    QByteArray data = TSqlQueryCache::serialize(QList<QSqlRecord>());
+    QVERIFY(!data.isEmpty());  // distinguishable from a cache miss
+    QVERIFY(TSqlQueryCache::deserialize(data).isEmpty());
+}
+
+
+void SqlQueryCache::deserializeBroken()
+{
+    QList<QSqlRecord> records;
+    records << makeRecord(1, "a", QDateTime::currentDateTime());
+    records << makeRecord(2, "b", QDateTime::currentDateTime());
+
+    QByteArray data = TSqlQueryCache::serialize(records);
+    data.chop(data.length() / 3);
+    QVERIFY(TSqlQueryCache::deserialize(data).isEmpty());
+}
+
+QTEST_APPLESS_MAIN(SqlQueryCache)
+#include "main.moc"
@@ -0,0 +1,141 @@
+#include <TfTest/TfTest>
+#include <TSqlQuery>
+#include "tdatabasecontext.h"
+#include "tsqldatabasepool.h"
+
+const int BROKEN_DB = 1;
+
+
+class TestSqlReplica : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void readFromReplica();
+    void roundRobin();
+    void readOnPrimary();
+    void stickyAfterWrite();
+    void stickyInTransaction();
+    void replicaBackoff();
+};
+
+
+static bool isReplica(const QSqlDatabase &db)
+{
+    return TSqlDatabasePool::getReplicaIndex(db) >= 0;
+}
+
+
+void TestSqlReplica::init()
+{
+    // Starts each test with a fresh context
+    Tf::currentDatabaseContext()->release();
+}
+
+
+void TestSqlReplica::readFromReplica()
+{
+    auto *ctx = Tf::currentDatabaseContext();
+    QCOMPARE(TSqlDatabasePool::instance()->replicaCount(0), 2);
+
+    QString name = ctx->getReadSqlDatabase(0).connectionName();
+    QVERIFY(isReplica(ctx->getReadSqlDatabase(0)));
+    QCOMPARE(TSqlDatabasePool::getDatabaseId(ctx->getReadSqlDatabase(0)), 0);
+
+    // Same connection within the context
+    QCOMPARE(ctx->getReadSqlDatabase(0).connectionName(), name);
+}
+
+
+void TestSqlReplica::roundRobin()
+{
+    auto *ctx = Tf::currentDatabaseContext();
+    int first = TSqlDatabasePool::getReplicaIndex(ctx->getReadSqlDatabase(0));
+    ctx->release();
+    int second = TSqlDatabasePool::getReplicaIndex(ctx->getReadSqlDatabase(0));
+
+    QVERIFY(first >= 0);
+    QVERIFY(second >= 0);
+    QVERIFY(first != second);
+}
+
+
+void TestSqlReplica::readOnPrimary()
+{
+    auto *ctx = Tf::currentDatabaseContext();
+    ctx->setTransactionEnabled(false);
+
+    // A read on the primary does not pin the following reads
+    TSqlQuery query;
+    QVERIFY(query.exec("SELECT 1"));
+    QVERIFY(!ctx->isTransactionActive(0));
+    QVERIFY(isReplica(ctx->getReadSqlDatabase(0)));
+}
+
+
+void TestSqlReplica::stickyAfterWrite()
+{
+    auto *ctx = Tf::currentDatabaseContext();
+    ctx->setTransactionEnabled(false);
+    QVERIFY(isReplica(ctx->getReadSqlDatabase(0)));
+
+    TSqlQuery query;
+    QVERIFY(query.exec("CREATE TEMP TABLE replica_test (a INTEGER)"));
+    QVERIFY(!isReplica(ctx->getReadSqlDatabase(0)));
+
+    // Reset by the release of the context
+    ctx->release();
+    ctx->setTransactionEnabled(false);
+    QVERIFY(isReplica(ctx->getReadSqlDatabase(0)));
+}
+
+
+void TestSqlReplica::stickyInTransaction()
+{
+    auto *ctx = Tf::currentDatabaseContext();
+    ctx->setTransactionEnabled(true);
+
+    TSqlQuery query;
+    QVERIFY(query.exec("SELECT 1"));
+    QVERIFY(ctx->isTransactionActive(0));
+    QVERIFY(!isReplica(ctx->getReadSqlDatabase(0)));
+}
+
+
+void TestSqlReplica::replicaBackoff()
+{
+    auto *pool = TSqlDatabasePool::instance();
+    QCOMPARE(pool->replicaCount(BROKEN_DB), 1);
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)0);
+
+    QSqlDatabase db = pool->replicaDatabase(BROKEN_DB);
+    QVERIFY(!db.isValid());
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)1);
+
+    // Skipped while backing off
+    db = pool->replicaDatabase(BROKEN_DB);
+    QVERIFY(!db.isValid());
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)1);
+
+    // Retried after the first backoff of 100 msecs, which then doubles
+    QThread::msleep(150);
+    db = pool->replicaDatabase(BROKEN_DB);
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)2);
+    QThread::msleep(100);
+    db = pool->replicaDatabase(BROKEN_DB);
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)2);
+    QThread::msleep(150);
+    db = pool->replicaDatabase(BROKEN_DB);
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)3);
+
+    // Bounded by ReplicaMaxBackoff of 400 msecs
+    QThread::msleep(450);
+    db = pool->replicaDatabase(BROKEN_DB);
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)4);
+    QThread::msleep(450);
+    db = pool->replicaDatabase(BROKEN_DB);
+    QCOMPARE(pool->replicaErrorCount(BROKEN_DB), (quint64)5);
+}
+
+TF_TEST_MAIN(TestSqlReplica)
+#include "main.moc"
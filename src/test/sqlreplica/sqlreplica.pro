@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sqlreplica
+SOURCES = main.cpp
@@ -0,0 +1,118 @@
+#include <QTest>
+#include <QList>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "tsystembusring.h"
+
+
+class SystemBusRing : public QObject
+{
+    Q_OBJECT
+private slots:
+    void writeRead();
+    void ownFrames();
+    void largeFrame();
+    void overrun();
+
+private:
+    static QString key();
+    static void writeInChild(const QList<QByteArray> &frames);
+};
+
+
+QString SystemBusRing::key()
+{
+    return QString("treefrog_test_ring_%1_%2").arg(::getpid()).arg(QTest::currentTestFunction());
+}
+
+// The ring skips the frames of its own process; writes in another one
+void SystemBusRing::writeInChild(const QList<QByteArray> &frames)
+{
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        int res = 0;
+        {
+            TSystemBusRing ring(key(), 0);
+            for (auto &frame : frames) {
+                if (!ring.write(frame)) {
+                    res = 1;
+                }
+            }
+        }
+        ::_exit(res);
+    }
+
+    int status = -1;
+    ::waitpid(pid, &status, 0);
+    QVERIFY(WIFEXITED(status));
+    QCOMPARE(WEXITSTATUS(status), 0);
+}
+
+
+void SystemBusRing::writeRead()
+{
+    TSystemBusRing ring(key(), 0);
+    QVERIFY(ring.isAttached());
+    QVERIFY(ring.readAll().isEmpty());
+
+    QList<QByteArray> frames {"a", "hello", QByteArray(1000, 'x'), QByteArray(7, '\0')};
+    writeInChild(frames);
+
+    QByteArray expected;
+    for (auto &frame : frames) {
+        expected += frame;
+    }
+    QCOMPARE(ring.readAll(), expected);
+    QVERIFY(ring.readAll().isEmpty());
+
+    // Wraps around the end of the buffer
+    QList<QByteArray> large;
+    for (int i = 0; i < 20; ++i) {
+        large << QByteArray(3000 + i, 'a' + i);
+    }
+    for (int i = 0; i < 3; ++i) {
+        writeInChild(large);
+        QCOMPARE(ring.readAll(), large.join());
+    }
+}
+
+
+void SystemBusRing::ownFrames()
+{
+    TSystemBusRing ring(key(), 0);
+    QVERIFY(ring.isAttached());
+    QVERIFY(ring.write("own"));
+    QVERIFY(ring.readAll().isEmpty());
+}
+
+
+void SystemBusRing::largeFrame()
+{
+    TSystemBusRing ring(key(), 0);
+    QVERIFY(ring.isAttached());
+    QVERIFY(!ring.write(QByteArray()));
+    QVERIFY(!ring.write(QByteArray(64 * 1024, 'x')));  // falls back on the socket
+    QVERIFY(ring.write(QByteArray(16 * 1024, 'x')));
+}
+
+
+void SystemBusRing::overrun()
+{
+    TSystemBusRing ring(key(), 0);
+    QVERIFY(ring.isAttached());
+
+    // More than the capacity of 64KB before being read
+    QList<QByteArray> frames;
+    for (int i = 0; i < 10; ++i) {
+        frames << QByteArray(10000, 'x');
+    }
+    writeInChild(frames);
+    QVERIFY(ring.readAll().isEmpty());  // lost
+
+    writeInChild({"next"});
+    QCOMPARE(ring.readAll(), QByteArray("next"));
+}
+
+QTEST_APPLESS_MAIN(SystemBusRing)
+#include "main.moc"
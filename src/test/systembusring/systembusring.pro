@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = systembusring
+SOURCES = main.cpp
@@ -4,7 +4,10 @@ SUBDIRS  = htmlescape httpheader hmac htmlparser
 SUBDIRS += mailmessage multipartformdata  smtpmailer viewhelper paginator
 SUBDIRS += fieldnametovariablename rand urlrouter urlrouter2
 SUBDIRS += sharedmemorylogstream buildtest stack queue forlist
-SUBDIRS += jscontext compression sqlitedb url
+SUBDIRS += jscontext compression sqlitedb url redisdriver sqlquerycache
+SUBDIRS += sqlasync queryprofiler mongobulkwrite viewbuffer jsonwriter sessionid sessioncookie session
+SUBDIRS += redis sqlormapper sqlreplica gcscheduler sessionfilestore
+linux:SUBDIRS += systembusring
 
 fwtests.target = test
 fwtests.commands = make check
@@ -0,0 +1,223 @@
+#include <QTest>
+#include <QDir>
+#include <QTextCodec>
+#include <THttpUtility>
+#include "tviewbuffer.h"
+
+
+class ViewBuffer : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void append_data();
+    void append();
+    void appendHtmlEscaped_data();
+    void appendHtmlEscaped();
+    void appendValue();
+    void compatibility();
+    void appendChar();
+    void benchRenderString();
+    void benchRenderBuffer();
+
+private:
+    QList<QString> templates;
+};
+
+
+// The templates of the tmake tests, rendered as the static text of views
+static const QString TemplateDir("../../../tools/tmake/test");
+
+
+void ViewBuffer::initTestCase()
+{
+    for (auto &name : QDir(TemplateDir).entryList({"*.html", "*.phtm"}, QDir::Files, QDir::Name)) {
+        QFile file(QDir(TemplateDir).filePath(name));
+        if (file.open(QIODevice::ReadOnly)) {
+            templates << QString::fromUtf8(file.readAll());
+        }
+    }
+}
+
+
+void ViewBuffer::append_data()
+{
+    QTest::addColumn<QString>("string");
+
+    QTest::newRow("1") << QString();
+    QTest::newRow("2") << QString("<body>Hello world</body>\n");
+    QTest::newRow("3") << QString(u8"こんにちは、世界");
+    QTest::newRow("4") << QString(u8"<p>Hello, 世界!</p>");
+    QTest::newRow("5") << QString(u8"emoji \U0001F600 and text");
+}
+
+
+void ViewBuffer::append()
+{
+    QFETCH(QString, string);
+
+    TViewBuffer buf;
+    buf += "<div>";
+    buf += string;
+    buf += QByteArray("</div>");
+    QCOMPARE(buf.toUtf8(), "<div>" + string.toUtf8() + "</div>");
+    QCOMPARE((QString)buf, "<div>" + string + "</div>");
+
+    TViewBuffer layout;
+    layout += QStringLiteral("<html>");
+    layout += buf;
+    QCOMPARE(layout.toString(), "<html><div>" + string + "</div>");
+}
+
+
+void ViewBuffer::appendHtmlEscaped_data()
+{
+    QTest::addColumn<QString>("string");
+    QTest::addColumn<int>("flag");
+
+    QTest::newRow("1") << QString() << (int)Tf::Quotes;
+    QTest::newRow("2") << QString(u8"こんにちは") << (int)Tf::Quotes;
+    QTest::newRow("3") << QString("<a href=\"hoge\">a & b</a>") << (int)Tf::Compatible;
+    QTest::newRow("4") << QString("A 'quote' is <b>bold</b>") << (int)Tf::Quotes;
+    QTest::newRow("5") << QString(u8"'日本語' & \"<英語>\"") << (int)Tf::NoQuotes;
+    QTest::newRow("6") << QString(u8"&\U0001F600<") << (int)Tf::Quotes;
+}
+
+
+void ViewBuffer::appendHtmlEscaped()
+{
+    QFETCH(QString, string);
+    QFETCH(int, flag);
+
+    QByteArray expected = THttpUtility::htmlEscape(string, (Tf::EscapeFlag)flag).toUtf8();
+    TViewBuffer buf;
+    buf.appendHtmlEscaped(string, (Tf::EscapeFlag)flag);
+    QCOMPARE(buf.toUtf8(), expected);
+
+    TViewBuffer buf2;
+    buf2.appendHtmlEscaped(string.toUtf8(), (Tf::EscapeFlag)flag);
+    QCOMPARE(buf2.toUtf8(), expected);
+}
+
+
+void ViewBuffer::appendValue()
+{
+    // Same as QVariant(value).toString()
+    TViewBuffer buf;
+    buf += 123;
+    buf += true;
+    buf += QLatin1String(" ");
+    buf += QVariant(1.5);
+    QCOMPARE(buf.toString(), QString("123true 1.5"));
+}
+
+void ViewBuffer::compatibility()
+{
+    // Same results as QString for the views written to a QString buffer
+    const QString str = QString::fromUtf8(u8"<p>caf\u00e9 \U0001F600</p>");
+    TViewBuffer buf;
+    buf = str;
+    QString expected = str;
+    QCOMPARE(buf.length(), expected.length());
+    QVERIFY(buf.contains(QString::fromUtf8(u8"caf\u00e9")));
+    QVERIFY(buf.startsWith("<p>"));
+    QVERIFY(buf.endsWith("</p>"));
+    QCOMPARE(buf.mid(3, 4), expected.mid(3, 4));
+
+    buf.chop(4);
+    expected.chop(4);
+    QCOMPARE(buf.toString(), expected);
+    buf.chop(2);  // surrogate pair
+    expected.chop(2);
+    QCOMPARE(buf.toString(), expected);
+
+    buf.prepend("<div>").replace(QString::fromUtf8(u8"\u00e9"), "e");
+    expected.prepend("<div>").replace(QString::fromUtf8(u8"\u00e9"), "e");
+    QCOMPARE(buf.toString(), expected);
+    QCOMPARE(buf.length(), expected.length());
+
+    buf.chop(100);
+    QVERIFY(buf.isEmpty());
+}
+
+
+void ViewBuffer::appendChar()
+{
+    // Same as QString::operator+=()
+    const QString latin1 = QString::fromUtf8(u8"caf\u00e9");
+    TViewBuffer buf;
+    QString expected;
+
+    buf += 'c';
+    expected += 'c';
+    buf += QChar(0x00e9);
+    expected += QChar(0x00e9);
+    buf += '\xe9';
+    expected += QChar::fromLatin1('\xe9');
+    buf += QLatin1String(latin1.toLatin1());
+    expected += QLatin1String(latin1.toLatin1());
+    buf += latin1.midRef(1, 2);
+    expected += latin1.midRef(1, 2);
+    QCOMPARE(buf.toString(), expected);
+    QCOMPARE(buf.toString(), QString::fromUtf8(u8"c\u00e9\u00e9caf\u00e9af"));
+}
+
+// Renders each template as a page with a layout, in the way of the views
+// generated before: QString output transcoded to the HTTP output encoding
+void ViewBuffer::benchRenderString()
+{
+    QVERIFY(!templates.isEmpty());
+    QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+    const QString value(u8"<b>Hello</b> 世界");
+    qint64 total = 0;
+
+    QBENCHMARK {
+        for (auto &tmpl : templates) {
+            QString body;
+            for (int i = 0; i < 10; ++i) {
+                body += tmpl;
+                body += THttpUtility::htmlEscape(value);
+            }
+
+            QString layout;
+            layout += QStringLiteral("<html><head><title>bench</title></head><body>");
+            layout += body;
+            layout += QStringLiteral("</body></html>");
+            total += codec->fromUnicode(layout).length();
+        }
+    }
+    QVERIFY(total > 0);
+}
+
+// Renders the same into a buffer of UTF-8 bytes with the static text
+// pre-encoded, and the content spliced into the layout
+void ViewBuffer::benchRenderBuffer()
+{
+    QVERIFY(!templates.isEmpty());
+    QList<QByteArray> literals;
+    for (auto &tmpl : templates) {
+        literals << tmpl.toUtf8();
+    }
+    const QString value(u8"<b>Hello</b> 世界");
+    qint64 total = 0;
+
+    QBENCHMARK {
+        for (auto &literal : literals) {
+            TViewBuffer body;
+            for (int i = 0; i < 10; ++i) {
+                body += literal;
+                body.appendHtmlEscaped(value);
+            }
+
+            TViewBuffer layout;
+            layout += QByteArrayLiteral("<html><head><title>bench</title></head><body>");
+            layout += body;
+            layout += QByteArrayLiteral("</body></html>");
+            total += layout.toUtf8().length();
+        }
+    }
+    QVERIFY(total > 0);
+}
+
+QTEST_APPLESS_MAIN(ViewBuffer)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = viewbuffer
+SOURCES = main.cpp
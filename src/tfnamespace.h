@@ -202,6 +202,20 @@ namespace Tf
         CacheEnableCompression,
         //
         SessionCookieSameSite,
+        //
+        SystemBusRingBufferSize,
+        WebSocketRedisBridge,
+        KvsPoolHealthCheckIdleTime,
+        KvsPoolReconnectMaxBackoff,
+        CacheEnableQueryCache,
+        SqlAsyncThreadCount,
+        SqlQuerySlowLogFile,
+        SqlQuerySlowLogThreshold,
+        SqlQuerySlowLogExplain,
+        SessionRefreshInterval,
+        SessionGcInterval,
+        CacheGcInterval,
+        SessionCookieMacAlgorithm,
     };
 
     // Reason codes why a web socket has been closed
@@ -281,6 +295,15 @@ namespace TSql
         LeftJoin,
         RightJoin,
     };
+
+    // Roles of a column of TSqlObject
+    enum ColumnRole {
+        PrimaryKeyColumn   = 0x01,
+        AutoValueColumn    = 0x02,
+        CreatedAtColumn    = 0x04,  // created_at
+        UpdatedAtColumn    = 0x08,  // updated_at or modified_at
+        LockRevisionColumn = 0x10,  // lock_revision
+    };
 }
 
 /*!
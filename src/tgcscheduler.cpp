@@ -0,0 +1,190 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tgcscheduler.h"
+#include "tsessionmanager.h"
+#include "tcachefactory.h"
+#include "tcachestore.h"
+#include "tsystemglobal.h"
+#include <TWebApplication>
+#include <TAppSettings>
+#include <TRedis>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHostInfo>
+
+// Number of sessions or cache values removed in a transaction
+constexpr int GC_BATCH_SIZE = 1000;
+// Time budget in msecs for a GC run
+constexpr qint64 GC_TIME_BUDGET = 1000;
+
+namespace {
+    TGcScheduler *schedulers[] = {nullptr, nullptr};
+
+    const QByteArray leaseKeys[] = {"_tf_gc_lease_session", "_tf_gc_lease_cache"};
+}
+
+/*!
+  \class TGcScheduler
+  \brief The TGcScheduler class collects the garbage of sessions and
+  cache in the background, instead of on the request threads.
+
+  Runs in the application server of ID 0 of each host. If Redis is
+  available, a lease in Redis lets only one host in the cluster collect
+  at a time; without Redis, each host collects on its own schedule.
+  Expired sessions and cache values are removed in batches, committing
+  each, until none remains or the time budget runs out; the rest is left
+  to the next run.
+*/
+
+TGcScheduler::TGcScheduler(Target target) :
+    TApplicationScheduler(),
+    _target(target)
+{ }
+
+/*!
+  Returns the interval in seconds of the GC for the \a target, or 0 if
+  the GC runs on the request threads by probability.
+*/
+int TGcScheduler::interval(Target target)
+{
+    static const int intervals[] = {
+        Tf::appSettings()->value(Tf::SessionGcInterval, 0).toInt(),
+        Tf::appSettings()->value(Tf::CacheGcInterval, 0).toInt(),
+    };
+    return qMax(intervals[target], 0);
+}
+
+/*!
+  Starts the schedulers of which interval is specified.
+*/
+void TGcScheduler::startAll()
+{
+    if (interval(Session) > 0) {
+        if (!schedulers[Session]) {
+            schedulers[Session] = new TGcScheduler(Session);
+        }
+        schedulers[Session]->start(interval(Session) * 1000);
+    }
+
+    if (interval(Cache) > 0 && Tf::app()->cacheEnabled()) {
+        if (!schedulers[Cache]) {
+            schedulers[Cache] = new TGcScheduler(Cache);
+        }
+        schedulers[Cache]->start(interval(Cache) * 1000);
+    }
+}
+
+/*!
+  Stops the schedulers.
+*/
+void TGcScheduler::stopAll()
+{
+    for (auto *scheduler : schedulers) {
+        if (scheduler) {
+            scheduler->stop();
+        }
+    }
+}
+
+
+void TGcScheduler::job()
+{
+    if (!acquireLease()) {
+        tSystemDebug("GC lease held by another process: %s", leaseKeys[_target].data());
+        return;
+    }
+
+    switch (_target) {
+    case Session:
+        collectSessions();
+        break;
+
+    case Cache:
+        collectCache();
+        break;
+
+    default:
+        tSystemError("Invalid logic  [%s:%d]",  __FILE__, __LINE__);
+        break;
+    }
+}
+
+/*!
+  Acquires the lease for the GC in Redis, which expires after the
+  interval. Returns true if acquired or already held by this process, or
+  if Redis is not available.
+*/
+bool TGcScheduler::acquireLease()
+{
+    if (!Tf::app()->isKvsAvailable(Tf::KvsEngine::Redis)) {
+        return true;
+    }
+
+    static const QByteArray owner = QHostInfo::localHostName().toUtf8() + ':' + QByteArray::number(QCoreApplication::applicationPid());
+    const QByteArrayList setCommand = { "SET", leaseKeys[_target], owner, "NX", "EX", QByteArray::number(qMax(interval(_target) - 1, 1)) };
+    const QByteArrayList getCommand = { "GET", leaseKeys[_target] };
+    QList<QVariantList> responses;
+
+    // Reads the holder back in the same round trip, as the status reply
+    // of SET is not returned; acquired if this process holds the lease
+    TRedis redis;
+    if (!redis.request({ setCommand, getCommand }, responses) || responses.count() != 2) {
+        tSystemWarn("Failed to acquire the GC lease: %s", leaseKeys[_target].data());
+        return false;
+    }
+    return responses[1].value(0).toByteArray() == owner;
+}
+
+
+void TGcScheduler::collectSessions()
+{
+    static const int gclifetime = Tf::appSettings()->value(Tf::SessionGcMaxLifeTime).toInt();
+    const QDateTime expire = QDateTime::currentDateTime().addSecs(-gclifetime);
+    QElapsedTimer timer;
+    timer.start();
+    int total = 0;
+
+    for (;;) {
+        int cnt = TSessionManager::instance().removeExpiredSessions(expire, GC_BATCH_SIZE);
+        commitTransactions();
+        total += qMax(cnt, 0);
+
+        if (cnt < GC_BATCH_SIZE || timer.hasExpired(GC_TIME_BUDGET)) {
+            break;
+        }
+    }
+    tSystemDebug("Session GC removed %d sessions in %lld msecs", total, timer.elapsed());
+}
+
+
+void TGcScheduler::collectCache()
+{
+    TCacheStore *store = TCacheFactory::create(Tf::app()->cacheBackend());
+    if (!store) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    int total = 0;
+
+    if (store->open()) {
+        for (;;) {
+            int cnt = store->gcBatch(GC_BATCH_SIZE);
+            commitTransactions();
+            total += qMax(cnt, 0);
+
+            if (cnt < GC_BATCH_SIZE || timer.hasExpired(GC_TIME_BUDGET)) {
+                break;
+            }
+        }
+        store->close();
+    }
+    TCacheFactory::destroy(Tf::app()->cacheBackend(), store);
+    tSystemDebug("Cache GC removed %d values in %lld msecs", total, timer.elapsed());
+}
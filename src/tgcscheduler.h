@@ -0,0 +1,36 @@
+#ifndef TGCSCHEDULER_H
+#define TGCSCHEDULER_H
+
+#include <TApplicationScheduler>
+
+
+class T_CORE_EXPORT TGcScheduler : public TApplicationScheduler
+{
+    Q_OBJECT
+public:
+    enum Target {
+        Session = 0,
+        Cache,
+    };
+
+    TGcScheduler(Target target);
+    virtual ~TGcScheduler() { }
+
+    static int interval(Target target);
+    static void startAll();
+    static void stopAll();
+
+protected:
+    void job() override;
+    bool acquireLease();
+    void collectSessions();
+    void collectCache();
+
+private:
+    Target _target {Session};
+
+    T_DISABLE_COPY(TGcScheduler)
+    T_DISABLE_MOVE(TGcScheduler)
+};
+
+#endif // TGCSCHEDULER_H
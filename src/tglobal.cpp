@@ -205,6 +205,16 @@ QSqlDatabase &Tf::currentSqlDatabase(int id) noexcept
     return currentDatabaseContext()->getSqlDatabase(id);
 }
 
+/*!
+  Returns the database connection for read-only queries, which may be
+  a connection to a read replica.
+  \sa TDatabaseContext::getReadSqlDatabase()
+*/
+QSqlDatabase &Tf::currentReadSqlDatabase(int id) noexcept
+{
+    return currentDatabaseContext()->getReadSqlDatabase(id);
+}
+
 
 QMap<QByteArray, std::function<QObject*()>> *Tf::objectFactories() noexcept
 {
@@ -236,6 +236,7 @@ namespace Tf
     T_CORE_EXPORT TActionContext *currentContext();
     T_CORE_EXPORT TDatabaseContext *currentDatabaseContext();
     T_CORE_EXPORT QSqlDatabase &currentSqlDatabase(int id) noexcept;
+    T_CORE_EXPORT QSqlDatabase &currentReadSqlDatabase(int id) noexcept;
     T_CORE_EXPORT QMap<QByteArray, std::function<QObject*()>> *objectFactories() noexcept;
 
     // LZ4 lossless compression algorithm
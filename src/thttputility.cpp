@@ -6,6 +6,7 @@
  */
 
 #include "thttputility.h"
+#include "tescapekernel.h"
 #include "tsystemglobal.h"
 #include <QMap>
 #include <QTextCodec>
@@ -19,6 +20,59 @@
 
 constexpr auto HTTP_DATE_TIME_FORMAT = "ddd, d MMM yyyy hh:mm:ss";
 
+namespace {
+
+// Copies the runs of characters not to be escaped in bulk, between the
+// special characters found by the escape kernel
+QString escapeString(const QString &input, Tf::EscapeFlag flag, const char *(*entityOf)(ushort))
+{
+    const QChar *src = input.constData();
+    const int len = input.length();
+    int i = TEscapeKernel::indexOfSpecialChar(src, len, flag);
+
+    if (i == len) {
+        return input;  // shares the data
+    }
+
+    QString escaped;
+    escaped.reserve(len + len / 8 + 8);
+    int start = 0;
+    while (i < len) {
+        escaped.append(src + start, i - start);
+        escaped += QLatin1String(entityOf(src[i].unicode()));
+        start = i + 1;
+        i = start + TEscapeKernel::indexOfSpecialChar(src + start, len - start, flag);
+    }
+    escaped.append(src + start, len - start);
+    return escaped;
+}
+
+
+QByteArray escapeBytes(const QByteArray &input, Tf::EscapeFlag flag, const char *(*entityOf)(ushort))
+{
+    const char *src = input.constData();
+    const int len = input.length();
+    int i = TEscapeKernel::indexOfSpecialChar(src, len, flag);
+
+    if (i == len) {
+        return input;
+    }
+
+    QByteArray escaped;
+    escaped.reserve(len + len / 8 + 8);
+    int start = 0;
+    while (i < len) {
+        escaped.append(src + start, i - start);
+        escaped += entityOf((uchar)src[i]);
+        start = i + 1;
+        i = start + TEscapeKernel::indexOfSpecialChar(src + start, len - start, flag);
+    }
+    escaped.append(src + start, len - start);
+    return escaped;
+}
+
+}
+
 
 class ReasonPhrase : public QMap<int, QByteArray>
 {
@@ -134,35 +188,7 @@ QList<QPair<QString, QString>> THttpUtility::fromFormUrlEncoded(const QByteArray
 */
 QString THttpUtility::htmlEscape(const QString &input, Tf::EscapeFlag flag)
 {
-    const QLatin1Char amp('&');
-    const QLatin1Char lt('<');
-    const QLatin1Char gt('>');
-    const QLatin1Char dquot('"');
-    const QLatin1Char squot('\'');
-    const QLatin1String eamp("&amp;");
-    const QLatin1String elt("&lt;");
-    const QLatin1String egt("&gt;");
-    const QString edquot("&quot;");
-    const QString esquot("&#039;");
-
-    QString escaped;
-    escaped.reserve(int(input.length() * 1.1));
-    for (int i = 0; i < input.length(); ++i) {
-        if (input.at(i) == amp) {
-            escaped += eamp;
-        } else if (input.at(i) == lt) {
-            escaped += elt;
-        } else if (input.at(i) == gt) {
-            escaped += egt;
-        } else if (input.at(i) == dquot) {
-            escaped += (flag == Tf::Compatible || flag == Tf::Quotes) ? edquot : input.at(i);
-        } else if (input.at(i) == squot) {
-            escaped += (flag == Tf::Quotes) ? esquot : input.at(i);
-        } else {
-            escaped += input.at(i);
-        }
-    }
-    return escaped;
+    return escapeString(input, flag, TEscapeKernel::htmlEntity);
 }
 
 /*!
@@ -203,24 +229,7 @@ QString THttpUtility::htmlEscape(const QVariant &input, Tf::EscapeFlag flag)
 */
 QString THttpUtility::jsonEscape(const QString &input)
 {
-    const QLatin1Char amp('&');
-    const QLatin1Char lt('<');
-    const QLatin1Char gt('>');
-
-    QString escaped;
-    escaped.reserve(int(input.length() * 1.1));
-    for (int i = 0; i < input.length(); ++i) {
-        if (input.at(i) == amp) {
-            escaped += QLatin1String("\\u0026");
-        } else if (input.at(i) == lt) {
-            escaped += QLatin1String("\\u003C");
-        } else if (input.at(i) == gt) {
-            escaped += QLatin1String("\\u003E");
-        } else {
-            escaped += input.at(i);
-        }
-    }
-    return escaped;
+    return escapeString(input, Tf::NoQuotes, TEscapeKernel::jsonEntity);
 }
 
 /*!
@@ -247,6 +256,26 @@ QString THttpUtility::jsonEscape(const QVariant &input)
     return jsonEscape(input.toString());
 }
 
+/*!
+  Returns a converted copy of the UTF-8 bytes \a input in the same way
+  as htmlEscape(const QString &, Tf::EscapeFlag), without decoding it.
+  No byte of a multibyte character in UTF-8 is an ASCII character, so
+  the result is also in UTF-8.
+*/
+QByteArray THttpUtility::htmlEscapeUtf8(const QByteArray &input, Tf::EscapeFlag flag)
+{
+    return escapeBytes(input, flag, TEscapeKernel::htmlEntity);
+}
+
+/*!
+  Returns a converted copy of the UTF-8 bytes \a input in the same way
+  as jsonEscape(const QString &), without decoding it.
+*/
+QByteArray THttpUtility::jsonEscapeUtf8(const QByteArray &input)
+{
+    return escapeBytes(input, Tf::NoQuotes, TEscapeKernel::jsonEntity);
+}
+
 /*!
   This function overloads toMimeEncoded(const QString &, QTextCodec *).
   @sa fromMimeEncoded(const QByteArray &)
@@ -32,6 +32,8 @@ public:
     static QString jsonEscape(const char *input);
     static QString jsonEscape(const QByteArray &input);
     static QString jsonEscape(const QVariant &input);
+    static QByteArray htmlEscapeUtf8(const QByteArray &input, Tf::EscapeFlag flag = Tf::Quotes);
+    static QByteArray jsonEscapeUtf8(const QByteArray &input);
     static QByteArray toMimeEncoded(const QString &input, const QByteArray &encoding = "UTF-8");
     static QByteArray toMimeEncoded(const QString &input, QTextCodec *codec);
     static QString fromMimeEncoded(const QByteArray &mime);
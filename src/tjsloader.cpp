@@ -8,12 +8,15 @@
 #include "tjsloader.h"
 #include "tsystemglobal.h"
 #include <TWebApplication>
+#include <QCache>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QThreadStorage>
 
 // #define tSystemError(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
 // #define tSystemDebug(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
@@ -25,9 +28,29 @@
 */
 
 namespace {
-    QMap<QString, TJSModule*> jsContexts;
+    class JSContextMap : public QMap<QString, TJSModule*>
+    {
+    public:
+        ~JSContextMap() { qDeleteAll(*this); }
+    };
+
+    // JavaScript contexts of each thread, so that the threads evaluate
+    // scripts in parallel without contention on a shared engine
+    QThreadStorage<JSContextMap*> jsContextStorage;
     QStringList defaultPaths;
     QMutex gMutex(QMutex::Recursive);
+
+    // Compiled JSX keyed by the SHA-1 of the source, shared by the threads
+    QCache<QByteArray, QString> jsxCache(16 * 1024 * 1024);
+    QMutex jsxMutex;
+
+    JSContextMap &jsContexts()
+    {
+        if (!jsContextStorage.hasLocalData()) {
+            jsContextStorage.setLocalData(new JSContextMap);
+        }
+        return *jsContextStorage.localData();
+    }
 }
 
 
@@ -127,6 +150,8 @@ TJSLoader::TJSLoader(const QString &defaultMember, const QString &moduleName, Al
   Loads the JavaScript module and returns the JavaScript context
   if successful; otherwise returns null pointer.
   i.e. var \a defaultMember = require( \a moduleName );
+  The context is created once per thread and kept for reuse, so the
+  returned pointer must not be passed to another thread.
 */
 TJSModule *TJSLoader::load(bool reload)
 {
@@ -134,13 +159,13 @@ TJSModule *TJSLoader::load(bool reload)
         return nullptr;
     }
 
-    QMutexLocker lock(&gMutex);
+    auto &contexts = jsContexts();
     QString key = member + QLatin1Char(';') + module;
-    TJSModule *context = jsContexts.value(key);
+    TJSModule *context = contexts.value(key);
 
     if (reload && context) {
-        jsContexts.remove(key);
-        context->deleteLater();
+        contexts.remove(key);
+        delete context;
         context = nullptr;
     }
 
@@ -154,10 +179,11 @@ TJSModule *TJSLoader::load(bool reload)
 
         QJSValue res = importTo(context, true);
         if (res.isError()) {
-            context->deleteLater();
+            delete context;
             context = nullptr;
         } else {
-            jsContexts.insert(key, context);
+            context->loadedTime = QDateTime::currentDateTime();
+            contexts.insert(key, context);
         }
     }
     return context;
@@ -308,7 +334,6 @@ TJSInstance TJSLoader::loadAsConstructor(const QJSValue &arg) const
 
 TJSInstance TJSLoader::loadAsConstructor(const QJSValueList &args) const
 {
-    QMutexLocker lock(&gMutex);
     QString constructorName = (member.isEmpty()) ? QLatin1String("_TF_") + QFileInfo(module).baseName().replace(QChar('-'), QChar('_')) : member;
     auto *ctx = TJSLoader(constructorName, module).load();
     return (ctx) ? ctx->callAsConstructor(constructorName, args) : TJSInstance();
@@ -393,8 +418,29 @@ void TJSLoader::replaceRequire(TJSModule *context, QString &content, const QDir
 
 QString TJSLoader::compileJsx(const QString &jsx)
 {
+    const QByteArray hash = QCryptographicHash::hash(QByteArray::fromRawData((const char *)jsx.constData(), jsx.length() * (int)sizeof(QChar)),
+                                                     QCryptographicHash::Sha1);
+    {
+        QMutexLocker lock(&jsxMutex);
+        QString *cached = jsxCache.object(hash);
+        if (cached) {
+            return *cached;
+        }
+    }
+
     auto *transform = TJSLoader("JSXTransformer", "JSXTransformer").load();
+    if (!transform) {
+        return QString();
+    }
+
     QJSValue jscode = transform->call("JSXTransformer.transform", QJSValue(jsx));
     //tSystemDebug("code:%s", qPrintable(jscode.property("code").toString()));
-    return jscode.property("code").toString();
+    if (jscode.isError()) {
+        return QString();
+    }
+
+    QString code = jscode.property("code").toString();
+    QMutexLocker lock(&jsxMutex);
+    jsxCache.insert(hash, new QString(code), qMax(code.length(), 1));
+    return code;
 }
@@ -6,6 +6,8 @@
 #include <QStringList>
 #include <QJSValue>
 #include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QMap>
 #include <QMutex>
 #include <TGlobal>
@@ -37,6 +39,8 @@ private:
     QString lastFunc;
     QString moduleFilePath;
     QMutex mutex;
+    QDateTime loadedTime;
+    QElapsedTimer modifiedCheckTimer;
 
     T_DISABLE_COPY(TJSModule)
     T_DISABLE_MOVE(TJSModule);
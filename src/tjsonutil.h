@@ -5,6 +5,7 @@
 #include <QJsonObject>
 #include <QList>
 #include <QVariantMap>
+#include <TJsonWriter>
 
 
 template <class T>
@@ -18,4 +19,13 @@ inline QJsonArray tfModelListToJsonArray(const QList<T> &models)
     return array;
 }
 
+
+template <class T>
+inline QByteArray tfModelListToJson(const QList<T> &models)
+{
+    TJsonWriter writer;
+    writer.value(models);
+    return writer.data();
+}
+
 #endif // TJSONUTIL_H
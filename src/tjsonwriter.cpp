@@ -0,0 +1,713 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tjsonwriter.h"
+#include <TAbstractModel>
+#include <TModelObject>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QMetaProperty>
+#include <QReadWriteLock>
+#include <QVector>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+// Property of a model object, with the key pre-encoded
+struct PropertyDescriptor {
+    int index;
+    int type;
+    QByteArray key;  // "name":
+};
+
+using PropertyDescriptors = QVector<PropertyDescriptor>;
+
+QHash<const QMetaObject *, PropertyDescriptors> descriptorCache;
+QReadWriteLock descriptorLock;
+
+
+const PropertyDescriptors &propertyDescriptors(const QMetaObject *metaObject)
+{
+    QReadLocker locker(&descriptorLock);
+    auto it = descriptorCache.constFind(metaObject);
+    if (it != descriptorCache.constEnd()) {
+        return *it;
+    }
+    locker.unlock();
+
+    PropertyDescriptors descriptors;
+    for (int i = metaObject->propertyOffset(); i < metaObject->propertyCount(); ++i) {
+        QMetaProperty prop = metaObject->property(i);
+        QString name = TAbstractModel::fieldNameToVariableName(QLatin1String(prop.name()));
+        if (name.isEmpty()) {
+            continue;
+        }
+
+        TJsonWriter keyWriter;
+        keyWriter.beginObject().key(name);
+        PropertyDescriptor desc;
+        desc.index = i;
+        desc.type = prop.userType();
+        desc.key = keyWriter.data().mid(1);
+        descriptors << desc;
+    }
+
+    QWriteLocker writeLocker(&descriptorLock);
+    auto wit = descriptorCache.find(metaObject);
+    if (wit == descriptorCache.end()) {
+        wit = descriptorCache.insert(metaObject, descriptors);
+    }
+    // Entries are never removed, so the reference stays valid
+    return *wit;
+}
+
+// Reads the property of the index into the storage of the type
+template <typename T>
+inline T readProperty(QObject *object, int index)
+{
+    T value {};
+    int status = -1;
+    void *argv[] = {&value, nullptr, &status};
+    QMetaObject::metacall(object, QMetaObject::ReadProperty, index, argv);
+    return value;
+}
+
+
+inline bool needsEscape(ushort c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+
+inline char *writeEscaped(char *d, ushort c)
+{
+    static const char hex[] = "0123456789abcdef";
+    *d++ = '\\';
+    switch (c) {
+    case '"':
+        *d++ = '"';
+        break;
+    case '\\':
+        *d++ = '\\';
+        break;
+    case '\b':
+        *d++ = 'b';
+        break;
+    case '\f':
+        *d++ = 'f';
+        break;
+    case '\n':
+        *d++ = 'n';
+        break;
+    case '\r':
+        *d++ = 'r';
+        break;
+    case '\t':
+        *d++ = 't';
+        break;
+    default:
+        *d++ = 'u';
+        *d++ = '0';
+        *d++ = '0';
+        *d++ = hex[c >> 4];
+        *d++ = hex[c & 0xf];
+        break;
+    }
+    return d;
+}
+
+}
+
+/*!
+  \class TJsonWriter
+  \brief The TJsonWriter class writes a JSON document directly into a
+  buffer of UTF-8 bytes.
+
+  Unlike converting through QVariantMap and QJsonDocument, the values
+  are encoded as they are written, without intermediate objects. A model
+  is written by TAbstractModel::writeJson(); writeProperties() reads the
+  properties through descriptors cached per class.
+  \code
+  TJsonWriter writer;
+  writer.beginObject();
+  writer.key("total").value(total);
+  writer.key("blogs").value(blogList);
+  writer.endObject();
+  renderJson(writer);
+  \endcode
+  \sa TActionController::renderJson(const TJsonWriter &)
+*/
+
+/*!
+  Begins a JSON object.
+*/
+TJsonWriter &TJsonWriter::beginObject()
+{
+    separate();
+    buffer += '{';
+    needComma = false;
+    return *this;
+}
+
+/*!
+  Ends the JSON object.
+*/
+TJsonWriter &TJsonWriter::endObject()
+{
+    buffer += '}';
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Begins a JSON array.
+*/
+TJsonWriter &TJsonWriter::beginArray()
+{
+    separate();
+    buffer += '[';
+    needComma = false;
+    return *this;
+}
+
+/*!
+  Ends the JSON array.
+*/
+TJsonWriter &TJsonWriter::endArray()
+{
+    buffer += ']';
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the \a name of a member of the current object. The value is
+  written next.
+*/
+TJsonWriter &TJsonWriter::key(const QString &name)
+{
+    separate();
+    writeString(name.constData(), name.length());
+    buffer += ':';
+    needComma = false;
+    return *this;
+}
+
+/*!
+  Writes the \a name in UTF-8 of a member of the current object.
+*/
+TJsonWriter &TJsonWriter::key(const char *name)
+{
+    separate();
+    writeUtf8String(name, qstrlen(name));
+    buffer += ':';
+    needComma = false;
+    return *this;
+}
+
+/*!
+  Writes null.
+*/
+TJsonWriter &TJsonWriter::value(std::nullptr_t)
+{
+    separate();
+    buffer += QByteArrayLiteral("null");
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the boolean \a b.
+*/
+TJsonWriter &TJsonWriter::value(bool b)
+{
+    separate();
+    buffer += (b) ? QByteArrayLiteral("true") : QByteArrayLiteral("false");
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the number \a n.
+*/
+TJsonWriter &TJsonWriter::value(int n)
+{
+    writeInteger(n);
+    return *this;
+}
+
+/*!
+  Writes the number \a n.
+*/
+TJsonWriter &TJsonWriter::value(uint n)
+{
+    writeInteger(n);
+    return *this;
+}
+
+/*!
+  Writes the number \a n.
+*/
+TJsonWriter &TJsonWriter::value(long n)
+{
+    writeInteger(n);
+    return *this;
+}
+
+/*!
+  Writes the number \a n.
+*/
+TJsonWriter &TJsonWriter::value(ulong n)
+{
+    writeInteger(n);
+    return *this;
+}
+
+/*!
+  Writes the number \a n.
+*/
+TJsonWriter &TJsonWriter::value(qlonglong n)
+{
+    writeInteger(n);
+    return *this;
+}
+
+/*!
+  Writes the number \a n.
+*/
+TJsonWriter &TJsonWriter::value(qulonglong n)
+{
+    writeInteger(n);
+    return *this;
+}
+
+/*!
+  Writes the number \a d in the shortest representation. A number not
+  finite is written as null as QJsonDocument does.
+*/
+TJsonWriter &TJsonWriter::value(double d)
+{
+    if (!std::isfinite(d)) {
+        return value(nullptr);
+    }
+
+    if (d == std::floor(d) && std::fabs(d) < 1e15) {
+        writeInteger((qint64)d);
+        return *this;
+    }
+
+    separate();
+#if QT_VERSION >= 0x050700
+    buffer += QByteArray::number(d, 'g', QLocale::FloatingPointShortest);
+#else
+    buffer += QByteArray::number(d, 'g', 17);
+#endif
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the string \a str, escaped and encoded in UTF-8.
+*/
+TJsonWriter &TJsonWriter::value(const QString &str)
+{
+    separate();
+    writeString(str.constData(), str.length());
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the UTF-8 string \a str.
+*/
+TJsonWriter &TJsonWriter::value(const char *str)
+{
+    if (!str) {
+        return value(nullptr);
+    }
+    separate();
+    writeUtf8String(str, qstrlen(str));
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the UTF-8 string \a str.
+*/
+TJsonWriter &TJsonWriter::value(const QByteArray &str)
+{
+    separate();
+    writeUtf8String(str.constData(), str.length());
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Writes the \a dateTime in ISO 8601 format as QJsonValue does.
+*/
+TJsonWriter &TJsonWriter::value(const QDateTime &dateTime)
+{
+#if QT_VERSION >= 0x050800
+    return value(dateTime.toString(Qt::ISODateWithMs).toLatin1());
+#else
+    return value(dateTime.toString(Qt::ISODate).toLatin1());
+#endif
+}
+
+/*!
+  Writes the \a date in ISO 8601 format.
+*/
+TJsonWriter &TJsonWriter::value(const QDate &date)
+{
+    return value(date.toString(Qt::ISODate).toLatin1());
+}
+
+/*!
+  Writes the \a time in ISO 8601 format.
+*/
+TJsonWriter &TJsonWriter::value(const QTime &time)
+{
+#if QT_VERSION >= 0x050800
+    return value(time.toString(Qt::ISODateWithMs).toLatin1());
+#else
+    return value(time.toString(Qt::ISODate).toLatin1());
+#endif
+}
+
+/*!
+  Writes the \a list as an array of strings.
+*/
+TJsonWriter &TJsonWriter::value(const QStringList &list)
+{
+    beginArray();
+    for (auto &str : list) {
+        value(str);
+    }
+    return endArray();
+}
+
+/*!
+  Writes the \a map as an object.
+*/
+TJsonWriter &TJsonWriter::value(const QVariantMap &map)
+{
+    beginObject();
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        key(it.key());
+        value(it.value());
+    }
+    return endObject();
+}
+
+/*!
+  Writes the \a list as an array.
+*/
+TJsonWriter &TJsonWriter::value(const QVariantList &list)
+{
+    beginArray();
+    for (auto &var : list) {
+        value(var);
+    }
+    return endArray();
+}
+
+/*!
+  Writes the variant \a var in the same way as QJsonValue::fromVariant()
+  converts it.
+*/
+TJsonWriter &TJsonWriter::value(const QVariant &var)
+{
+    switch (var.userType()) {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        return value(nullptr);
+    case QMetaType::Bool:
+        return value(var.toBool());
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::SChar:
+        return value(var.toInt());
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::UChar:
+        return value(var.toUInt());
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        return value(var.toLongLong());
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        return value(var.toULongLong());
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return value(var.toDouble());
+    case QMetaType::QString:
+        return value(var.toString());
+    case QMetaType::QByteArray:
+        return value(var.toByteArray());
+    case QMetaType::QDateTime:
+        return value(var.toDateTime());
+    case QMetaType::QDate:
+        return value(var.toDate());
+    case QMetaType::QTime:
+        return value(var.toTime());
+    case QMetaType::QStringList:
+        return value(var.toStringList());
+    case QMetaType::QVariantMap:
+        return value(var.toMap());
+    case QMetaType::QVariantList:
+        return value(var.toList());
+    default:
+        break;
+    }
+
+    // Others through QJsonValue
+    return value(QJsonValue::fromVariant(var));
+}
+
+/*!
+  Writes the JSON value \a json.
+*/
+TJsonWriter &TJsonWriter::value(const QJsonValue &json)
+{
+    switch (json.type()) {
+    case QJsonValue::Object:
+        return value(json.toObject());
+    case QJsonValue::Array:
+        return value(json.toArray());
+    case QJsonValue::Bool:
+        return value(json.toBool());
+    case QJsonValue::Double:
+        return value(json.toDouble());
+    case QJsonValue::String:
+        return value(json.toString());
+    default:
+        return value(nullptr);
+    }
+}
+
+/*!
+  Writes the JSON \a object.
+*/
+TJsonWriter &TJsonWriter::value(const QJsonObject &object)
+{
+    beginObject();
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        key(it.key());
+        value(it.value());
+    }
+    return endObject();
+}
+
+/*!
+  Writes the JSON \a array.
+*/
+TJsonWriter &TJsonWriter::value(const QJsonArray &array)
+{
+    beginArray();
+    for (const auto &json : array) {
+        value(json);
+    }
+    return endArray();
+}
+
+/*!
+  Writes the properties of the \a model as an object, as
+  TAbstractModel::toJsonObject() converts it.
+  \sa TAbstractModel::writeJson()
+*/
+TJsonWriter &TJsonWriter::value(const TAbstractModel &model)
+{
+    model.writeJson(*this);
+    return *this;
+}
+
+/*!
+  Writes the properties of the model \a object as an object, keyed by
+  the variable names of the properties. The properties are read by the
+  descriptors cached per class, without looking them up by name.
+*/
+TJsonWriter &TJsonWriter::writeProperties(const TModelObject *object)
+{
+    if (!object) {
+        return value(nullptr);
+    }
+
+    QObject *obj = const_cast<TModelObject *>(object);
+    const PropertyDescriptors &descriptors = propertyDescriptors(object->metaObject());
+    const QMetaObject *metaObject = object->metaObject();
+
+    beginObject();
+    for (auto &desc : descriptors) {
+        separate();
+        buffer += desc.key;
+        needComma = false;
+
+        // Reads the values of common types without QVariant
+        switch (desc.type) {
+        case QMetaType::Int:
+            value(readProperty<int>(obj, desc.index));
+            break;
+        case QMetaType::LongLong:
+            value(readProperty<qlonglong>(obj, desc.index));
+            break;
+        case QMetaType::Double:
+            value(readProperty<double>(obj, desc.index));
+            break;
+        case QMetaType::Bool:
+            value(readProperty<bool>(obj, desc.index));
+            break;
+        case QMetaType::QString:
+            value(readProperty<QString>(obj, desc.index));
+            break;
+        case QMetaType::QDateTime:
+            value(readProperty<QDateTime>(obj, desc.index));
+            break;
+        default:
+            value(metaObject->property(desc.index).read(obj));
+            break;
+        }
+    }
+    return endObject();
+}
+
+/*!
+  Writes the \a json as it is, which must be a valid JSON value.
+*/
+TJsonWriter &TJsonWriter::writeRaw(const QByteArray &json)
+{
+    separate();
+    buffer += json;
+    needComma = true;
+    return *this;
+}
+
+/*!
+  Clears the contents of the writer.
+*/
+void TJsonWriter::clear()
+{
+    buffer.clear();
+    needComma = false;
+}
+
+
+void TJsonWriter::separate()
+{
+    if (needComma) {
+        buffer += ',';
+    }
+}
+
+
+void TJsonWriter::writeString(const QChar *str, int length)
+{
+    // A UTF-16 unit is encoded to at most 6 bytes
+    const int oldSize = buffer.size();
+    buffer.resize(oldSize + length * 6 + 2);
+    char *d = buffer.data() + oldSize;
+    const ushort *s = reinterpret_cast<const ushort *>(str);
+    const ushort *end = s + length;
+
+    *d++ = '"';
+    while (s < end) {
+        ushort c = *s++;
+        if (c < 0x80) {
+            if (Q_UNLIKELY(needsEscape(c))) {
+                d = writeEscaped(d, c);
+            } else {
+                *d++ = (char)c;
+            }
+        } else if (c < 0x800) {
+            *d++ = (char)(0xc0 | (c >> 6));
+            *d++ = (char)(0x80 | (c & 0x3f));
+        } else if (QChar::isHighSurrogate(c) && s < end && QChar::isLowSurrogate(*s)) {
+            uint ucs4 = QChar::surrogateToUcs4(c, *s++);
+            *d++ = (char)(0xf0 | (ucs4 >> 18));
+            *d++ = (char)(0x80 | ((ucs4 >> 12) & 0x3f));
+            *d++ = (char)(0x80 | ((ucs4 >> 6) & 0x3f));
+            *d++ = (char)(0x80 | (ucs4 & 0x3f));
+        } else if (QChar::isSurrogate(c)) {
+            // Unpaired surrogate, replaced as QString::toUtf8() does
+            *d++ = (char)0xef;
+            *d++ = (char)0xbf;
+            *d++ = (char)0xbd;
+        } else {
+            *d++ = (char)(0xe0 | (c >> 12));
+            *d++ = (char)(0x80 | ((c >> 6) & 0x3f));
+            *d++ = (char)(0x80 | (c & 0x3f));
+        }
+    }
+    *d++ = '"';
+    buffer.resize(d - buffer.constData());
+}
+
+
+void TJsonWriter::writeUtf8String(const char *str, int length)
+{
+    const int oldSize = buffer.size();
+    buffer.resize(oldSize + length * 6 + 2);
+    char *d = buffer.data() + oldSize;
+    const char *end = str + length;
+
+    *d++ = '"';
+    for (const char *s = str; s < end; ++s) {
+        uchar c = (uchar)*s;
+        if (Q_UNLIKELY(needsEscape(c))) {
+            d = writeEscaped(d, c);
+        } else {
+            *d++ = (char)c;
+        }
+    }
+    *d++ = '"';
+    buffer.resize(d - buffer.constData());
+}
+
+
+template <typename T>
+void TJsonWriter::writeInteger(T n)
+{
+    char digits[24];
+    char *p = digits + sizeof(digits);
+    bool negative = (n < 0);
+    // Works for the minimum value of the signed types too
+    auto magnitude = (negative) ? 0 - (typename std::make_unsigned<T>::type)n : (typename std::make_unsigned<T>::type)n;
+
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+
+    if (negative) {
+        *--p = '-';
+    }
+
+    separate();
+    buffer.append(p, digits + sizeof(digits) - p);
+    needComma = true;
+}
+
+
+/*!
+  \fn TJsonWriter::TJsonWriter()
+  Constructs an empty writer.
+*/
+
+/*!
+  \fn const QByteArray &TJsonWriter::data() const
+  Returns the JSON document written, encoded in UTF-8.
+*/
+
+/*!
+  \fn TJsonWriter &TJsonWriter::value(const QList<T> &list)
+  Writes the \a list as an array, element by element. A large list of
+  models is written without building an intermediate array.
+*/
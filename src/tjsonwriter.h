@@ -0,0 +1,88 @@
+#ifndef TJSONWRITER_H
+#define TJSONWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <TGlobal>
+
+class TAbstractModel;
+class TModelObject;
+class QJsonValue;
+class QJsonObject;
+class QJsonArray;
+
+
+class T_CORE_EXPORT TJsonWriter
+{
+public:
+    TJsonWriter() { }
+
+    TJsonWriter &beginObject();
+    TJsonWriter &endObject();
+    TJsonWriter &beginArray();
+    TJsonWriter &endArray();
+    TJsonWriter &key(const QString &name);
+    TJsonWriter &key(const char *name);
+
+    TJsonWriter &value(std::nullptr_t);
+    TJsonWriter &value(bool b);
+    TJsonWriter &value(int n);
+    TJsonWriter &value(uint n);
+    TJsonWriter &value(long n);
+    TJsonWriter &value(ulong n);
+    TJsonWriter &value(qlonglong n);
+    TJsonWriter &value(qulonglong n);
+    TJsonWriter &value(double d);
+    TJsonWriter &value(const QString &str);
+    TJsonWriter &value(const char *str);
+    TJsonWriter &value(const QByteArray &str);
+    TJsonWriter &value(const QDateTime &dateTime);
+    TJsonWriter &value(const QDate &date);
+    TJsonWriter &value(const QTime &time);
+    TJsonWriter &value(const QStringList &list);
+    TJsonWriter &value(const QVariantMap &map);
+    TJsonWriter &value(const QVariantList &list);
+    TJsonWriter &value(const QVariant &var);
+    TJsonWriter &value(const QJsonValue &json);
+    TJsonWriter &value(const QJsonObject &object);
+    TJsonWriter &value(const QJsonArray &array);
+    TJsonWriter &value(const TAbstractModel &model);
+    template <typename T> TJsonWriter &value(const QList<T> &list);
+    TJsonWriter &writeProperties(const TModelObject *object);
+    TJsonWriter &writeRaw(const QByteArray &json);
+
+    int size() const { return buffer.size(); }
+    bool isEmpty() const { return buffer.isEmpty(); }
+    void reserve(int size) { buffer.reserve(size); }
+    void clear();
+    const QByteArray &data() const { return buffer; }
+
+private:
+    void separate();
+    void writeString(const QChar *str, int length);
+    void writeUtf8String(const char *str, int length);
+    template <typename T> void writeInteger(T n);
+
+    QByteArray buffer;
+    bool needComma {false};
+
+    T_DISABLE_COPY(TJsonWriter)
+    T_DISABLE_MOVE(TJsonWriter)
+};
+
+/*!
+  Writes the \a list as a JSON array, element by element, without
+  building an intermediate array.
+*/
+template <typename T>
+inline TJsonWriter &TJsonWriter::value(const QList<T> &list)
+{
+    beginArray();
+    for (auto &item : list) {
+        value(item);
+    }
+    return endArray();
+}
+
+#endif // TJSONWRITER_H
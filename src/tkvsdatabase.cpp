@@ -169,6 +169,15 @@ bool TKvsDatabase::command(const QString &cmd)
 }
 
 
+/*!
+  Checks if the connection to the server is alive.
+*/
+bool TKvsDatabase::ping()
+{
+    return (driver()) ? driver()->ping() : false;
+}
+
+
 bool TKvsDatabase::isOpen() const
 {
     return (driver()) ? driver()->isOpen() : false;
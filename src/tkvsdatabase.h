@@ -36,6 +36,7 @@ public:
     bool open();
     void close();
     bool command(const QString &cmd);
+    bool ping();
     bool isOpen() const;
     bool isValid() const;
     TKvsDriver *driver() { return drv; }
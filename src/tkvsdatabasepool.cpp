@@ -10,6 +10,7 @@
 #include "tsystemglobal.h"
 #include "tfnamespace.h"
 #include <TWebApplication>
+#include <TAppSettings>
 #include <QStringList>
 #include <QDateTime>
 #include <QMap>
@@ -22,6 +23,8 @@
 */
 
 constexpr auto CONN_NAME_FORMAT = "%02dkvs_%d";
+constexpr int CONN_NAME_PREFIX_LEN = 6;  // "00kvs_"
+constexpr int MIN_RECONNECT_BACKOFF = 100;  // msecs
 
 
 class KvsEngineHash : public QMap<Tf::KvsEngine, QString>
@@ -52,6 +55,8 @@ TKvsDatabasePool *TKvsDatabasePool::instance()
     static TKvsDatabasePool *databasePool = []() {
         auto *pool = new TKvsDatabasePool;
         pool->maxConnects = Tf::app()->maxNumberOfThreadsPerAppServer();
+        pool->healthCheckIdleTime = Tf::appSettings()->value(Tf::KvsPoolHealthCheckIdleTime, 10).toInt();
+        pool->maxBackoff = qMax(Tf::appSettings()->value(Tf::KvsPoolReconnectMaxBackoff, 5000).toInt(), MIN_RECONNECT_BACKOFF);
         pool->init();
         return pool;
     }();
@@ -88,6 +93,12 @@ TKvsDatabasePool::~TKvsDatabasePool()
     delete[] cachedDatabase;
     delete[] lastCachedTime;
     delete[] availableNames;
+    delete[] lastUsedTime;
+    delete[] retryTime;
+    delete[] backoff;
+    delete[] inUse;
+    delete[] reconnects;
+    delete[] errors;
 }
 
 
@@ -100,6 +111,23 @@ void TKvsDatabasePool::init()
     cachedDatabase = new TStack<QString>[kvsEngineHash()->count()];
     lastCachedTime = new TAtomic<uint>[kvsEngineHash()->count()];
     availableNames = new TStack<QString>[kvsEngineHash()->count()];
+    lastUsedTime = new TAtomic<uint>[kvsEngineHash()->count() * maxConnects];
+    retryTime = new TAtomic<qint64>[kvsEngineHash()->count()];
+    backoff = new TAtomic<int>[kvsEngineHash()->count()];
+    inUse = new TAtomic<int>[kvsEngineHash()->count()];
+    reconnects = new TAtomic<quint64>[kvsEngineHash()->count()];
+    errors = new TAtomic<quint64>[kvsEngineHash()->count()];
+
+    for (int i = 0; i < kvsEngineHash()->count(); i++) {
+        retryTime[i].store(0);
+        backoff[i].store(0);
+        inUse[i].store(0);
+        reconnects[i].store(0);
+        errors[i].store(0);
+    }
+    for (int i = 0; i < kvsEngineHash()->count() * maxConnects; i++) {
+        lastUsedTime[i].store(0);
+    }
     bool aval = false;
 
     // Adds databases previously
@@ -162,14 +190,32 @@ TKvsDatabase TKvsDatabasePool::database(Tf::KvsEngine engine)
 
     auto &cache = cachedDatabase[(int)engine];
     auto &stack = availableNames[(int)engine];
+    bool reconnect = false;
 
     for (;;) {
         QString name;
         if (cache.pop(name)) {
             db = TKvsDatabase::database(name);
             if (Q_LIKELY(db.isOpen())) {
-                tSystemDebug("Gets cached KVS database: %s", qPrintable(db.connectionName()));
                 db.moveToThread(QThread::currentThread());  // move to thread
+
+                if (Q_UNLIKELY(!isAlive(db))) {
+                    tSystemWarn("Pooled KVS database is dead: %s", qPrintable(db.connectionName()));
+                    errors[(int)engine]++;
+                    db.close();
+                    stack.push(name);
+
+                    // The server may have restarted, closes all the idle connections
+                    while (cache.pop(name)) {
+                        TKvsDatabase::database(name).close();
+                        stack.push(name);
+                    }
+                    reconnect = true;
+                    continue;
+                }
+
+                tSystemDebug("Gets cached KVS database: %s", qPrintable(db.connectionName()));
+                inUse[(int)engine]++;
                 return db;
             } else {
                 tSystemError("Pooled database is not open: %s  [%s:%d]", qPrintable(db.connectionName()), __FILE__, __LINE__);
@@ -182,26 +228,18 @@ TKvsDatabase TKvsDatabasePool::database(Tf::KvsEngine engine)
             db = TKvsDatabase::database(name);
             if (Q_UNLIKELY(db.isOpen())) {
                 tSystemWarn("Gets a opend KVS database: %s", qPrintable(db.connectionName()));
+                inUse[(int)engine]++;
                 return db;
             } else {
                 db.moveToThread(QThread::currentThread());  // move to thread
 
-                if (Q_UNLIKELY(!db.open())) {
-                    tError("KVS Database open error. Invalid database settings, or maximum number of KVS connection exceeded.");
-                    tSystemError("KVS database open error: %s", qPrintable(db.connectionName()));
+                if (Q_UNLIKELY(!openDatabase(db, engine, reconnect))) {
+                    stack.push(name);
                     return TKvsDatabase();
                 }
 
-                tSystemDebug("KVS opened successfully  env:%s connectname:%s dbname:%s", qPrintable(Tf::app()->databaseEnvironment()), qPrintable(db.connectionName()), qPrintable(db.databaseName()));
                 tSystemDebug("Gets KVS database: %s", qPrintable(db.connectionName()));
-                // Executes post-open statements
-                if (! db.postOpenStatements().isEmpty()) {
-                    for (QString st : db.postOpenStatements()) {
-                        st = st.trimmed();
-                        db.command(st);
-                    }
-                }
-
+                inUse[(int)engine]++;
                 return db;
             }
         }
@@ -211,6 +249,71 @@ TKvsDatabase TKvsDatabasePool::database(Tf::KvsEngine engine)
 }
 
 
+/*!
+  Opens the \a database. After a failure, opening is not retried until
+  the backoff time, which doubles on every failure, has elapsed.
+*/
+bool TKvsDatabasePool::openDatabase(TKvsDatabase &database, Tf::KvsEngine engine, bool reconnect)
+{
+    const int e = (int)engine;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (now < retryTime[e].load()) {
+        tSystemDebug("KVS reconnect postponed: %s", qPrintable(database.connectionName()));
+        return false;
+    }
+
+    if (Q_UNLIKELY(!database.open())) {
+        int wait = qBound(MIN_RECONNECT_BACKOFF, backoff[e].load() * 2, maxBackoff);
+        backoff[e].store(wait);
+        retryTime[e].store(now + wait);
+        errors[e]++;
+        tError("KVS Database open error. Invalid database settings, or maximum number of KVS connection exceeded.");
+        tSystemError("KVS database open error: %s  retry after %d msecs", qPrintable(database.connectionName()), wait);
+        return false;
+    }
+
+    if (backoff[e].exchange(0) > 0) {
+        retryTime[e].store(0);
+        reconnect = true;
+    }
+
+    if (reconnect) {
+        reconnects[e]++;
+        tSystemInfo("KVS reconnected: %s", qPrintable(database.connectionName()));
+    }
+
+    tSystemDebug("KVS opened successfully  env:%s connectname:%s dbname:%s", qPrintable(Tf::app()->databaseEnvironment()), qPrintable(database.connectionName()), qPrintable(database.databaseName()));
+    // Executes post-open statements
+    if (! database.postOpenStatements().isEmpty()) {
+        for (QString st : database.postOpenStatements()) {
+            st = st.trimmed();
+            database.command(st);
+        }
+    }
+
+    lastUsedTime[connectionIndex(database.connectionName())].store((uint)std::time(nullptr));
+    return true;
+}
+
+/*!
+  Returns true if the \a database has been used recently or replies to
+  a ping; otherwise returns false.
+*/
+bool TKvsDatabasePool::isAlive(TKvsDatabase &database)
+{
+    if (healthCheckIdleTime < 0) {
+        return true;
+    }
+
+    uint lastUsed = lastUsedTime[connectionIndex(database.connectionName())].load();
+    if ((uint)std::time(nullptr) - lastUsed < (uint)healthCheckIdleTime) {
+        return true;
+    }
+    return database.ping();
+}
+
+
 bool TKvsDatabasePool::setDatabaseSettings(TKvsDatabase &database, Tf::KvsEngine engine) const
 {
     // Initiates database
@@ -271,8 +374,11 @@ void TKvsDatabasePool::pool(TKvsDatabase &database)
             throw RuntimeException("No such KVS engine", __FILE__, __LINE__);
         }
 
+        uint now = (uint)std::time(nullptr);
+        lastUsedTime[connectionIndex(database.connectionName())].store(now);
         cachedDatabase[engine].push(database.connectionName());
-        lastCachedTime[engine].store((uint)std::time(nullptr));
+        lastCachedTime[engine].store(now);
+        inUse[engine]--;
         tSystemDebug("Pooled KVS database: %s", qPrintable(database.connectionName()));
     }
     database = TKvsDatabase();  // Sets an invalid object
@@ -308,3 +414,47 @@ QString TKvsDatabasePool::driverName(Tf::KvsEngine engine)
 {
     return kvsEngineHash()->value(engine);
 }
+
+
+int TKvsDatabasePool::connectionIndex(const QString &name) const
+{
+    int engine = name.left(2).toInt();
+    int index = name.mid(CONN_NAME_PREFIX_LEN).toInt();
+    return engine * maxConnects + index;
+}
+
+/*!
+  Returns the number of connections of the \a engine checked out from
+  the pool.
+*/
+int TKvsDatabasePool::inUseCount(Tf::KvsEngine engine) const
+{
+    return Tf::app()->isKvsAvailable(engine) ? inUse[(int)engine].load() : 0;
+}
+
+/*!
+  Returns the number of open connections of the \a engine waiting in
+  the pool.
+*/
+int TKvsDatabasePool::idleCount(Tf::KvsEngine engine) const
+{
+    return Tf::app()->isKvsAvailable(engine) ? cachedDatabase[(int)engine].count() : 0;
+}
+
+/*!
+  Returns the number of times connections of the \a engine have been
+  reopened after failures.
+*/
+quint64 TKvsDatabasePool::reconnectCount(Tf::KvsEngine engine) const
+{
+    return Tf::app()->isKvsAvailable(engine) ? reconnects[(int)engine].load() : 0;
+}
+
+/*!
+  Returns the number of connection failures of the \a engine, including
+  failed health checks.
+*/
+quint64 TKvsDatabasePool::errorCount(Tf::KvsEngine engine) const
+{
+    return Tf::app()->isKvsAvailable(engine) ? errors[(int)engine].load() : 0;
+}
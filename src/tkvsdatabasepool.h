@@ -22,11 +22,20 @@ public:
     TKvsDatabase database(Tf::KvsEngine engine);
     void pool(TKvsDatabase &database);
 
+    // Metrics
+    int inUseCount(Tf::KvsEngine engine) const;
+    int idleCount(Tf::KvsEngine engine) const;
+    quint64 reconnectCount(Tf::KvsEngine engine) const;
+    quint64 errorCount(Tf::KvsEngine engine) const;
+
     static TKvsDatabasePool *instance();
 
 protected:
     void init();
     bool setDatabaseSettings(TKvsDatabase &database, Tf::KvsEngine engine) const;
+    bool openDatabase(TKvsDatabase &database, Tf::KvsEngine engine, bool reconnect);
+    bool isAlive(TKvsDatabase &database);
+    int connectionIndex(const QString &name) const;
     void timerEvent(QTimerEvent *event);
 
     static QString driverName(Tf::KvsEngine engine);
@@ -39,7 +48,15 @@ private:
     TStack<QString> *cachedDatabase {nullptr};
     TAtomic<uint> *lastCachedTime {nullptr};
     TStack<QString> *availableNames {nullptr};
+    TAtomic<uint> *lastUsedTime {nullptr};   // per connection
+    TAtomic<qint64> *retryTime {nullptr};    // msecs since epoch
+    TAtomic<int> *backoff {nullptr};         // msecs
+    TAtomic<int> *inUse {nullptr};
+    TAtomic<quint64> *reconnects {nullptr};
+    TAtomic<quint64> *errors {nullptr};
     int maxConnects {0};
+    int healthCheckIdleTime {10};
+    int maxBackoff {5000};
     QBasicTimer timer;
 };
 
@@ -16,6 +16,7 @@ public:
     virtual void close() = 0;
     virtual bool command(const QString &) { return false; }
     virtual bool isOpen() const = 0;
+    virtual bool ping() { return isOpen(); }
     virtual void moveToThread(QThread *) { }
 };
 
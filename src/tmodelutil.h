@@ -2,6 +2,8 @@
 #define TMODELUTIL_H
 
 #include <QList>
+#include <QHash>
+#include <QSet>
 #include <TCriteria>
 #include <TSqlORMapper>
 #include <TSqlORMapperIterator>
@@ -102,6 +104,127 @@ inline QList<T> tfGetModelListByMongoCriteria(const TCriteria &cri, int limit =
 }
 
 
+// Maximum number of values in an IN clause of eager loading
+constexpr int TF_EAGER_LOAD_IN_VALUES_MAX = 1000;
+
+/*!
+  Retrieves the models whose \a column is one of the \a keys by one IN
+  query per 1000 keys, and returns them grouped by the value of the
+  column. Every key has an entry, which is empty if no model refers to it.
+*/
+template <class T, class S, typename K>
+inline QHash<K, QList<T>> tfGetModelListsGroupedBy(int column, const QList<K> &keys, int sortColumn = -1, Tf::SortOrder order = Tf::AscendingOrder)
+{
+    QHash<K, QList<T>> groups;
+    groups.reserve(keys.count());
+    QVariantList values;
+    values.reserve(qMin(keys.count(), TF_EAGER_LOAD_IN_VALUES_MAX));
+
+    for (auto &key : keys) {
+        if (!groups.contains(key)) {
+            groups.insert(key, QList<T>());
+            values << QVariant::fromValue(key);
+        }
+    }
+
+    for (int i = 0; i < values.count(); i += TF_EAGER_LOAD_IN_VALUES_MAX) {
+        TSqlORMapper<S> mapper;
+        if (sortColumn >= 0) {
+            mapper.setSortOrder(sortColumn, order);
+        }
+
+        if (mapper.findIn(column, values.mid(i, TF_EAGER_LOAD_IN_VALUES_MAX)) > 0) {
+            for (auto &o : mapper) {
+                auto it = groups.find(o.columnValue(column).template value<K>());
+                if (it != groups.end()) {
+                    it->append(T(o));
+                }
+            }
+        }
+    }
+    return groups;
+}
+
+/*!
+  Loads the models related to the \a parents in a one-to-many relation
+  at once, to avoid querying the table for every parent. The \a key
+  function returns the key of a parent, which the \a column of the
+  related models refers to.
+  \code
+  QList<Blog> blogs = Blog::getAll();
+  auto comments = tfGetRelatedModelLists<Comment, CommentObject>(blogs, &Blog::id, CommentObject::BlogId);
+  for (auto &blog : blogs) {
+      for (auto &comment : comments[blog.id()]) {
+          ...
+      }
+  }
+  \endcode
+*/
+template <class T, class S, class P, typename K>
+inline QHash<K, QList<T>> tfGetRelatedModelLists(const QList<P> &parents, K (P::*key)() const, int column, int sortColumn = -1, Tf::SortOrder order = Tf::AscendingOrder)
+{
+    QList<K> keys;
+    keys.reserve(parents.count());
+    for (auto &p : parents) {
+        keys << (p.*key)();
+    }
+    return tfGetModelListsGroupedBy<T, S>(column, keys, sortColumn, order);
+}
+
+/*!
+  Loads the models related to all the models in the \a parents, the
+  result of a previous eager loading, for a nested relation.
+*/
+template <class T, class S, class P, typename K, typename PK>
+inline QHash<K, QList<T>> tfGetRelatedModelLists(const QHash<PK, QList<P>> &parents, K (P::*key)() const, int column, int sortColumn = -1, Tf::SortOrder order = Tf::AscendingOrder)
+{
+    QList<P> list;
+    for (auto &lst : parents) {
+        list += lst;
+    }
+    return tfGetRelatedModelLists<T, S>(list, key, column, sortColumn, order);
+}
+
+/*!
+  Loads the models related to the \a children in a many-to-one or
+  one-to-one relation at once. The \a key function returns the foreign
+  key of a child, which refers to the \a column of the related model,
+  usually the primary key.
+  \code
+  QList<Comment> comments = Comment::getAll();
+  auto blogs = tfGetRelatedModels<Blog, BlogObject>(comments, &Comment::blogId, BlogObject::Id);
+  \endcode
+*/
+template <class T, class S, class P, typename K>
+inline QHash<K, T> tfGetRelatedModels(const QList<P> &children, K (P::*key)() const, int column)
+{
+    QHash<K, T> models;
+    const auto groups = tfGetRelatedModelLists<T, S>(children, key, column);
+    models.reserve(groups.count());
+
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        if (!it.value().isEmpty()) {
+            models.insert(it.key(), it.value().first());
+        }
+    }
+    return models;
+}
+
+/*!
+  Loads the models related to all the models in the \a children, the
+  result of a previous eager loading, for a nested relation.
+*/
+template <class T, class S, class P, typename K, typename PK>
+inline QHash<K, T> tfGetRelatedModels(const QHash<PK, QList<P>> &children, K (P::*key)() const, int column)
+{
+    QList<P> list;
+    for (auto &lst : children) {
+        list += lst;
+    }
+    return tfGetRelatedModels<T, S>(list, key, column);
+}
+
+
 template <class T>
 inline QJsonArray tfConvertToJsonArray(const QList<T> &list)
 {
@@ -8,6 +8,8 @@
 #include <TMongoCursor>
 #include <TBson>
 #include "tsystemglobal.h"
+#include "tqueryprofiler.h"
+#include <QElapsedTimer>
 extern "C" {
 #include <mongoc.h>
 }
@@ -30,12 +32,27 @@ bool TMongoCursor::next()
     bsonDoc = nullptr;
 
     if (mongoCursor) {
+        QElapsedTimer timer;
+        if (!profStatement.isEmpty()) {
+            timer.start();
+        }
+
+        // The query is sent to the server on the first call
         ret = mongoc_cursor_next(mongoCursor, (const bson_t **)&bsonDoc);
         if (!ret) {
             if (mongoc_cursor_error(mongoCursor, &error)) {
                 tSystemError("MongoDB Cursor Error: %s", error.message);
             }
         }
+
+        if (!profStatement.isEmpty()) {
+            profTime += timer.nsecsElapsed() / 1000;
+            if (ret) {
+                profRows++;
+            } else {
+                recordProfile();
+            }
+        }
     }
     return ret;
 }
@@ -59,6 +76,7 @@ QVariantList TMongoCursor::toList()
 
 void TMongoCursor::release()
 {
+    recordProfile();
     if (mongoCursor) {
         mongoc_cursor_destroy(mongoCursor);
         mongoCursor = nullptr;
@@ -72,3 +90,26 @@ void TMongoCursor::setCursor(void *cursor)
     release();
     mongoCursor = (mongoc_cursor_t *)cursor;
 }
+
+/*!
+  Starts profiling the \a statement with the \a params, which has taken
+  \a usecs microseconds so far. The time spent in next() is added, and
+  the duration is recorded when the cursor is exhausted or released.
+*/
+void TMongoCursor::setProfile(const QString &statement, const QVariantList &params, qint64 usecs)
+{
+    profStatement = statement;
+    profParams = params;
+    profTime = usecs;
+    profRows = 0;
+}
+
+
+void TMongoCursor::recordProfile()
+{
+    if (!profStatement.isEmpty()) {
+        TQueryProfiler::recordDuration(profTime, profStatement, profRows, profParams);
+        profStatement.clear();
+        profParams.clear();
+    }
+}
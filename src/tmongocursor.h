@@ -21,10 +21,16 @@ protected:
     void release();
     TCursorObject *cursor() { return mongoCursor; }
     void setCursor(void *cursor);
+    void setProfile(const QString &statement, const QVariantList &params, qint64 usecs);
+    void recordProfile();
 
 private:
     mongoc_cursor_t *mongoCursor {nullptr};
     const TBsonObject *bsonDoc {nullptr};  // pointer to a object of bson_t
+    QString profStatement;
+    QVariantList profParams;
+    qint64 profTime {0};  // usecs
+    int profRows {0};
 
     TMongoCursor();
     friend class TMongoDriver;
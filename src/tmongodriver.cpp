@@ -9,6 +9,8 @@
 #include <TMongoCursor>
 #include <TBson>
 #include <TSystemGlobal>
+#include <TWebApplication>
+#include "tqueryprofiler.h"
 extern "C" {
 #include "mongoc.h"
 #if !MONGOC_CHECK_VERSION(1,9,0)
@@ -16,6 +18,98 @@ extern "C" {
 #endif
 }
 #include <QDateTime>
+#include <QMap>
+#include <QMutex>
+#include <vector>
+
+namespace {
+
+QMap<QString, mongoc_client_pool_t *> clientPools;  // client pool of each URI
+QMutex clientPoolMutex;
+
+
+mongoc_client_pool_t *getClientPool(const QString &uri)
+{
+    QMutexLocker locker(&clientPoolMutex);
+
+    // The pools are shared by all the drivers and live until the process exits
+    mongoc_client_pool_t *pool = clientPools.value(uri);
+    if (pool) {
+        return pool;
+    }
+
+    bson_error_t error;
+    mongoc_uri_t *muri = mongoc_uri_new_with_error(qPrintable(uri), &error);
+    if (!muri) {
+        tSystemError("MongoDB URI error: %s  URI: %s", error.message, qPrintable(uri));
+        return nullptr;
+    }
+
+    pool = mongoc_client_pool_new(muri);
+    if (pool) {
+        if (mongoc_uri_get_option_as_int32(muri, "maxpoolsize", 0) <= 0) {
+            // The KVS database pool holds a client per action thread at most
+            mongoc_client_pool_max_size(pool, qMax(Tf::app()->maxNumberOfThreadsPerAppServer(), 1));
+        }
+        clientPools.insert(uri, pool);
+    } else {
+        tSystemError("MongoDB client pool create error. Connection URI: %s", qPrintable(uri));
+    }
+    mongoc_uri_destroy(muri);
+    return pool;
+}
+
+
+bool appendBulkOperation(mongoc_bulk_operation_t *bulk, const QVariantMap &operation, bson_error_t *error)
+{
+    static const QString FilterKey("filter");
+    static const QString UpsertKey("upsert");
+
+    if (operation.count() != 1 || operation.first().type() != QVariant::Map) {
+        bson_set_error(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Invalid bulk write operation");
+        return false;
+    }
+
+    const QString name = operation.firstKey();
+    const QVariantMap args = operation.first().toMap();
+    const TBson filter = TBson::toBson(args.value(FilterKey).toMap());
+    bson_t *opts = nullptr;
+    bool res = false;
+
+    if (args.contains(UpsertKey)) {
+        opts = BCON_NEW("upsert", BCON_BOOL(args.value(UpsertKey).toBool()));
+    }
+
+    if (name == QLatin1String("insertOne")) {
+        res = mongoc_bulk_operation_insert_with_opts(bulk, (bson_t *)TBson::toBson(args.value("document").toMap()).constData(), nullptr, error);
+    } else if (name == QLatin1String("updateOne")) {
+        res = mongoc_bulk_operation_update_one_with_opts(bulk, (bson_t *)filter.constData(), (bson_t *)TBson::toBson(args.value("update").toMap()).constData(), opts, error);
+    } else if (name == QLatin1String("updateMany")) {
+        res = mongoc_bulk_operation_update_many_with_opts(bulk, (bson_t *)filter.constData(), (bson_t *)TBson::toBson(args.value("update").toMap()).constData(), opts, error);
+    } else if (name == QLatin1String("replaceOne")) {
+        res = mongoc_bulk_operation_replace_one_with_opts(bulk, (bson_t *)filter.constData(), (bson_t *)TBson::toBson(args.value("replacement").toMap()).constData(), opts, error);
+    } else if (name == QLatin1String("deleteOne")) {
+        res = mongoc_bulk_operation_remove_one_with_opts(bulk, (bson_t *)filter.constData(), nullptr, error);
+    } else if (name == QLatin1String("deleteMany")) {
+        res = mongoc_bulk_operation_remove_many_with_opts(bulk, (bson_t *)filter.constData(), nullptr, error);
+    } else {
+        bson_set_error(error, MONGOC_ERROR_COMMAND, MONGOC_ERROR_COMMAND_INVALID_ARG, "Unknown bulk write operation: %s", qPrintable(name));
+    }
+
+    if (opts) {
+        bson_destroy(opts);
+    }
+    return res;
+}
+
+inline void recordQuery(TQueryProfiler &profiler, const char *operation, const QString &collection, qint64 rows, const QVariantMap &criteria)
+{
+    if (TQueryProfiler::isEnabled()) {
+        profiler.record(QLatin1String("mongodb.") + QLatin1String(operation) + QLatin1Char(' ') + collection, (int)rows, (criteria.isEmpty() ? QVariantList() : QVariantList({criteria})));
+    }
+}
+
+}
 
 
 TMongoDriver::TMongoDriver() :
@@ -61,13 +155,19 @@ bool TMongoDriver::open(const QString &db, const QString &user, const QString &p
         uri.prepend(QLatin1String("mongodb://"));
     }
 
-    // connect
-    mongoClient = mongoc_client_new(qPrintable(uri));
+    // Takes a client from the pool of the URI
+    clientPool = getClientPool(uri);
+    if (!clientPool) {
+        return false;
+    }
+
+    mongoClient = mongoc_client_pool_try_pop(clientPool);
     if (mongoClient) {
         dbName = db;
         serverVersionNumber(); // Gets server version
     } else {
-        tSystemError("MongoDB client create error. Connection URI: %s", qPrintable(uri));
+        tSystemError("MongoDB client pool exhausted. Connection URI: %s", qPrintable(uri));
+        clientPool = nullptr;
     }
     return (bool)mongoClient;
 }
@@ -76,8 +176,14 @@ bool TMongoDriver::open(const QString &db, const QString &user, const QString &p
 void TMongoDriver::close()
 {
     if (isOpen()) {
-        mongoc_client_destroy(mongoClient);
+        mongoCursor->release();
+        for (auto *col : collections) {
+            mongoc_collection_destroy(col);
+        }
+        collections.clear();
+        mongoc_client_pool_push(clientPool, mongoClient);
         mongoClient = nullptr;
+        clientPool = nullptr;
     }
 }
 
@@ -98,12 +204,13 @@ bool TMongoDriver::find(const QString &collection, const QVariantMap &criteria,
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
     if (!col) {
         tSystemError("MongoDB GetCollection Error");
         return false;
     }
 
+    TQueryProfiler profiler;
     bson_t *opts = BCON_NEW("skip", BCON_INT64((skip > 0) ? skip : 0));
     if (limit > 0) {
         bson_append_int64(opts, "limit", 5, limit);
@@ -138,7 +245,10 @@ bool TMongoDriver::find(const QString &collection, const QVariantMap &criteria,
         tSystemError("MongoDB Cursor Error");
     }
 
-    mongoc_collection_destroy(col);
+    if (cursor && TQueryProfiler::isEnabled()) {
+        // Recorded by the cursor, as the query is sent on the first fetch
+        mongoCursor->setProfile(QLatin1String("mongodb.find ") + collection, (criteria.isEmpty() ? QVariantList() : QVariantList({criteria})), profiler.elapsed());
+    }
     return (bool)cursor;
 }
 
@@ -165,11 +275,12 @@ bool TMongoDriver::insertOne(const QString &collection, const QVariantMap &objec
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
     bson_t rep;
+    TQueryProfiler profiler;
     bool res = mongoc_collection_insert_one(col, (bson_t *)TBson::toBson(object).constData(),
                                         nullptr, &rep, &error);
-    mongoc_collection_destroy(col);
+    recordQuery(profiler, "insertOne", collection, (res ? 1 : 0), QVariantMap());
 
     if (res) {
         if (reply) {
@@ -183,6 +294,124 @@ bool TMongoDriver::insertOne(const QString &collection, const QVariantMap &objec
 }
 
 
+/*!
+  Inserts the \a objects into the \a collection in a single round trip.
+  If \a ordered is true, the server stops inserting at the first error;
+  otherwise it goes on to insert the remaining documents.
+*/
+bool TMongoDriver::insertMany(const QString &collection, const QList<QVariantMap> &objects, bool ordered, QVariantMap *reply)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (objects.isEmpty()) {
+        if (reply) {
+            *reply = QVariantMap({{QStringLiteral("insertedCount"), 0}});
+        }
+        return true;
+    }
+
+    bson_error_t error;
+    clearError();
+
+    std::vector<TBson> bsons;
+    std::vector<const bson_t *> docs;
+    bsons.reserve(objects.count());
+    docs.reserve(objects.count());
+    for (const auto &obj : objects) {
+        bsons.emplace_back(TBson::toBson(obj));
+        docs.push_back((const bson_t *)bsons.back().constData());
+    }
+
+    mongoc_collection_t *col = getCollection(collection);
+    bson_t rep;
+    bson_t *opts = BCON_NEW("ordered", BCON_BOOL(ordered));
+    TQueryProfiler profiler;
+    bool res = mongoc_collection_insert_many(col, docs.data(), docs.size(), opts, &rep, &error);
+    bson_destroy(opts);
+    auto repmap = TBson::fromBson((TBsonObject*)&rep);
+    bson_destroy(&rep);
+    recordQuery(profiler, "insertMany", collection, repmap.value(QStringLiteral("insertedCount")).toLongLong(), QVariantMap());
+
+    if (reply) {
+        *reply = repmap;
+    }
+    if (!res) {
+        tSystemError("MongoDB InsertMany Error: %s", error.message);
+        setLastError(&error);
+    }
+    return res;
+}
+
+/*!
+  Executes the write \a operations on the \a collection as a bulk write.
+  Each operation is a map with a single key which names it, in the same
+  form as db.collection.bulkWrite() of the mongo shell:
+  \code
+  {"insertOne":  {"document": doc}}
+  {"updateOne":  {"filter": criteria, "update": doc, "upsert": bool}}
+  {"updateMany": {"filter": criteria, "update": doc, "upsert": bool}}
+  {"replaceOne": {"filter": criteria, "replacement": doc, "upsert": bool}}
+  {"deleteOne":  {"filter": criteria}}
+  {"deleteMany": {"filter": criteria}}
+  \endcode
+  If \a ordered is true, the operations are executed serially and the
+  execution stops at the first error; otherwise the remaining operations
+  are executed. The \a reply holds the nInserted, nMatched, nModified,
+  nRemoved, nUpserted and writeErrors fields.
+*/
+bool TMongoDriver::bulkWrite(const QString &collection, const QList<QVariantMap> &operations, bool ordered, QVariantMap *reply)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    if (reply) {
+        reply->clear();
+    }
+    if (operations.isEmpty()) {
+        return true;
+    }
+
+    bson_error_t error;
+    clearError();
+
+    mongoc_collection_t *col = getCollection(collection);
+    bson_t *opts = BCON_NEW("ordered", BCON_BOOL(ordered));
+    mongoc_bulk_operation_t *bulk = mongoc_collection_create_bulk_operation_with_opts(col, opts);
+    bson_destroy(opts);
+
+    bool res = true;
+    for (const auto &op : operations) {
+        if (!appendBulkOperation(bulk, op, &error)) {
+            res = false;
+            break;
+        }
+    }
+
+    if (res) {
+        bson_t rep;
+        TQueryProfiler profiler;
+        res = (mongoc_bulk_operation_execute(bulk, &rep, &error) != 0);
+        auto repmap = TBson::fromBson((TBsonObject*)&rep);
+        bson_destroy(&rep);
+        recordQuery(profiler, "bulkWrite", collection, operations.count(), QVariantMap());
+
+        if (reply) {
+            *reply = repmap;
+        }
+    }
+    mongoc_bulk_operation_destroy(bulk);
+
+    if (!res) {
+        tSystemError("MongoDB BulkWrite Error: %s", error.message);
+        setLastError(&error);
+    }
+    return res;
+}
+
+
 bool TMongoDriver::removeOne(const QString &collection, const QVariantMap &criteria, QVariantMap *reply)
 {
     if (!isOpen()) {
@@ -192,10 +421,11 @@ bool TMongoDriver::removeOne(const QString &collection, const QVariantMap &crite
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
     bson_t rep;
+    TQueryProfiler profiler;
     bool res = mongoc_collection_delete_one(col, (bson_t *)TBson::toBson(criteria).constData(), nullptr, &rep, &error);
-    mongoc_collection_destroy(col);
+    recordQuery(profiler, "removeOne", collection, -1, criteria);
 
     if (res) {
         if (reply) {
@@ -218,10 +448,11 @@ bool TMongoDriver::removeMany(const QString &collection, const QVariantMap &crit
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
     bson_t rep;
+    TQueryProfiler profiler;
     bool res = mongoc_collection_delete_many(col, (bson_t *)TBson::toBson(criteria).constData(), nullptr, &rep, &error);
-    mongoc_collection_destroy(col);
+    recordQuery(profiler, "removeMany", collection, -1, criteria);
 
     if (res) {
         if (reply) {
@@ -245,13 +476,14 @@ bool TMongoDriver::updateOne(const QString &collection, const QVariantMap &crite
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
     bson_t rep;
     bson_t *opts = BCON_NEW("upsert", BCON_BOOL(upsert));
+    TQueryProfiler profiler;
     bool res = mongoc_collection_update_one(col, (bson_t *)TBson::toBson(criteria).data(),
                                             (bson_t *)TBson::toBson(object).data(), opts, &rep, &error);
-    bson_free(opts);
-    mongoc_collection_destroy(col);
+    bson_destroy(opts);
+    recordQuery(profiler, "updateOne", collection, -1, criteria);
 
     if (res) {
         if (reply) {
@@ -274,13 +506,14 @@ bool TMongoDriver::updateMany(const QString &collection, const QVariantMap &crit
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
     bson_t rep;
     bson_t *opts = BCON_NEW("upsert", BCON_BOOL(upsert));
+    TQueryProfiler profiler;
     bool res = mongoc_collection_update_many(col, (bson_t *)TBson::toBson(criteria).data(),
                                             (bson_t *)TBson::toBson(object).data(), opts, &rep, &error);
-    bson_free(opts);
-    mongoc_collection_destroy(col);
+    bson_destroy(opts);
+    recordQuery(profiler, "updateMany", collection, -1, criteria);
 
     if (res) {
         if (reply) {
@@ -305,13 +538,14 @@ qint64 TMongoDriver::count(const QString &collection, const QVariantMap &criteri
     bson_error_t error;
     clearError();
 
-    mongoc_collection_t *col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+    mongoc_collection_t *col = getCollection(collection);
+    TQueryProfiler profiler;
 #if MONGOC_CHECK_VERSION(1,11,0)
     count = mongoc_collection_count_documents(col, (bson_t *)TBson::toBson(criteria).data(), nullptr, nullptr, nullptr, &error);
 #else
     count = mongoc_collection_count(col, MONGOC_QUERY_NONE, (bson_t *)TBson::toBson(criteria).data(), 0, 0, nullptr, &error);
 #endif
-    mongoc_collection_destroy(col);
+    recordQuery(profiler, "count", collection, count, criteria);
 
     if (count < 0) {
         tSystemError("MongoDB Count Error: %s", error.message);
@@ -321,6 +555,23 @@ qint64 TMongoDriver::count(const QString &collection, const QVariantMap &criteri
 }
 
 
+/*!
+  Returns the handle of the \a collection, which is cached until the
+  driver is closed.
+*/
+TMongoDriver::mongoc_collection_t *TMongoDriver::getCollection(const QString &collection)
+{
+    mongoc_collection_t *col = collections.value(collection);
+    if (!col) {
+        col = mongoc_client_get_collection(mongoClient, qPrintable(dbName), qPrintable(collection));
+        if (col) {
+            collections.insert(collection, col);
+        }
+    }
+    return col;
+}
+
+
 void TMongoDriver::clearError()
 {
     errorDomain = 0;
@@ -3,6 +3,7 @@
 
 #include <QStringList>
 #include <QVariant>
+#include <QHash>
 #include <TGlobal>
 #include <TKvsDriver>
 
@@ -25,12 +26,14 @@ public:
     QVariantMap findOne(const QString &collection, const QVariantMap &criteria,
                         const QStringList &projectFields = QStringList());
     bool insertOne(const QString &collection, const QVariantMap &object, QVariantMap *reply = nullptr);
+    bool insertMany(const QString &collection, const QList<QVariantMap> &objects, bool ordered = true, QVariantMap *reply = nullptr);
     bool updateOne(const QString &collection, const QVariantMap &criteria, const QVariantMap &object,
                 bool upsert = false, QVariantMap *reply = nullptr);
     bool updateMany(const QString &collection, const QVariantMap &criteria, const QVariantMap &object,
                     bool upsert = false, QVariantMap *reply = nullptr);
     bool removeOne(const QString &collection, const QVariantMap &criteria, QVariantMap *reply = nullptr);
     bool removeMany(const QString &collection, const QVariantMap &criteria, QVariantMap *reply = nullptr);
+    bool bulkWrite(const QString &collection, const QList<QVariantMap> &operations, bool ordered = true, QVariantMap *reply = nullptr);
     qint64 count(const QString &collection, const QVariantMap &criteria);
     int lastErrorDomain() const { return errorDomain; }
     int lastErrorCode() const { return errorCode; }
@@ -45,11 +48,16 @@ public:
 private:
     typedef struct _bson_error_t bson_error_t;
     typedef struct _mongoc_client_t mongoc_client_t;
+    typedef struct _mongoc_client_pool_t mongoc_client_pool_t;
+    typedef struct _mongoc_collection_t mongoc_collection_t;
 
+    mongoc_collection_t *getCollection(const QString &collection);
     void clearError();
     void setLastError(const bson_error_t *error);
 
+    mongoc_client_pool_t *clientPool {nullptr};
     mongoc_client_t *mongoClient {nullptr};
+    QHash<QString, mongoc_collection_t *> collections;
     TMongoCursor *mongoCursor {nullptr};
     QString dbName;
     int serverVerionNumber {-1};
@@ -73,6 +73,20 @@ void TMongoObject::setBsonData(const QVariantMap &bson)
 
 
 bool TMongoObject::create()
+{
+    TMongoQuery mongo(collectionName());
+    bool ret = mongo.insert(setCreationValues());
+    if (ret) {
+        syncToObject();  // '_id' reflected
+    }
+    return ret;
+}
+
+/*!
+  Sets the values of the timestamp and revision properties for a new
+  document, and returns the document to insert.
+*/
+QVariantMap &TMongoObject::setCreationValues()
 {
     // Sets the values of 'created_at', 'updated_at' or 'modified_at' properties
     for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
@@ -91,13 +105,7 @@ bool TMongoObject::create()
 
     syncToVariantMap();
     QVariantMap::remove("_id"); // remove _id to generate internally
-
-    TMongoQuery mongo(collectionName());
-    bool ret = mongo.insert(*this);
-    if (ret) {
-        syncToObject();  // '_id' reflected
-    }
-    return ret;
+    return *this;
 }
 
 
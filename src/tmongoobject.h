@@ -36,6 +36,11 @@ protected:
     void syncToVariantMap();
     void syncToObject();
     virtual QString &objectId() = 0;
+
+private:
+    QVariantMap &setCreationValues();
+
+    template <class T> friend class TMongoODMapper;
 };
 
 #endif // TMONGOOBJECT_H
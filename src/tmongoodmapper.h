@@ -48,6 +48,8 @@ public:
     int updateAll(const TCriteria &cri, int column, QVariant value);
     int updateAll(const TCriteria &cri, const QMap<int, QVariant> &values);
     int removeAll(const TCriteria &cri = TCriteria());
+    int createAll(QList<T> &objects, bool ordered = true);
+    int bulkWrite(QList<QVariantMap> &operations, bool ordered = true, QVariantMap *reply = nullptr);
 
 private:
     QString sortColumn;
@@ -306,4 +308,38 @@ inline int TMongoODMapper<T>::removeAll(const TCriteria &criteria)
     return TMongoQuery::remove(TCriteriaMongoConverter<T>(criteria).toVariantMap());
 }
 
+/*!
+  Inserts the \a objects into the collection in a single round trip and
+  returns the number of the objects inserted, or -1 if an error occurred.
+  The Object IDs are reflected to the \a objects on success.
+  \sa TMongoQuery::insertMany()
+*/
+template <class T>
+inline int TMongoODMapper<T>::createAll(QList<T> &objects, bool ordered)
+{
+    QList<QVariantMap> docs;
+    docs.reserve(objects.count());
+    for (auto &obj : objects) {
+        docs << obj.setCreationValues();
+    }
+
+    int cnt = TMongoQuery::insertMany(docs, ordered);
+    if (cnt >= 0) {
+        for (int i = 0; i < objects.count(); ++i) {
+            objects[i].setBsonData(docs[i]);  // '_id' reflected
+        }
+    }
+    return cnt;
+}
+
+/*!
+  Executes the write \a operations on the collection as a bulk write.
+  \sa TMongoQuery::bulkWrite()
+*/
+template <class T>
+inline int TMongoODMapper<T>::bulkWrite(QList<QVariantMap> &operations, bool ordered, QVariantMap *reply)
+{
+    return TMongoQuery::bulkWrite(operations, ordered, reply);
+}
+
 #endif // TMONGOODMAPPER_H
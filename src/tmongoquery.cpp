@@ -148,6 +148,86 @@ bool TMongoQuery::insert(QVariantMap &document)
     return (insertedCount == 1);
 }
 
+/*!
+  Inserts the \a documents into the collection in a single round trip
+  and returns the number of the documents inserted, or -1 if an error
+  occurred. If \a ordered is true, the insertion stops at the first
+  error; otherwise the remaining documents are inserted.
+*/
+int TMongoQuery::insertMany(QList<QVariantMap> &documents, bool ordered)
+{
+    int insertedCount = -1;
+
+    if (!_database.isValid()) {
+        tSystemError("TMongoQuery::insertMany : driver not loaded");
+        return insertedCount;
+    }
+
+    for (auto &doc : documents) {
+        if (!doc.contains(ObjectIdKey)) {
+            // Sets Object ID
+            doc.insert(ObjectIdKey, TBson::generateObjectId());
+        }
+    }
+
+    QVariantMap reply;
+    bool ret = driver()->insertMany(_collection, documents, ordered, &reply);
+    if (ret) {
+        insertedCount = reply.value(QStringLiteral("insertedCount")).toInt();
+    }
+    tSystemDebug("TMongoQuery::insertMany insertedCount:%d", insertedCount);
+    return insertedCount;
+}
+
+/*!
+  Executes the write \a operations on the collection as a bulk write and
+  returns the number of the documents inserted, upserted, modified and
+  removed, or -1 if an error occurred. The operations are in the same
+  form as db.collection.bulkWrite() of the mongo shell, and an Object ID
+  is set to the document of each insertOne operation which has none.
+  If \a ordered is true, the execution stops at the first error;
+  otherwise the remaining operations are executed. The whole result is
+  stored in \a reply if it is not null.
+  \sa TMongoDriver::bulkWrite()
+*/
+int TMongoQuery::bulkWrite(QList<QVariantMap> &operations, bool ordered, QVariantMap *reply)
+{
+    static const QString InsertOneKey("insertOne");
+    static const QString DocumentKey("document");
+
+    if (!_database.isValid()) {
+        tSystemError("TMongoQuery::bulkWrite : driver not loaded");
+        return -1;
+    }
+
+    for (auto &op : operations) {
+        auto it = op.find(InsertOneKey);
+        if (it != op.end()) {
+            QVariantMap args = it->toMap();
+            QVariantMap doc = args.value(DocumentKey).toMap();
+            if (!doc.contains(ObjectIdKey)) {
+                doc.insert(ObjectIdKey, TBson::generateObjectId());
+                args.insert(DocumentKey, doc);
+                *it = args;
+            }
+        }
+    }
+
+    QVariantMap rep;
+    bool res = driver()->bulkWrite(_collection, operations, ordered, &rep);
+    if (reply) {
+        *reply = rep;
+    }
+
+    int count = -1;
+    if (res) {
+        count = rep.value(QStringLiteral("nInserted")).toInt() + rep.value(QStringLiteral("nUpserted")).toInt()
+            + rep.value(QStringLiteral("nModified")).toInt() + rep.value(QStringLiteral("nRemoved")).toInt();
+    }
+    tSystemDebug("TMongoQuery::bulkWrite count:%d", count);
+    return count;
+}
+
 /*!
   Removes documents that matches the \a criteria from the collection.
 */
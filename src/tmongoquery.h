@@ -27,11 +27,13 @@ public:
     QVariantMap findOne(const QVariantMap &criteria = QVariantMap(), const QStringList &fields = QStringList());
     QVariantMap findById(const QString &id, const QStringList &fields = QStringList());
     bool insert(QVariantMap &document);
+    int insertMany(QList<QVariantMap> &documents, bool ordered = true);
     int update(const QVariantMap &criteria, const QVariantMap &document, bool upsert = false);
     bool updateById(const QVariantMap &document);
     int updateMulti(const QVariantMap &criteria, const QVariantMap &document);
     int remove(const QVariantMap &criteria);
     bool removeById(const QVariantMap &document);
+    int bulkWrite(QList<QVariantMap> &operations, bool ordered = true, QVariantMap *reply = nullptr);
     int count(const QVariantMap &criteria = QVariantMap());
     QString lastErrorString() const;
 
@@ -18,6 +18,12 @@
   \class TPaginator
   \brief The TPaginator class provides simple functionality for a pagination
   bar.
+
+  For keyset pagination, which doesn't need the total number of items,
+  set the cursors returned by TSqlORMapper::nextCursor() and
+  TSqlORMapper::previousCursor() with setNextCursor() and
+  setPreviousCursor(), and render the links by
+  TViewHelper::linkToNextCursor() and TViewHelper::linkToPreviousCursor().
 */
 
 /*!
@@ -43,7 +49,9 @@ TPaginator::TPaginator(const TPaginator &other) :
     _itemsPerPage(other._itemsPerPage),
     _midRange(other._midRange),
     _numPages(other._numPages),
-    _currentPage(other._currentPage)
+    _currentPage(other._currentPage),
+    _previousCursor(other._previousCursor),
+    _nextCursor(other._nextCursor)
 { }
 
 /*!
@@ -56,6 +64,8 @@ TPaginator &TPaginator::operator=(const TPaginator &other)
     _midRange = other._midRange;
     _numPages = other._numPages;
     _currentPage = other._currentPage;
+    _previousCursor = other._previousCursor;
+    _nextCursor = other._nextCursor;
     return *this;
 }
 
@@ -221,3 +231,39 @@ int TPaginator::currentPage() const
   \fn bool TPaginator::hasPage(int page) const
   Returns true if \a page is a valid page; otherwise returns false.
 */
+
+/*!
+  \fn void TPaginator::setPreviousCursor(const QByteArray &cursor)
+  Sets the cursor of keyset pagination pointing to the previous page to
+  \a cursor.
+  \sa TSqlORMapper::previousCursor()
+*/
+
+/*!
+  \fn void TPaginator::setNextCursor(const QByteArray &cursor)
+  Sets the cursor of keyset pagination pointing to the next page to
+  \a cursor.
+  \sa TSqlORMapper::nextCursor()
+*/
+
+/*!
+  \fn QByteArray TPaginator::previousCursor() const
+  Returns the cursor of keyset pagination pointing to the previous page.
+*/
+
+/*!
+  \fn QByteArray TPaginator::nextCursor() const
+  Returns the cursor of keyset pagination pointing to the next page.
+*/
+
+/*!
+  \fn bool TPaginator::hasPreviousCursor() const
+  Returns true if the cursor pointing to the previous page is set;
+  otherwise returns false.
+*/
+
+/*!
+  \fn bool TPaginator::hasNextCursor() const
+  Returns true if the cursor pointing to the next page is set;
+  otherwise returns false.
+*/
@@ -2,6 +2,7 @@
 #define TPAGINATOR_H
 
 #include <QList>
+#include <QByteArray>
 #include <TGlobal>
 
 
@@ -19,6 +20,8 @@ public:
     void setItemCountPerPage(int count);
     void setMidRange(int range);
     void setCurrentPage(int page);
+    void setPreviousCursor(const QByteArray &cursor) { _previousCursor = cursor; }
+    void setNextCursor(const QByteArray &cursor) { _nextCursor = cursor; }
 
     // Getter
     int itemTotalCount() const { return _itemsTotal; }
@@ -36,6 +39,10 @@ public:
     bool hasPrevious() const { return (currentPage() >= 2); }
     bool hasNext() const { return (currentPage() < _numPages); }
     bool hasPage(int page) const { return (page > 0 && page <= _numPages); }
+    QByteArray previousCursor() const { return _previousCursor; }
+    QByteArray nextCursor() const { return _nextCursor; }
+    bool hasPreviousCursor() const { return !_previousCursor.isEmpty(); }
+    bool hasNextCursor() const { return !_nextCursor.isEmpty(); }
 
 protected:
     void calculateNumPages();  // Internal use
@@ -46,6 +53,8 @@ private:
     int _midRange {5};
     int _numPages {1};
     int _currentPage {1};
+    QByteArray _previousCursor;
+    QByteArray _nextCursor;
 };
 
 Q_DECLARE_METATYPE(TPaginator)
@@ -9,6 +9,8 @@
 #include "tsystemglobal.h"
 #include "twebsocket.h"
 #include "tsystembus.h"
+#include "tpublisherredisbridge.h"
+#include "tsqlquerycache.h"
 #include <TWebApplication>
 #ifdef Q_OS_LINUX
 # include "tepollwebsocket.h"
@@ -110,6 +112,10 @@ TPublisher *TPublisher::instance()
     static TPublisher *globalInstance = []() {
         auto *pub = new TPublisher();
         connect(TSystemBus::instance(), SIGNAL(readyReceive()), pub, SLOT(receiveSystemBus()));
+        if (TPublisherRedisBridge::isEnabled()) {
+            connect(TPublisherRedisBridge::instance(), SIGNAL(received(int, const QString&, const QByteArray&)),
+                    pub, SLOT(receiveRedisBridge(int, const QString&, const QByteArray&)), Qt::QueuedConnection);
+        }
         return pub;
     }();
     return globalInstance;
@@ -197,7 +203,10 @@ QObject *TPublisher::castToObject(TAbstractWebSocket *socket)
 
 void TPublisher::publish(const QString &topic, const QString &text, TAbstractWebSocket *socket)
 {
-    if (Tf::app()->maxNumberOfAppServers() > 1) {
+    if (TPublisherRedisBridge::isEnabled()) {
+        // Delivered to all processes on all hosts through Redis
+        TPublisherRedisBridge::instance()->publish(Tf::WebSocketPublishText, topic, text.toUtf8());
+    } else if (Tf::app()->maxNumberOfAppServers() > 1) {
         TSystemBus::instance()->send(Tf::WebSocketPublishText, topic, text.toUtf8());
     }
 
@@ -211,7 +220,10 @@ void TPublisher::publish(const QString &topic, const QString &text, TAbstractWeb
 
 void TPublisher::publish(const QString &topic, const QByteArray &binary, TAbstractWebSocket *socket)
 {
-    if (Tf::app()->maxNumberOfAppServers() > 1) {
+    if (TPublisherRedisBridge::isEnabled()) {
+        // Delivered to all processes on all hosts through Redis
+        TPublisherRedisBridge::instance()->publish(Tf::WebSocketPublishBinary, topic, binary);
+    } else if (Tf::app()->maxNumberOfAppServers() > 1) {
         TSystemBus::instance()->send(Tf::WebSocketPublishBinary, topic, binary);
     }
 
@@ -249,6 +261,10 @@ void TPublisher::receiveSystemBus()
             }
             break; }
 
+        case Tf::SqlQueryCacheInvalidate:
+            TSqlQueryCache::updateGeneration(msg.target(), msg.data());
+            break;
+
         default:
             tSystemError("Internal Error  [%s:%d]", __FILE__, __LINE__);
             break;
@@ -257,6 +273,30 @@ void TPublisher::receiveSystemBus()
 }
 
 
+void TPublisher::receiveRedisBridge(int opcode, const QString &topic, const QByteArray &data)
+{
+    QMutexLocker locker(&mutex);
+    Pub *pub = get(topic);
+    if (!pub) {
+        return;
+    }
+
+    switch (opcode) {
+    case Tf::WebSocketPublishText:
+        pub->publish(QString::fromUtf8(data), nullptr);
+        break;
+
+    case Tf::WebSocketPublishBinary:
+        pub->publish(data, nullptr);
+        break;
+
+    default:
+        tSystemError("Internal Error  [%s:%d]", __FILE__, __LINE__);
+        break;
+    }
+}
+
+
 Pub *TPublisher::create(const QString &topic)
 {
     auto *pub = new Pub(topic);
@@ -29,6 +29,7 @@ protected:
 
 protected slots:
     void receiveSystemBus();
+    void receiveRedisBridge(int opcode, const QString &topic, const QByteArray &data);
 
 private:
     TPublisher();
@@ -0,0 +1,210 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tpublisherredisbridge.h"
+#include "tredisdriver.h"
+#include <TWebApplication>
+#include <TAppSettings>
+#include <QMutexLocker>
+
+constexpr auto CHANNEL_PREFIX = "treefrog.publish:";
+constexpr int ORIGIN_ID_LEN = 8;
+constexpr int ENVELOPE_HEADER_LEN = ORIGIN_ID_LEN + 1;  // origin id + opcode
+constexpr int MAX_BATCH_COMMANDS = 512;
+
+
+class TRedisSubscriber : public QThread
+{
+public:
+    TRedisSubscriber(TPublisherRedisBridge *bridge) : QThread(), bridge(bridge) { }
+    void stop() { stopped = true; wait(); }
+
+protected:
+    void run() override;
+
+private:
+    TPublisherRedisBridge *bridge {nullptr};
+    volatile bool stopped {false};
+};
+
+
+void TRedisSubscriber::run()
+{
+    TRedisDriver driver;
+    int backoff = 100;  // msecs
+
+    while (!stopped) {
+        if (!driver.isOpen()) {
+            QVariantList resp;
+            QByteArrayList command = { "PSUBSCRIBE", QByteArray(CHANNEL_PREFIX) + "*" };
+
+            if (!TPublisherRedisBridge::openDriver(&driver) || !driver.request(command, resp)) {
+                driver.close();
+                QThread::msleep(backoff);
+                backoff = qMin(backoff * 2, 5000);
+                continue;
+            }
+            tSystemDebug("Redis bridge subscribed");
+            backoff = 100;
+        }
+
+        // pmessage: [ "pmessage", pattern, channel, payload ]
+        QVariantList message;
+        if (driver.waitForMessage(message, 500)) {
+            if (message.count() == 4 && message[0].toByteArray() == "pmessage") {
+                bridge->dispatch(message[2].toByteArray(), message[3].toByteArray());
+            }
+        }
+    }
+    driver.close();
+}
+
+
+/*!
+  \class TPublisherRedisBridge
+  \brief The TPublisherRedisBridge class relays topics published by
+  TPublisher to other hosts through Redis PUBLISH/SUBSCRIBE.
+*/
+
+bool TPublisherRedisBridge::isEnabled()
+{
+    static const bool enabled = Tf::appSettings()->value(Tf::WebSocketRedisBridge, false).toBool()
+        && Tf::app()->isKvsAvailable(Tf::KvsEngine::Redis);
+    return enabled;
+}
+
+
+TPublisherRedisBridge *TPublisherRedisBridge::instance()
+{
+    static TPublisherRedisBridge *bridge = []() {
+        auto *bridge = new TPublisherRedisBridge();
+        bridge->writerThread.start();
+        bridge->subscriber->start();
+        return bridge;
+    }();
+    return bridge;
+}
+
+
+TPublisherRedisBridge::TPublisherRedisBridge() :
+    QObject(),
+    subscriber(new TRedisSubscriber(this))
+{
+    quint64 id = Tf::rand64_r();
+    originId = QByteArray((const char *)&id, ORIGIN_ID_LEN);
+    moveToThread(&writerThread);  // Writes in the writer thread
+}
+
+
+TPublisherRedisBridge::~TPublisherRedisBridge()
+{
+    subscriber->stop();
+    delete subscriber;
+    writerThread.quit();
+    writerThread.wait();
+    delete pubDriver;
+}
+
+
+/*!
+  Opens the \a driver with the settings of redis.ini, in the same way as
+  the connections of TKvsDatabasePool, including the post-open statements.
+*/
+bool TPublisherRedisBridge::openDriver(TRedisDriver *driver)
+{
+    const QVariantMap &settings = Tf::app()->kvsSettings(Tf::KvsEngine::Redis);
+    QString databaseName = settings.value("DatabaseName").toString().trimmed();
+    QString userName = settings.value("UserName").toString().trimmed();
+    QString password = settings.value("Password").toString().trimmed();
+    QString hostName = settings.value("HostName").toString().trimmed();
+    quint16 port = qMax(settings.value("Port").toInt(), 0);
+    QString connectOptions = settings.value("ConnectOptions").toString().trimmed();
+
+    if (!driver->open(databaseName, userName, password, hostName, port, connectOptions)) {
+        return false;
+    }
+
+    const QStringList postOpenStatements = settings.value("PostOpenStatements").toString().trimmed().split(";", QString::SkipEmptyParts);
+    for (auto &st : postOpenStatements) {
+        if (!driver->command(st.trimmed())) {
+            tSystemError("Redis bridge post-open statement error: %s  [%s:%d]", qPrintable(st), __FILE__, __LINE__);
+            driver->close();
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+  Queues the \a data published on the \a topic. Queued messages are sent
+  to Redis in one write by the writer thread.
+*/
+void TPublisherRedisBridge::publish(Tf::SystemOpCode opcode, const QString &topic, const QByteArray &data)
+{
+    QByteArray payload;
+    payload.reserve(ENVELOPE_HEADER_LEN + data.length());
+    payload += originId;
+    payload += (char)opcode;
+    payload += data;
+
+    QMutexLocker locker(&mutex);
+    queue << QByteArrayList({ "PUBLISH", QByteArray(CHANNEL_PREFIX) + topic.toUtf8(), payload });
+    if (queue.count() == 1) {
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+
+void TPublisherRedisBridge::flush()
+{
+    QList<QByteArrayList> commands;
+    {
+        QMutexLocker locker(&mutex);
+        commands.swap(queue);
+    }
+
+    if (commands.isEmpty()) {
+        return;
+    }
+
+    if (!pubDriver) {
+        pubDriver = new TRedisDriver;
+    }
+
+    if (!pubDriver->isOpen() && !openDriver(pubDriver)) {
+        tSystemError("Redis bridge open error, dropped %d messages  [%s:%d]", commands.count(), __FILE__, __LINE__);
+        return;
+    }
+
+    while (!commands.isEmpty()) {
+        QList<QVariantList> responses;
+        QList<QByteArrayList> batch = commands.mid(0, MAX_BATCH_COMMANDS);
+        commands = commands.mid(batch.count());
+
+        if (!pubDriver->request(batch, responses)) {
+            tSystemError("Redis bridge publish error  [%s:%d]", __FILE__, __LINE__);
+        }
+    }
+}
+
+
+void TPublisherRedisBridge::dispatch(const QByteArray &channel, const QByteArray &payload)
+{
+    if (payload.length() < ENVELOPE_HEADER_LEN || !channel.startsWith(CHANNEL_PREFIX)) {
+        tSystemError("Redis bridge invalid message  [%s:%d]", __FILE__, __LINE__);
+        return;
+    }
+
+    if (payload.startsWith(originId)) {
+        // Already delivered locally
+        return;
+    }
+
+    int opcode = (quint8)payload.at(ORIGIN_ID_LEN);
+    QString topic = QString::fromUtf8(channel.mid(qstrlen(CHANNEL_PREFIX)));
+    emit received(opcode, topic, payload.mid(ENVELOPE_HEADER_LEN));
+}
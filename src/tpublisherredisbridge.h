@@ -0,0 +1,49 @@
+#ifndef TPUBLISHERREDISBRIDGE_H
+#define TPUBLISHERREDISBRIDGE_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QList>
+#include <QByteArrayList>
+#include <TGlobal>
+#include "tsystemglobal.h"
+
+class TRedisDriver;
+class TRedisSubscriber;
+
+
+class T_CORE_EXPORT TPublisherRedisBridge : public QObject
+{
+    Q_OBJECT
+public:
+    ~TPublisherRedisBridge();
+    void publish(Tf::SystemOpCode opcode, const QString &topic, const QByteArray &data);
+
+    static bool isEnabled();
+    static TPublisherRedisBridge *instance();
+
+signals:
+    void received(int opcode, const QString &topic, const QByteArray &data);
+
+protected slots:
+    void flush();
+
+private:
+    TPublisherRedisBridge();
+    void dispatch(const QByteArray &channel, const QByteArray &payload);
+    static bool openDriver(TRedisDriver *driver);
+
+    QThread writerThread;
+    TRedisDriver *pubDriver {nullptr};
+    TRedisSubscriber *subscriber {nullptr};
+    QList<QByteArrayList> queue;
+    QMutex mutex {QMutex::NonRecursive};
+    QByteArray originId;
+
+    friend class TRedisSubscriber;
+    T_DISABLE_COPY(TPublisherRedisBridge)
+    T_DISABLE_MOVE(TPublisherRedisBridge)
+};
+
+#endif // TPUBLISHERREDISBRIDGE_H
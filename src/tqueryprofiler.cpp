@@ -0,0 +1,328 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tqueryprofiler.h"
+#include "tsqlasync.h"
+#include "tsystemglobal.h"
+#include <TAppSettings>
+#include <TWebApplication>
+#include <TActionContext>
+#include <TActionController>
+#include <TSqlQuery>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlRecord>
+#include <QJsonDocument>
+
+constexpr int MAX_STATEMENTS = 1000;
+constexpr int MAX_STATEMENT_LENGTH = 1024;
+constexpr auto OTHER_STATEMENTS = "(others)";
+
+namespace {
+QMap<QString, TQueryProfiler::Histogram> histogramMap;
+QMutex histogramMutex;
+
+
+QString controllerAction()
+{
+    try {
+        auto *controller = Tf::currentContext()->currentController();
+        if (controller) {
+            return controller->name() + QLatin1Char('#') + controller->activeAction();
+        }
+    } catch (...) { }  // not an action thread
+    return QStringLiteral("-");
+}
+
+
+QString paramsToString(const QVariantList &params)
+{
+    QStringList list;
+    for (auto &p : params) {
+        switch (p.type()) {
+        case QVariant::Map:
+        case QVariant::List:
+            list << QString::fromUtf8(QJsonDocument::fromVariant(p).toJson(QJsonDocument::Compact));
+            break;
+        default:
+            list << p.toString();
+            break;
+        }
+    }
+    return QLatin1Char('[') + list.join(QLatin1String(", ")) + QLatin1Char(']');
+}
+
+
+QString explainPrefix(int databaseId)
+{
+    QString driver = Tf::app()->sqlDatabaseSettings(databaseId).value("DriverType").toString().trimmed().toUpper();
+    if (driver.startsWith(QLatin1String("QSQLITE"))) {
+        return QStringLiteral("EXPLAIN QUERY PLAN ");
+    }
+    if (driver.startsWith(QLatin1String("QPSQL")) || driver.startsWith(QLatin1String("QMYSQL"))) {
+        return QStringLiteral("EXPLAIN ");
+    }
+    return QString();  // not supported
+}
+
+
+void explain(const QString &statement, const QVariantList &params, int databaseId)
+{
+    QString prefix = explainPrefix(databaseId);
+    if (prefix.isEmpty()) {
+        return;
+    }
+
+    TSqlAsync::post([statement, params, prefix, databaseId]() {
+        TSqlQuery query(databaseId);
+        query.prepare(prefix + statement);
+        for (auto &p : params) {
+            query.addBind(p);
+        }
+
+        if (!query.exec()) {
+            Tf::writeSlowQueryLog(QLatin1String("EXPLAIN failed: ") + query.lastError().text() + QLatin1String(" | ") + statement);
+            return;
+        }
+
+        QString plan = QLatin1String("Plan: ") + statement;
+        while (query.next()) {
+            QSqlRecord rec = query.record();
+            QStringList cols;
+            for (int i = 0; i < rec.count(); ++i) {
+                cols << rec.value(i).toString();
+            }
+            plan += QLatin1String("\n    ") + cols.join(QLatin1String(" | "));
+        }
+        Tf::writeSlowQueryLog(plan);
+    });
+}
+}
+
+/*!
+  \class TQueryProfiler
+  \brief The TQueryProfiler class measures the duration of a query with
+  a monotonic clock, keeps the latency histograms per normalized
+  statement, and writes the slow queries to the slow query log.
+
+  \code
+  TQueryProfiler profiler;
+  bool ret = query.exec(statement);
+  profiler.record(statement, query.numRowsAffected());
+  \endcode
+
+  The profiling is enabled by the SqlQuerySlowLogFile setting, and the
+  threshold is specified by SqlQuerySlowLogThreshold in milliseconds.
+*/
+
+/*!
+  Records the duration elapsed since the construction of the \a statement
+  which has retrieved or affected \a rows rows, with the bound parameters
+  \a params. If the duration exceeds the threshold, the statement is
+  written to the slow query log, and its execution plan is captured if the
+  SqlQuerySlowLogExplain setting is true and the SQL database \a databaseId
+  is specified.
+*/
+void TQueryProfiler::record(const QString &statement, int rows, const QVariantList &params, int databaseId)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    recordDuration(elapsed(), statement, rows, params, databaseId);
+}
+
+/*!
+  Records the duration \a usecs in microseconds of the \a statement, for
+  a query whose time is not measured by a single profiler, such as a
+  cursor fetching its results in batches.
+  \sa record()
+*/
+void TQueryProfiler::recordDuration(qint64 usecs, const QString &statement, int rows, const QVariantList &params, int databaseId)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    static const bool explainEnabled = Tf::appSettings()->value(Tf::SqlQuerySlowLogExplain, false).toBool();
+    const bool slow = usecs >= slowQueryThreshold() * 1000LL;
+    const QString normalized = normalize(statement);
+    bool needsPlan = false;
+
+    {
+        QMutexLocker locker(&histogramMutex);
+        auto it = histogramMap.find(normalized);
+        if (it == histogramMap.end()) {
+            if (histogramMap.count() < MAX_STATEMENTS) {
+                it = histogramMap.insert(normalized, Histogram());
+            } else {
+                // Shares one histogram among the statements over the limit
+                it = histogramMap.find(QLatin1String(OTHER_STATEMENTS));
+                if (it == histogramMap.end()) {
+                    it = histogramMap.insert(QLatin1String(OTHER_STATEMENTS), Histogram());
+                }
+            }
+        }
+
+        Histogram &hist = it.value();
+        hist.count++;
+        hist.totalTime += usecs;
+        hist.maxTime = qMax(hist.maxTime, usecs);
+        hist.buckets[bucketIndex(usecs)]++;
+
+        if (slow && explainEnabled && databaseId >= 0 && databaseId < Tf::app()->sqlDatabaseSettingsCount() && !hist.explained
+            && statement.trimmed().startsWith(QLatin1String("SELECT"), Qt::CaseInsensitive)) {
+            hist.explained = true;  // once per statement
+            needsPlan = true;
+        }
+    }
+
+    if (slow) {
+        QString msg = QString("%1 ms | rows: %2 | %3 | %4").arg(usecs / 1000.0, 0, 'f', 3).arg(rows).arg(controllerAction(), statement);
+        if (!params.isEmpty()) {
+            msg += QLatin1String(" | params: ") + paramsToString(params);
+        }
+        Tf::writeSlowQueryLog(msg);
+
+        if (needsPlan) {
+            explain(statement, params, databaseId);
+        }
+    }
+}
+
+/*!
+  Returns true if the query profiling is enabled; otherwise returns false.
+*/
+bool TQueryProfiler::isEnabled()
+{
+    return Tf::isSlowQueryLogEnabled();
+}
+
+/*!
+  Returns the threshold in milliseconds of the duration of a slow query.
+*/
+int TQueryProfiler::slowQueryThreshold()
+{
+    static const int threshold = Tf::appSettings()->value(Tf::SqlQuerySlowLogThreshold, 1000).toInt();
+    return threshold;
+}
+
+/*!
+  Returns the normalized \a statement, in which the string and numeric
+  literals are replaced with '?', the lists of them are folded and the
+  whitespaces are collapsed, so that the statements which differ only in
+  their values share a histogram.
+*/
+QString TQueryProfiler::normalize(const QString &statement)
+{
+    QString ret;
+    ret.reserve(qMin(statement.length(), MAX_STATEMENT_LENGTH));
+
+    auto isIdentChar = [](QChar c) {
+        return c.isLetterOrNumber() || c == QLatin1Char('_') || c == QLatin1Char('$');
+    };
+
+    auto appendValue = [&ret]() {
+        // Folds a list of values, such as "IN (?, ?, ?)", into "IN (?...)"
+        int n = ret.endsWith(QLatin1String(", ")) ? 2 : (ret.endsWith(QLatin1Char(',')) ? 1 : 0);
+        if (n > 0) {
+            QStringRef prev = ret.leftRef(ret.length() - n);
+            if (prev.endsWith(QLatin1Char('?')) || prev.endsWith(QLatin1String("..."))) {
+                ret.chop(n);
+                if (!ret.endsWith(QLatin1String("..."))) {
+                    ret += QLatin1String("...");
+                }
+                return;
+            }
+        }
+        ret += QLatin1Char('?');
+    };
+
+    const int len = statement.length();
+    for (int i = 0; i < len && ret.length() < MAX_STATEMENT_LENGTH; ++i) {
+        const QChar c = statement[i];
+
+        if (c == QLatin1Char('\'')) {
+            // String literal
+            for (++i; i < len; ++i) {
+                if (statement[i] == QLatin1Char('\'')) {
+                    if (i + 1 < len && statement[i + 1] == QLatin1Char('\'')) {
+                        ++i;  // escaped quote
+                    } else {
+                        break;
+                    }
+                }
+            }
+            appendValue();
+
+        } else if (c.isDigit() && (ret.isEmpty() || !isIdentChar(ret.at(ret.length() - 1)))) {
+            // Numeric literal
+            while (i + 1 < len && (statement[i + 1].isLetterOrNumber() || statement[i + 1] == QLatin1Char('.'))) {
+                ++i;
+            }
+            appendValue();
+
+        } else if (c == QLatin1Char('?')) {
+            appendValue();
+
+        } else if (c.isSpace()) {
+            if (!ret.isEmpty() && !ret.endsWith(QLatin1Char(' '))) {
+                ret += QLatin1Char(' ');
+            }
+
+        } else {
+            ret += c;
+        }
+    }
+    return ret.trimmed();
+}
+
+/*!
+  Returns the index of the histogram bucket for the duration \a usecs.
+*/
+int TQueryProfiler::bucketIndex(qint64 usecs)
+{
+    qint64 msecs = usecs / 1000;
+    int idx = 0;
+    while (msecs > 0 && idx < Histogram::BucketCount - 1) {
+        msecs >>= 1;
+        ++idx;
+    }
+    return idx;
+}
+
+/*!
+  Returns the latency histograms keyed by the normalized statements.
+*/
+QMap<QString, TQueryProfiler::Histogram> TQueryProfiler::histograms()
+{
+    QMutexLocker locker(&histogramMutex);
+    return histogramMap;
+}
+
+/*!
+  Writes the latency histograms to the slow query log.
+*/
+void TQueryProfiler::writeHistograms()
+{
+    const auto hists = histograms();
+    for (auto it = hists.begin(); it != hists.end(); ++it) {
+        const Histogram &hist = it.value();
+        QString msg = QString("Histogram: count: %1 | avg: %2 ms | max: %3 ms | buckets:").arg(hist.count).arg(hist.totalTime / 1000.0 / qMax(hist.count, (quint64)1), 0, 'f', 3).arg(hist.maxTime / 1000.0, 0, 'f', 3);
+
+        for (int i = 0; i < Histogram::BucketCount; ++i) {
+            if (hist.buckets[i] > 0) {
+                if (i < Histogram::BucketCount - 1) {
+                    msg += QString(" <%1ms:%2").arg(1 << i).arg(hist.buckets[i]);
+                } else {
+                    msg += QString(" >=%1ms:%2").arg(1 << (i - 1)).arg(hist.buckets[i]);
+                }
+            }
+        }
+        msg += QLatin1String(" | ") + it.key();
+        Tf::writeSlowQueryLog(msg);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef TQUERYPROFILER_H
+#define TQUERYPROFILER_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QString>
+#include <QVariant>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TQueryProfiler
+{
+public:
+    struct Histogram {
+        enum { BucketCount = 16 };
+        quint64 count {0};
+        qint64 totalTime {0};  // usecs
+        qint64 maxTime {0};  // usecs
+        quint64 buckets[BucketCount] {0};  // upper bounds: 1, 2, 4, .. 16384 ms and infinity
+        bool explained {false};
+    };
+
+    TQueryProfiler();
+
+    qint64 elapsed() const;
+    void record(const QString &statement, int rows, const QVariantList &params = QVariantList(), int databaseId = -1);
+
+    static void recordDuration(qint64 usecs, const QString &statement, int rows, const QVariantList &params = QVariantList(), int databaseId = -1);
+    static bool isEnabled();
+    static int slowQueryThreshold();
+    static QString normalize(const QString &statement);
+    static int bucketIndex(qint64 usecs);
+    static QMap<QString, Histogram> histograms();
+    static void writeHistograms();
+
+private:
+    QElapsedTimer timer;
+
+    T_DISABLE_COPY(TQueryProfiler)
+    T_DISABLE_MOVE(TQueryProfiler)
+};
+
+
+inline TQueryProfiler::TQueryProfiler()
+{
+    timer.start();
+}
+
+/*!
+  Returns the number of microseconds elapsed since the profiler was
+  constructed, measured with a monotonic clock.
+*/
+inline qint64 TQueryProfiler::elapsed() const
+{
+    return timer.nsecsElapsed() / 1000;
+}
+
+#endif // TQUERYPROFILER_H
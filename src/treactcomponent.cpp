@@ -12,6 +12,9 @@
 //#define tSystemError(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
 //#define tSystemDebug(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
 
+// Interval in msecs to check if the module file is modified
+static const qint64 ModifiedCheckInterval = 1000;
+
 
 TReactComponent::TReactComponent(const QString &moduleName, const QStringList &searchPaths)
     : jsLoader(new TJSLoader(moduleName, TJSLoader::Jsx)), loadedTime()
@@ -24,6 +27,12 @@ TReactComponent::TReactComponent(const QString &moduleName, const QStringList &s
 }
 
 
+TReactComponent::~TReactComponent()
+{
+    delete jsLoader;
+}
+
+
 void TReactComponent::import(const QString &moduleName)
 {
     jsLoader->import(moduleName);
@@ -40,21 +49,19 @@ QString TReactComponent::renderToString(const QString &component)
 {
     auto *context = jsLoader->load();
 
-    if (loadedTime.isNull()) {
-        loadedTime = QDateTime::currentDateTime();
-    } else {
-        if (context) {
-            QFileInfo fi(context->modulePath());
-            if (context->modulePath().isEmpty() || (fi.exists() && fi.lastModified() > loadedTime)) {
-                context = jsLoader->load(true);
-                loadedTime = QDateTime::currentDateTime();
-            }
+    // Checks the modification of the module file at most once per interval
+    if (context && (!context->modifiedCheckTimer.isValid() || context->modifiedCheckTimer.hasExpired(ModifiedCheckInterval))) {
+        context->modifiedCheckTimer.start();
+        QFileInfo fi(context->modulePath());
+        if (context->modulePath().isEmpty() || (fi.exists() && fi.lastModified() > context->loadedTime)) {
+            context = jsLoader->load(true);
         }
     }
 
     if (!context) {
         return QString();
     }
+    loadedTime = context->loadedTime;
 
     QString func = QLatin1String("ReactDOMServer.renderToString(") + TJSLoader::compileJsx(component) + QLatin1String(");");
     tSystemDebug("TReactComponent func: %s", qPrintable(func));
@@ -12,7 +12,7 @@ class T_CORE_EXPORT TReactComponent
 {
 public:
     TReactComponent(const QString &moduleName, const QStringList &searchPaths = QStringList());
-    virtual ~TReactComponent() { }
+    virtual ~TReactComponent();
 
     void import(const QString &moduleName);
     void import(const QString &defaultMember, const QString &moduleName);
@@ -107,10 +107,10 @@ QByteArray TRedis::get(const QByteArray &key)
         return QByteArray();
     }
 
-    QVariantList resp;
+    QByteArrayList resp;
     QByteArrayList command = { "GET", key };
     bool res = driver()->request(command, resp);
-    return (res) ? resp.value(0).toByteArray() : QByteArray();
+    return (res) ? resp.value(0) : QByteArray();
 }
 
 /*!
@@ -170,10 +170,10 @@ QByteArray TRedis::getSet(const QByteArray &key, const QByteArray &value)
         return QByteArray();
     }
 
-    QVariantList resp;
+    QByteArrayList resp;
     QByteArrayList command = { "GETSET", key, value };
     bool res = driver()->request(command, resp);
-    return (res) ? resp.value(0).toByteArray() : QByteArray();
+    return (res) ? resp.value(0) : QByteArray();
 }
 
 /*!
@@ -204,6 +204,87 @@ int TRedis::del(const QByteArrayList &keys)
     return (res) ? resp.value(0).toInt() : 0;
 }
 
+/*!
+  Returns the values of all the specified \a keys. For every key that
+  does not hold a value, a null byte array is returned.
+ */
+QByteArrayList TRedis::mget(const QByteArrayList &keys)
+{
+    QByteArrayList ret;
+    if (!driver() || keys.isEmpty()) {
+        return ret;
+    }
+
+    QByteArrayList command = { "MGET" };
+    command << keys;
+    driver()->request(command, ret);
+    return ret;
+}
+
+/*!
+  Sets the given keys to their respective \a values in one command.
+ */
+bool TRedis::mset(const QMap<QByteArray, QByteArray> &values)
+{
+    if (!driver() || values.isEmpty()) {
+        return false;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = { "MSET" };
+    command.reserve(values.count() * 2 + 1);
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        command << it.key() << it.value();
+    }
+    return driver()->request(command, resp);
+}
+
+/*!
+  Sets a timeout on the \a key in \a seconds. Returns true if the timeout
+  was set; returns false if the key does not exist.
+ */
+bool TRedis::expire(const QByteArray &key, int seconds)
+{
+    if (!driver()) {
+        return false;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = { "EXPIRE", key, QByteArray::number(seconds) };
+    bool res = driver()->request(command, resp);
+    return (res && resp.value(0).toInt() == 1);
+}
+
+/*!
+  Increments the number stored at the \a key by the \a increment and
+  returns the value after the increment.
+ */
+qint64 TRedis::incrBy(const QByteArray &key, qint64 increment)
+{
+    if (!driver()) {
+        return 0;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = { "INCRBY", key, QByteArray::number(increment) };
+    bool res = driver()->request(command, resp);
+    return (res) ? resp.value(0).toLongLong() : 0;
+}
+
+/*!
+  Sends all the \a commands in one write and receives their replies into
+  the \a responses. Returns false if any of the commands fails.
+  \sa TRedisPipeline
+ */
+bool TRedis::request(const QList<QByteArrayList> &commands, QList<QVariantList> &responses)
+{
+    if (!driver()) {
+        responses.clear();
+        return false;
+    }
+    return driver()->request(commands, responses);
+}
+
 /*!
   Inserts all the \a values at the tail of the list stored at the \a key.
   Returns the length of the list after the push operation.
@@ -248,14 +329,8 @@ QByteArrayList TRedis::lrange(const QByteArray &key, int start, int end = -1)
     }
 
     QByteArrayList ret;
-    QVariantList resp;
     QByteArrayList command = { "LRANGE", key, QByteArray::number(start), QByteArray::number(end) };
-    bool res = driver()->request(command, resp);
-    if (res) {
-        for (auto &var : (const QVariantList&)resp) {
-            ret << var.toByteArray();
-        }
-    }
+    driver()->request(command, ret);
     return ret;
 }
 
@@ -268,10 +343,10 @@ QByteArray TRedis::lindex(const QByteArray &key, int index)
         return QByteArray();
     }
 
-    QVariantList resp;
+    QByteArrayList resp;
     QByteArrayList command = { "LINDEX", key, QByteArray::number(index) };
     bool res = driver()->request(command, resp);
-    return (res) ? resp.value(0).toByteArray() : QByteArray();
+    return (res) ? resp.value(0) : QByteArray();
 }
 
 /*!
@@ -342,10 +417,10 @@ QByteArray TRedis::hget(const QByteArray &key, const QByteArray &field)
         return QByteArray();
     }
 
-    QVariantList resp;
+    QByteArrayList resp;
     QByteArrayList command = { "HGET", key, field };
     bool res = driver()->request(command, resp);
-    return (res) ? resp.value(0).toByteArray() : QByteArray();
+    return (res) ? resp.value(0) : QByteArray();
 }
 
 
@@ -404,23 +479,37 @@ QList<QPair<QByteArray, QByteArray>> TRedis::hgetAll(const QByteArray &key)
         return ret;
     }
 
-    QVariantList resp;
+    QByteArrayList resp;
     QByteArrayList command = { "HGETALL", key };
     bool res = driver()->request(command, resp);
     if (res) {
-        for (QListIterator<QVariant> it(resp); it.hasNext(); ) {
-            QByteArray f = it.next().toByteArray();
-            if (!it.hasNext()) {
-                break;
-            }
-            QByteArray v = it.next().toByteArray();
-            ret << qMakePair(f, v);
+        ret.reserve(resp.count() / 2);
+        for (int i = 0; i + 1 < resp.count(); i += 2) {
+            ret << qMakePair(resp[i], resp[i + 1]);
         }
     }
     return ret;
 }
 
 
+/*!
+  Returns the values associated with the \a fields in the hash stored
+  at the \a key.
+ */
+QByteArrayList TRedis::hmget(const QByteArray &key, const QByteArrayList &fields)
+{
+    QByteArrayList ret;
+    if (!driver() || fields.isEmpty()) {
+        return ret;
+    }
+
+    QByteArrayList command = { "HMGET", key };
+    command << fields;
+    driver()->request(command, ret);
+    return ret;
+}
+
+
 void TRedis::flushDb()
 {
     if (!driver()) {
@@ -7,6 +7,7 @@
 #include <QVariant>
 #include <QByteArray>
 #include <QStringList>
+#include <QMap>
 
 class TRedisDriver;
 
@@ -38,6 +39,12 @@ public:
     bool del(const QByteArray &key);
     int del(const QByteArrayList &keys);
 
+    // multiple keys
+    QByteArrayList mget(const QByteArrayList &keys);
+    bool mset(const QMap<QByteArray, QByteArray> &values);
+    bool expire(const QByteArray &key, int seconds);
+    qint64 incrBy(const QByteArray &key, qint64 increment);
+
     // binary list
     int rpush(const QByteArray &key, const QByteArrayList &values);
     int lpush(const QByteArray &key, const QByteArrayList &values);
@@ -63,6 +70,10 @@ public:
     int hdel(const QByteArray &key, const QByteArrayList &fields);
     int hlen(const QByteArray &key);
     QList<QPair<QByteArray, QByteArray>> hgetAll(const QByteArray &key);
+    QByteArrayList hmget(const QByteArray &key, const QByteArrayList &fields);
+
+    // pipeline
+    bool request(const QList<QByteArrayList> &commands, QList<QVariantList> &responses);
 
     void flushDb();
 
@@ -77,6 +88,7 @@ private:
     TKvsDatabase database;
 
     friend class TCacheRedisStore;
+    friend class TRedisPipeline;
 };
 
 
@@ -7,8 +7,14 @@
 
 #include "tredisdriver.h"
 #include "tsystemglobal.h"
+#include <QStringList>
+#include <QVarLengthArray>
+#include <cstring>
 using namespace Tf;
 
+constexpr int MAX_RETAINED_BUFFER_SIZE = 1024 * 1024;
+constexpr int DEFAULT_CONNECT_TIMEOUT = 1000;  // msecs
+
 
 bool TRedisDriver::command(const QString &cmd)
 {
@@ -19,6 +25,16 @@ bool TRedisDriver::command(const QString &cmd)
 }
 
 
+/*!
+  Sends a PING command and returns true if the server replies.
+*/
+bool TRedisDriver::ping()
+{
+    QVariantList response;
+    return isOpen() && request({"PING"}, response);
+}
+
+
 bool TRedisDriver::request(const QByteArrayList &command, QVariantList &response)
 {
     if (Q_UNLIKELY(!isOpen())) {
@@ -26,227 +42,501 @@ bool TRedisDriver::request(const QByteArrayList &command, QVariantList &response
         return false;
     }
 
-    bool ret = true;
-    bool ok = false;
-    QByteArray str;
-
-    QByteArray cmd = toMultiBulk(command);
-    tSystemDebug("Redis command: %s", cmd.data());
-    if (! writeCommand(cmd)) {
-        tSystemError("Redis write error  [%s:%d]", __FILE__, __LINE__);
-        close();
+    _sendBuffer.resize(0);
+    appendCommand(_sendBuffer, command);
+    tSystemDebug("Redis command: %s", _sendBuffer.data());
+    if (! flushCommands()) {
         return false;
     }
+
+    bool ret = readResponse(response);
+    if (isOpen() && _pos < _buffer.length()) {
+        tSystemError("Invalid format  [%s:%d]", __FILE__, __LINE__);
+    }
     clearBuffer();
+    return ret;
+}
 
-    for (;;) {
-        if (! readReply()) {
-            tSystemError("Redis read error   pos:%d  buflen:%d", _pos, _buffer.length());
-            close();
-            break;
-        }
+/*!
+  Sends the \a command and stores the strings of the reply in \a response
+  without converting them to QVariant. Elements of nested arrays are
+  flattened, and a null element is stored as a null byte array.
+*/
+bool TRedisDriver::request(const QByteArrayList &command, QByteArrayList &response)
+{
+    response.clear();
 
-        switch (_buffer.at(_pos)) {
+    if (Q_UNLIKELY(!isOpen())) {
+        tSystemError("Not open Redis session  [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    _sendBuffer.resize(0);
+    appendCommand(_sendBuffer, command);
+    tSystemDebug("Redis command: %s", _sendBuffer.data());
+    if (! flushCommands()) {
+        return false;
+    }
+
+    bool ret = readElements();
+    if (ret) {
+        const Element &reply = _elements.first();
+        switch (reply.type) {
         case Error:
+        case BulkError:
+            tSystemError("Redis error response: %s", toByteArray(_buffer, reply).data());
             ret = false;
-            str = getLine(&ok);
-            tSystemError("Redis error response: %s", qPrintable(str));
             break;
 
         case SimpleString:
-            str = getLine(&ok);
-            tSystemDebug("Redis response: %s", qPrintable(str));
+            tSystemDebug("Redis response: %s", toByteArray(_buffer, reply).data());
             break;
 
-        case Integer: {
-            _pos++;
-            int num = getNumber(&ok);
-            if (ok) {
-                response << num;
-            }
-            break; }
-
-        case BulkString:
-            str = parseBulkString(&ok);
-            if (ok) {
-                response << str;
+        default:
+            response.reserve(_elements.count());
+            for (auto &e : (const QVector<Element> &)_elements) {
+                switch (e.type) {
+                case Array:
+                case Map:
+                case Set:
+                case Push:
+                    break;
+                default:
+                    response << toByteArray(_buffer, e);
+                    break;
+                }
             }
             break;
+        }
 
-        case Array:
-            response = parseArray(&ok);
-            if (!ok) {
-                response.clear();
-            }
-            break;
+        if (_pos < _buffer.length()) {
+            tSystemError("Invalid format  [%s:%d]", __FILE__, __LINE__);
+        }
+    }
+    clearBuffer();
+    return ret;
+}
 
-        default:
-            tSystemError("Invalid protocol: %c  [%s:%d]", _buffer.at(_pos), __FILE__, __LINE__);
+/*!
+  Sends all the \a commands in one write and reads their replies into
+  \a responses in order. Returns false if any of the commands fails.
+*/
+bool TRedisDriver::request(const QList<QByteArrayList> &commands, QList<QVariantList> &responses)
+{
+    responses.clear();
+
+    if (Q_UNLIKELY(!isOpen())) {
+        tSystemError("Not open Redis session  [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    if (commands.isEmpty()) {
+        return true;
+    }
+
+    _sendBuffer.resize(0);
+    for (auto &command : commands) {
+        appendCommand(_sendBuffer, command);
+    }
+
+    tSystemDebug("Redis pipelined commands: %d", commands.count());
+    if (! flushCommands()) {
+        return false;
+    }
+
+    bool ret = true;
+    responses.reserve(commands.count());
+    for (int i = 0; i < commands.count(); i++) {
+        QVariantList response;
+        ret &= readResponse(response);
+        if (!isOpen()) {
+            responses.clear();
             ret = false;
-            clearBuffer();
-            close();
-            goto parse_done;
             break;
         }
+        responses << response;
+    }
+    clearBuffer();
+    return ret;
+}
 
-        if (ok) {
-            if (_pos < _buffer.length()) {
-                tSystemError("Invalid format  [%s:%d]", __FILE__, __LINE__);
-            }
-            clearBuffer();
-            break;
+/*!
+  Waits at most \a msecs milliseconds for a message pushed by the server,
+  such as a pub/sub message, and stores it in \a message. Returns true
+  if a message has been received.
+*/
+bool TRedisDriver::waitForMessage(QVariantList &message, int msecs)
+{
+    message.clear();
+
+    if (Q_UNLIKELY(!isOpen())) {
+        return false;
+    }
+
+    if (_pos >= _buffer.length()) {
+        clearBuffer();
+        if (!waitForReadyRead(msecs)) {
+            return false;
         }
+    }
 
-        _pos = 0;
-        // retry to read..
+    bool ret = readResponse(message);
+    if (_pos >= _buffer.length()) {
+        clearBuffer();
     }
+    return ret && isOpen();
+}
 
-parse_done:
+/*!
+  Writes the commands stored in the send buffer.
+*/
+bool TRedisDriver::flushCommands()
+{
+    bool ret = writeCommand(_sendBuffer);
+    if (! ret) {
+        tSystemError("Redis write error  [%s:%d]", __FILE__, __LINE__);
+        close();
+    }
+    clearBuffer();
     return ret;
 }
 
+/*!
+  Parses one reply at the current position of the buffer into the
+  element list, receiving data from the socket as necessary.
+*/
+bool TRedisDriver::readElements()
+{
+    for (;;) {
+        if (_pos < _buffer.length()) {
+            bool ok;
+            if (! parseElements(_buffer, _pos, _elements, &ok)) {
+                tSystemError("Invalid protocol: %c  [%s:%d]", _buffer.at(_pos), __FILE__, __LINE__);
+                clearBuffer();
+                close();
+                return false;
+            }
+
+            if (ok) {
+                return true;
+            }
+        }
+
+        if (! readReply()) {
+            tSystemError("Redis read error   pos:%d  buflen:%d", _pos, _buffer.length());
+            close();
+            return false;
+        }
+    }
+}
 
-QByteArray TRedisDriver::getLine(bool *ok)
+/*!
+  Reads one reply at the current position of the buffer. The elements of
+  an array reply are stored in \a response, and other replies are stored
+  as one element.
+*/
+bool TRedisDriver::readResponse(QVariantList &response)
 {
-    int idx = _buffer.indexOf(CRLF, _pos);
-    if (idx < 0) {
-        *ok = false;
-        return QByteArray();
+    response.clear();
+
+    if (! readElements()) {
+        return false;
     }
 
-    QByteArray ret = _buffer.mid(_pos, idx);
-    _pos = idx + 2;
-    *ok = true;
-    return ret;
+    const Element &reply = _elements.first();
+    int index = 0;
+
+    switch (reply.type) {
+    case Error:
+    case BulkError:
+        tSystemError("Redis error response: %s", toByteArray(_buffer, reply).data());
+        return false;
+
+    case SimpleString:
+        tSystemDebug("Redis response: %s", toByteArray(_buffer, reply).data());
+        break;
+
+    case Array:
+    case Map:
+    case Set:
+    case Push:
+        index = 1;
+        response.reserve(reply.number);
+        for (qint64 i = 0; i < reply.number; i++) {
+            response << toVariant(_buffer, _elements, index);
+        }
+        break;
+
+    default:
+        response << toVariant(_buffer, _elements, index);
+        break;
+    }
+    return true;
 }
 
 
-QByteArray TRedisDriver::parseBulkString(bool *ok)
+void TRedisDriver::clearBuffer()
 {
-    QByteArray str;
-    int startpos = _pos;
+    if (Q_UNLIKELY(_buffer.capacity() > MAX_RETAINED_BUFFER_SIZE)) {
+        // Releases the memory allocated for a huge reply
+        _buffer = QByteArray();
+        _buffer.reserve(1023);
+    }
+    _buffer.resize(0);
+    _pos = 0;
+}
 
-    Q_ASSERT((int)_buffer[_pos] == BulkString);
-    _pos++;
 
-    int len = getNumber(ok);
-    if (*ok) {
-        if (len < -1) {
-            tSystemError("Invalid length: %d  [%s:%d]", len, __FILE__, __LINE__);
-            *ok = false;
-        } else if (len == -1) {
-            // null string
-            tSystemDebug("Null string parsed");
-        } else {
-            if (_pos + 2 <= _buffer.length()) {
-                str = (len > 0) ? _buffer.mid(_pos, len) : QByteArray("");
-                _pos += len + 2;
-            } else {
-                *ok = false;
+/*!
+  Returns the timeout in milliseconds for connecting, which is specified
+  as CONNECT_TIMEOUT in the connect \a options, such as
+  "CONNECT_TIMEOUT=500".
+*/
+int TRedisDriver::connectTimeout(const QString &options)
+{
+    const QStringList opts = options.split(';', QString::SkipEmptyParts);
+    for (auto &opt : opts) {
+        QString name = opt.section('=', 0, 0).trimmed();
+        if (name.compare(QLatin1String("CONNECT_TIMEOUT"), Qt::CaseInsensitive) == 0) {
+            bool ok;
+            int timeout = opt.section('=', 1).trimmed().toInt(&ok);
+            if (ok && timeout > 0) {
+                return timeout;
             }
+            tSystemWarn("Invalid Redis connect option: %s", qPrintable(opt));
         }
     }
+    return DEFAULT_CONNECT_TIMEOUT;
+}
+
 
-    if (! *ok) {
-        _pos = startpos;
+static inline bool toNumber(const char *str, int len, qint64 *num)
+{
+    bool neg = (len > 0 && *str == '-');
+    if (neg) {
+        str++;
+        len--;
     }
-    return str;
-}
 
+    if (len <= 0 || len > 19) {
+        return false;
+    }
 
-QVariantList TRedisDriver::parseArray(bool *ok)
+    quint64 n = 0;
+    for (int i = 0; i < len; i++) {
+        uint c = (uchar)str[i] - '0';
+        if (c > 9) {
+            return false;
+        }
+        n = n * 10 + c;
+    }
+    *num = (neg) ? -(qint64)n : (qint64)n;
+    return true;
+}
+
+/*!
+  Parses one reply at \a pos in the \a buffer into a flat list of
+  elements referring to the buffer, without copying any data. An
+  aggregate element is followed by its child elements. If the reply is
+  complete, \a pos is moved to the end of the reply and \a ok is set to
+  true; otherwise \a pos is unchanged and \a ok is set to false. Returns
+  false if the reply is malformed.
+*/
+bool TRedisDriver::parseElements(const QByteArray &buffer, int &pos, QVector<Element> &elements, bool *ok)
 {
-    QVariantList lst;
-    int startpos = _pos;
+    const char *data = buffer.constData();
+    const int length = buffer.length();
+    QVarLengthArray<qint64, 16> remains;  // number of child elements to be parsed
+    int p = pos;
+
+    elements.resize(0);
     *ok = false;
 
-    Q_ASSERT((int)_buffer[_pos] == Array);
-    _pos++;
+    do {
+        if (p + 1 >= length) {
+            return true;  // incomplete
+        }
+
+        const char *cr = (const char *)std::memchr(data + p + 1, '\r', length - p - 1);
+        if (!cr || cr + 1 >= data + length) {
+            return true;  // incomplete
+        }
+        if (cr[1] != '\n') {
+            return false;
+        }
+
+        Element e;
+        e.type = data[p];
+        e.offset = p + 1;
+        e.length = cr - data - e.offset;
+        int next = cr - data + 2;
+        qint64 count = 0;
+
+        switch (e.type) {
+        case SimpleString:
+        case Error:
+        case Boolean:
+        case Double:
+        case BigNumber:
+            break;
 
-    int count = getNumber(ok);
-    while (*ok) {
-        switch (_buffer[_pos]) {
-        case BulkString: {
-            auto str = parseBulkString(ok);
-            if (*ok) {
-                lst << str;
+        case Null:
+            e.length = -1;
+            break;
+
+        case Integer:
+            if (!toNumber(data + e.offset, e.length, &e.number)) {
+                return false;
             }
-            break; }
+            break;
 
-        case Integer: {
-            _pos++;
-            int num = getNumber(ok);
-            if (*ok) {
-                lst << num;
+        case BulkString:
+        case BulkError:
+        case VerbatimString: {
+            qint64 len;
+            if (!toNumber(data + e.offset, e.length, &len) || len < -1) {
+                return false;
             }
-            break; }
 
-        case Array: {
-            auto var = parseArray(ok);
-            if (*ok) {
-                lst << QVariant(var);
+            if (len >= 0) {
+                if (next + len + 2 > length) {
+                    return true;  // incomplete
+                }
+                e.offset = next;
+                next += len + 2;
             }
+            e.length = len;
             break; }
 
-        default:
-            tSystemError("Bad logic  [%s:%d]", __FILE__, __LINE__);
-            *ok = false;
+        case Array:
+        case Map:
+        case Set:
+        case Push:
+            if (!toNumber(data + e.offset, e.length, &count) || count < -1) {
+                return false;
+            }
+
+            e.length = (count < 0) ? -1 : 0;  // -1 for null array
+            count = qMax(count, (qint64)0);
+            if (e.type == Map) {
+                count *= 2;  // key-value pairs
+            }
+            e.number = count;
             break;
+
+        default:
+            return false;
         }
 
-        if (lst.count() >= count) {
-            break;
+        elements.append(e);
+        p = next;
+
+        if (!remains.isEmpty()) {
+            remains.last()--;
         }
-    }
+        if (count > 0) {
+            remains.append(count);
+        }
+        while (!remains.isEmpty() && remains.last() == 0) {
+            remains.removeLast();
+        }
+    } while (!remains.isEmpty());
 
-    if (! *ok) {
-        _pos = startpos;
-    }
-    return lst;
+    pos = p;
+    *ok = true;
+    return true;
 }
 
-
-int TRedisDriver::getNumber(bool *ok)
+/*!
+  Converts the element at \a index and its child elements to a QVariant
+  object, and moves \a index to the next element.
+*/
+QVariant TRedisDriver::toVariant(const QByteArray &buffer, const QVector<Element> &elements, int &index)
 {
-    int idx = _buffer.indexOf(CRLF, _pos);
-    if (idx < 0) {
-        *ok = false;
-        return 0;
+    if (index >= elements.count()) {
+        return QVariant();
     }
 
-    int num = _buffer.mid(_pos, idx - _pos).toInt();
-    _pos = idx + 2;
-    *ok = true;
-    tSystemDebug("getNumber: %d", num);
-    return num;
-}
+    const Element &e = elements[index++];
+    switch (e.type) {
+    case Integer:
+        return QVariant(e.number);
 
+    case Null:
+        return QVariant();
 
-void TRedisDriver::clearBuffer()
+    case Boolean:
+        return QVariant(e.length > 0 && buffer.at(e.offset) == 't');
+
+    case Double:
+        return QVariant(toByteArray(buffer, e).toDouble());
+
+    case Array:
+    case Map:
+    case Set:
+    case Push: {
+        QVariantList lst;
+        lst.reserve(e.number);
+        for (qint64 i = 0; i < e.number; i++) {
+            lst << toVariant(buffer, elements, index);
+        }
+        return QVariant(lst); }
+
+    default:
+        return QVariant(toByteArray(buffer, e));
+    }
+}
+
+/*!
+  Returns a copy of the data of the element \a e in the \a buffer.
+*/
+QByteArray TRedisDriver::toByteArray(const QByteArray &buffer, const Element &e)
 {
-    _buffer.resize(0);
-    _pos = 0;
+    if (e.length < 0) {
+        return QByteArray();
+    }
+
+    if (e.length == 0) {
+        return QByteArray("");
+    }
+
+    int offset = e.offset;
+    int length = e.length;
+    if (e.type == VerbatimString && length >= 4) {
+        // Skips the format, such as 'txt:'
+        offset += 4;
+        length -= 4;
+    }
+    return QByteArray(buffer.constData() + offset, length);
 }
 
 
-QByteArray TRedisDriver::toBulk(const QByteArray &data)
+static inline void appendHeader(QByteArray &buffer, char type, int num)
 {
-    QByteArray bulk("$");
-    bulk += QByteArray::number(data.length());
-    bulk += CRLF;
-    bulk += data;
-    bulk += CRLF;
-    return bulk;
+    char buf[16];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+    uint n = num;
+
+    *--p = '\n';
+    *--p = '\r';
+    do {
+        *--p = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    *--p = type;
+    buffer.append(p, end - p);
 }
 
-
-QByteArray TRedisDriver::toMultiBulk(const QByteArrayList &data)
+/*!
+  Appends the \a command in RESP format to the \a buffer.
+*/
+void TRedisDriver::appendCommand(QByteArray &buffer, const QByteArrayList &command)
 {
-    QByteArray mbulk("*");
-    mbulk += QByteArray::number(data.count());
-    mbulk += CRLF;
-    for (auto &d : data) {
-        mbulk += toBulk(d);
+    appendHeader(buffer, Array, command.count());
+    for (auto &arg : command) {
+        appendHeader(buffer, BulkString, arg.length());
+        buffer.append(arg);
+        buffer.append(CRLF, 2);
     }
-    return mbulk;
 }
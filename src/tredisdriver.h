@@ -5,6 +5,7 @@
 #include <TKvsDriver>
 #include <QString>
 #include <QVariant>
+#include <QVector>
 #include <QtGlobal>
 
 class QTcpSocket;
@@ -21,28 +22,54 @@ public:
     void close() override;
     bool command(const QString &cmd) override;
     bool isOpen() const override;
+    bool ping() override;
     void moveToThread(QThread *thread) override;
     bool request(const QByteArrayList &command, QVariantList &response);
+    bool request(const QByteArrayList &command, QByteArrayList &response);
+    bool request(const QList<QByteArrayList> &commands, QList<QVariantList> &responses);
+    bool waitForMessage(QVariantList &message, int msecs);
 
 protected:
     enum DataType {
-        SimpleString = '+',
-        Error        = '-',
-        Integer      = ':',
-        BulkString   = '$',
-        Array        = '*',
+        SimpleString   = '+',
+        Error          = '-',
+        Integer        = ':',
+        BulkString     = '$',
+        Array          = '*',
+        // RESP3
+        Null           = '_',
+        Boolean        = '#',
+        Double         = ',',
+        BigNumber      = '(',
+        BulkError      = '!',
+        VerbatimString = '=',
+        Map            = '%',
+        Set            = '~',
+        Push           = '>',
+    };
+
+    // View of a reply element in the receive buffer
+    struct Element {
+        char type {0};
+        int offset {0};     // offset of the data in the buffer
+        int length {0};     // length of the data, -1 for null
+        qint64 number {0};  // integer value, or count of child elements
     };
 
     bool writeCommand(const QByteArray &command);
     bool readReply();
-    QByteArray parseBulkString(bool *ok);
-    QVariantList parseArray(bool *ok);
-    QByteArray getLine(bool *ok);
-    int getNumber(bool *ok);
+    bool waitForReadyRead(int msecs);
+    bool flushCommands();
+    bool readElements();
+    bool readResponse(QVariantList &response);
     void clearBuffer();
 
-    static QByteArray toBulk(const QByteArray &data);
-    static QByteArray toMultiBulk(const QByteArrayList &data);
+    static int connectTimeout(const QString &options);
+
+    static bool parseElements(const QByteArray &buffer, int &pos, QVector<Element> &elements, bool *ok);
+    static QVariant toVariant(const QByteArray &buffer, const QVector<Element> &elements, int &index);
+    static QByteArray toByteArray(const QByteArray &buffer, const Element &element);
+    static void appendCommand(QByteArray &buffer, const QByteArrayList &command);
 
 private:
 #ifdef Q_OS_UNIX
@@ -52,6 +79,8 @@ private:
 #endif
     QByteArray _buffer;
     int _pos {0};
+    QByteArray _sendBuffer;
+    QVector<Element> _elements;
     QString _host;
     quint16 _port {0};
 
@@ -8,8 +8,13 @@
 #include "tredisdriver.h"
 #include "tsystemglobal.h"
 #include "tfcore_unix.h"
-#include <TApplicationServerBase>
-#include <QTcpSocket>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <cstring>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 using namespace Tf;
 
 constexpr int DEFAULT_PORT = 6379;
@@ -21,6 +26,7 @@ TRedisDriver::TRedisDriver() :
     TKvsDriver()
 {
     _buffer.reserve(1023);
+    _sendBuffer.reserve(1023);
 }
 
 
@@ -36,45 +42,104 @@ bool TRedisDriver::isOpen() const
 }
 
 
-bool TRedisDriver::open(const QString &, const QString &, const QString &, const QString &host, quint16 port, const QString &)
+/*
+  Connects to the \a address in non-blocking mode and waits at most
+  \a msecs milliseconds. Returns the socket descriptor, or -1 on error.
+*/
+static int connectToHost(const QHostAddress &address, quint16 port, int msecs)
 {
-    if (isOpen()) {
-        return true;
+    struct sockaddr_storage ss;
+    socklen_t sslen = 0;
+    std::memset(&ss, 0, sizeof(ss));
+
+    if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+        auto *sin6 = reinterpret_cast<struct sockaddr_in6 *>(&ss);
+        Q_IPV6ADDR ip6 = address.toIPv6Address();
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        std::memcpy(&sin6->sin6_addr, &ip6, sizeof(ip6));
+        sslen = sizeof(struct sockaddr_in6);
+    } else {
+        auto *sin = reinterpret_cast<struct sockaddr_in *>(&ss);
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        sin->sin_addr.s_addr = htonl(address.toIPv4Address());
+        sslen = sizeof(struct sockaddr_in);
+    }
+
+    int sd = ::socket(ss.ss_family, SOCK_STREAM, 0);
+    if (sd < 0) {
+        return -1;
     }
 
-    QTcpSocket tcpSocket;
+    ::fcntl(sd, F_SETFD, FD_CLOEXEC);
+    ::fcntl(sd, F_SETFL, ::fcntl(sd, F_GETFL) | O_NONBLOCK);
+
+    if (::connect(sd, reinterpret_cast<struct sockaddr *>(&ss), sslen) < 0) {
+        int err = 0;
+        socklen_t errlen = sizeof(err);
+
+        if (errno != EINPROGRESS
+            || tf_poll_send(sd, msecs) != 0
+            || ::getsockopt(sd, SOL_SOCKET, SO_ERROR, &err, &errlen) < 0
+            || err != 0) {
+            tf_close(sd);
+            return -1;
+        }
+    }
 
     // Sets socket options
-    tcpSocket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    int val = 1;
+    ::setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
 
     // Sets buffer size of socket
-    int val = tcpSocket.socketOption(QAbstractSocket::SendBufferSizeSocketOption).toInt();
-    if (val < SEND_BUF_SIZE) {
-        tcpSocket.setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, SEND_BUF_SIZE);
+    socklen_t vallen = sizeof(val);
+    if (::getsockopt(sd, SOL_SOCKET, SO_SNDBUF, &val, &vallen) == 0 && val < SEND_BUF_SIZE) {
+        val = SEND_BUF_SIZE;
+        ::setsockopt(sd, SOL_SOCKET, SO_SNDBUF, &val, sizeof(val));
     }
 
-    val = tcpSocket.socketOption(QAbstractSocket::ReceiveBufferSizeSocketOption).toInt();
-    if (val < RECV_BUF_SIZE) {
-        tcpSocket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, RECV_BUF_SIZE);
+    vallen = sizeof(val);
+    if (::getsockopt(sd, SOL_SOCKET, SO_RCVBUF, &val, &vallen) == 0 && val < RECV_BUF_SIZE) {
+        val = RECV_BUF_SIZE;
+        ::setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val));
+    }
+    return sd;
+}
+
+
+bool TRedisDriver::open(const QString &, const QString &, const QString &, const QString &host, quint16 port, const QString &options)
+{
+    if (isOpen()) {
+        return true;
     }
 
     _host = (host.isEmpty()) ? "localhost" : host;
     _port = (port == 0) ? DEFAULT_PORT : port;
 
-    tSystemDebug("Redis open host:%s  port:%d", qPrintable(_host), _port);
-    tcpSocket.connectToHost(_host, _port);
-
-    bool ret = tcpSocket.waitForConnected(5000);
-    if (Q_LIKELY(ret)) {
-        tSystemDebug("Redis open successfully");
+    QList<QHostAddress> addresses;
+    QHostAddress address(_host);
+    if (address.isNull()) {
+        addresses = QHostInfo::fromName(_host).addresses();
     } else {
-        tSystemError("Redis open failed");
-        close();
-        return false;
+        addresses << address;
     }
 
-    _socket = TApplicationServerBase::duplicateSocket(tcpSocket.socketDescriptor());
-    return _socket > 0;
+    tSystemDebug("Redis open host:%s  port:%d", qPrintable(_host), _port);
+    const int timeout = connectTimeout(options);
+
+    for (auto &addr : (const QList<QHostAddress> &)addresses) {
+        int sd = connectToHost(addr, _port, timeout);
+        if (sd > 0) {
+            _socket = sd;
+            tSystemDebug("Redis open successfully");
+            return true;
+        }
+    }
+
+    tSystemError("Redis open failed  host:%s  port:%d", qPrintable(_host), _port);
+    close();
+    return false;
 }
 
 
@@ -117,19 +182,19 @@ bool TRedisDriver::readReply()
         return false;
     }
 
-    QByteArray buf;
-    buf.reserve(RECV_BUF_SIZE);
     int timeout = 5000;
     int len = 0;
 
     while (tf_poll_recv(_socket, timeout) == 0) {
-        len = tf_recv(_socket, buf.data(), RECV_BUF_SIZE, 0);
+        // Receives into the buffer directly
+        const int oldlen = _buffer.length();
+        _buffer.resize(oldlen + RECV_BUF_SIZE);
+        len = tf_recv(_socket, _buffer.data() + oldlen, RECV_BUF_SIZE, 0);
+        _buffer.resize(oldlen + qMax(len, 0));
         if (len <= 0) {
             break;
         }
 
-        buf.resize(len);
-        _buffer += buf;
         if (len < RECV_BUF_SIZE) {
             break;
         }
@@ -140,5 +205,11 @@ bool TRedisDriver::readReply()
 }
 
 
+bool TRedisDriver::waitForReadyRead(int msecs)
+{
+    return isOpen() && tf_poll_recv(_socket, msecs) == 0;
+}
+
+
 void TRedisDriver::moveToThread(QThread *)
 { }
@@ -21,6 +21,7 @@ TRedisDriver::TRedisDriver() :
     TKvsDriver()
 {
     _buffer.reserve(1023);
+    _sendBuffer.reserve(1023);
 }
 
 
@@ -37,7 +38,7 @@ bool TRedisDriver::isOpen() const
 }
 
 
-bool TRedisDriver::open(const QString &, const QString &, const QString &, const QString &host, quint16 port, const QString &)
+bool TRedisDriver::open(const QString &, const QString &, const QString &, const QString &host, quint16 port, const QString &options)
 {
     if (isOpen()) {
         return true;
@@ -71,7 +72,7 @@ bool TRedisDriver::open(const QString &, const QString &, const QString &, const
     tSystemDebug("Redis open host:%s  port:%d", qPrintable(_host), _port);
     _client->connectToHost(_host, _port);
 
-    bool ret = _client->waitForConnected(5000);
+    bool ret = _client->waitForConnected(connectTimeout(options));
     if (Q_LIKELY(ret)) {
         tSystemDebug("Redis open successfully");
     } else {
@@ -103,7 +104,7 @@ bool TRedisDriver::readReply()
         return false;
     }
 
-    bool ret = _client->waitForReadyRead(5000);
+    bool ret = waitForReadyRead(5000);
     if (ret) {
         _buffer += _client->readAll();
     } else {
@@ -116,6 +117,12 @@ bool TRedisDriver::readReply()
 }
 
 
+bool TRedisDriver::waitForReadyRead(int msecs)
+{
+    return _client && (_client->bytesAvailable() > 0 || _client->waitForReadyRead(msecs));
+}
+
+
 void TRedisDriver::moveToThread(QThread *thread)
 {
     int socket = 0;
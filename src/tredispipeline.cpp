@@ -0,0 +1,70 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include <TRedisPipeline>
+
+/*!
+  \class TRedisPipeline
+  \brief The TRedisPipeline class queues Redis commands and sends them
+  in one write, so that many commands cost a single round trip.
+
+  \code
+  TRedisPipeline pipeline;
+  pipeline << QByteArrayList({"GET", "foo"}) << QByteArrayList({"INCRBY", "bar", "1"});
+  if (pipeline.exec()) {
+      QByteArray foo = pipeline.response(0).value(0).toByteArray();
+      ...
+  }
+  \endcode
+*/
+
+/*!
+  Constructs a TRedisPipeline object for the Redis database of the
+  current context.
+*/
+TRedisPipeline::TRedisPipeline() :
+    _redis()
+{ }
+
+/*!
+  Constructs a TRedisPipeline object for the database of \a redis.
+*/
+TRedisPipeline::TRedisPipeline(const TRedis &redis) :
+    _redis(redis)
+{ }
+
+/*!
+  Queues the \a command.
+*/
+TRedisPipeline &TRedisPipeline::append(const QByteArrayList &command)
+{
+    if (!command.isEmpty()) {
+        _commands << command;
+    }
+    return *this;
+}
+
+/*!
+  Sends all the queued commands and receives their replies, which are
+  available by response() in the order the commands were appended.
+  Returns false if any of the commands fails. The queue is cleared.
+*/
+bool TRedisPipeline::exec()
+{
+    bool ret = _redis.request(_commands, _responses);
+    _commands.clear();
+    return ret;
+}
+
+/*!
+  Clears the queued commands and the replies.
+*/
+void TRedisPipeline::clear()
+{
+    _commands.clear();
+    _responses.clear();
+}
@@ -0,0 +1,35 @@
+#ifndef TREDISPIPELINE_H
+#define TREDISPIPELINE_H
+
+#include <TGlobal>
+#include <TRedis>
+#include <QList>
+#include <QVariant>
+
+
+class T_CORE_EXPORT TRedisPipeline
+{
+public:
+    TRedisPipeline();
+    TRedisPipeline(const TRedis &redis);
+    ~TRedisPipeline() { }
+
+    TRedisPipeline &append(const QByteArrayList &command);
+    TRedisPipeline &operator<<(const QByteArrayList &command) { return append(command); }
+    int count() const { return _commands.count(); }
+    bool isEmpty() const { return _commands.isEmpty(); }
+    bool exec();
+    QVariantList response(int index) const { return _responses.value(index); }
+    const QList<QVariantList> &responses() const { return _responses; }
+    void clear();
+
+private:
+    TRedis _redis;
+    QList<QByteArrayList> _commands;
+    QList<QVariantList> _responses;
+
+    T_DISABLE_COPY(TRedisPipeline)
+    T_DISABLE_MOVE(TRedisPipeline)
+};
+
+#endif // TREDISPIPELINE_H
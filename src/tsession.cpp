@@ -59,6 +59,14 @@ QByteArray TSession::sessionName()
   Returns the ID.
 */
 
+/*!
+  \fn bool TSession::isModified() const
+  Returns true if the ID or any item has been changed since the session
+  was found in the session store, or if it is a new session; otherwise
+  returns false. An unmodified session is not written to the store again
+  at the end of the action.
+*/
+
 /*!
   \fn iterator TSession::insert(const Key &key, const T &value)
   Inserts a new item with the \a key and a value of \a value.
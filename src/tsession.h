@@ -3,6 +3,7 @@
 
 #include <QVariant>
 #include <QByteArray>
+#include <QDateTime>
 #include <TGlobal>
 
 
@@ -14,6 +15,7 @@ public:
     TSession &operator=(const TSession &other);
 
     QByteArray id() const { return sessionId; }
+    bool isModified() const;
     void reset();
     iterator insert(const QString &key, const QVariant &value);
     int remove(const QString &key);
@@ -24,9 +26,14 @@ public:
 
 private:
     QByteArray sessionId;
+    QByteArray storedId;
+    QVariantMap storedData;
+    QDateTime storedTime;
 
     void clear(); // disabled
     friend class TSessionCookieStore;
+    friend class TSessionStore;
+    friend class TSessionManager;
     friend class TActionContext;
 };
 
@@ -36,16 +43,26 @@ inline TSession::TSession(const QByteArray &id)
 { }
 
 inline TSession::TSession(const TSession &other)
-    : QVariantMap(*static_cast<const QVariantMap *>(&other)), sessionId(other.sessionId)
+    : QVariantMap(*static_cast<const QVariantMap *>(&other)), sessionId(other.sessionId),
+      storedId(other.storedId), storedData(other.storedData), storedTime(other.storedTime)
 { }
 
 inline TSession &TSession::operator=(const TSession &other)
 {
     QVariantMap::operator=(*static_cast<const QVariantMap *>(&other));
     sessionId = other.sessionId;
+    storedId = other.storedId;
+    storedData = other.storedData;
+    storedTime = other.storedTime;
     return *this;
 }
 
+inline bool TSession::isModified() const
+{
+    // Compares the implicitly shared data first, so it's cheap when unchanged
+    return sessionId != storedId || *static_cast<const QVariantMap *>(this) != storedData;
+}
+
 inline TSession::iterator TSession::insert(const QString &key, const QVariant &value)
 {
     return QVariantMap::insert(key, value);
@@ -0,0 +1,626 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tsessioncookiecodec.h"
+#include <TCryptMac>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStringList>
+#include <QThreadStorage>
+#include <cstring>
+
+// Encoded sessions longer than this are compressed
+constexpr int COMPRESSION_THRESHOLD = 256;
+constexpr int HMAC_LENGTH = 16;
+constexpr int MAX_DEPTH = 32;
+
+namespace {
+
+enum Tag : uchar {
+    Invalid = 0,
+    False,
+    True,
+    Int,
+    UInt,
+    LongLong,
+    ULongLong,
+    Double,
+    String,
+    ByteArray,
+    StringList,
+    Map,
+    List,
+    DateTime,
+    Other = 0xff,  // serialized by QDataStream
+};
+
+enum Flag : uchar {
+    Compressed = 0x01,
+};
+
+
+inline void writeVarint(QByteArray &out, quint64 n)
+{
+    while (n >= 0x80) {
+        out += (char)(n | 0x80);
+        n >>= 7;
+    }
+    out += (char)n;
+}
+
+
+inline quint64 zigzag(qint64 n)
+{
+    return ((quint64)n << 1) ^ (quint64)(n >> 63);
+}
+
+
+inline qint64 unzigzag(quint64 n)
+{
+    return (qint64)(n >> 1) ^ -(qint64)(n & 1);
+}
+
+
+inline void writeBytes(QByteArray &out, const char *data, int length)
+{
+    writeVarint(out, length);
+    out.append(data, length);
+}
+
+
+inline void writeString(QByteArray &out, const QString &str)
+{
+    QByteArray utf8 = str.toUtf8();
+    writeBytes(out, utf8.constData(), utf8.length());
+}
+
+
+bool writeMap(QByteArray &out, const QVariantMap &map);
+bool writeValue(QByteArray &out, const QVariant &value);
+
+
+bool writeValue(QByteArray &out, const QVariant &value)
+{
+    if (!value.isValid()) {
+        out += (char)Invalid;
+        return true;
+    }
+
+    switch (value.userType()) {
+    case QMetaType::Bool:
+        out += (char)(value.toBool() ? True : False);
+        break;
+
+    case QMetaType::Int:
+        out += (char)Int;
+        writeVarint(out, zigzag(value.toInt()));
+        break;
+
+    case QMetaType::UInt:
+        out += (char)UInt;
+        writeVarint(out, value.toUInt());
+        break;
+
+    case QMetaType::LongLong:
+        out += (char)LongLong;
+        writeVarint(out, zigzag(value.toLongLong()));
+        break;
+
+    case QMetaType::ULongLong:
+        out += (char)ULongLong;
+        writeVarint(out, value.toULongLong());
+        break;
+
+    case QMetaType::Double: {
+        out += (char)Double;
+        double d = value.toDouble();
+        char buf[sizeof(d)];
+        std::memcpy(buf, &d, sizeof(d));
+        out.append(buf, sizeof(buf));
+        break; }
+
+    case QMetaType::QString:
+        out += (char)String;
+        writeString(out, value.toString());
+        break;
+
+    case QMetaType::QByteArray: {
+        out += (char)ByteArray;
+        const QByteArray ba = value.toByteArray();
+        writeBytes(out, ba.constData(), ba.length());
+        break; }
+
+    case QMetaType::QStringList: {
+        out += (char)StringList;
+        const QStringList list = value.toStringList();
+        writeVarint(out, list.count());
+        for (auto &str : list) {
+            writeString(out, str);
+        }
+        break; }
+
+    case QMetaType::QVariantMap:
+        out += (char)Map;
+        return writeMap(out, value.toMap());
+
+    case QMetaType::QVariantList: {
+        out += (char)List;
+        const QVariantList list = value.toList();
+        writeVarint(out, list.count());
+        for (auto &var : list) {
+            if (!writeValue(out, var)) {
+                return false;
+            }
+        }
+        break; }
+
+    case QMetaType::QDateTime: {
+        const QDateTime dt = value.toDateTime();
+        if (dt.isValid() && (dt.timeSpec() == Qt::LocalTime || dt.timeSpec() == Qt::UTC)) {
+            out += (char)DateTime;
+            out += (char)dt.timeSpec();
+            writeVarint(out, zigzag(dt.toMSecsSinceEpoch()));
+            break;
+        }
+    }  // fall through
+
+    default: {
+        out += (char)Other;
+        QByteArray ba;
+        QDataStream ds(&ba, QIODevice::WriteOnly);
+        ds << value;
+        if (ds.status() != QDataStream::Ok) {
+            return false;
+        }
+        writeBytes(out, ba.constData(), ba.length());
+        break; }
+    }
+    return true;
+}
+
+
+bool writeMap(QByteArray &out, const QVariantMap &map)
+{
+    writeVarint(out, map.count());
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        writeString(out, it.key());
+        if (!writeValue(out, it.value())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads the encoded data in place, checking the bounds
+class Reader
+{
+public:
+    Reader(const char *data, int length) : ptr((const uchar *)data), end((const uchar *)data + length) { }
+
+    bool atEnd() const { return ptr == end; }
+
+    bool readByte(uchar &c)
+    {
+        if (ptr >= end) {
+            return false;
+        }
+        c = *ptr++;
+        return true;
+    }
+
+    bool readVarint(quint64 &n)
+    {
+        n = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uchar c;
+            if (!readByte(c)) {
+                return false;
+            }
+            n |= (quint64)(c & 0x7f) << shift;
+            if (!(c & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readBytes(const char *&data, int &length)
+    {
+        quint64 n;
+        if (!readVarint(n) || n > (quint64)(end - ptr)) {
+            return false;
+        }
+        data = (const char *)ptr;
+        length = (int)n;
+        ptr += n;
+        return true;
+    }
+
+    bool readString(QString &str)
+    {
+        const char *data;
+        int length;
+        if (!readBytes(data, length)) {
+            return false;
+        }
+        str = QString::fromUtf8(data, length);
+        return true;
+    }
+
+    bool readMap(QVariantMap &map, int depth);
+    bool readValue(QVariant &value, int depth);
+
+private:
+    const uchar *ptr;
+    const uchar *end;
+};
+
+
+bool Reader::readValue(QVariant &value, int depth)
+{
+    uchar tag;
+    quint64 n;
+
+    if (depth > MAX_DEPTH || !readByte(tag)) {
+        return false;
+    }
+
+    switch (tag) {
+    case Invalid:
+        value = QVariant();
+        return true;
+
+    case False:
+    case True:
+        value = QVariant(tag == True);
+        return true;
+
+    case Int:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant((int)unzigzag(n));
+        return true;
+
+    case UInt:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant((uint)n);
+        return true;
+
+    case LongLong:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant((qlonglong)unzigzag(n));
+        return true;
+
+    case ULongLong:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant((qulonglong)n);
+        return true;
+
+    case Double: {
+        double d;
+        if (end - ptr < (int)sizeof(d)) {
+            return false;
+        }
+        std::memcpy(&d, ptr, sizeof(d));
+        ptr += sizeof(d);
+        value = QVariant(d);
+        return true; }
+
+    case String: {
+        QString str;
+        if (!readString(str)) {
+            return false;
+        }
+        value = QVariant(str);
+        return true; }
+
+    case ByteArray: {
+        const char *data;
+        int length;
+        if (!readBytes(data, length)) {
+            return false;
+        }
+        value = QVariant(QByteArray(data, length));
+        return true; }
+
+    case StringList: {
+        if (!readVarint(n) || n > (quint64)(end - ptr)) {
+            return false;
+        }
+        QStringList list;
+        list.reserve((int)n);
+        for (quint64 i = 0; i < n; ++i) {
+            QString str;
+            if (!readString(str)) {
+                return false;
+            }
+            list << str;
+        }
+        value = QVariant(list);
+        return true; }
+
+    case Map: {
+        QVariantMap map;
+        if (!readMap(map, depth + 1)) {
+            return false;
+        }
+        value = QVariant(map);
+        return true; }
+
+    case List: {
+        if (!readVarint(n) || n > (quint64)(end - ptr)) {
+            return false;
+        }
+        QVariantList list;
+        list.reserve((int)n);
+        for (quint64 i = 0; i < n; ++i) {
+            QVariant var;
+            if (!readValue(var, depth + 1)) {
+                return false;
+            }
+            list << var;
+        }
+        value = QVariant(list);
+        return true; }
+
+    case DateTime: {
+        uchar spec;
+        if (!readByte(spec) || (spec != Qt::LocalTime && spec != Qt::UTC) || !readVarint(n)) {
+            return false;
+        }
+        value = QVariant(QDateTime::fromMSecsSinceEpoch(unzigzag(n), (Qt::TimeSpec)spec));
+        return true; }
+
+    case Other: {
+        const char *data;
+        int length;
+        if (!readBytes(data, length)) {
+            return false;
+        }
+        QByteArray ba = QByteArray::fromRawData(data, length);
+        QDataStream ds(ba);
+        ds >> value;
+        return ds.status() == QDataStream::Ok; }
+
+    default:
+        return false;
+    }
+}
+
+
+bool Reader::readMap(QVariantMap &map, int depth)
+{
+    quint64 n;
+    if (depth > MAX_DEPTH || !readVarint(n) || n > (quint64)(end - ptr)) {
+        return false;
+    }
+
+    for (quint64 i = 0; i < n; ++i) {
+        QString key;
+        QVariant value;
+        if (!readString(key) || !readValue(value, depth)) {
+            return false;
+        }
+        map.insert(key, value);
+    }
+    return true;
+}
+
+
+inline quint64 rotl(quint64 x, int b)
+{
+    return (x << b) | (x >> (64 - b));
+}
+
+
+inline quint64 readLE64(const uchar *p)
+{
+    quint64 v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+
+#define SIPROUND                                \
+    do {                                        \
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0;  \
+        v0 = rotl(v0, 32);                      \
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;  \
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;  \
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2;  \
+        v2 = rotl(v2, 32);                      \
+    } while (0)
+
+
+// Keys of SipHash derived from the secret for each thread
+class MacKey
+{
+public:
+    QByteArray secret;
+    uchar sipKey[16];
+};
+
+QThreadStorage<MacKey *> macKeyStorage;
+
+
+MacKey *macKey(const QByteArray &secret)
+{
+    MacKey *key = macKeyStorage.localData();
+    if (!key) {
+        key = new MacKey;
+        macKeyStorage.setLocalData(key);
+    }
+
+    if (key->secret != secret || key->secret.isNull()) {
+        // Derives a 128-bit key of SipHash from the secret
+        QByteArray hash = QCryptographicHash::hash(secret, QCryptographicHash::Sha256);
+        std::memcpy(key->sipKey, hash.constData(), sizeof(key->sipKey));
+        key->secret = secret;
+    }
+    return key;
+}
+
+}
+
+/*!
+  \class TSessionCookieCodec
+  \brief The TSessionCookieCodec class encodes sessions into compact
+  binary data signed with a MAC for the cookie session store.
+
+  Common types of values such as numbers, strings, byte arrays, lists
+  and maps are written with a tag byte and varint lengths; others are
+  serialized by QDataStream.
+*/
+
+/*!
+  Encodes the \a map into the compact binary format. Returns a null
+  byte array if a value can not be serialized.
+*/
+QByteArray TSessionCookieCodec::encode(const QVariantMap &map)
+{
+    QByteArray out;
+    out.reserve(256);
+    if (!writeMap(out, map)) {
+        return QByteArray();
+    }
+    return out;
+}
+
+/*!
+  Decodes the \a data of \a length bytes encoded by encode() into the
+  \a map. Returns true if successful; otherwise returns false.
+*/
+bool TSessionCookieCodec::decode(const char *data, int length, QVariantMap &map)
+{
+    Reader reader(data, length);
+    return reader.readMap(map, 0) && reader.atEnd();
+}
+
+/*!
+  Returns the cookie value of the \a map; the encoded data, compressed if
+  large, and its MAC with the \a secret, in Base64URL joined by a dot.
+  Returns a null byte array if a value can not be serialized.
+*/
+QByteArray TSessionCookieCodec::encodeCookie(const QVariantMap &map, const QByteArray &secret, MacAlgorithm algorithm)
+{
+    QByteArray payload;
+    QByteArray data = encode(map);
+    if (data.isNull()) {
+        return QByteArray();
+    }
+
+    if (data.length() > COMPRESSION_THRESHOLD) {
+        payload = Tf::lz4Compress(data);
+        payload.prepend((char)Compressed);
+    } else {
+        payload.reserve(data.length() + 1);
+        payload += (char)0;
+        payload += data;
+    }
+
+    const auto options = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+    return payload.toBase64(options) + '.' + mac(payload, secret, algorithm).toBase64(options);
+}
+
+/*!
+  Verifies the MAC of the \a cookie made by encodeCookie() with the
+  \a secret, and decodes it into the \a map. Returns true if successful;
+  otherwise returns false.
+*/
+bool TSessionCookieCodec::decodeCookie(const QByteArray &cookie, const QByteArray &secret, MacAlgorithm algorithm, QVariantMap &map)
+{
+    int dot = cookie.indexOf('.');
+    if (dot <= 0) {
+        return false;
+    }
+
+    const auto options = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+    QByteArray payload = QByteArray::fromBase64(QByteArray::fromRawData(cookie.constData(), dot), options);
+    QByteArray digest = QByteArray::fromBase64(QByteArray::fromRawData(cookie.constData() + dot + 1, cookie.length() - dot - 1), options);
+
+    if (payload.isEmpty() || !TCryptMac::equals(digest, mac(payload, secret, algorithm))) {
+        return false;
+    }
+
+    if (payload[0] & Compressed) {
+        QByteArray data = Tf::lz4Uncompress(payload.constData() + 1, payload.length() - 1);
+        return decode(data.constData(), data.length(), map);
+    }
+    return decode(payload.constData() + 1, payload.length() - 1, map);
+}
+
+/*!
+  Returns the MAC of the \a data with the \a secret. HMAC-SHA256 is
+  computed by TCryptMac::hmacSha256(), and truncated to 128 bits.
+  SipHash-2-4 is a 64-bit keyed hash, much faster but only for integrity.
+*/
+QByteArray TSessionCookieCodec::mac(const QByteArray &data, const QByteArray &secret, MacAlgorithm algorithm)
+{
+    switch (algorithm) {
+    case SipHash: {
+        quint64 h = sipHash(data.constData(), data.length(), macKey(secret)->sipKey);
+        char buf[sizeof(h)];
+        for (int i = 0; i < (int)sizeof(h); ++i) {
+            buf[i] = (char)(h >> (i * 8));
+        }
+        return QByteArray(buf, sizeof(buf)); }
+
+    case HmacSha256:
+    default:
+        return TCryptMac::hmacSha256(data, secret).left(HMAC_LENGTH);
+    }
+}
+
+/*!
+  Returns the SipHash-2-4 of the \a data of \a length bytes with the
+  128-bit \a key.
+*/
+quint64 TSessionCookieCodec::sipHash(const char *data, int length, const uchar key[16])
+{
+    const quint64 k0 = readLE64(key);
+    const quint64 k1 = readLE64(key + 8);
+    quint64 v0 = 0x736f6d6570736575ULL ^ k0;
+    quint64 v1 = 0x646f72616e646f6dULL ^ k1;
+    quint64 v2 = 0x6c7967656e657261ULL ^ k0;
+    quint64 v3 = 0x7465646279746573ULL ^ k1;
+
+    const uchar *p = (const uchar *)data;
+    const uchar *end = p + (length & ~7);
+    for (; p != end; p += 8) {
+        quint64 m = readLE64(p);
+        v3 ^= m;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= m;
+    }
+
+    quint64 b = (quint64)length << 56;
+    for (int i = (length & 7) - 1; i >= 0; --i) {
+        b |= (quint64)p[i] << (i * 8);
+    }
+
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+    v2 ^= 0xff;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
@@ -0,0 +1,29 @@
+#ifndef TSESSIONCOOKIECODEC_H
+#define TSESSIONCOOKIECODEC_H
+
+#include <QByteArray>
+#include <QVariant>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TSessionCookieCodec
+{
+public:
+    enum MacAlgorithm {
+        HmacSha256 = 0,  // HMAC-SHA256 truncated to 128 bits
+        SipHash,         // SipHash-2-4, for integrity only
+    };
+
+    static QByteArray encode(const QVariantMap &map);
+    static bool decode(const char *data, int length, QVariantMap &map);
+    static QByteArray encodeCookie(const QVariantMap &map, const QByteArray &secret, MacAlgorithm algorithm);
+    static bool decodeCookie(const QByteArray &cookie, const QByteArray &secret, MacAlgorithm algorithm, QVariantMap &map);
+    static QByteArray mac(const QByteArray &data, const QByteArray &secret, MacAlgorithm algorithm);
+    static quint64 sipHash(const char *data, int length, const uchar key[16]);
+
+private:
+    T_DISABLE_COPY(TSessionCookieCodec)
+    T_DISABLE_MOVE(TSessionCookieCodec)
+};
+
+#endif // TSESSIONCOOKIECODEC_H
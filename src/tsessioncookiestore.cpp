@@ -6,7 +6,9 @@
  */
 
 #include "tsessioncookiestore.h"
+#include "tsessioncookiecodec.h"
 #include <TAppSettings>
+#include <TCryptMac>
 #include <TSystemGlobal>
 #include <QByteArray>
 #include <QDataStream>
@@ -15,6 +17,10 @@
 /*!
   \class TSessionCookieStore
   \brief The TSessionCookieStore class stores HTTP sessions into a cookie.
+
+  Sessions are encoded by TSessionCookieCodec and signed with the MAC
+  specified by Session.CookieMacAlgorithm. Cookies of the legacy format,
+  signed with SHA-1, are still accepted.
 */
 
 
@@ -25,50 +31,24 @@ static const QByteArray &sessionSecret()
 }
 
 
-bool TSessionCookieStore::store(TSession &session)
+static TSessionCookieCodec::MacAlgorithm macAlgorithm()
 {
-    if (session.isEmpty()) {
-        session.sessionId = "";
-        return true;
-    }
-
-#ifndef TF_NO_DEBUG
-    {
-        QByteArray badummy;
-        QDataStream dsdmy(&badummy, QIODevice::ReadWrite);
-        dsdmy << *static_cast<const QVariantMap *>(&session);
-
-        TSession dummy;
-        dsdmy.device()->seek(0);
-        dsdmy >> *static_cast<QVariantMap *>(&dummy);
-        if (dsdmy.status() != QDataStream::Ok) {
-            tSystemError("Failed to store a session into the cookie store. Must set objects that can be serialized.");
+    static TSessionCookieCodec::MacAlgorithm algorithm = []() {
+        QString str = Tf::appSettings()->value(Tf::SessionCookieMacAlgorithm).toString().trimmed().toLower();
+        if (str == QLatin1String("siphash")) {
+            return TSessionCookieCodec::SipHash;
         }
-    }
-#endif
-
-    QByteArray ba;
-    QDataStream ds(&ba, QIODevice::WriteOnly);
-    ds << *static_cast<const QVariantMap *>(&session);
-    if (ds.status() != QDataStream::Ok) {
-        tSystemError("Failed to store session. Must set objects that can be serialized.");
-        return false;
-    }
-
-    ba = Tf::lz4Compress(ba);
-    QByteArray digest = QCryptographicHash::hash(ba + sessionSecret(), QCryptographicHash::Sha1);
-    session.sessionId = ba.toBase64() + "_" + digest.toBase64();
-    return true;
+        if (!str.isEmpty() && str != QLatin1String("hmacsha256")) {
+            tSystemWarn("Invalid Session.CookieMacAlgorithm: %s  [%s:%d]", qPrintable(str), __FILE__, __LINE__);
+        }
+        return TSessionCookieCodec::HmacSha256;
+    }();
+    return algorithm;
 }
 
 
-TSession TSessionCookieStore::find(const QByteArray &id)
+static bool findLegacy(const QByteArray &id, TSession &session)
 {
-    TSession session(id);
-    if (id.isEmpty()) {
-        return session;
-    }
-
     QByteArrayList balst = id.split('_');
 
     if (balst.count() == 2) {
@@ -79,10 +59,8 @@ TSession TSessionCookieStore::find(const QByteArray &id)
             QByteArray ba = QByteArray::fromBase64(data);
             QByteArray digest = QCryptographicHash::hash(ba + sessionSecret(), QCryptographicHash::Sha1);
 
-            if (digest != QByteArray::fromBase64(dgstr)) {
-                tSystemWarn("Recieved a tampered cookie or that of other web application.");
-                //throw SecurityException("Tampered with cookie", __FILE__, __LINE__);
-                return session;
+            if (!TCryptMac::equals(digest, QByteArray::fromBase64(dgstr))) {
+                return false;
             }
 
             ba = Tf::lz4Uncompress(ba);
@@ -93,8 +71,65 @@ TSession TSessionCookieStore::find(const QByteArray &id)
                 tSystemError("Failed to load a session from the cookie store.");
                 session.reset();
             }
+            return true;
         }
     }
+    return false;
+}
+
+
+bool TSessionCookieStore::store(TSession &session)
+{
+    if (session.isEmpty()) {
+        session.sessionId = "";
+        return true;
+    }
+
+    QByteArray cookie = TSessionCookieCodec::encodeCookie(session, sessionSecret(), macAlgorithm());
+    if (cookie.isNull()) {
+        tSystemError("Failed to store session. Must set objects that can be serialized.");
+        return false;
+    }
+
+    session.sessionId = cookie;
+    return true;
+}
+
+/*!
+  Sends the cookie of the unmodified session again as it is, without
+  encoding, unless it is of the legacy format; such a cookie is encoded
+  again to migrate to the current format.
+*/
+bool TSessionCookieStore::touch(TSession &session)
+{
+    if (!session.id().isEmpty() && !session.id().contains('.')) {
+        return store(session);
+    }
+    return true;
+}
+
+
+TSession TSessionCookieStore::find(const QByteArray &id)
+{
+    TSession session(id);
+    if (id.isEmpty()) {
+        return session;
+    }
+
+    bool verified;
+    if (id.contains('.')) {
+        verified = TSessionCookieCodec::decodeCookie(id, sessionSecret(), macAlgorithm(), session);
+        if (!verified) {
+            session = TSession(id);
+        }
+    } else {
+        verified = findLegacy(id, session);
+    }
+
+    if (!verified) {
+        tSystemWarn("Recieved a tampered cookie or that of other web application.");
+        //throw SecurityException("Tampered with cookie", __FILE__, __LINE__);
+    }
     return session;
 }
 
@@ -7,54 +7,120 @@
 
 #include "tsessionfilestore.h"
 #include "tsystemglobal.h"
-#include "tfcore.h"
 #include <TWebApplication>
 #include <QFile>
+#include <QSaveFile>
 #include <QDir>
+#include <QDirIterator>
 #include <QDataStream>
-#include <QReadWriteLock>
+#include <QMutex>
+#include <QAtomicInt>
+#include <cctype>
 
 constexpr auto SESSION_DIR_NAME = "session";
+// Length of the ID prefix naming the shard directory
+constexpr int SHARD_PREFIX_LENGTH = 2;
+constexpr int LOCK_STRIPES = 64;
+
+namespace {
+    // Striped locks serializing writes of the same session in a process
+    QMutex writeLocks[LOCK_STRIPES];
+    // Shard where the next GC batch starts
+    QAtomicInt gcShardCursor;
+
+    inline QMutex &writeLock(const QByteArray &id)
+    {
+        return writeLocks[qHash(id) % LOCK_STRIPES];
+    }
+
+    // Rejects IDs from cookies that could escape the session directory
+    bool isValidId(const QByteArray &id)
+    {
+        if (id.length() <= SHARD_PREFIX_LENGTH) {
+            return false;
+        }
+        for (char c : id) {
+            if (!isalnum((uchar)c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QString shardDirPath(const QByteArray &id)
+    {
+        return TSessionFileStore::sessionDirPath() + QLatin1String(id.left(SHARD_PREFIX_LENGTH)) + QLatin1Char('/');
+    }
+
+    inline QString filePath(const QByteArray &id)
+    {
+        return shardDirPath(id) + QLatin1String(id);
+    }
+
+    // Path of the flat layout before sharding
+    inline QString legacyFilePath(const QByteArray &id)
+    {
+        return TSessionFileStore::sessionDirPath() + QLatin1String(id);
+    }
 
-static QReadWriteLock rwLock(QReadWriteLock::Recursive);  // Global read-write lock
+    // Removes at most maxCount files older than the expire in the dir
+    int removeExpiredFiles(const QString &dirPath, const QDateTime &expire, int maxCount)
+    {
+        int res = 0;
+        QDirIterator it(dirPath, QDir::Files);
+        while (res < maxCount && it.hasNext()) {
+            it.next();
+            if (it.fileInfo().lastModified() < expire && QFile::remove(it.filePath())) {
+                res++;
+            }
+        }
+        return res;
+    }
+}
 
 /*!
   \class TSessionFileStore
   \brief The TSessionFileStore class stores HTTP sessions to files.
+
+  The files are sharded into subdirectories named by the first two
+  characters of the session IDs. A session is written to a temporary
+  file that is renamed to the session file, so readers see either the
+  old or the new file and take no lock.
 */
 
 bool TSessionFileStore::store(TSession &session)
 {
-    QDir dir(sessionDirPath());
-    if (!dir.exists()) {
-        dir.mkpath(".");
+    if (!isValidId(session.id())) {
+        tSystemError("Invalid session ID: %s", session.id().data());
+        return false;
     }
 
-    bool res = false;
-    QWriteLocker locker(&rwLock);  // lock for threads
-    QFile file(sessionDirPath() + session.id());
+    QByteArray buffer;
+    QDataStream dsbuf(&buffer, QIODevice::WriteOnly);
+    dsbuf << *static_cast<const QVariantMap *>(&session);
+    buffer = Tf::lz4Compress(buffer);  // compress
 
-    if (file.open(QIODevice::ReadWrite)) {
-        auto reslock = tf_lockfile(file.handle(), true, true);  // blocking flock for processes
-        int err = errno;
-        if (reslock < 0) {
-            tSystemWarn("flock error  errno:%d", err);
-        }
+    QMutexLocker locker(&writeLock(session.id()));
+    QSaveFile file(filePath(session.id()));
 
-        QByteArray buffer;
-        QDataStream dsbuf(&buffer, QIODevice::WriteOnly);
-        dsbuf << *static_cast<const QVariantMap *>(&session);
-        buffer = Tf::lz4Compress(buffer);  // compress
+    if (!file.open(QIODevice::WriteOnly)) {
+        // Creates the shard directory at the first write
+        QDir().mkpath(shardDirPath(session.id()));
+        if (!file.open(QIODevice::WriteOnly)) {
+            tSystemError("Failed to open a session file: %s", qPrintable(file.fileName()));
+            return false;
+        }
+    }
 
-        file.resize(0); // truncate
-        QDataStream ds(&file);
-        ds << buffer;
-        file.close();
+    QDataStream ds(&file);
+    ds << buffer;
 
-        res = (ds.status() == QDataStream::Ok);
-        if (!res) {
-            tSystemError("Failed to store session. Must set objects that can be serialized.");
-        }
+    bool res = (ds.status() == QDataStream::Ok) && file.commit();  // renames atomically
+    if (res) {
+        // Moved from the legacy layout, if any
+        QFile::remove(legacyFilePath(session.id()));
+    } else {
+        tSystemError("Failed to store session. Must set objects that can be serialized.");
     }
     return res;
 }
@@ -62,20 +128,21 @@ bool TSessionFileStore::store(TSession &session)
 
 TSession TSessionFileStore::find(const QByteArray &id)
 {
-    QFileInfo fi(sessionDirPath() + id);
+    if (!isValidId(id)) {
+        return TSession();
+    }
+
+    QFileInfo fi(filePath(id));
+    if (!fi.exists()) {
+        fi.setFile(legacyFilePath(id));
+    }
+
     QDateTime modified = QDateTime::currentDateTime().addSecs(-lifeTimeSecs());
 
     if (fi.exists() && fi.lastModified() >= modified) {
-        QReadLocker locker(&rwLock);  // lock for threads
         QFile file(fi.filePath());
 
         if (file.open(QIODevice::ReadOnly)) {
-            auto reslock = tf_lockfile(file.handle(), false, true);  // blocking flock for processes
-            int err = errno;
-            if (reslock < 0) {
-                tSystemWarn("flock error  errno:%d", err);
-            }
-
             QDataStream ds(&file);
             QByteArray buffer;
             ds >> buffer;
@@ -92,6 +159,7 @@ TSession TSessionFileStore::find(const QByteArray &id)
             dsbuf >> *static_cast<QVariantMap *>(&result);
 
             if (ds.status() == QDataStream::Ok) {
+                setStoredTime(result, fi.lastModified());
                 return result;
             } else {
                 tSystemError("Failed to load a session from the file store.");
@@ -104,25 +172,63 @@ TSession TSessionFileStore::find(const QByteArray &id)
 
 bool TSessionFileStore::remove(const QByteArray &id)
 {
-    return QFile::remove(sessionDirPath() + id);
+    if (!isValidId(id)) {
+        return false;
+    }
+
+    bool res = QFile::remove(filePath(id));
+    res |= QFile::remove(legacyFilePath(id));
+    return res;
+}
+
+
+bool TSessionFileStore::touch(TSession &session)
+{
+#if QT_VERSION >= 0x050a00  // 5.10.0
+    // Updates the modification time only
+    if (isValidId(session.id())) {
+        QFile file(filePath(session.id()));
+        if (file.exists() && file.open(QIODevice::ReadWrite)) {
+            return file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        }
+    }
+#endif
+    // The session in the legacy layout moves to its shard
+    return TSessionStore::touch(session);
 }
 
 
 int TSessionFileStore::gc(const QDateTime &expire)
 {
+    constexpr int batchSize = 1000;
     int res = 0;
-    QDir dir(sessionDirPath());
-    if (dir.exists()) {
-        const QList<QFileInfo> lst = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
-        for (auto &fi : lst) {
-            if (fi.lastModified() < expire) {
-                if (dir.remove(fi.fileName())) {
-                    res++;
-                }
-            } else {
-                break;
-            }
-        }
+    int cnt;
+    do {
+        cnt = gcBatch(expire, batchSize);
+        res += cnt;
+    } while (cnt == batchSize);
+    return res;
+}
+
+
+int TSessionFileStore::gcBatch(const QDateTime &expire, int maxCount)
+{
+    // Walks the shards one by one from where the last batch stopped,
+    // including the directory itself for files in the legacy layout
+    QStringList shards = QDir(sessionDirPath()).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    shards.prepend(QString());
+
+    int res = 0;
+    int start = gcShardCursor.load() % shards.count();
+    for (int i = 0; i < shards.count() && res < maxCount; ++i) {
+        int idx = (start + i) % shards.count();
+        res += removeExpiredFiles(sessionDirPath() + shards[idx], expire, maxCount - res);
+        gcShardCursor.store(idx);
+    }
+
+    if (res < maxCount) {
+        // All shards are collected
+        gcShardCursor.store(0);
     }
     return res;
 }
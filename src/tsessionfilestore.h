@@ -12,6 +12,8 @@ public:
     bool store(TSession &session) override;
     bool remove(const QByteArray &id) override;
     int gc(const QDateTime &expire) override;
+    bool touch(TSession &session) override;
+    int gcBatch(const QDateTime &expire, int maxCount) override;
 
     static QString sessionDirPath();
 };
@@ -8,29 +8,47 @@
 #include "tsessionmanager.h"
 #include "tsystemglobal.h"
 #include "tsessionstorefactory.h"
+#include "tgcscheduler.h"
 #include <TAppSettings>
 #include <TSessionStore>
-#include <TAtomic>
-#include <QHostInfo>
-#include <QCryptographicHash>
-#include <QThread>
-#include <QCoreApplication>
-
-
-static QByteArray createHash()
-{
-    static TAtomic<quint32> seq(0);
-    QByteArray data;
-    data.reserve(127);
-
-    data.append(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
-    data.append(QHostInfo::localHostName());
-    data.append(QByteArray::number(++seq));
-    data.append(QByteArray::number(QCoreApplication::applicationPid()));
-    data.append(QByteArray::number((qulonglong)QThread::currentThread()));
-    data.append(QByteArray::number((qulonglong)qApp));
-    data.append(QByteArray::number(Tf::rand32_r()));
-    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+#include <QThreadStorage>
+#if QT_VERSION >= 0x050a00
+# include <QRandomGenerator>
+#else
+# include <QMutex>
+# include <random>
+#endif
+
+namespace {
+    // Session store created for each thread and kept for reuse
+    class SessionStoreHolder
+    {
+    public:
+        SessionStoreHolder(const QString &type) : storeType(type), store(TSessionStoreFactory::create(type)) { }
+        ~SessionStoreHolder() { TSessionStoreFactory::destroy(storeType, store); }
+
+        const QString storeType;
+        TSessionStore *const store;
+    };
+
+    QThreadStorage<SessionStoreHolder*> sessionStoreStorage;
+
+
+    // Fills the buffer with random numbers from a CSPRNG of the OS,
+    // e.g. getrandom(2) on Linux
+    void fillSecureRandom(quint32 *buffer, int count)
+    {
+#if QT_VERSION >= 0x050a00
+        QRandomGenerator::system()->fillRange(buffer, count);
+#else
+        static std::random_device randev;
+        static QMutex mutex;
+        QMutexLocker locker(&mutex);
+        for (int i = 0; i < count; ++i) {
+            buffer[i] = randev();
+        }
+#endif
+    }
 }
 
 
@@ -47,12 +65,15 @@ TSession TSessionManager::findSession(const QByteArray &id)
     TSession session;
 
     if (!id.isEmpty()) {
-        TSessionStore *store = TSessionStoreFactory::create(storeType());
+        TSessionStore *store = sessionStore();
         if (Q_LIKELY(store)) {
             session = store->find(id);
-            TSessionStoreFactory::destroy(storeType(), store);
-        } else {
-            tSystemError("Session store not found: %s", qPrintable(storeType()));
+
+            if (!session.id().isEmpty()) {
+                // Keeps the found data to detect modification
+                session.storedId = session.sessionId;
+                session.storedData = *static_cast<const QVariantMap *>(&session);
+            }
         }
     }
     return session;
@@ -67,27 +88,51 @@ bool TSessionManager::store(TSession &session)
     }
 
     bool res = false;
-    TSessionStore *store = TSessionStoreFactory::create(storeType());
+    TSessionStore *store = sessionStore();
     if (Q_LIKELY(store)) {
         res = store->store(session);
-        TSessionStoreFactory::destroy(storeType(), store);
-    } else {
-        tSystemError("Session store not found: %s", qPrintable(storeType()));
     }
     return res;
 }
 
 
+/*!
+  Extends the expiration of the unmodified \a session in the session
+  store without writing its data.
+*/
+bool TSessionManager::touch(TSession &session)
+{
+    if (session.id().isEmpty()) {
+        tSystemError("Internal Error  [%s:%d]", __FILE__, __LINE__);
+        return false;
+    }
+
+    bool res = false;
+    TSessionStore *store = sessionStore();
+    if (Q_LIKELY(store)) {
+        res = store->touch(session);
+    }
+    return res;
+}
+
+/*!
+  Returns true if the expiration of the unmodified \a session needs to
+  be extended, i.e. the session was last stored before the refresh
+  interval, or the store does not tell when.
+*/
+bool TSessionManager::isRefreshRequired(const TSession &session) const
+{
+    static const int interval = Tf::appSettings()->value(Tf::SessionRefreshInterval).toInt();
+    return !session.storedTime.isValid() || session.storedTime.addSecs(interval) <= QDateTime::currentDateTime();
+}
+
+
 bool TSessionManager::remove(const QByteArray &id)
 {
     if (!id.isEmpty()) {
-        TSessionStore *store = TSessionStoreFactory::create(storeType());
+        TSessionStore *store = sessionStore();
         if (Q_LIKELY(store)) {
-            bool ret = store->remove(id);
-            TSessionStoreFactory::destroy(storeType(), store);
-            return ret;
-        } else {
-            tSystemError("Session store not found: %s", qPrintable(storeType()));
+            return store->remove(id);
         }
     }
     return false;
@@ -101,20 +146,34 @@ QString TSessionManager::storeType() const
 }
 
 
-QByteArray TSessionManager::generateId()
+/*!
+  Returns the session store of the current thread. The store is created
+  on the first call in each thread and reused afterwards.
+*/
+TSessionStore *TSessionManager::sessionStore() const
 {
-    QByteArray id;
-    int i;
-    for (i = 0; i < 3; ++i) {
-        id = createHash();   // Hash algorithm is important!
-        if (findSession(id).isEmpty())
-            break;
+    if (Q_UNLIKELY(!sessionStoreStorage.hasLocalData())) {
+        sessionStoreStorage.setLocalData(new SessionStoreHolder(storeType()));
     }
 
-    if (i == 3)
-        throw RuntimeException("Unable to generate a unique session ID", __FILE__, __LINE__);
+    TSessionStore *store = sessionStoreStorage.localData()->store;
+    if (Q_UNLIKELY(!store)) {
+        tSystemError("Session store not found: %s", qPrintable(storeType()));
+    }
+    return store;
+}
+
 
-    return id;
+/*!
+  Generates a new session ID of 128 random bits. The bits are drawn from
+  a cryptographically secure random number generator, so the ID is
+  unique without looking it up in the session store.
+*/
+QByteArray TSessionManager::generateId()
+{
+    quint32 buffer[4];
+    fillSecureRandom(buffer, 4);
+    return QByteArray::fromRawData((const char *)buffer, sizeof(buffer)).toHex();
 }
 
 
@@ -122,25 +181,36 @@ void TSessionManager::collectGarbage()
 {
     static const int prob = Tf::appSettings()->value(Tf::SessionGcProbability).toInt();
 
-    if (prob > 0) {
+    // Collected by TGcScheduler in the background if the interval is set
+    if (prob > 0 && TGcScheduler::interval(TGcScheduler::Session) == 0) {
         int r = Tf::random(0, prob - 1);
         tSystemDebug("Session garbage collector : rand = %d", r);
 
         if (r == 0) {
             tSystemDebug("Session garbage collector started");
 
-            TSessionStore *store = TSessionStoreFactory::create(storeType());
+            TSessionStore *store = sessionStore();
             if (store) {
                 int gclifetime = Tf::appSettings()->value(Tf::SessionGcMaxLifeTime).toInt();
                 QDateTime expire = QDateTime::currentDateTime().addSecs(-gclifetime);
                 store->gc(expire);
-                TSessionStoreFactory::destroy(storeType(), store);
             }
         }
     }
 }
 
 
+/*!
+  Removes at most \a maxCount sessions older than the \a expire datetime
+  from the session store, and returns the number of removed sessions.
+*/
+int TSessionManager::removeExpiredSessions(const QDateTime &expire, int maxCount)
+{
+    TSessionStore *store = sessionStore();
+    return (store) ? store->gcBatch(expire, maxCount) : 0;
+}
+
+
 TSessionManager &TSessionManager::instance()
 {
     static TSessionManager manager;
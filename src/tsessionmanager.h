@@ -5,6 +5,8 @@
 #include <TGlobal>
 #include <TSession>
 
+class TSessionStore;
+
 
 class T_CORE_EXPORT TSessionManager
 {
@@ -13,15 +15,20 @@ public:
 
     TSession findSession(const QByteArray &id);
     bool store(TSession &session);
+    bool touch(TSession &session);
+    bool isRefreshRequired(const TSession &session) const;
     bool remove(const QByteArray &id);
     QString storeType() const;
     QByteArray generateId();
     void collectGarbage();
+    int removeExpiredSessions(const QDateTime &expire, int maxCount);
 
     static TSessionManager &instance();
     static int sessionLifeTime();
 
 private:
+    TSessionStore *sessionStore() const;
+
     T_DISABLE_COPY(TSessionManager)
     T_DISABLE_MOVE(TSessionManager)
     TSessionManager();
@@ -76,6 +76,7 @@ TSession TSessionMongoStore::find(const QByteArray &id)
     if (ds.status() != QDataStream::Ok) {
         tSystemError("Failed to load a session from the mongoobject store.");
     }
+    setStoredTime(session, so.updatedAt);
     return session;
 }
 
@@ -88,6 +89,33 @@ bool TSessionMongoStore::remove(const QByteArray &id)
 }
 
 
+int TSessionMongoStore::gcBatch(const QDateTime &expire, int maxCount)
+{
+    TMongoODMapper<TSessionMongoObject> mapper;
+    mapper.setLimit(maxCount);
+    mapper.find(TCriteria(TSessionMongoObject::UpdatedAt, TMongo::LessThan, expire));
+
+    QVariantList ids;
+    while (mapper.next()) {
+        ids << mapper.value().sessionId;
+    }
+
+    if (ids.isEmpty()) {
+        return 0;
+    }
+    return TMongoODMapper<TSessionMongoObject>().removeAll(TCriteria(TSessionMongoObject::SessionId, TMongo::In, ids));
+}
+
+
+bool TSessionMongoStore::touch(TSession &session)
+{
+    // Updates the timestamp only
+    TMongoODMapper<TSessionMongoObject> mapper;
+    int cnt = mapper.updateAll(TCriteria(TSessionMongoObject::SessionId, QString::fromUtf8(session.id())), TSessionMongoObject::UpdatedAt, QDateTime::currentDateTime());
+    return (cnt > 0);
+}
+
+
 int TSessionMongoStore::gc(const QDateTime &expire)
 {
     TMongoODMapper<TSessionMongoObject> mapper;
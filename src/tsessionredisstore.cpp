@@ -73,6 +73,13 @@ bool TSessionRedisStore::remove(const QByteArray &id)
 }
 
 
+bool TSessionRedisStore::touch(TSession &session)
+{
+    TRedis redis;
+    return redis.expire('_' + session.id(), lifeTimeSecs());
+}
+
+
 int TSessionRedisStore::gc(const QDateTime &)
 {
     return 0;
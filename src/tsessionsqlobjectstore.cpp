@@ -99,6 +99,7 @@ TSession TSessionSqlObjectStore::find(const QByteArray &id)
     if (ds.status() != QDataStream::Ok) {
         tSystemError("Failed to load a session from the sqlobject store.");
     }
+    setStoredTime(session, so.updated_at);
     return session;
 }
 
@@ -111,6 +112,33 @@ bool TSessionSqlObjectStore::remove(const QByteArray &id)
 }
 
 
+int TSessionSqlObjectStore::gcBatch(const QDateTime &expire, int maxCount)
+{
+    TSqlORMapper<TSessionObject> mapper;
+    mapper.setLimit(maxCount);
+    mapper.find(TCriteria(TSessionObject::UpdatedAt, TSql::LessThan, expire));
+
+    QVariantList ids;
+    for (auto so : mapper) {
+        ids << so.id;
+    }
+
+    if (ids.isEmpty()) {
+        return 0;
+    }
+    return TSqlORMapper<TSessionObject>().removeAll(TCriteria(TSessionObject::Id, TSql::In, ids));
+}
+
+
+bool TSessionSqlObjectStore::touch(TSession &session)
+{
+    // Updates the timestamp only
+    TSqlORMapper<TSessionObject> mapper;
+    int cnt = mapper.updateAll(TCriteria(TSessionObject::Id, session.id()), TSessionObject::UpdatedAt, QDateTime::currentDateTime());
+    return (cnt > 0);
+}
+
+
 int TSessionSqlObjectStore::gc(const QDateTime &expire)
 {
     TSqlORMapper<TSessionObject> mapper;
@@ -21,6 +21,38 @@ qint64 TSessionStore::lifeTimeSecs()
     return lifetime;
 }
 
+/*!
+  Extends the expiration of the \a session that has not been modified
+  since it was found. The default implementation stores the whole
+  session again; reimplement it to just refresh the timestamp or TTL.
+*/
+bool TSessionStore::touch(TSession &session)
+{
+    return store(session);
+}
+
+/*!
+  Removes at most \a maxCount sessions older than the \a expire datetime,
+  and returns the number of the removed sessions. The background GC calls
+  this function repeatedly while it returns \a maxCount. The default
+  implementation calls gc() to remove all of them at once.
+*/
+int TSessionStore::gcBatch(const QDateTime &expire, int maxCount)
+{
+    Q_UNUSED(maxCount);
+    return gc(expire);
+}
+
+/*!
+  Sets the \a time when the \a session was last written to the store.
+  Call this function from reimplementations of find() if the store keeps
+  the timestamp, so that touch() is skipped within the refresh interval.
+*/
+void TSessionStore::setStoredTime(TSession &session, const QDateTime &time)
+{
+    session.storedTime = time;
+}
+
 
 /*!
   \class TSessionStore
@@ -16,8 +16,13 @@ public:
     virtual bool store(TSession &sesion) = 0;
     virtual bool remove(const QByteArray &id) = 0;
     virtual int gc(const QDateTime &expire) = 0;
+    virtual bool touch(TSession &session);
+    virtual int gcBatch(const QDateTime &expire, int maxCount);
 
     static qint64 lifeTimeSecs();
+
+protected:
+    static void setStoredTime(TSession &session, const QDateTime &time);
 };
 
 #endif // TSESSIONSTORE_H
@@ -0,0 +1,118 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tsqlasync.h"
+#include "tsystemglobal.h"
+#include <TAppSettings>
+#include <TDatabaseContext>
+#include <TfException>
+#include <QRunnable>
+#include <QThreadPool>
+
+/*!
+  \class TSqlAsync
+  \brief The TSqlAsync class executes database tasks on the database I/O
+  threads of the process, so that an action can issue independent queries
+  concurrently and join their results.
+
+  \code
+  auto f1 = TSqlQuery::execAsync("SELECT COUNT(*) FROM blog");
+  auto f2 = TSqlORMapper<BlogObject>().findAsync(crit);
+  auto count = f1.get().value(0).value(0).toInt();
+  QList<BlogObject> blogs = f2.get();
+  \endcode
+
+  The number of the threads is specified by the SqlAsyncThreadCount
+  setting, and the SQL database pool reserves a connection for each.
+  \sa TSqlQuery::execAsync(), TSqlORMapper::findAsync()
+*/
+
+namespace {
+
+class AsyncTask : public QRunnable
+{
+public:
+    AsyncTask(const std::function<bool()> &task) : _task(task) {}
+
+    void run() override
+    {
+        TDatabaseContext context;
+        TDatabaseContext::setCurrentDatabaseContext(&context);
+
+        try {
+            if (_task()) {
+                context.commitTransactions();
+            } else {
+                context.rollbackTransactions();
+            }
+        } catch (std::exception &e) {
+            tSystemError("Caught Exception in database I/O thread: %s  [%s:%d]", e.what(), __FILE__, __LINE__);
+            context.rollbackTransactions();
+        }
+
+        context.release();
+        TDatabaseContext::setCurrentDatabaseContext(nullptr);
+    }
+
+private:
+    std::function<bool()> _task;
+};
+
+
+QThreadPool *threadPool()
+{
+    static QThreadPool *pool = []() {
+        auto *p = new QThreadPool;
+        p->setMaxThreadCount(TSqlAsync::maxThreadCount());
+        p->setExpiryTimeout(-1);  // keeps the threads
+        return p;
+    }();
+    return pool;
+}
+
+}
+
+/*!
+  Returns true if a transaction is active on the database \a databaseId in
+  the database context of the calling thread; otherwise returns false.
+*/
+bool TSqlAsync::isTransactionBound(int databaseId)
+{
+    auto *context = TDatabaseContext::currentDatabaseContext();
+    return context && context->isTransactionActive(databaseId);
+}
+
+/*!
+  Returns the maximum number of the database I/O threads of the process.
+*/
+int TSqlAsync::maxThreadCount()
+{
+    static const int count = []() {
+        int num = Tf::appSettings()->value(Tf::SqlAsyncThreadCount, 4).toInt();
+        return qMax(num, 1);
+    }();
+    return count;
+}
+
+
+/*!
+  Executes the \a task on a database I/O thread without waiting for it,
+  whether a transaction is active in the current context or not.
+*/
+void TSqlAsync::post(const std::function<void()> &task)
+{
+    start([task]() {
+        task();
+        return true;
+    });
+}
+
+
+void TSqlAsync::start(const std::function<bool()> &task)
+{
+    threadPool()->start(new AsyncTask(task));
+}
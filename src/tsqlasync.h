@@ -0,0 +1,60 @@
+#ifndef TSQLASYNC_H
+#define TSQLASYNC_H
+
+#include <TGlobal>
+#include <functional>
+#include <future>
+#include <memory>
+
+
+class T_CORE_EXPORT TSqlAsync
+{
+public:
+    template <class R> static std::future<R> run(int databaseId, const std::function<R()> &task);
+    static void post(const std::function<void()> &task);
+    static bool isTransactionBound(int databaseId);
+    static int maxThreadCount();
+
+private:
+    static void start(const std::function<bool()> &task);
+
+    T_DISABLE_COPY(TSqlAsync)
+    T_DISABLE_MOVE(TSqlAsync)
+};
+
+/*!
+  Executes the \a task on a database I/O thread and returns the future of
+  its result. The task has its own database context, so that its queries
+  run on connections checked out of the pool for the thread, and the
+  transaction is committed when the task returns successfully, or rolled
+  back when it throws an exception.
+  If a transaction is active on the database \a databaseId in the current
+  context, the task is executed in the calling thread instead, so that it
+  sees the uncommitted changes of the transaction.
+  An exception thrown by the task is rethrown by std::future::get().
+*/
+template <class R>
+inline std::future<R> TSqlAsync::run(int databaseId, const std::function<R()> &task)
+{
+    auto promise = std::make_shared<std::promise<R>>();
+    std::future<R> future = promise->get_future();
+
+    auto exec = [promise, task]() {
+        try {
+            promise->set_value(task());
+            return true;
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+            return false;
+        }
+    };
+
+    if (isTransactionBound(databaseId)) {
+        exec();  // keeps the transactional work on the owning context
+    } else {
+        start(exec);
+    }
+    return future;
+}
+
+#endif // TSQLASYNC_H
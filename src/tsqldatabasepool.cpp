@@ -8,6 +8,7 @@
 #include "tsqldatabasepool.h"
 #include "tsqldatabase.h"
 #include "tsqldriverextensionfactory.h"
+#include "tsqlasync.h"
 #include "tsystemglobal.h"
 #include <TWebApplication>
 #include <TSqlQuery>
@@ -15,16 +16,43 @@
 #include <QMutexLocker>
 #include <QFileInfo>
 #include <QDir>
+#include <climits>
 #include <ctime>
 
 constexpr auto CONN_NAME_FORMAT = "rdb%02d_%d";
+constexpr auto REPLICA_CONN_NAME_FORMAT = "rdb%02dr%02d_%d";
+constexpr int MIN_REPLICA_BACKOFF = 100;  // msecs
+
+
+struct TSqlDatabasePool::Replica
+{
+    TStack<QString> cachedDatabase;
+    TAtomic<uint> lastCachedTime {0};
+    TStack<QString> availableNames;
+    TAtomic<int> outstanding {0};  // number of connections in use
+    TAtomic<int> backoff {0};      // msecs
+    TAtomic<qint64> retryTime {0};
+    TAtomic<quint64> errors {0};
+};
+
+
+struct TSqlDatabasePool::ReplicaSet
+{
+    ~ReplicaSet() { qDeleteAll(replicas); }
+
+    QVector<Replica *> replicas;
+    TAtomic<uint> cursor {0};
+    bool leastOutstanding {false};
+    int maxBackoff {30000};  // msecs
+};
 
 
 TSqlDatabasePool *TSqlDatabasePool::instance()
 {
     static TSqlDatabasePool *databasePool = []() {
         auto *pool = new TSqlDatabasePool;
-        pool->maxConnects = Tf::app()->maxNumberOfThreadsPerAppServer();
+        // Connections for the action threads and the database I/O threads
+        pool->maxConnects = Tf::app()->maxNumberOfThreadsPerAppServer() + TSqlAsync::maxThreadCount();
         pool->init();
         return pool;
     }();
@@ -53,8 +81,21 @@ TSqlDatabasePool::~TSqlDatabasePool()
         while (stack.pop(name)) {
             TSqlDatabase::removeDatabase(name);
         }
+
+        for (auto *replica : replicaSets[j].replicas) {
+            while (replica->cachedDatabase.pop(name)) {
+                QSqlDatabase db = TSqlDatabase::database(name).sqlDatabase();
+                db.close();
+                TSqlDatabase::removeDatabase(name);
+            }
+
+            while (replica->availableNames.pop(name)) {
+                TSqlDatabase::removeDatabase(name);
+            }
+        }
     }
 
+    delete[] replicaSets;
     delete[] cachedDatabase;
     delete[] lastCachedTime;
     delete[] availableNames;
@@ -84,6 +125,7 @@ void TSqlDatabasePool::init()
     cachedDatabase = new TStack<QString>[Tf::app()->sqlDatabaseSettingsCount()];
     lastCachedTime = new TAtomic<uint>[Tf::app()->sqlDatabaseSettingsCount()];
     availableNames = new TStack<QString>[Tf::app()->sqlDatabaseSettingsCount()];
+    replicaSets = new ReplicaSet[Tf::app()->sqlDatabaseSettingsCount()];
     bool aval = false;
     tSystemDebug("SQL database available");
 
@@ -107,6 +149,8 @@ void TSqlDatabasePool::init()
             stack.push(db.connectionName());  // push onto stack
             tSystemDebug("Add Database successfully. name:%s", qPrintable(db.connectionName()));
         }
+
+        initReplicas(j, type);
     }
 
     if (aval) {
@@ -116,58 +160,195 @@ void TSqlDatabasePool::init()
 }
 
 
+/*!
+  Adds the connections to the read replicas of the database specified by
+  \a databaseId, which are listed in ReplicaHostNames as 'host[:port]'.
+*/
+void TSqlDatabasePool::initReplicas(int databaseId, const QString &driverType)
+{
+    auto settings = Tf::app()->sqlDatabaseSettings(databaseId);
+    const QStringList hosts = settings.value("ReplicaHostNames").toString().split(',', QString::SkipEmptyParts);
+    auto &set = replicaSets[databaseId];
+
+    set.leastOutstanding = (settings.value("ReplicaSelection").toString().trimmed().toLower() == QLatin1String("leastoutstanding"));
+    set.maxBackoff = qMax(settings.value("ReplicaMaxBackoff", 30000).toInt(), MIN_REPLICA_BACKOFF);
+
+    for (auto host : hosts) {
+        host = host.trimmed();
+        if (host.isEmpty()) {
+            continue;
+        }
+
+        int port = 0;
+        int idx = host.lastIndexOf(':');
+        if (idx > 0 && host.indexOf(':') == idx) {
+            port = host.mid(idx + 1).toInt();
+            host.truncate(idx);
+        }
+
+        auto *replica = new Replica;
+        for (int i = 0; i < maxConnects; ++i) {
+            TSqlDatabase &db = TSqlDatabase::addDatabase(driverType, QString().sprintf(REPLICA_CONN_NAME_FORMAT, databaseId, set.replicas.count(), i));
+            if (!db.isValid()) {
+                break;
+            }
+
+            setDatabaseSettings(db, databaseId);
+            db.sqlDatabase().setHostName(host);
+            if (port > 0) {
+                db.sqlDatabase().setPort(port);
+            }
+            replica->availableNames.push(db.connectionName());
+        }
+        set.replicas << replica;
+        tSystemDebug("Add replica database. id:%d  host:%s  port:%d", databaseId, qPrintable(host), port);
+    }
+}
+
+
 QSqlDatabase TSqlDatabasePool::database(int databaseId)
+{
+    if (Q_LIKELY(databaseId >= 0 && databaseId < Tf::app()->sqlDatabaseSettingsCount())) {
+        return popDatabase(cachedDatabase[databaseId], availableNames[databaseId]);
+    }
+    throw RuntimeException("No pooled connection", __FILE__, __LINE__);
+}
+
+/*!
+  Returns a connection to one of the read replicas of the database
+  specified by \a databaseId, which is selected by round-robin or by the
+  least number of outstanding connections. A replica which failed to open
+  is skipped until its backoff time, which doubles on every failure up to
+  ReplicaMaxBackoff, has elapsed. If no replica is available, returns a
+  connection to the primary database.
+*/
+QSqlDatabase TSqlDatabasePool::replicaDatabase(int databaseId)
+{
+    if (replicaCount(databaseId) == 0) {
+        return database(databaseId);
+    }
+
+    auto &set = replicaSets[databaseId];
+    const int num = set.replicas.count();
+    int start = 0;
+
+    if (set.leastOutstanding) {
+        int min = INT_MAX;
+        for (int i = 0; i < num; ++i) {
+            int cnt = set.replicas[i]->outstanding.load();
+            if (cnt < min) {
+                min = cnt;
+                start = i;
+            }
+        }
+    } else {
+        start = set.cursor++ % num;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 0; i < num; ++i) {
+        const int index = (start + i) % num;
+        auto *replica = set.replicas[index];
+        if (now < replica->retryTime.load()) {
+            continue;
+        }
+
+        QSqlDatabase db = popDatabase(replica->cachedDatabase, replica->availableNames);
+        if (db.isValid()) {
+            if (replica->backoff.exchange(0) > 0) {
+                replica->retryTime.store(0);
+                tSystemInfo("Replica database reconnected. id:%d  replica:%d", databaseId, index);
+            }
+            replica->outstanding++;
+            return db;
+        }
+
+        int wait = qBound(MIN_REPLICA_BACKOFF, replica->backoff.load() * 2, set.maxBackoff);
+        replica->backoff.store(wait);
+        replica->retryTime.store(now + wait);
+        replica->errors++;
+        tSystemError("Replica database open error. id:%d  replica:%d  retry after %d msecs", databaseId, index, wait);
+    }
+
+    tSystemWarn("No replica database available, uses the primary. id:%d", databaseId);
+    return database(databaseId);
+}
+
+/*!
+  Returns the number of the read replicas of the database specified by
+  \a databaseId.
+*/
+int TSqlDatabasePool::replicaCount(int databaseId) const
+{
+    if (databaseId < 0 || databaseId >= Tf::app()->sqlDatabaseSettingsCount() || !replicaSets) {
+        return 0;
+    }
+    return replicaSets[databaseId].replicas.count();
+}
+
+
+/*!
+  Returns the number of the failures to open a connection to the read
+  replicas of the database specified by \a databaseId.
+*/
+quint64 TSqlDatabasePool::replicaErrorCount(int databaseId) const
+{
+    quint64 count = 0;
+    if (replicaCount(databaseId) > 0) {
+        for (auto *replica : replicaSets[databaseId].replicas) {
+            count += replica->errors.load();
+        }
+    }
+    return count;
+}
+
+
+QSqlDatabase TSqlDatabasePool::popDatabase(TStack<QString> &cache, TStack<QString> &stack)
 {
     TSqlDatabase tdb;
 
-    if (Q_LIKELY(databaseId >= 0 && databaseId < Tf::app()->sqlDatabaseSettingsCount())) {
-        auto &cache = cachedDatabase[databaseId];
-        auto &stack = availableNames[databaseId];
-
-        for (;;) {
-            QString name;
-            if (cache.pop(name)) {
-                tdb = TSqlDatabase::database(name);
-                if (Q_LIKELY(tdb.sqlDatabase().isOpen())) {
-                    tSystemDebug("Gets cached database: %s", qPrintable(tdb.connectionName()));
-                    return tdb.sqlDatabase();
-                } else {
-                    tSystemError("Pooled database is not open: %s  [%s:%d]", qPrintable(tdb.connectionName()), __FILE__, __LINE__);
-                    stack.push(name);
-                    continue;
-                }
+    for (;;) {
+        QString name;
+        if (cache.pop(name)) {
+            tdb = TSqlDatabase::database(name);
+            if (Q_LIKELY(tdb.sqlDatabase().isOpen())) {
+                tSystemDebug("Gets cached database: %s", qPrintable(tdb.connectionName()));
+                return tdb.sqlDatabase();
+            } else {
+                tSystemError("Pooled database is not open: %s  [%s:%d]", qPrintable(tdb.connectionName()), __FILE__, __LINE__);
+                stack.push(name);
+                continue;
             }
+        }
 
-            if (Q_LIKELY(stack.pop(name))) {
-                auto tdb = TSqlDatabase::database(name);
-                if (Q_UNLIKELY(tdb.sqlDatabase().isOpen())) {
-                    tSystemWarn("Gets a opend database: %s", qPrintable(tdb.connectionName()));
-                    return tdb.sqlDatabase();
-                } else {
-                    if (Q_UNLIKELY(!tdb.sqlDatabase().open())) {
-                        tError("Database open error. Invalid database settings, or maximum number of SQL connection exceeded.");
-                        tSystemError("SQL database open error: %s", qPrintable(tdb.sqlDatabase().connectionName()));
-                        stack.push(name);
-                        return QSqlDatabase();
-                    }
+        if (Q_LIKELY(stack.pop(name))) {
+            auto tdb = TSqlDatabase::database(name);
+            if (Q_UNLIKELY(tdb.sqlDatabase().isOpen())) {
+                tSystemWarn("Gets a opend database: %s", qPrintable(tdb.connectionName()));
+                return tdb.sqlDatabase();
+            } else {
+                if (Q_UNLIKELY(!tdb.sqlDatabase().open())) {
+                    tError("Database open error. Invalid database settings, or maximum number of SQL connection exceeded.");
+                    tSystemError("SQL database open error: %s", qPrintable(tdb.sqlDatabase().connectionName()));
+                    stack.push(name);
+                    return QSqlDatabase();
+                }
 
-                    tSystemDebug("SQL database opened successfully (env:%s)", qPrintable(Tf::app()->databaseEnvironment()));
-                    tSystemDebug("Gets database: %s", qPrintable(tdb.sqlDatabase().connectionName()));
+                tSystemDebug("SQL database opened successfully (env:%s)", qPrintable(Tf::app()->databaseEnvironment()));
+                tSystemDebug("Gets database: %s", qPrintable(tdb.sqlDatabase().connectionName()));
 
-                    // Executes setup-queries
-                    if (! tdb.postOpenStatements().isEmpty()) {
-                        TSqlQuery query(tdb.sqlDatabase());
-                        for (QString st : tdb.postOpenStatements()) {
-                            st = st.trimmed();
-                            query.exec(st);
-                        }
+                // Executes setup-queries
+                if (! tdb.postOpenStatements().isEmpty()) {
+                    TSqlQuery query(tdb.sqlDatabase());
+                    for (QString st : tdb.postOpenStatements()) {
+                        st = st.trimmed();
+                        query.exec(st);
                     }
-                    return tdb.sqlDatabase();
                 }
+                return tdb.sqlDatabase();
             }
         }
     }
-    throw RuntimeException("No pooled connection", __FILE__, __LINE__);
 }
 
 
@@ -246,9 +427,19 @@ void TSqlDatabasePool::pool(QSqlDatabase &database, bool forceClose)
         int databaseId = getDatabaseId(database);
 
         if (databaseId >= 0 && databaseId < Tf::app()->sqlDatabaseSettingsCount()) {
+            int replicaIndex = getReplicaIndex(database);
+            if (replicaIndex >= 0) {
+                replicaSets[databaseId].replicas[replicaIndex]->outstanding--;
+            }
+
             if (forceClose) {
                 tSystemWarn("Force close database: %s", qPrintable(database.connectionName()));
                 closeDatabase(database);
+            } else if (replicaIndex >= 0) {
+                auto *replica = replicaSets[databaseId].replicas[replicaIndex];
+                replica->cachedDatabase.push(database.connectionName());
+                replica->lastCachedTime.store((uint)std::time(nullptr));
+                tSystemDebug("Pooled replica database: %s", qPrintable(database.connectionName()));
             } else {
                 // pool
                 cachedDatabase[databaseId].push(database.connectionName());
@@ -281,6 +472,16 @@ void TSqlDatabasePool::timerEvent(QTimerEvent *event)
                 closeDatabase(db);
             }
         }
+
+        for (int i = 0; i < Tf::app()->sqlDatabaseSettingsCount(); ++i) {
+            for (auto *replica : replicaSets[i].replicas) {
+                while (replica->lastCachedTime.load() < (uint)std::time(nullptr) - 30
+                       && replica->cachedDatabase.pop(name)) {
+                    QSqlDatabase db = TSqlDatabase::database(name).sqlDatabase();
+                    closeDatabase(db);
+                }
+            }
+        }
     } else {
         QObject::timerEvent(event);
     }
@@ -291,9 +492,15 @@ void TSqlDatabasePool::closeDatabase(QSqlDatabase &database)
 {
     int id = getDatabaseId(database);
     QString name = database.connectionName();
+    int replicaIndex = getReplicaIndex(database);
     database.close();
     tSystemDebug("Closed database connection, name: %s", qPrintable(name));
-    availableNames[id].push(name);
+
+    if (replicaIndex >= 0) {
+        replicaSets[id].replicas[replicaIndex]->availableNames.push(name);
+    } else {
+        availableNames[id].push(name);
+    }
 }
 
 
@@ -307,3 +514,20 @@ int TSqlDatabasePool::getDatabaseId(const QSqlDatabase &database)
     }
     return -1;
 }
+
+/*!
+  Returns the index of the read replica for the connection \a database,
+  or -1 if it is a connection to the primary database.
+*/
+int TSqlDatabasePool::getReplicaIndex(const QSqlDatabase &database)
+{
+    const QString name = database.connectionName();
+    if (name.length() > 8 && name.at(5) == QLatin1Char('r')) {
+        bool ok;
+        int idx = name.mid(6, 2).toInt(&ok);
+        if (ok) {
+            return idx;
+        }
+    }
+    return -1;
+}
@@ -21,23 +21,33 @@ class T_CORE_EXPORT TSqlDatabasePool : public QObject
 public:
     ~TSqlDatabasePool();
     QSqlDatabase database(int databaseId = 0);
+    QSqlDatabase replicaDatabase(int databaseId = 0);
+    int replicaCount(int databaseId = 0) const;
+    quint64 replicaErrorCount(int databaseId = 0) const;
     void pool(QSqlDatabase &database, bool forceClose = false);
 
     static TSqlDatabasePool *instance();
     static bool setDatabaseSettings(TSqlDatabase &database, int databaseId);
     static int getDatabaseId(const QSqlDatabase &database);
+    static int getReplicaIndex(const QSqlDatabase &database);
 
 protected:
     void init();
+    void initReplicas(int databaseId, const QString &driverType);
+    QSqlDatabase popDatabase(TStack<QString> &cache, TStack<QString> &stack);
     void timerEvent(QTimerEvent *event);
     void closeDatabase(QSqlDatabase &database);
 
 private:
+    struct Replica;
+    struct ReplicaSet;
+
     TSqlDatabasePool();
 
     TStack<QString> *cachedDatabase {nullptr};
     TAtomic<uint> *lastCachedTime {nullptr};
     TStack<QString> *availableNames {nullptr};
+    ReplicaSet *replicaSets {nullptr};
     int maxConnects {0};
     QBasicTimer timer;
 
@@ -6,3 +6,48 @@
  */
 
 #include "tsqldriverextension.h"
+#include <TSqlQuery>
+#include <QSqlDriver>
+
+
+/*!
+  Returns a multi-row INSERT statement with placeholders for the \a fields
+  of \a rowCount rows. The table name and the field names are escaped
+  according to the rules of the \a driver. If \a alias is not empty, the
+  table is given the alias, as in "INSERT INTO table AS alias".
+*/
+QString TSqlDriverExtension::bulkInsertStatement(const QString &tableName, const QStringList &fields, int rowCount,
+                                                 const QSqlDriver *driver, const QString &alias)
+{
+    QString statement;
+    if (tableName.isEmpty() || fields.isEmpty() || rowCount <= 0) {
+        return statement;
+    }
+
+    QString row;
+    row.reserve(fields.count() * 2 + 2);
+    row.append(QLatin1Char('('));
+
+    statement.reserve(128 + fields.count() * 16 + (fields.count() * 2 + 2) * rowCount);
+    statement.append(QLatin1String("INSERT INTO "));
+    statement.append(TSqlQuery::escapeIdentifier(tableName, QSqlDriver::TableName, driver));
+    if (!alias.isEmpty()) {
+        statement.append(QLatin1String(" AS ")).append(alias);
+    }
+    statement.append(QLatin1String(" ("));
+
+    for (auto &field : fields) {
+        statement.append(TSqlQuery::escapeIdentifier(field, QSqlDriver::FieldName, driver)).append(QLatin1String(", "));
+        row.append(QLatin1String("?,"));
+    }
+    statement.chop(2);
+    row.chop(1);
+    row.append(QLatin1String("),"));
+
+    statement.append(QLatin1String(") VALUES "));
+    for (int i = 0; i < rowCount; ++i) {
+        statement.append(row);
+    }
+    statement.chop(1);
+    return statement;
+}
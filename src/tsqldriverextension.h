@@ -2,9 +2,11 @@
 #define TSQLDRIVEREXTENSION_H
 
 #include <QString>
+#include <QStringList>
 #include <TGlobal>
 
 class QSqlRecord;
+class QSqlDriver;
 
 
 class T_CORE_EXPORT TSqlDriverExtension
@@ -15,6 +17,11 @@ public:
     virtual bool isUpsertSupported() const { return false; }
     virtual QString upsertStatement(const QString &tableName, const QSqlRecord &recordToInsert,
                                     const QSqlRecord &recordToUpdate, const QString &pkField, const QString &lockRevisionField) const;
+    virtual QString bulkUpsertStatement(const QString &tableName, const QStringList &insertFields, int rowCount,
+                                        const QStringList &updateFields, const QString &pkField, const QString &lockRevisionField) const;
+
+    static QString bulkInsertStatement(const QString &tableName, const QStringList &fields, int rowCount,
+                                       const QSqlDriver *driver, const QString &alias = QString());
 };
 
 
@@ -29,4 +36,17 @@ inline QString TSqlDriverExtension::upsertStatement(const QString &tableName, co
     return QString();
 }
 
+
+inline QString TSqlDriverExtension::bulkUpsertStatement(const QString &tableName, const QStringList &insertFields, int rowCount,
+                                                        const QStringList &updateFields, const QString &pkField, const QString &lockRevisionField) const
+{
+    Q_UNUSED(tableName);
+    Q_UNUSED(insertFields);
+    Q_UNUSED(rowCount);
+    Q_UNUSED(updateFields);
+    Q_UNUSED(pkField);
+    Q_UNUSED(lockRevisionField);
+    return QString();
+}
+
 #endif // TSQLDRIVEREXTENSION_H
@@ -69,6 +69,35 @@ namespace {
         vals.chop(2); // remove trailing comma
         return vals;
     }
+
+
+    // Generates the SET clause which assigns the values proposed for insertion
+    QString generateBulkUpdateValues(const QString &table, const QStringList &fields, const QString &lockRevisionField, const QSqlDriver *driver, bool excluded)
+    {
+        QString vals;
+        for (auto &field : fields) {
+            auto str = prepareIdentifier(field, QSqlDriver::FieldName, driver);
+            vals.append(str).append(QLatin1Char('='));
+            if (excluded) {
+                vals.append(QLatin1String("EXCLUDED.")).append(str);
+            } else {
+                vals.append(QLatin1String("VALUES(")).append(str).append(QLatin1Char(')'));
+            }
+            vals.append(QLatin1String(", "));
+        }
+
+        if (! lockRevisionField.isEmpty()) {
+            auto str = prepareIdentifier(lockRevisionField, QSqlDriver::FieldName, driver);
+            vals.append(str).append(QLatin1String("=1+"));
+            if (! table.isEmpty()) {
+                vals.append(table).append(QLatin1Char('.'));
+            }
+            vals.append(str).append(QLatin1String(", "));
+        }
+
+        vals.chop(2); // remove trailing comma
+        return vals;
+    }
 }
 
 class TMySQLDriverExtension : public TSqlDriverExtension
@@ -79,6 +108,8 @@ public:
     bool isUpsertSupported() const override { return true; }
     QString upsertStatement(const QString &tableName, const QSqlRecord &recordToInsert, const QSqlRecord &recordToUpdate,
                             const QString &pkField, const QString &lockRevisionField) const override;
+    QString bulkUpsertStatement(const QString &tableName, const QStringList &insertFields, int rowCount,
+                                const QStringList &updateFields, const QString &pkField, const QString &lockRevisionField) const override;
 
 private:
     const QSqlDriver *driver {nullptr};
@@ -116,6 +147,22 @@ QString TMySQLDriverExtension::upsertStatement(const QString &tableName, const Q
 }
 
 
+QString TMySQLDriverExtension::bulkUpsertStatement(const QString &tableName, const QStringList &insertFields, int rowCount,
+                                                   const QStringList &updateFields, const QString &, const QString &lockRevisionField) const
+{
+    QString statement;
+
+    if (tableName.isEmpty() || insertFields.isEmpty() || updateFields.isEmpty() || rowCount <= 0) {
+        return statement;
+    }
+
+    statement = bulkInsertStatement(tableName, insertFields, rowCount, driver);
+    statement.append(QLatin1String(" ON DUPLICATE KEY UPDATE "));
+    statement.append(generateBulkUpdateValues("", updateFields, lockRevisionField, driver, false));
+    return statement;
+}
+
+
 class TPostgreSQLDriverExtension : public TSqlDriverExtension
 {
 public:
@@ -124,6 +171,8 @@ public:
     bool isUpsertSupported() const override { return true; }
     QString upsertStatement(const QString &tableName, const QSqlRecord &recordToInsert, const QSqlRecord &recordToUpdate,
                             const QString &pkField, const QString &lockRevisionField) const override;
+    QString bulkUpsertStatement(const QString &tableName, const QStringList &insertFields, int rowCount,
+                                const QStringList &updateFields, const QString &pkField, const QString &lockRevisionField) const override;
 
 private:
     const QSqlDriver *driver {nullptr};
@@ -162,6 +211,24 @@ QString TPostgreSQLDriverExtension::upsertStatement(const QString &tableName, co
     return statement;
 }
 
+
+QString TPostgreSQLDriverExtension::bulkUpsertStatement(const QString &tableName, const QStringList &insertFields, int rowCount,
+                                                        const QStringList &updateFields, const QString &pkField, const QString &lockRevisionField) const
+{
+    QString statement;
+
+    if (tableName.isEmpty() || insertFields.isEmpty() || pkField.isEmpty() || updateFields.isEmpty() || rowCount <= 0) {
+        return statement;
+    }
+
+    statement = bulkInsertStatement(tableName, insertFields, rowCount, driver, QLatin1String("t0"));
+    statement.append(QLatin1String(" ON CONFLICT ("));
+    statement.append(prepareIdentifier(pkField, QSqlDriver::FieldName, driver));
+    statement.append(") DO UPDATE SET ");
+    statement.append(generateBulkUpdateValues("t0", updateFields, lockRevisionField, driver, true));
+    return statement;
+}
+
 namespace {
     // Extension Keys
     QString MYSQL_KEY;
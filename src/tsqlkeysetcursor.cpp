@@ -0,0 +1,368 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tsqlkeysetcursor.h"
+#include <TAppSettings>
+#include <TCryptMac>
+#include <QDateTime>
+#include <cstring>
+
+constexpr quint8 CURSOR_VERSION = 2;
+constexpr int MAX_CURSOR_LENGTH = 4096;  // in Base64URL
+constexpr int MAX_COLUMNS = 32;
+constexpr int MAC_LENGTH = 16;  // HMAC-SHA256 truncated to 128 bits
+
+namespace {
+
+enum Tag : uchar {
+    Null = 0,
+    False,
+    True,
+    LongLong,
+    ULongLong,
+    Double,
+    String,
+    ByteArray,
+    DateTime,
+    Date,
+    Time,
+};
+
+enum Flag : uchar {
+    Backward = 0x01,
+};
+
+
+const QByteArray &cursorSecret()
+{
+    static const QByteArray secret = Tf::appSettings()->value(Tf::SessionSecret).toByteArray();
+    return secret;
+}
+
+
+inline void writeVarint(QByteArray &out, quint64 n)
+{
+    while (n >= 0x80) {
+        out += (char)(n | 0x80);
+        n >>= 7;
+    }
+    out += (char)n;
+}
+
+
+inline quint64 zigzag(qint64 n)
+{
+    return ((quint64)n << 1) ^ (quint64)(n >> 63);
+}
+
+
+inline qint64 unzigzag(quint64 n)
+{
+    return (qint64)(n >> 1) ^ -(qint64)(n & 1);
+}
+
+
+inline void writeBytes(QByteArray &out, const QByteArray &bytes)
+{
+    writeVarint(out, bytes.length());
+    out += bytes;
+}
+
+
+void writeValue(QByteArray &out, const QVariant &value)
+{
+    if (value.isNull()) {
+        out += (char)Null;
+        return;
+    }
+
+    switch (value.userType()) {
+    case QMetaType::Bool:
+        out += (char)(value.toBool() ? True : False);
+        break;
+
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        out += (char)LongLong;
+        writeVarint(out, zigzag(value.toLongLong()));
+        break;
+
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        out += (char)ULongLong;
+        writeVarint(out, value.toULongLong());
+        break;
+
+    case QMetaType::Float:
+    case QMetaType::Double: {
+        out += (char)Double;
+        double d = value.toDouble();
+        char buf[sizeof(d)];
+        std::memcpy(buf, &d, sizeof(d));
+        out.append(buf, sizeof(buf));
+        break; }
+
+    case QMetaType::QByteArray:
+        out += (char)ByteArray;
+        writeBytes(out, value.toByteArray());
+        break;
+
+    case QMetaType::QDateTime: {
+        const QDateTime dt = value.toDateTime();
+        out += (char)DateTime;
+        out += (char)((dt.timeSpec() == Qt::UTC) ? Qt::UTC : Qt::LocalTime);
+        writeVarint(out, zigzag(dt.toMSecsSinceEpoch()));
+        break; }
+
+    case QMetaType::QDate:
+        out += (char)Date;
+        writeVarint(out, zigzag(value.toDate().toJulianDay()));
+        break;
+
+    case QMetaType::QTime:
+        out += (char)Time;
+        writeVarint(out, QTime(0, 0).msecsTo(value.toTime()));
+        break;
+
+    default:
+        // Strings and the types convertible to them, such as numerics
+        out += (char)String;
+        writeBytes(out, value.toString().toUtf8());
+        break;
+    }
+}
+
+// Reads the payload in place, checking the bounds
+class Reader
+{
+public:
+    Reader(const QByteArray &data) : ptr((const uchar *)data.constData()), end(ptr + data.length()) { }
+
+    bool atEnd() const { return ptr == end; }
+
+    bool readByte(uchar &c)
+    {
+        if (ptr >= end) {
+            return false;
+        }
+        c = *ptr++;
+        return true;
+    }
+
+    bool readVarint(quint64 &n)
+    {
+        n = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uchar c;
+            if (!readByte(c)) {
+                return false;
+            }
+            n |= (quint64)(c & 0x7f) << shift;
+            if (!(c & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readBytes(QByteArray &bytes)
+    {
+        quint64 n;
+        if (!readVarint(n) || n > (quint64)(end - ptr)) {
+            return false;
+        }
+        bytes = QByteArray((const char *)ptr, (int)n);
+        ptr += n;
+        return true;
+    }
+
+    bool readValue(QVariant &value);
+
+private:
+    const uchar *ptr;
+    const uchar *end;
+};
+
+
+bool Reader::readValue(QVariant &value)
+{
+    uchar tag;
+    quint64 n;
+    QByteArray bytes;
+
+    if (!readByte(tag)) {
+        return false;
+    }
+
+    switch (tag) {
+    case Null:
+        value = QVariant();
+        return true;
+
+    case False:
+    case True:
+        value = QVariant(tag == True);
+        return true;
+
+    case LongLong:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant((qlonglong)unzigzag(n));
+        return true;
+
+    case ULongLong:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant((qulonglong)n);
+        return true;
+
+    case Double: {
+        double d;
+        if (end - ptr < (int)sizeof(d)) {
+            return false;
+        }
+        std::memcpy(&d, ptr, sizeof(d));
+        ptr += sizeof(d);
+        value = QVariant(d);
+        return true; }
+
+    case String:
+        if (!readBytes(bytes)) {
+            return false;
+        }
+        value = QVariant(QString::fromUtf8(bytes));
+        return true;
+
+    case ByteArray:
+        if (!readBytes(bytes)) {
+            return false;
+        }
+        value = QVariant(bytes);
+        return true;
+
+    case DateTime: {
+        uchar spec;
+        if (!readByte(spec) || (spec != Qt::LocalTime && spec != Qt::UTC) || !readVarint(n)) {
+            return false;
+        }
+        value = QVariant(QDateTime::fromMSecsSinceEpoch(unzigzag(n), (Qt::TimeSpec)spec));
+        return true; }
+
+    case Date:
+        if (!readVarint(n)) {
+            return false;
+        }
+        value = QVariant(QDate::fromJulianDay(unzigzag(n)));
+        return true;
+
+    case Time:
+        if (!readVarint(n) || n >= 86400000) {
+            return false;
+        }
+        value = QVariant(QTime(0, 0).addMSecs((int)n));
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+inline QByteArray mac(const QByteArray &payload)
+{
+    return TCryptMac::hmacSha256(payload, cursorSecret()).left(MAC_LENGTH);
+}
+
+}
+
+/*!
+  \class TSqlKeysetCursor
+  \brief The TSqlKeysetCursor class encodes the sort key of a row into
+  an opaque cursor for the keyset pagination of TSqlORMapper.
+
+  The cursor is signed with HMAC-SHA256 keyed by Session.Secret in
+  application.ini, so that a client can not tamper with it, and only the
+  values of a few fixed types are decoded within the bounds of its length.
+  \sa TSqlORMapper::seek()
+*/
+
+/*!
+  Returns the cursor of the sort key \a values of the \a columns, which
+  points to the rows after them, or before them if \a backward is true.
+*/
+QByteArray TSqlKeysetCursor::encode(const QStringList &columns, const QVariantList &values, bool backward)
+{
+    QByteArray payload;
+    payload.reserve(64);
+    payload += (char)CURSOR_VERSION;
+    payload += (char)(backward ? Backward : 0);
+    writeVarint(payload, values.count());
+    for (int i = 0; i < values.count(); ++i) {
+        writeBytes(payload, columns.value(i).toUtf8());
+        writeValue(payload, values[i]);
+    }
+
+    const auto options = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+    return payload.toBase64(options) + '.' + mac(payload).toBase64(options);
+}
+
+/*!
+  Verifies the signature of the \a cursor made by encode() and decodes
+  it into the sort key \a values and the direction \a backward. Returns
+  false if the cursor is tampered, malformed or made for columns other
+  than \a columns.
+*/
+bool TSqlKeysetCursor::decode(const QByteArray &cursor, const QStringList &columns, QVariantList &values, bool &backward)
+{
+    values.clear();
+    backward = false;
+
+    int dot = cursor.indexOf('.');
+    if (cursor.length() > MAX_CURSOR_LENGTH || dot <= 0) {
+        return false;
+    }
+
+    const auto options = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+    QByteArray payload = QByteArray::fromBase64(cursor.left(dot), options);
+    QByteArray digest = QByteArray::fromBase64(cursor.mid(dot + 1), options);
+    if (payload.isEmpty() || !TCryptMac::equals(digest, mac(payload))) {
+        return false;
+    }
+
+    Reader reader(payload);
+    uchar version, flags;
+    quint64 count;
+    if (!reader.readByte(version) || version != CURSOR_VERSION || !reader.readByte(flags)
+        || !reader.readVarint(count) || count > MAX_COLUMNS || (int)count != columns.count()) {
+        return false;
+    }
+
+    for (int i = 0; i < (int)count; ++i) {
+        QByteArray name;
+        QVariant value;
+        if (!reader.readBytes(name) || QString::fromUtf8(name) != columns[i] || !reader.readValue(value)) {
+            values.clear();
+            return false;
+        }
+        values << value;
+    }
+
+    if (!reader.atEnd()) {
+        values.clear();
+        return false;
+    }
+    backward = (flags & Backward);
+    return true;
+}
@@ -0,0 +1,21 @@
+#ifndef TSQLKEYSETCURSOR_H
+#define TSQLKEYSETCURSOR_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVariant>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TSqlKeysetCursor
+{
+public:
+    static QByteArray encode(const QStringList &columns, const QVariantList &values, bool backward);
+    static bool decode(const QByteArray &cursor, const QStringList &columns, QVariantList &values, bool &backward);
+
+private:
+    T_DISABLE_COPY(TSqlKeysetCursor)
+    T_DISABLE_MOVE(TSqlKeysetCursor)
+};
+
+#endif // TSQLKEYSETCURSOR_H
@@ -10,15 +10,22 @@
 #include <TSystemGlobal>
 #include "tsqldatabase.h"
 #include "tsqldriverextension.h"
+#include "tsqlquerycache.h"
 #include <QtSql>
 #include <QCoreApplication>
 #include <QMetaObject>
+#include <QReadWriteLock>
+#include <QHash>
 
 const QByteArray LockRevision("lock_revision");
 const QByteArray CreatedAt("created_at");
 const QByteArray UpdatedAt("updated_at");
 const QByteArray ModifiedAt("modified_at");
 
+// Maximum number of bind parameters in a statement
+constexpr int MAX_BIND_PARAMS_SQLITE = 999;
+constexpr int MAX_BIND_PARAMS = 32767;
+
 /*!
   \class TSqlObject
   \brief The TSqlObject class is the base class of ORM objects.
@@ -124,27 +131,11 @@ void TSqlObject::setRecord(const QSqlRecord &record, const QSqlError &error)
 */
 bool TSqlObject::create()
 {
-    // Sets the values of 'created_at', 'updated_at' or 'modified_at' properties
-    for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
-        const char *propName = metaObject()->property(i).name();
-        QByteArray prop = QByteArray(propName).toLower();
-
-        if (prop == CreatedAt || prop == UpdatedAt || prop == ModifiedAt) {
-            setProperty(propName, QDateTime::currentDateTime());
-        } else if (prop == LockRevision) {
-            // Sets the default value of 'revision' property
-            setProperty(propName, 1);  // 1 : default value
-        } else {
-            // do nothing
-        }
-    }
-
+    setCreationValues();
     syncToSqlRecord();
 
-    QString autoValName;
     QSqlRecord record = *this;
     if (autoValueIndex() >= 0) {
-        autoValName = field(autoValueIndex()).name();
         record.remove(autoValueIndex()); // not insert the value of auto-value field
     }
 
@@ -161,6 +152,8 @@ bool TSqlObject::create()
     bool ret = query.exec(ins);
     sqlError = query.lastError();
     if (Q_LIKELY(ret)) {
+        TSqlQueryCache::tableModified(databaseId(), tableName());
+
         // Gets the last inserted value of auto-value field
         if (autoValueIndex() >= 0) {
             QVariant lastid = query.lastInsertId();
@@ -179,8 +172,7 @@ bool TSqlObject::create()
             }
 
             if (lastid.isValid()) {
-                QObject::setProperty(autoValName.toLatin1().constData(), lastid);
-                QSqlRecord::setValue(autoValueIndex(), lastid);
+                setAutoValue(lastid);
             }
         }
     }
@@ -205,20 +197,18 @@ bool TSqlObject::update()
     where.append(QLatin1String(" WHERE "));
 
     // Updates the value of 'updated_at' or 'modified_at' property
+    const TSqlColumnList cols = columns();
     bool updflag = false;
     int revIndex = -1;
 
-    for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
-        const char *propName = metaObject()->property(i).name();
-        QByteArray prop = QByteArray(propName).toLower();
-
-        if (!updflag && (prop == UpdatedAt || prop == ModifiedAt)) {
-            setProperty(propName, QDateTime::currentDateTime());
+    for (auto &col : cols) {
+        if (!updflag && (col.roles & TSql::UpdatedAtColumn)) {
+            setColumnValue(col.index, QDateTime::currentDateTime());
             updflag = true;
 
-        } else if (revIndex < 0 && prop == LockRevision) {
+        } else if (revIndex < 0 && (col.roles & TSql::LockRevisionColumn)) {
             bool ok;
-            int oldRevision = property(propName).toInt(&ok);
+            int oldRevision = columnValue(col.index).toInt(&ok);
 
             if (!ok || oldRevision <= 0) {
                 sqlError = QSqlError(QLatin1String("Unable to convert the 'revision' property to an int"),
@@ -227,10 +217,10 @@ bool TSqlObject::update()
                 return false;
             }
 
-            setProperty(propName, oldRevision + 1);
-            revIndex = i;
+            setColumnValue(col.index, oldRevision + 1);
+            revIndex = col.index;
 
-            where.append(QLatin1String(propName));
+            where.append(QLatin1String(col.name));
             where.append(QLatin1Char('=')).append(TSqlQuery::formatValue(oldRevision, QVariant::Int, database));
             where.append(QLatin1String(" AND "));
         } else {
@@ -242,32 +232,33 @@ bool TSqlObject::update()
     upd.reserve(255);
     upd.append(QLatin1String("UPDATE ")).append(tableName()).append(QLatin1String(" SET "));
 
-    int pkidx = metaObject()->propertyOffset() + primaryKeyIndex();
-    QMetaProperty metaProp = metaObject()->property(pkidx);
-    const char *pkName = metaProp.name();
-    if (primaryKeyIndex() < 0 || !pkName) {
+    const int pkidx = primaryKeyIndex();
+    if (pkidx < 0 || pkidx >= cols.count()) {
         QString msg = QString("Primary key not found for table ") + tableName() + QLatin1String(". Create a primary key!");
         sqlError = QSqlError(msg, QString(), QSqlError::StatementError);
         tError("%s", qPrintable(msg));
         return false;
     }
 
-    QVariant::Type pkType = metaProp.type();
-    QVariant origpkval = value(pkName);
-    where.append(QLatin1String(pkName));
-    where.append(QLatin1Char('=')).append(TSqlQuery::formatValue(origpkval, pkType, database));
+    const TSqlColumn &pkcol = cols.at(pkidx);
+    QVariant origpkval = QSqlRecord::value(recordIndex(pkcol));
+    where.append(QLatin1String(pkcol.name));
+    where.append(QLatin1Char('=')).append(TSqlQuery::formatValue(origpkval, (QVariant::Type)pkcol.type, database));
     // Restore the value of primary key
-    QObject::setProperty(pkName, origpkval);
-
-    for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
-        metaProp = metaObject()->property(i);
-        const char *propName = metaProp.name();
-        QVariant newval = QObject::property(propName);
-        QVariant recval = QSqlRecord::value(QLatin1String(propName));
-        if (i != pkidx && recval.isValid() && recval != newval) {
-            upd.append(QLatin1String(propName));
+    setColumnValue(pkidx, origpkval);
+
+    for (auto &col : cols) {
+        int idx = recordIndex(col);
+        if (col.index == pkidx || idx < 0) {
+            continue;
+        }
+
+        QVariant newval = columnValue(col.index);
+        QVariant recval = QSqlRecord::value(idx);
+        if (recval.isValid() && recval != newval) {
+            upd.append(QLatin1String(col.name));
             upd.append(QLatin1Char('='));
-            upd.append(TSqlQuery::formatValue(newval, metaProp.type(), database));
+            upd.append(TSqlQuery::formatValue(newval, (QVariant::Type)col.type, database));
             upd.append(QLatin1Char(','));
         }
     }
@@ -285,6 +276,8 @@ bool TSqlObject::update()
     bool ret = query.exec(upd);
     sqlError = query.lastError();
     if (ret) {
+        TSqlQueryCache::tableModified(databaseId(), tableName());
+
         // Optimistic lock check
         if (revIndex >= 0 && query.numRowsAffected() != 1) {
             QString msg = QString("Row was updated or deleted from table ") + tableName() + QLatin1String(" by another transaction");
@@ -310,31 +303,15 @@ bool TSqlObject::save()
         return (isNew()) ? create() : update();
     }
 
-    // Sets the values of 'created_at', 'updated_at' or 'modified_at' properties
-    for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
-        const char *propName = metaObject()->property(i).name();
-        QByteArray prop = QByteArray(propName).toLower();
-
-        if (prop == CreatedAt || prop == UpdatedAt || prop == ModifiedAt) {
-            setProperty(propName, QDateTime::currentDateTime());
-        } else if (prop == LockRevision) {
-            // Sets the default value of 'revision' property
-            setProperty(propName, 1);  // 1 : default value
-            lockrev = LockRevision;
-        } else {
-            // do nothing
-        }
+    if (setCreationValues()) {
+        lockrev = LockRevision;
     }
-
     syncToSqlRecord();
 
     QSqlRecord recordToInsert = *this;
     QSqlRecord recordToUpdate = *this;
-    QList<int> removeFields;
-    QString autoValName;
 
     if (autoValueIndex() >= 0 && autoValueIndex() != primaryKeyIndex()) {
-        autoValName = field(autoValueIndex()).name();
         recordToInsert.remove(autoValueIndex()); // not insert the value of auto-value field
     }
 
@@ -356,12 +333,13 @@ bool TSqlObject::save()
     bool ret = query.exec(upst);
     sqlError = query.lastError();
     if (ret) {
+        TSqlQueryCache::tableModified(databaseId(), tableName());
+
         // Gets the last inserted value of auto-value field
         if (autoValueIndex() >= 0) {
             QVariant lastid = query.lastInsertId();
             if (lastid.isValid()) {
-                QObject::setProperty(autoValName.toLatin1().constData(), lastid);
-                QSqlRecord::setValue(autoValueIndex(), lastid);
+                setAutoValue(lastid);
             }
         }
     }
@@ -389,15 +367,13 @@ bool TSqlObject::remove()
     }
 
     del.append(QLatin1String(" WHERE "));
+    const TSqlColumnList cols = columns();
     int revIndex = -1;
 
-    for (int i = metaObject()->propertyOffset(); i < metaObject()->propertyCount(); ++i) {
-        const char *propName = metaObject()->property(i).name();
-        QByteArray prop = QByteArray(propName).toLower();
-
-        if (prop == LockRevision) {
+    for (auto &col : cols) {
+        if (col.roles & TSql::LockRevisionColumn) {
             bool ok;
-            int revision = property(propName).toInt(&ok);
+            int revision = columnValue(col.index).toInt(&ok);
 
             if (!ok || revision <= 0) {
                 sqlError = QSqlError(QLatin1String("Unable to convert the 'revision' property to an int"),
@@ -406,30 +382,32 @@ bool TSqlObject::remove()
                 return false;
             }
 
-            del.append(QLatin1String(propName));
+            del.append(QLatin1String(col.name));
             del.append(QLatin1Char('=')).append(TSqlQuery::formatValue(revision, QVariant::Int, database));
             del.append(QLatin1String(" AND "));
 
-            revIndex = i;
+            revIndex = col.index;
             break;
         }
     }
 
-    auto metaProp = metaObject()->property(metaObject()->propertyOffset() + primaryKeyIndex());
-    const char *pkName = metaProp.name();
-    if (primaryKeyIndex() < 0 || !pkName) {
+    const int pkidx = primaryKeyIndex();
+    if (pkidx < 0 || pkidx >= cols.count()) {
         QString msg = QString("Primary key not found for table ") + tableName() + QLatin1String(". Create a primary key!");
         sqlError = QSqlError(msg, QString(), QSqlError::StatementError);
         tError("%s", qPrintable(msg));
         return false;
     }
-    del.append(QLatin1String(pkName));
-    del.append(QLatin1Char('=')).append(TSqlQuery::formatValue(value(pkName), metaProp.type(), database));
+    const TSqlColumn &pkcol = cols.at(pkidx);
+    del.append(QLatin1String(pkcol.name));
+    del.append(QLatin1Char('=')).append(TSqlQuery::formatValue(QSqlRecord::value(recordIndex(pkcol)), (QVariant::Type)pkcol.type, database));
 
     TSqlQuery query(database);
     bool ret = query.exec(del);
     sqlError = query.lastError();
     if (ret) {
+        TSqlQueryCache::tableModified(databaseId(), tableName());
+
         // Optimistic lock check
         if (query.numRowsAffected() != 1) {
             if (revIndex >= 0) {
@@ -465,33 +443,137 @@ bool TSqlObject::isModified() const
     if (isNew())
         return false;
 
-    for (int i = 0; i < QSqlRecord::count(); ++i) {
-        QString name = field(i).name();
-        int index = metaObject()->indexOfProperty(name.toLatin1().constData());
-        if (index >= 0) {
-            if (value(name) != property(name.toLatin1().constData())) {
-                return true;
-            }
+    for (auto &col : columns()) {
+        int idx = recordIndex(col);
+        if (idx >= 0 && QSqlRecord::value(idx) != columnValue(col.index)) {
+            return true;
         }
     }
     return false;
 }
 
+/*!
+  Returns the descriptors of the columns, which are the properties of the
+  object. The code generated by tspawn overrides this function with a
+  static table; otherwise the descriptors are built from the meta-object
+  once per class.
+*/
+TSqlColumnList TSqlObject::columns() const
+{
+    static QHash<const QMetaObject *, QVector<TSqlColumn>> columnsHash;
+    static QReadWriteLock lock;
+    const QMetaObject *metaObj = metaObject();
+
+    {
+        QReadLocker locker(&lock);
+        auto it = columnsHash.constFind(metaObj);
+        if (it != columnsHash.constEnd()) {
+            return TSqlColumnList(it->constData(), it->count());
+        }
+    }
+
+    QVector<TSqlColumn> cols;
+    for (int i = metaObj->propertyOffset(); i < metaObj->propertyCount(); ++i) {
+        const QMetaProperty metaProp = metaObj->property(i);
+        const QByteArray prop = QByteArray(metaProp.name()).toLower();
+        const int index = i - metaObj->propertyOffset();
+        int roles = 0;
+
+        if (index == primaryKeyIndex()) {
+            roles |= TSql::PrimaryKeyColumn;
+        }
+        if (index == autoValueIndex()) {
+            roles |= TSql::AutoValueColumn;
+        }
+        if (prop == CreatedAt) {
+            roles |= TSql::CreatedAtColumn;
+        } else if (prop == UpdatedAt || prop == ModifiedAt) {
+            roles |= TSql::UpdatedAtColumn;
+        } else if (prop == LockRevision) {
+            roles |= TSql::LockRevisionColumn;
+        }
+        cols << TSqlColumn{index, metaProp.name(), metaProp.userType(), roles};
+    }
+
+    QWriteLocker locker(&lock);
+    auto it = columnsHash.constFind(metaObj);
+    if (it == columnsHash.constEnd()) {
+        it = columnsHash.insert(metaObj, cols);
+    }
+    return TSqlColumnList(it->constData(), it->count());
+}
+
+/*!
+  Returns the value of the property at the \a index of the columns.
+  The code generated by tspawn overrides this function to read the member
+  directly.
+*/
+QVariant TSqlObject::columnValue(int index) const
+{
+    return metaObject()->property(metaObject()->propertyOffset() + index).read(this);
+}
+
+/*!
+  Sets the \a value to the property at the \a index of the columns.
+  The code generated by tspawn overrides this function to write the
+  member directly.
+*/
+void TSqlObject::setColumnValue(int index, const QVariant &value)
+{
+    metaObject()->property(metaObject()->propertyOffset() + index).write(this, value);
+}
+
+/*!
+  Returns the index of the field for the \a column in the record, or -1
+  if not found.
+*/
+int TSqlObject::recordIndex(const TSqlColumn &column) const
+{
+    if (column.index < QSqlRecord::count() && QSqlRecord::fieldName(column.index) == QLatin1String(column.name)) {
+        return column.index;
+    }
+    return QSqlRecord::indexOf(QLatin1String(column.name));
+}
+
 /*!
   Synchronizes the internal record data to the properties of the object.
   This function is for internal use only.
 */
 void TSqlObject::syncToObject()
 {
-    int offset = metaObject()->propertyOffset();
+    const TSqlColumnList cols = columns();
     for (int i = 0; i < QSqlRecord::count(); ++i) {
-        QString propertyName = field(i).name();
-        QByteArray name = propertyName.toLatin1();
-        int index = metaObject()->indexOfProperty(name.constData());
-        if (index >= offset) {
-            QObject::setProperty(name.constData(), value(propertyName));
+        const TSqlColumn *col = cols.find(QSqlRecord::fieldName(i), i);
+        if (col) {
+            setColumnValue(col->index, QSqlRecord::value(i));
+        }
+    }
+}
+
+/*!
+  Returns the record of the table \a tableName, which is retrieved from
+  the database once and reused.
+*/
+static QSqlRecord tableRecord(int databaseId, const QString &tableName)
+{
+    static QHash<QPair<int, QString>, QSqlRecord> recordHash;
+    static QReadWriteLock lock;
+    const auto key = qMakePair(databaseId, tableName);
+
+    {
+        QReadLocker locker(&lock);
+        auto it = recordHash.constFind(key);
+        if (it != recordHash.constEnd()) {
+            return it.value();
         }
     }
+
+    QSqlRecord record = Tf::currentSqlDatabase(databaseId).record(tableName);
+    if (!record.isEmpty()) {
+        QWriteLocker locker(&lock);
+        recordHash.insert(key, record);
+    }
+    return record;
 }
 
 /*!
@@ -500,15 +582,344 @@ void TSqlObject::syncToObject()
 */
 void TSqlObject::syncToSqlRecord()
 {
-    QSqlRecord::operator=(Tf::currentSqlDatabase(databaseId()).record(tableName()));
-    const QMetaObject *metaObj = metaObject();
-    for (int i = metaObj->propertyOffset(); i < metaObj->propertyCount(); ++i) {
-        const char *propName = metaObj->property(i).name();
-        int idx = indexOf(propName);
+    QSqlRecord::operator=(tableRecord(databaseId(), tableName()));
+    for (auto &col : columns()) {
+        int idx = recordIndex(col);
         if (idx >= 0) {
-            QSqlRecord::setValue(idx, QObject::property(propName));
+            QSqlRecord::setValue(idx, columnValue(col.index));
         } else {
-            tWarn("invalid name: %s", propName);
+            tWarn("invalid name: %s", col.name);
+        }
+    }
+}
+
+/*!
+  Sets the current date-time to the 'created_at', 'updated_at' or
+  'modified_at' property, and the default value to the 'lock_revision'
+  property. Returns true if the object has the 'lock_revision' property.
+*/
+bool TSqlObject::setCreationValues()
+{
+    bool lockrev = false;
+
+    for (auto &col : columns()) {
+        if (col.roles & (TSql::CreatedAtColumn | TSql::UpdatedAtColumn)) {
+            setColumnValue(col.index, QDateTime::currentDateTime());
+        } else if (col.roles & TSql::LockRevisionColumn) {
+            // Sets the default value of 'revision' property
+            setColumnValue(col.index, 1);  // 1 : default value
+            lockrev = true;
+        } else {
+            // do nothing
+        }
+    }
+    return lockrev;
+}
+
+/*!
+  Sets the \a value to the auto-value field and its property.
+*/
+void TSqlObject::setAutoValue(const QVariant &value)
+{
+    setColumnValue(autoValueIndex(), value);
+    QSqlRecord::setValue(autoValueIndex(), value);
+}
+
+
+static int maxRowsPerStatement(const TSqlDatabase &database, int columnCount)
+{
+    int params = (database.dbmsType() == TSqlDatabase::SQLite) ? MAX_BIND_PARAMS_SQLITE : MAX_BIND_PARAMS;
+    return qMax(params / qMax(columnCount, 1), 1);
+}
+
+// Returns the increment of the auto-increment values of MySQL, or 0 if
+// the values generated for a multi-row INSERT may not be consecutive
+static qint64 mysqlAutoIncrement(QSqlDatabase &sqldb)
+{
+    TSqlQuery query(sqldb);
+    if (query.exec(QStringLiteral("SELECT @@auto_increment_increment, @@innodb_autoinc_lock_mode")) && query.next()) {
+        // Not consecutive in the interleaved lock mode
+        return (query.value(1).toInt() < 2) ? query.value(0).toLongLong() : 0;
+    }
+    return 0;
+}
+
+/*!
+  Inserts all the \a objects, which must be of the same class, into the
+  database by multi-row INSERT statements, each of which is bounded by
+  the number of bind parameters. Returns the number of the rows inserted,
+  or -1 if an error occurred.
+  The values of the auto-value field are set to the objects. On PostgreSQL
+  they are retrieved by RETURNING, assuming that the rows are returned in
+  the order of VALUES, as PostgreSQL does for INSERT ... VALUES. On MySQL
+  they are computed from LAST_INSERT_ID(), the value of the first row,
+  and on SQLite from last_insert_rowid(), that of the last row, as the
+  values generated for a statement are consecutive. If they may not be,
+  as in the interleaved mode of innodb_autoinc_lock_mode of MySQL, or on
+  the other databases, the objects are inserted one by one with a
+  prepared statement. This function is for internal use only; use
+  TSqlORMapper::insertAll() instead.
+*/
+int TSqlObject::insertAll(const QList<TSqlObject *> &objects)
+{
+    if (objects.isEmpty()) {
+        return 0;
+    }
+
+    const TSqlObject *first = objects.first();
+    QSqlDatabase &sqldb = Tf::currentSqlDatabase(first->databaseId());
+    const auto &db = TSqlDatabase::database(sqldb.connectionName());
+    const int autoIndex = first->autoValueIndex();
+
+    for (auto *obj : objects) {
+        obj->setCreationValues();
+        obj->syncToSqlRecord();
+    }
+
+    // Columns to insert
+    QStringList fields;
+    QVector<int> indexes;
+    for (int i = 0; i < first->count(); ++i) {
+        if (i != autoIndex && first->isGenerated(i)) {
+            fields << first->fieldName(i);
+            indexes << i;
+        }
+    }
+
+    if (Q_UNLIKELY(fields.isEmpty())) {
+        tWarn("SQL statement error, no fields to insert");
+        return -1;
+    }
+
+    // How the values of the auto-value field are retrieved
+    enum AutoValue {
+        NoAutoValue = 0,
+        Returning,
+        FirstInsertId,
+        LastInsertId,
+        OneByOne,
+    } autoValue = NoAutoValue;
+    qint64 increment = 1;
+
+    if (autoIndex >= 0) {
+        switch (db.dbmsType()) {
+        case TSqlDatabase::PostgreSQL:
+            autoValue = Returning;
+            break;
+        case TSqlDatabase::SQLite:
+            autoValue = LastInsertId;
+            break;
+        case TSqlDatabase::MySqlServer:
+            increment = mysqlAutoIncrement(sqldb);
+            autoValue = (increment > 0) ? FirstInsertId : OneByOne;
+            break;
+        default:
+            autoValue = OneByOne;
+            break;
+        }
+    }
+
+    int count = 0;
+    if (autoValue == OneByOne) {
+        TSqlQuery query(sqldb);
+        query.prepare(TSqlDriverExtension::bulkInsertStatement(first->tableName(), fields, 1, sqldb.driver()));
+
+        for (auto *obj : objects) {
+            for (int i = 0; i < indexes.count(); ++i) {
+                query.bindValue(i, obj->QSqlRecord::value(indexes[i]));
+            }
+
+            if (Q_UNLIKELY(!query.exec())) {
+                obj->sqlError = query.lastError();
+                count = -1;
+                break;
+            }
+
+            QVariant lastid = query.lastInsertId();
+            if (lastid.isValid()) {
+                obj->setAutoValue(lastid);
+            }
+            count++;
+        }
+
+        if (count != 0) {
+            TSqlQueryCache::tableModified(first->databaseId(), first->tableName());
+        }
+        return count;
+    }
+
+    const int maxRows = maxRowsPerStatement(db, fields.count());
+    QString autoValName;
+    if (autoValue == Returning) {
+        autoValName = TSqlQuery::escapeIdentifier(first->fieldName(autoIndex), QSqlDriver::FieldName, sqldb.driver());
+    }
+
+    for (int offset = 0; offset < objects.count(); offset += maxRows) {
+        const int rows = qMin(maxRows, objects.count() - offset);
+        QString ins = TSqlDriverExtension::bulkInsertStatement(first->tableName(), fields, rows, sqldb.driver());
+        if (autoValue == Returning) {
+            ins.append(QLatin1String(" RETURNING ")).append(autoValName);
+        }
+
+        TSqlQuery query(sqldb);
+        query.prepare(ins);
+        for (int r = offset; r < offset + rows; ++r) {
+            const TSqlObject *obj = objects[r];
+            for (int idx : indexes) {
+                query.addBindValue(obj->QSqlRecord::value(idx));
+            }
+        }
+
+        if (Q_UNLIKELY(!query.exec())) {
+            for (int r = offset; r < offset + rows; ++r) {
+                objects[r]->sqlError = query.lastError();
+            }
+            return -1;
+        }
+        TSqlQueryCache::tableModified(first->databaseId(), first->tableName());
+
+        // Sets the inserted values of auto-value field
+        if (autoValue == Returning) {
+            for (int r = offset; r < offset + rows && query.next(); ++r) {
+                objects[r]->setAutoValue(query.value(0));
+            }
+        } else if (autoValue != NoAutoValue) {
+            QVariant lastid = query.lastInsertId();
+            if (lastid.isValid()) {
+                qint64 value = lastid.toLongLong();
+                if (autoValue == LastInsertId) {
+                    value -= (rows - 1) * increment;
+                }
+                for (int r = offset; r < offset + rows; ++r) {
+                    objects[r]->setAutoValue(value);
+                    value += increment;
+                }
+            }
+        }
+        count += rows;
+    }
+    return count;
+}
+
+/*!
+  Inserts or updates all the \a objects, which must be of the same class,
+  by multi-row UPSERT statements. If UPSERT is not available, each object
+  is saved one by one with save(). If the class has the 'lock_revision'
+  property, the objects read from the database are updated one by one
+  with update() to check the optimistic lock. Returns the number of the
+  objects processed, or -1 if an error occurred. This function is for
+  internal use only; use TSqlORMapper::upsertAll() instead.
+*/
+int TSqlObject::upsertAll(const QList<TSqlObject *> &objects)
+{
+    if (objects.isEmpty()) {
+        return 0;
+    }
+
+    const TSqlObject *first = objects.first();
+    QSqlDatabase &sqldb = Tf::currentSqlDatabase(first->databaseId());
+    const auto &db = TSqlDatabase::database(sqldb.connectionName());
+    const int autoIndex = first->autoValueIndex();
+    const int pkIndex = first->primaryKeyIndex();
+    QString lockrev;
+    QString upst;
+
+    auto saveAll = [](const QList<TSqlObject *> &objects) {
+        for (auto *obj : objects) {
+            if (!obj->save()) {
+                return -1;
+            }
+        }
+        return objects.count();
+    };
+
+    if (! db.isUpsertSupported() || ! db.isUpsertEnabled() || pkIndex < 0) {
+        return saveAll(objects);
+    }
+
+    // The objects read from the database are updated one by one with
+    // the optimistic lock check of update(), which throws SqlException
+    // if the row was updated or deleted by another transaction
+    int count = 0;
+    QList<TSqlObject *> upserts;
+    bool lockable = false;
+    for (auto &col : first->columns()) {
+        if (col.roles & TSql::LockRevisionColumn) {
+            lockable = true;
+            break;
+        }
+    }
+
+    for (auto *obj : objects) {
+        if (lockable && !obj->isNew()) {
+            if (!obj->update()) {
+                return -1;
+            }
+            count++;
+        } else {
+            upserts << obj;
+        }
+    }
+
+    if (upserts.isEmpty()) {
+        return count;
+    }
+
+    for (auto *obj : upserts) {
+        if (obj->setCreationValues()) {
+            lockrev = LockRevision;
+        }
+        obj->syncToSqlRecord();
+    }
+    first = upserts.first();
+
+    QStringList insertFields;
+    QStringList updateFields;
+    QVector<int> indexes;
+    for (int i = 0; i < first->count(); ++i) {
+        if (!first->isGenerated(i)) {
+            continue;
+        }
+
+        const QString name = first->fieldName(i);
+        if (i != autoIndex || autoIndex == pkIndex) {
+            insertFields << name;
+            indexes << i;
+        }
+        if (name.compare(QLatin1String(CreatedAt), Qt::CaseInsensitive) != 0 && name.compare(QLatin1String(LockRevision), Qt::CaseInsensitive) != 0) {
+            updateFields << name;
+        }
+    }
+
+    const int maxRows = maxRowsPerStatement(db, insertFields.count());
+    const QString pkField = first->fieldName(pkIndex);
+
+    for (int offset = 0; offset < upserts.count(); offset += maxRows) {
+        const int rows = qMin(maxRows, upserts.count() - offset);
+        upst = db.driverExtension()->bulkUpsertStatement(first->tableName(), insertFields, rows, updateFields, pkField, lockrev);
+        if (upst.isEmpty()) {
+            // In case unable to generate upsert statement
+            int cnt = saveAll(upserts.mid(offset));
+            return (cnt < 0) ? -1 : count + cnt;
+        }
+
+        TSqlQuery query(sqldb);
+        query.prepare(upst);
+        for (int r = offset; r < offset + rows; ++r) {
+            const TSqlObject *obj = upserts[r];
+            for (int idx : indexes) {
+                query.addBindValue(obj->QSqlRecord::value(idx));
+            }
+        }
+
+        if (Q_UNLIKELY(!query.exec())) {
+            for (int r = offset; r < offset + rows; ++r) {
+                upserts[r]->sqlError = query.lastError();
+            }
+            return -1;
         }
+        TSqlQueryCache::tableModified(first->databaseId(), first->tableName());
+        count += rows;
     }
+    return count;
 }
@@ -10,6 +10,56 @@
 #include <TGlobal>
 #include <TModelObject>
 
+/*!
+  \struct TSqlColumn
+  \brief The TSqlColumn struct describes a column of TSqlObject.
+*/
+struct TSqlColumn
+{
+    int index;        // property index
+    const char *name;
+    int type;         // QMetaType::Type
+    int roles;        // TSql::ColumnRole flags
+};
+
+
+class TSqlColumnList
+{
+public:
+    constexpr TSqlColumnList() {}
+    constexpr TSqlColumnList(const TSqlColumn *columns, int count) : _columns(columns), _count(count) {}
+    template <int N> constexpr TSqlColumnList(const TSqlColumn (&columns)[N]) : _columns(columns), _count(N) {}
+
+    constexpr int count() const { return _count; }
+    constexpr bool isEmpty() const { return _count == 0; }
+    constexpr const TSqlColumn &at(int i) const { return _columns[i]; }
+    constexpr const TSqlColumn *begin() const { return _columns; }
+    constexpr const TSqlColumn *end() const { return _columns + _count; }
+    const TSqlColumn *find(const QString &name, int hint = -1) const;
+
+private:
+    const TSqlColumn *_columns {nullptr};
+    int _count {0};
+};
+
+/*!
+  Returns the column named \a name, or nullptr if not found. The column at
+  the index \a hint is checked first.
+*/
+inline const TSqlColumn *TSqlColumnList::find(const QString &name, int hint) const
+{
+    if (hint >= 0 && hint < _count && name == QLatin1String(_columns[hint].name)) {
+        return _columns + hint;
+    }
+
+    for (int i = 0; i < _count; ++i) {
+        if (name == QLatin1String(_columns[i].name)) {
+            return _columns + i;
+        }
+    }
+    return nullptr;
+}
+
 
 class T_CORE_EXPORT TSqlObject : public TModelObject, public QSqlRecord
 {
@@ -24,6 +74,9 @@ public:
     virtual int primaryKeyIndex() const { return -1; }
     virtual int autoValueIndex() const { return -1; }
     virtual int databaseId() const { return 0; }
+    virtual TSqlColumnList columns() const;
+    virtual QVariant columnValue(int index) const;
+    virtual void setColumnValue(int index, const QVariant &value);
     void setRecord(const QSqlRecord &record, const QSqlError &error);
     bool create() override;
     bool update() override;
@@ -36,9 +89,15 @@ public:
     void clear() override { QSqlRecord::clear(); }
     QSqlError error() const { return sqlError; }
 
+    static int insertAll(const QList<TSqlObject *> &objects);
+    static int upsertAll(const QList<TSqlObject *> &objects);
+
 protected:
     void syncToSqlRecord();
     void syncToObject();
+    int recordIndex(const TSqlColumn &column) const;
+    bool setCreationValues();
+    void setAutoValue(const QVariant &value);
     QSqlError sqlError;
 };
 
@@ -10,6 +10,11 @@
 #include <TCriteriaConverter>
 #include <TSqlQuery>
 #include <TSqlJoin>
+#include "tsqlormapperstream.h"
+#include "tsqlquerycache.h"
+#include "tsqlkeysetcursor.h"
+#include "tsqlasync.h"
+#include "tqueryprofiler.h"
 #include "tsystemglobal.h"
 
 /*!
@@ -35,12 +40,16 @@ public:
     TSqlORMapper<T> &orderBy(int column, Tf::SortOrder order = Tf::AscendingOrder);
     TSqlORMapper<T> &orderBy(const QString &column, Tf::SortOrder order = Tf::AscendingOrder);
     template <class C> TSqlORMapper<T> &join(int column, const TSqlJoin<C> &join);
+    TSqlORMapper<T> &cache(int seconds);
+    TSqlORMapper<T> &seek(const QByteArray &cursor);
 
     void setLimit(int limit);
     void setOffset(int offset);
     void setSortOrder(int column, Tf::SortOrder order = Tf::AscendingOrder);
     void setSortOrder(const QString &column, Tf::SortOrder order = Tf::AscendingOrder);
     template <class C> void setJoin(int column, const TSqlJoin<C> &join);
+    void setCacheTimeout(int seconds);
+    void setSeekCursor(const QByteArray &cursor);
     void reset();
 
     T findFirst(const TCriteria &cri = TCriteria());
@@ -49,16 +58,22 @@ public:
     int find(const TCriteria &cri = TCriteria());
     int findBy(int column, QVariant value);
     int findIn(int column, const QVariantList &values);
+    TSqlORMapperStream<T> findStream(const TCriteria &cri = TCriteria());
+    std::future<QList<T>> findAsync(const TCriteria &cri = TCriteria());
     int rowCount() const;
     T first() const;
     T last() const;
     T value(int i) const;
+    QByteArray nextCursor() const;
+    QByteArray previousCursor() const;
 
     int findCount(const TCriteria &cri = TCriteria());
     int findCountBy(int column, QVariant value);
     int updateAll(const TCriteria &cri, int column, QVariant value);
     int updateAll(const TCriteria &cri, const QMap<int, QVariant> &values);
     int removeAll(const TCriteria &cri = TCriteria());
+    int insertAll(QList<T> &objects);
+    int upsertAll(QList<T> &objects);
 
     class ConstIterator;
     inline ConstIterator begin() const { return ConstIterator(this, 0); }
@@ -97,13 +112,29 @@ protected:
     virtual int rowCount(const QModelIndex &parent) const;
 
 private:
+    typedef QList<QPair<QString, Tf::SortOrder>> SortColumnList;
+
+    bool selectWithCache();
+    QStringList queryTables() const;
+    QString orderBy(const SortColumnList &columns) const;
+    SortColumnList keysetColumns() const;
+    QString keysetFilter(const SortColumnList &columns, const QVariantList &values, bool backward) const;
+    QByteArray encodeCursor(int row, bool backward) const;
+    bool decodeCursor(const QByteArray &cursor, bool *backward, QVariantList *values) const;
+
     QString queryFilter;
-    QList<QPair<QString, Tf::SortOrder>> sortColumns;
+    SortColumnList sortColumns;
     int queryLimit {0};
     int queryOffset {0};
     int joinCount {0};
     QStringList joinClauses;
     QStringList joinWhereClauses;
+    QStringList joinTables;
+    int cacheSeconds {0};
+    bool cachedResult {false};
+    QList<QSqlRecord> cachedRecords;
+    bool keysetEnabled {false};
+    QByteArray seekCursor;
 
     T_DISABLE_COPY(TSqlORMapper)
     T_DISABLE_MOVE(TSqlORMapper)
@@ -114,7 +145,7 @@ private:
 */
 template <class T>
 inline TSqlORMapper<T>::TSqlORMapper()
-    : QSqlTableModel(0, Tf::currentSqlDatabase(T().databaseId()))
+    : QSqlTableModel(0, Tf::currentReadSqlDatabase(T().databaseId()))
 {
     setTable(T().tableName());
 }
@@ -142,8 +173,7 @@ inline T TSqlORMapper<T>::findFirst(const TCriteria &cri)
 
     int oldLimit = queryLimit;
     queryLimit = 1;
-    bool ret = select();
-    Tf::writeQueryLog(query().lastQuery(), ret, lastError());
+    selectWithCache();
     queryLimit = oldLimit;
 
     //tSystemDebug("findFirst() rowCount: %d", rowCount());
@@ -192,13 +222,63 @@ inline int TSqlORMapper<T>::find(const TCriteria &cri)
         setFilter(QString());
     }
 
+    bool ret = selectWithCache();
+    //tSystemDebug("find() rowCount: %d", rowCount());
+    return ret ? rowCount() : -1;
+}
+
+/*!
+  Executes the SELECT statement, or restores the rows from the query
+  cache if cache() is specified. This function is for internal use only.
+*/
+template <class T>
+inline bool TSqlORMapper<T>::selectWithCache()
+{
+    QByteArray cacheKey;
+    cachedResult = false;
+    cachedRecords.clear();
+
+    if (cacheSeconds > 0 && TSqlQueryCache::isEnabled()) {
+        // Made before the SELECT with the current generations of the tables
+        cacheKey = TSqlQueryCache::cacheKey(T().databaseId(), selectStatement(), queryTables());
+        QByteArray data = TSqlQueryCache::get(cacheKey);
+        if (!data.isEmpty()) {
+            cachedRecords = TSqlQueryCache::deserialize(data);
+            cachedResult = true;
+            return true;
+        }
+    }
+
+    TQueryProfiler profiler;
     bool ret = select();
     while (canFetchMore()) { // For SQLite, not report back the size of a query
         fetchMore();
     }
-    Tf::writeQueryLog(query().lastQuery(), ret, lastError());
-    //tSystemDebug("find() rowCount: %d", rowCount());
-    return ret ? rowCount() : -1;
+    Tf::writeQueryLog(query().lastQuery(), ret, lastError(), profiler.elapsed());
+    if (ret) {
+        profiler.record(query().lastQuery(), rowCount(), QVariantList(), T().databaseId());
+    }
+
+    if (ret && !cacheKey.isEmpty()) {
+        QList<QSqlRecord> records;
+        records.reserve(rowCount());
+        for (int i = 0; i < rowCount(); ++i) {
+            records << record(i);
+        }
+        TSqlQueryCache::set(cacheKey, TSqlQueryCache::serialize(records), cacheSeconds);
+    }
+    return ret;
+}
+
+/*!
+  Returns the names of the tables touched by the query.
+*/
+template <class T>
+inline QStringList TSqlORMapper<T>::queryTables() const
+{
+    QStringList tables = joinTables;
+    tables.prepend(tableName());
+    return tables;
 }
 
 /*!
@@ -225,6 +305,66 @@ inline int TSqlORMapper<T>::findIn(int column, const QVariantList &values)
     return find(TCriteria(column, TSql::In, values));
 }
 
+/*!
+  Retrieves with the criteria \a cri from the table and returns a stream
+  which yields the ORM objects one by one with a forward-only cursor.
+  Unlike find(), the rows are not cached in the mapper, so rowCount()
+  and value() are not available for them.
+  \sa TSqlORMapperStream
+*/
+template <class T>
+inline TSqlORMapperStream<T> TSqlORMapper<T>::findStream(const TCriteria &cri)
+{
+    if (!cri.isEmpty()) {
+        TCriteriaConverter<T> conv(cri, database(), "t0");
+        setFilter(conv.toString());
+    } else {
+        setFilter(QString());
+    }
+
+    return TSqlORMapperStream<T>(database(), selectStatement());
+}
+
+/*!
+  Retrieves with the criteria \a cri on a database I/O thread and returns
+  the future of the list of the ORM objects, so that independent queries
+  can be executed concurrently. The settings of limit, offset, order and
+  join are applied; the query cache is not. The query is executed in the
+  calling thread if a transaction is active on the database in the
+  current context. If the query fails, std::future::get() throws
+  SqlException.
+  \sa TSqlAsync
+*/
+template <class T>
+inline std::future<QList<T>> TSqlORMapper<T>::findAsync(const TCriteria &cri)
+{
+    if (!cri.isEmpty()) {
+        TCriteriaConverter<T> conv(cri, database(), "t0");
+        setFilter(conv.toString());
+    } else {
+        setFilter(QString());
+    }
+
+    const int databaseId = T().databaseId();
+    const QString statement = selectStatement();
+
+    return TSqlAsync::run<QList<T>>(databaseId, [databaseId, statement]() {
+        TSqlQuery query(Tf::currentReadSqlDatabase(databaseId));
+        query.setForwardOnly(true);
+        if (!query.exec(statement)) {
+            throw SqlException(query.lastError().text(), __FILE__, __LINE__);
+        }
+
+        QList<T> list;
+        while (query.next()) {
+            T obj;
+            obj.setRecord(query.record(), QSqlError());
+            list << obj;
+        }
+        return list;
+    });
+}
+
 /*!
   Returns the number of rows of the current query.
  */
@@ -240,7 +380,7 @@ inline int TSqlORMapper<T>::rowCount() const
 template <class T>
 inline int TSqlORMapper<T>::rowCount(const QModelIndex &parent) const
 {
-    return QSqlTableModel::rowCount(parent);
+    return cachedResult ? cachedRecords.count() : QSqlTableModel::rowCount(parent);
 }
 
 /*!
@@ -273,7 +413,7 @@ inline T TSqlORMapper<T>::value(int i) const
 {
     T rec;
     if (i >= 0 && i < rowCount()) {
-        rec.setRecord(record(i), QSqlError());
+        rec.setRecord((cachedResult ? cachedRecords[i] : record(i)), QSqlError());
     } else {
         tSystemDebug("no such record, index: %d  rowCount:%d", i, rowCount());
     }
@@ -300,6 +440,56 @@ inline void TSqlORMapper<T>::setOffset(int offset)
     queryOffset = offset;
 }
 
+/*!
+  Sets the number of \a seconds for which the results of find(),
+  findFirst() and findCount() are stored in the query cache. The cached
+  results are invalidated when the tables are modified. If 0 is
+  specified, the query cache is not used. Cache.EnableQueryCache must be
+  true in application.ini.
+  \sa TSqlQueryCache
+*/
+template <class T>
+inline void TSqlORMapper<T>::setCacheTimeout(int seconds)
+{
+    cacheSeconds = seconds;
+}
+
+/*!
+  Enables the keyset (seek) pagination and sets the position to the
+  opaque \a cursor, which is returned by nextCursor() or previousCursor()
+  of the previous query. An empty cursor means the first page.
+  The rows are sorted by the columns specified by setSortOrder() and the
+  primary key as a tie-breaker, and the page size is specified by
+  setLimit(). The sort columns must not contain NULL. The cursor is
+  signed with Session.Secret, and a tampered cursor is ignored.
+  \code
+  TSqlORMapper<BlogObject> mapper;
+  mapper.orderBy(BlogObject::CreatedAt, Tf::DescendingOrder).limit(20).seek(cursor);
+  mapper.find();
+  ...
+  QByteArray next = mapper.nextCursor();
+  \endcode
+  \sa nextCursor(), previousCursor()
+*/
+template <class T>
+inline TSqlORMapper<T> &TSqlORMapper<T>::seek(const QByteArray &cursor)
+{
+    setSeekCursor(cursor);
+    return *this;
+}
+
+/*!
+  Enables the keyset (seek) pagination and sets the position to the
+  opaque \a cursor.
+  \sa seek()
+*/
+template <class T>
+inline void TSqlORMapper<T>::setSeekCursor(const QByteArray &cursor)
+{
+    keysetEnabled = true;
+    seekCursor = cursor;
+}
+
 /*!
   Sets the sort order for \a column to \a order.
 */
@@ -353,6 +543,17 @@ inline TSqlORMapper<T> &TSqlORMapper<T>::offset(int o)
     return *this;
 }
 
+/*!
+  Stores the results of the queries in the query cache for \a seconds.
+  \sa setCacheTimeout(int)
+*/
+template <class T>
+inline TSqlORMapper<T> &TSqlORMapper<T>::cache(int seconds)
+{
+    setCacheTimeout(seconds);
+    return *this;
+}
+
 /*!
   Sets the sort order for \a column to \a order.
 */
@@ -436,11 +637,36 @@ inline QString TSqlORMapper<T>::selectStatement() const
         }
     }
 
+    // Keyset pagination
+    SortColumnList sortKeys = sortColumns;
+    bool backward = false;
+    if (keysetEnabled) {
+        sortKeys = keysetColumns();
+        QVariantList values;
+        if (decodeCursor(seekCursor, &backward, &values)) {
+            if (!filter.isEmpty()) {
+                filter = QLatin1Char('(') + filter + QLatin1String(") AND ");
+            }
+            filter += keysetFilter(sortKeys, values, backward);
+        }
+    }
+
     if (Q_LIKELY(!filter.isEmpty())) {
         query.append(QLatin1String(" WHERE ")).append(filter);
     }
 
-    QString orderby = orderBy();
+    QString orderby;
+    if (backward) {
+        // Retrieves the rows before the cursor in reverse order
+        SortColumnList reverseKeys;
+        for (auto &p : sortKeys) {
+            reverseKeys << qMakePair(p.first, (p.second == Tf::AscendingOrder) ? Tf::DescendingOrder : Tf::AscendingOrder);
+        }
+        orderby = orderBy(reverseKeys);
+    } else {
+        orderby = orderBy(sortKeys);
+    }
+
     if (!orderby.isEmpty()) {
         query.append(orderby);
     }
@@ -453,6 +679,10 @@ inline QString TSqlORMapper<T>::selectStatement() const
         query.append(QLatin1String(" OFFSET ")).append(QString::number(queryOffset));
     }
 
+    if (backward) {
+        // Restores the order
+        query.prepend(QLatin1String("SELECT * FROM (")).append(QLatin1String(") t0")).append(orderBy(sortKeys));
+    }
     return query;
 }
 
@@ -475,12 +705,24 @@ inline int TSqlORMapper<T>::findCount(const TCriteria &cri)
     query += selectStatement();
     query += QLatin1String(") t");
 
+    QByteArray cacheKey;
+    if (cacheSeconds > 0 && TSqlQueryCache::isEnabled()) {
+        cacheKey = TSqlQueryCache::cacheKey(T().databaseId(), query, queryTables());
+        QByteArray data = TSqlQueryCache::get(cacheKey);
+        if (!data.isEmpty()) {
+            return data.toInt();
+        }
+    }
+
     int cnt = -1;
     TSqlQuery q(database());
     bool res = q.exec(query);
     if (res) {
         q.next();
         cnt = q.value(0).toInt();
+        if (!cacheKey.isEmpty()) {
+            TSqlQueryCache::set(cacheKey, QByteArray::number(cnt), cacheSeconds);
+        }
     }
     return cnt;
 }
@@ -503,14 +745,11 @@ inline int TSqlORMapper<T>::findCountBy(int column, QVariant value)
 template <class T>
 int TSqlORMapper<T>::updateAll(const TCriteria &cri, const QMap<int, QVariant> &values)
 {
-    static const QByteArray UpdatedAt("updated_at");
-    static const QByteArray ModifiedAt("modified_at");
-
     QString upd;   // UPDATE Statement
     upd.reserve(256);
     upd.append(QLatin1String("UPDATE ")).append(tableName()).append(QLatin1String(" SET "));
 
-    QSqlDatabase db = database();
+    QSqlDatabase db = Tf::currentSqlDatabase(T().databaseId());  // primary database
     TCriteriaConverter<T> conv(cri, db);
     QString where = conv.toString();
 
@@ -520,11 +759,9 @@ int TSqlORMapper<T>::updateAll(const TCriteria &cri, const QMap<int, QVariant> &
     }
 
     T obj;
-    for (int i = obj.metaObject()->propertyOffset(); i < obj.metaObject()->propertyCount(); ++i) {
-        const char *propName = obj.metaObject()->property(i).name();
-        QByteArray prop = QByteArray(propName).toLower();
-        if (prop == UpdatedAt || prop == ModifiedAt) {
-            upd += propName;
+    for (auto &col : obj.columns()) {
+        if (col.roles & TSql::UpdatedAtColumn) {
+            upd += QLatin1String(col.name);
             upd += QLatin1Char('=');
             upd += TSqlQuery::formatValue(QDateTime::currentDateTime(), QVariant::DateTime, db);
             upd += QLatin1Char(',');
@@ -550,6 +787,9 @@ int TSqlORMapper<T>::updateAll(const TCriteria &cri, const QMap<int, QVariant> &
 
     TSqlQuery sqlQuery(db);
     bool res = sqlQuery.exec(upd);
+    if (res) {
+        TSqlQueryCache::tableModified(T().databaseId(), tableName());
+    }
     return res ? sqlQuery.numRowsAffected() : -1;
 }
 
@@ -572,7 +812,7 @@ inline int TSqlORMapper<T>::updateAll(const TCriteria &cri, int column, QVariant
 template <class T>
 inline int TSqlORMapper<T>::removeAll(const TCriteria &cri)
 {
-    QSqlDatabase db = database();
+    QSqlDatabase db = Tf::currentSqlDatabase(T().databaseId());  // primary database
     QString del = db.driver()->sqlStatement(QSqlDriver::DeleteStatement,
                                                     T().tableName(), QSqlRecord(), false);
     TCriteriaConverter<T> conv(cri, db);
@@ -588,9 +828,49 @@ inline int TSqlORMapper<T>::removeAll(const TCriteria &cri)
 
     TSqlQuery sqlQuery(db);
     bool res = sqlQuery.exec(del);
+    if (res) {
+        TSqlQueryCache::tableModified(T().databaseId(), tableName());
+    }
     return res ? sqlQuery.numRowsAffected() : -1;
 }
 
+/*!
+  Inserts all the \a objects into the table by multi-row INSERT
+  statements and returns the number of the rows inserted, or -1 if an
+  error occurred. The values of the auto-value field are set to the
+  objects.
+*/
+template <class T>
+inline int TSqlORMapper<T>::insertAll(QList<T> &objects)
+{
+    QList<TSqlObject *> list;
+    list.reserve(objects.count());
+    for (auto &obj : objects) {
+        list << &obj;
+    }
+    return TSqlObject::insertAll(list);
+}
+
+/*!
+  Inserts or updates all the \a objects by multi-row UPSERT statements
+  if UPSERT is enabled, and returns the number of the objects processed,
+  or -1 if an error occurred. Objects with the same primary key must not
+  be included in the list. Objects read from the database are updated
+  with the optimistic lock check if the class has the 'lock_revision'
+  property; SqlException is thrown if one of the rows was updated or
+  deleted by another transaction.
+*/
+template <class T>
+inline int TSqlORMapper<T>::upsertAll(QList<T> &objects)
+{
+    QList<TSqlObject *> list;
+    list.reserve(objects.count());
+    for (auto &obj : objects) {
+        list << &obj;
+    }
+    return TSqlObject::upsertAll(list);
+}
+
 /*!
   Sets a JOIN clause for \a column to \a join.
  */
@@ -625,6 +905,7 @@ template <class C> inline void TSqlORMapper<T>::setJoin(int column, const TSqlJo
     QSqlDatabase db = database();
 
     clause += C().tableName();
+    joinTables << C().tableName();
     clause += QLatin1Char(' ');
     clause += alias;
     clause += QLatin1String(" ON ");
@@ -669,6 +950,12 @@ inline void TSqlORMapper<T>::clear()
     joinCount = 0;
     joinClauses.clear();
     joinWhereClauses.clear();
+    joinTables.clear();
+    cacheSeconds = 0;
+    cachedResult = false;
+    cachedRecords.clear();
+    keysetEnabled = false;
+    seekCursor.clear();
 
     // Don't call the setTable() here,
     // or it causes a segmentation fault.
@@ -679,12 +966,19 @@ inline void TSqlORMapper<T>::clear()
 */
 template <class T>
 inline QString TSqlORMapper<T>::orderBy() const
+{
+    return orderBy(sortColumns);
+}
+
+
+template <class T>
+inline QString TSqlORMapper<T>::orderBy(const SortColumnList &columns) const
 {
     QString str;
 
-    if (!sortColumns.isEmpty()) {
+    if (!columns.isEmpty()) {
         str += QLatin1String(" ORDER BY ");
-        for (auto &p : sortColumns) {
+        for (auto &p : columns) {
             str += QLatin1String("t0.");
             str += TSqlQuery::escapeIdentifier(p.first, QSqlDriver::FieldName, database().driver());
             str += (p.second == Tf::AscendingOrder) ? QLatin1String(" ASC,") : QLatin1String(" DESC,");
@@ -694,4 +988,161 @@ inline QString TSqlORMapper<T>::orderBy() const
     return str;
 }
 
+/*!
+  Returns the next cursor for the keyset pagination, which points to the
+  rows after the last row of the results, or an empty byte array if no
+  more rows are available. The end is detected when the number of the
+  rows is less than the limit, without counting the rows of the table.
+  \sa seek()
+*/
+template <class T>
+inline QByteArray TSqlORMapper<T>::nextCursor() const
+{
+    if (!keysetEnabled || rowCount() == 0) {
+        return QByteArray();
+    }
+
+    bool backward = false;
+    QVariantList values;
+    bool seeking = decodeCursor(seekCursor, &backward, &values);
+    if (!(seeking && backward) && (queryLimit <= 0 || rowCount() < queryLimit)) {
+        return QByteArray();  // last page
+    }
+    return encodeCursor(rowCount() - 1, false);
+}
+
+/*!
+  Returns the previous cursor for the keyset pagination, which points to
+  the rows before the first row of the results, or an empty byte array if
+  the results are on the first page.
+  \sa seek()
+*/
+template <class T>
+inline QByteArray TSqlORMapper<T>::previousCursor() const
+{
+    if (!keysetEnabled || rowCount() == 0) {
+        return QByteArray();
+    }
+
+    bool backward = false;
+    QVariantList values;
+    bool seeking = decodeCursor(seekCursor, &backward, &values);
+    if (!seeking || (backward && (queryLimit <= 0 || rowCount() < queryLimit))) {
+        return QByteArray();  // first page
+    }
+    return encodeCursor(0, true);
+}
+
+/*!
+  Returns the sort columns for the keyset pagination, to which the
+  primary key is appended as a tie-breaker.
+*/
+template <class T>
+inline typename TSqlORMapper<T>::SortColumnList TSqlORMapper<T>::keysetColumns() const
+{
+    SortColumnList columns = sortColumns;
+    const QSqlDriver *driver = database().driver();
+    const QString pkName = TCriteriaConverter<T>::getPropertyName(T().primaryKeyIndex(), driver);
+
+    if (!pkName.isEmpty()) {
+        const QString pk = driver->stripDelimiters(pkName, QSqlDriver::FieldName);
+        bool found = false;
+        for (auto &p : columns) {
+            if (driver->stripDelimiters(p.first, QSqlDriver::FieldName).compare(pk, Qt::CaseInsensitive) == 0) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            columns << qMakePair(pkName, (columns.isEmpty() ? Tf::AscendingOrder : columns.last().second));
+        }
+    }
+    return columns;
+}
+
+/*!
+  Returns the WHERE clause that selects the rows after the sort key
+  \a values in the order of \a columns, or before them if \a backward
+  is true. A row value comparison such as "(a,b) > (1,2)" is used if all
+  the columns are sorted in the same direction.
+*/
+template <class T>
+inline QString TSqlORMapper<T>::keysetFilter(const SortColumnList &columns, const QVariantList &values, bool backward) const
+{
+    QStringList names, vals, ops;
+    bool sameDirection = true;
+
+    for (int i = 0; i < columns.count(); ++i) {
+        const auto &p = columns[i];
+        names << QLatin1String("t0.") + TSqlQuery::escapeIdentifier(p.first, QSqlDriver::FieldName, database().driver());
+        vals << TSqlQuery::formatValue(values.value(i), database());
+        ops << (((p.second == Tf::AscendingOrder) != backward) ? QStringLiteral(">") : QStringLiteral("<"));
+        sameDirection &= (ops.last() == ops.first());
+    }
+
+    if (names.count() == 1) {
+        return names[0] + ops[0] + vals[0];
+    }
+
+    if (sameDirection) {
+        return QLatin1Char('(') + names.join(QLatin1Char(',')) + QLatin1String(")") + ops[0] + QLatin1Char('(') + vals.join(QLatin1Char(',')) + QLatin1Char(')');
+    }
+
+    // (a > 1) OR (a = 1 AND b < 2) OR ...
+    QStringList terms;
+    for (int i = 0; i < names.count(); ++i) {
+        QString term = QLatin1String("(");
+        for (int j = 0; j < i; ++j) {
+            term += names[j] + QLatin1Char('=') + vals[j] + QLatin1String(" AND ");
+        }
+        term += names[i] + ops[i] + vals[i] + QLatin1Char(')');
+        terms << term;
+    }
+    return QLatin1Char('(') + terms.join(QLatin1String(" OR ")) + QLatin1Char(')');
+}
+
+/*!
+  Encodes the sort key of the \a row into an opaque cursor signed with
+  Session.Secret.
+  \sa TSqlKeysetCursor
+*/
+template <class T>
+inline QByteArray TSqlORMapper<T>::encodeCursor(int row, bool backward) const
+{
+    const QSqlRecord rec = cachedResult ? cachedRecords.value(row) : record(row);
+    const QSqlDriver *driver = database().driver();
+    QStringList names;
+    QVariantList values;
+
+    for (auto &p : keysetColumns()) {
+        QString name = driver->stripDelimiters(p.first, QSqlDriver::FieldName);
+        names << name.toLower();
+        values << rec.value(name);
+    }
+    return TSqlKeysetCursor::encode(names, values, backward);
+}
+
+/*!
+  Decodes the \a cursor. Returns false if the cursor is empty, or
+  tampered or invalid for the current sort order.
+*/
+template <class T>
+inline bool TSqlORMapper<T>::decodeCursor(const QByteArray &cursor, bool *backward, QVariantList *values) const
+{
+    if (cursor.isEmpty()) {
+        return false;
+    }
+
+    QStringList names;
+    for (auto &p : keysetColumns()) {
+        names << database().driver()->stripDelimiters(p.first, QSqlDriver::FieldName).toLower();
+    }
+
+    if (!TSqlKeysetCursor::decode(cursor, names, *values, *backward)) {
+        tSystemWarn("Invalid cursor for keyset pagination: %s", cursor.left(256).constData());
+        return false;
+    }
+    return true;
+}
+
 #endif // TSQLORMAPPER_H
@@ -0,0 +1,116 @@
+#ifndef TSQLORMAPPERSTREAM_H
+#define TSQLORMAPPERSTREAM_H
+
+#include <QtSql>
+#include <TGlobal>
+#include <TSqlQuery>
+#include "tsystemglobal.h"
+
+/*!
+  \class TSqlORMapperStream
+  \brief The TSqlORMapperStream class is a template class that retrieves
+  ORM objects one by one from the result of a query executed with a
+  forward-only cursor. Only the current row is held in memory, so it is
+  suitable for exporting a large table.
+
+  \code
+  TSqlORMapper<BlogObject> mapper;
+  for (auto &blog : mapper.findStream(crit)) {
+      ...
+  }
+  \endcode
+
+  Note that some drivers, such as MySQL, can not execute another query
+  on the same connection until all the rows have been retrieved.
+  \sa TSqlORMapper::findStream()
+*/
+
+
+template <class T>
+class TSqlORMapperStream
+{
+public:
+    TSqlORMapperStream(const QSqlDatabase &database, const QString &statement);
+    TSqlORMapperStream(TSqlORMapperStream<T> &&other) = default;
+
+    bool isActive() const { return query.isActive(); }
+    QSqlError lastError() const { return query.lastError(); }
+    bool next();
+    const T &value() const { return current; }
+
+    class Iterator;
+    Iterator begin();
+    Iterator end() { return Iterator(nullptr); }
+
+    /*!
+      Input iterator
+     */
+    class Iterator {
+    public:
+        inline const T &operator*() const { return s->value(); }
+        inline const T *operator->() const { return &s->value(); }
+        inline bool operator==(const Iterator &o) const { return s == o.s; }
+        inline bool operator!=(const Iterator &o) const { return s != o.s; }
+        inline Iterator &operator++() { s = (s && s->next()) ? s : nullptr; return *this; }
+
+    private:
+        inline Iterator(TSqlORMapperStream<T> *stream) : s(stream) {}
+        TSqlORMapperStream<T> *s {nullptr};
+        friend class TSqlORMapperStream;
+    };
+
+private:
+    TSqlQuery query;
+    T current;
+    bool started {false};
+
+    T_DISABLE_COPY(TSqlORMapperStream)
+};
+
+/*!
+  Executes the SELECT \a statement on the \a database with a forward-only
+  cursor.
+*/
+template <class T>
+inline TSqlORMapperStream<T>::TSqlORMapperStream(const QSqlDatabase &database, const QString &statement)
+    : query(database)
+{
+    // Retrieves rows one by one instead of caching the whole result
+    // in the driver, if supported
+    query.setForwardOnly(true);
+    if (!statement.isEmpty()) {
+        query.exec(statement);
+    }
+}
+
+/*!
+  Retrieves the next row and makes it the current ORM object. Returns
+  false if no more rows are available.
+*/
+template <class T>
+inline bool TSqlORMapperStream<T>::next()
+{
+    started = true;
+    if (!query.isActive() || !query.next()) {
+        current = T();
+        return false;
+    }
+    current.setRecord(query.record(), QSqlError());
+    return true;
+}
+
+/*!
+  Returns an iterator pointing to the first ORM object. The stream
+  can be iterated only once.
+*/
+template <class T>
+inline typename TSqlORMapperStream<T>::Iterator TSqlORMapperStream<T>::begin()
+{
+    if (started) {
+        tSystemWarn("TSqlORMapperStream can be iterated only once");
+        return end();
+    }
+    return next() ? Iterator(this) : end();
+}
+
+#endif // TSQLORMAPPERSTREAM_H
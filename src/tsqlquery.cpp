@@ -8,6 +8,10 @@
 #include <TSqlQuery>
 #include <TWebApplication>
 #include <TAppSettings>
+#include "tsqlasync.h"
+#include "tsqldatabasepool.h"
+#include "tdatabasecontext.h"
+#include "tqueryprofiler.h"
 #include "tsystemglobal.h"
 #include <QMap>
 #include <QMutex>
@@ -29,12 +33,15 @@ namespace {
   Constructs a TSqlQuery object using the database \a databaseId.
 */
 TSqlQuery::TSqlQuery(int databaseId) :
-    QSqlQuery(QString(), Tf::currentSqlDatabase(databaseId))
+    QSqlQuery(QString(), Tf::currentSqlDatabase(databaseId)),
+    _databaseId(databaseId)
 { }
 
 
 TSqlQuery::TSqlQuery(QSqlDatabase db) :
-    QSqlQuery(db)
+    QSqlQuery(db),
+    _databaseId(TSqlDatabasePool::getDatabaseId(db)),
+    _primary(TSqlDatabasePool::getReplicaIndex(db) < 0)
 { }
 
 
@@ -163,8 +170,15 @@ TSqlQuery &TSqlQuery::prepare(const QString &query)
 */
 bool TSqlQuery::exec(const QString &query)
 {
+    TQueryProfiler profiler;
     bool ret = QSqlQuery::exec(query);
-    Tf::writeQueryLog(query, ret, lastError());
+    Tf::writeQueryLog(query, ret, lastError(), profiler.elapsed());
+    if (ret) {
+        profiler.record(query, (isSelect() ? size() : numRowsAffected()), QVariantList(), _databaseId);
+        if (!isSelect()) {
+            setWritten();
+        }
+    }
     return ret;
 }
 
@@ -174,11 +188,67 @@ bool TSqlQuery::exec(const QString &query)
 */
 bool TSqlQuery::exec()
 {
+    TQueryProfiler profiler;
     bool ret = QSqlQuery::exec();
-    Tf::writeQueryLog(executedQuery(), ret, lastError());
+    Tf::writeQueryLog(executedQuery(), ret, lastError(), profiler.elapsed());
+    if (ret && TQueryProfiler::isEnabled()) {
+        profiler.record(executedQuery(), (isSelect() ? size() : numRowsAffected()), boundValues().values(), _databaseId);
+    }
+    if (ret && !isSelect()) {
+        setWritten();
+    }
     return ret;
 }
 
+/*!
+  Records in the current database context that a statement other than
+  SELECT has been executed on the primary database, so that the following
+  reads in the context are not routed to a read replica.
+*/
+void TSqlQuery::setWritten()
+{
+    auto *context = TDatabaseContext::currentDatabaseContext();
+    if (context && _primary && _databaseId >= 0) {
+        context->setDatabaseWritten(_databaseId);
+    }
+}
+
+/*!
+  Executes the SQL \a query with the \a values bound to its positional
+  placeholders on a database I/O thread, and returns the future of the
+  records of the result. The query is executed in the calling thread if
+  a transaction is active on the database \a databaseId in the current
+  context. If the query fails, std::future::get() throws SqlException.
+  \sa TSqlAsync
+*/
+std::future<QList<QSqlRecord>> TSqlQuery::execAsync(const QString &query, const QVariantList &values, int databaseId)
+{
+    return TSqlAsync::run<QList<QSqlRecord>>(databaseId, [query, values, databaseId]() {
+        TSqlQuery sqlQuery(databaseId);
+        bool res;
+
+        if (values.isEmpty()) {
+            res = sqlQuery.exec(query);
+        } else {
+            sqlQuery.prepare(query);
+            for (auto &val : values) {
+                sqlQuery.addBind(val);
+            }
+            res = sqlQuery.exec();
+        }
+
+        if (!res) {
+            throw SqlException(sqlQuery.lastError().text(), __FILE__, __LINE__);
+        }
+
+        QList<QSqlRecord> records;
+        while (sqlQuery.next()) {
+            records << sqlQuery.record();
+        }
+        return records;
+    });
+}
+
 /*!
   Set the placeholder \a placeholder to be bound to value \a val in the
   prepared statement.
@@ -3,6 +3,7 @@
 
 #include <QtSql>
 #include <TGlobal>
+#include <future>
 
 
 class T_CORE_EXPORT TSqlQuery : public QSqlQuery
@@ -26,12 +27,19 @@ public:
     QVariant value(int index) const;
     QVariant value(const QString &name) const;
 
+    static std::future<QList<QSqlRecord>> execAsync(const QString &query, const QVariantList &values = QVariantList(), int databaseId = 0);
     static void clearCachedQueries();
     static QString escapeIdentifier(const QString &identifier, QSqlDriver::IdentifierType type = QSqlDriver::FieldName, int databaseId = 0);
     static QString escapeIdentifier(const QString &identifier, QSqlDriver::IdentifierType type, const QSqlDriver *driver);
     static QString formatValue(const QVariant &val, QVariant::Type type = QVariant::Invalid, int databaseId = 0);
     static QString formatValue(const QVariant &val, QVariant::Type type, const QSqlDatabase &database);
     static QString formatValue(const QVariant &val, const QSqlDatabase &database);
+
+private:
+    void setWritten();
+
+    int _databaseId {-1};
+    bool _primary {true};
 };
 
 
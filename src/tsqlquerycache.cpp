@@ -0,0 +1,319 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tsqlquerycache.h"
+#include "tsystembus.h"
+#include "tpublisher.h"
+#include "tsystemglobal.h"
+#include "tcachefactory.h"
+#include "tcachestore.h"
+#include <TWebApplication>
+#include <TAppSettings>
+#include <TDatabaseContext>
+#include <TCache>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QDateTime>
+#include <QSqlField>
+#include <QHash>
+
+constexpr auto CACHE_KEY_PREFIX = "tf.sqlcache:";
+constexpr auto GENERATION_KEY_PREFIX = "tf.sqlcache.gen:";
+constexpr int GENERATION_LIFETIME = 7 * 24 * 3600;  // secs
+constexpr int GENERATION_CHECK_INTERVAL = 1000;  // msecs
+
+namespace {
+struct Generation
+{
+    QByteArray value;
+    qint64 checkTime {0};  // msecs since epoch to re-read from the store
+};
+
+QHash<QString, Generation> generations;  // generation of each table
+QReadWriteLock generationLock;
+QMutex storeMutex;
+
+
+// Name of the table qualified by the database ID, as "0:blog"
+inline QString qualifiedTableName(int databaseId, const QString &table)
+{
+    return QString::number(databaseId) + QLatin1Char(':') + table.trimmed().toLower();
+}
+
+
+QByteArray newGeneration()
+{
+    return QByteArray::number((qulonglong)Tf::rand64_r(), 36);
+}
+
+// Cache store shared by all threads, not the TCache of the action
+// context, as tables are also modified on the threads of TSqlAsync and
+// TScheduler. Accessed under the storeMutex.
+TCacheStore *cacheStore()
+{
+    static TCacheStore *store = []() -> TCacheStore * {
+        TCacheStore *st = TCacheFactory::create(Tf::app()->cacheBackend());
+        if (st && !st->open()) {
+            tSystemError("Failed to open the cache store for the query cache  [%s:%d]", __FILE__, __LINE__);
+            TCacheFactory::destroy(Tf::app()->cacheBackend(), st);
+            st = nullptr;
+        }
+        return st;
+    }();
+    return store;
+}
+
+
+QByteArray storeGet(const QByteArray &key)
+{
+    QMutexLocker locker(&storeMutex);
+    TCacheStore *store = cacheStore();
+    if (!store) {
+        return QByteArray();
+    }
+
+    QByteArray value = store->get(key);
+    return TCache::compressionEnabled() ? Tf::lz4Uncompress(value) : value;
+}
+
+
+bool storeSet(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    QMutexLocker locker(&storeMutex);
+    TCacheStore *store = cacheStore();
+    if (!store) {
+        return false;
+    }
+    return store->set(key, (TCache::compressionEnabled() ? Tf::lz4Compress(value) : value), seconds);
+}
+}
+
+/*!
+  \class TSqlQueryCache
+  \brief The TSqlQueryCache class caches the results of SELECT statements
+  in the cache backend, tagged by the tables they touch.
+
+  Each table has a generation, a random token that is part of the cache
+  keys of the queries on it. When a row of the table is inserted, updated
+  or deleted, the generation is renewed on commit of the transaction, so
+  that the entries cached before are never hit again and expire by their
+  timeout. The new generation is stored in the cache backend and
+  broadcast to the other application server processes through
+  TSystemBus. Each process holds the generations for a second and then
+  re-reads them from the cache backend, so that renewals made on the
+  other hosts are followed as well. Tables are told apart by the
+  database ID.
+
+  The cache backend is accessed through a store shared by all threads,
+  so that the query cache can be used on any thread with a database
+  context, such as the tasks of TSqlAsync.
+  \sa TSqlORMapper::cache()
+*/
+
+/*!
+  Returns true if the query cache is enabled by the Cache.EnableQueryCache
+  setting and the cache module is available.
+*/
+bool TSqlQueryCache::isEnabled()
+{
+    static const bool enabled = []() {
+        bool ret = Tf::appSettings()->value(Tf::CacheEnableQueryCache, false).toBool() && Tf::app()->cacheEnabled();
+        if (ret && Tf::app()->maxNumberOfAppServers() > 1) {
+            // Receives new generations from the other processes
+            TPublisher::instance();
+        }
+        return ret;
+    }();
+    return enabled;
+}
+
+/*!
+  Returns the key of the cache for the \a query on the \a tables of the
+  database \a databaseId, made from the current generations of the
+  tables. The key must be computed once before the query is executed and
+  used for both get() and set(), so that a result read before the tables
+  are modified is not stored under the new generations.
+*/
+QByteArray TSqlQueryCache::cacheKey(int databaseId, const QString &query, const QStringList &tables)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(databaseId));
+    hash.addData(query.toUtf8());
+    for (auto &table : tables) {
+        hash.addData("\n", 1);
+        hash.addData(generation(databaseId, table));
+    }
+    return CACHE_KEY_PREFIX + hash.result().toHex();
+}
+
+/*!
+  Returns the result cached with the \a key made by cacheKey(), or an
+  empty byte array if not cached.
+*/
+QByteArray TSqlQueryCache::get(const QByteArray &key)
+{
+    if (!isEnabled() || key.isEmpty()) {
+        return QByteArray();
+    }
+    return storeGet(key);
+}
+
+/*!
+  Stores the result \a value with the \a key made by cacheKey() for
+  \a seconds.
+*/
+bool TSqlQueryCache::set(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (!isEnabled() || key.isEmpty() || seconds <= 0) {
+        return false;
+    }
+    return storeSet(key, value, seconds);
+}
+
+/*!
+  Notifies that rows of the \a table in the database \a databaseId have
+  been modified. The cached results on the table are invalidated when the
+  current transaction is committed, or immediately if no transaction is
+  active.
+*/
+void TSqlQueryCache::tableModified(int databaseId, const QString &table)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    Tf::currentDatabaseContext()->addModifiedTable(databaseId, table);
+}
+
+/*!
+  Invalidates all the results cached for the queries on the \a tables of
+  the database \a databaseId.
+*/
+void TSqlQueryCache::invalidate(int databaseId, const QStringList &tables)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    for (const auto &table : tables) {
+        if (table.trimmed().isEmpty()) {
+            continue;
+        }
+
+        const QString name = qualifiedTableName(databaseId, table);
+        QByteArray gen = newGeneration();
+        updateGeneration(name, gen);
+        storeSet(GENERATION_KEY_PREFIX + name.toUtf8(), gen, GENERATION_LIFETIME);
+
+        if (Tf::app()->maxNumberOfAppServers() > 1) {
+            TSystemBus::instance()->send(Tf::SqlQueryCacheInvalidate, name, gen);
+        }
+        tSystemDebug("Query cache invalidated: %s", qPrintable(name));
+    }
+}
+
+/*!
+  Sets the generation of the table of the qualified \a name, such as
+  "0:blog", to \a generation. This function is for internal use only.
+*/
+void TSqlQueryCache::updateGeneration(const QString &name, const QByteArray &generation)
+{
+    QWriteLocker locker(&generationLock);
+    auto &gen = generations[name];
+    gen.value = generation;
+    gen.checkTime = QDateTime::currentMSecsSinceEpoch() + GENERATION_CHECK_INTERVAL;
+}
+
+
+QByteArray TSqlQueryCache::generation(int databaseId, const QString &table)
+{
+    const QString name = qualifiedTableName(databaseId, table);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QByteArray current;
+    {
+        QReadLocker locker(&generationLock);
+        auto it = generations.constFind(name);
+        if (it != generations.constEnd()) {
+            if (now < it->checkTime) {
+                return it->value;
+            }
+            current = it->value;
+        }
+    }
+
+    // Loads the generation shared by the processes
+    const QByteArray key = GENERATION_KEY_PREFIX + name.toUtf8();
+    QByteArray gen = storeGet(key);
+    if (gen.isEmpty()) {
+        // Stores the generation again if evicted, so that the results
+        // cached with it stay valid
+        gen = current.isEmpty() ? newGeneration() : current;
+        storeSet(key, gen, GENERATION_LIFETIME);
+    }
+
+    updateGeneration(name, gen);
+    return gen;
+}
+
+/*!
+  Serializes the \a records, which have the same fields, into a byte array.
+*/
+QByteArray TSqlQueryCache::serialize(const QList<QSqlRecord> &records)
+{
+    QByteArray buf;
+    QDataStream ds(&buf, QIODevice::WriteOnly);
+    QStringList names;
+
+    if (!records.isEmpty()) {
+        const auto &rec = records.first();
+        for (int i = 0; i < rec.count(); ++i) {
+            names << rec.fieldName(i);
+        }
+    }
+
+    ds << names << (qint32)records.count();
+    for (const auto &rec : records) {
+        for (int i = 0; i < names.count(); ++i) {
+            ds << rec.value(i);
+        }
+    }
+    return buf;
+}
+
+/*!
+  Deserializes the records from the \a data serialized by serialize().
+*/
+QList<QSqlRecord> TSqlQueryCache::deserialize(const QByteArray &data)
+{
+    QList<QSqlRecord> records;
+    QDataStream ds(data);
+    QStringList names;
+    qint32 count = 0;
+
+    ds >> names >> count;
+    records.reserve(qMax(count, 0));
+
+    for (int r = 0; r < count && ds.status() == QDataStream::Ok; ++r) {
+        QSqlRecord rec;
+        for (auto &name : names) {
+            QVariant val;
+            ds >> val;
+            QSqlField field(name, val.type());
+            field.setValue(val);
+            rec.append(field);
+        }
+        records << rec;
+    }
+
+    if (ds.status() != QDataStream::Ok) {
+        tSystemError("Invalid data of query cache  [%s:%d]", __FILE__, __LINE__);
+        records.clear();
+    }
+    return records;
+}
@@ -0,0 +1,31 @@
+#ifndef TSQLQUERYCACHE_H
+#define TSQLQUERYCACHE_H
+
+#include <QSqlRecord>
+#include <QList>
+#include <QStringList>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TSqlQueryCache
+{
+public:
+    static bool isEnabled();
+    static QByteArray cacheKey(int databaseId, const QString &query, const QStringList &tables);
+    static QByteArray get(const QByteArray &key);
+    static bool set(const QByteArray &key, const QByteArray &value, int seconds);
+    static void tableModified(int databaseId, const QString &table);
+    static void invalidate(int databaseId, const QStringList &tables);
+    static void updateGeneration(const QString &name, const QByteArray &generation);
+
+    static QByteArray serialize(const QList<QSqlRecord> &records);
+    static QList<QSqlRecord> deserialize(const QByteArray &data);
+
+private:
+    static QByteArray generation(int databaseId, const QString &table);
+
+    T_DISABLE_COPY(TSqlQueryCache)
+    T_DISABLE_MOVE(TSqlQueryCache)
+};
+
+#endif // TSQLQUERYCACHE_H
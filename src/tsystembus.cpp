@@ -9,8 +9,12 @@
 #include "tsystemglobal.h"
 #include "tprocessinfo.h"
 #include "tfcore.h"
+#ifdef Q_OS_LINUX
+# include "tsystembusring.h"
+#endif
 #include <TWebApplication>
 #include <TApplicationServerBase>
+#include <TAppSettings>
 #include <QMutex>
 #include <QDataStream>
 #include <QLocalSocket>
@@ -42,6 +46,9 @@ TSystemBus::TSystemBus() :
 
 TSystemBus::~TSystemBus()
 {
+#ifdef Q_OS_LINUX
+    delete busRing;
+#endif
     busSocket->close();
     delete busSocket;
 }
@@ -49,6 +56,12 @@ TSystemBus::~TSystemBus()
 
 bool TSystemBus::send(const TSystemBusMessage &message)
 {
+#ifdef Q_OS_LINUX
+    if (busRing && busRing->write(message.toByteArray())) {
+        return true;  // Broadcasted through the shared memory
+    }
+#endif
+
     QMutexLocker locker(&mutexWrite);
     sendBuffer += message.toByteArray();
     QMetaObject::invokeMethod(this, "writeBus", Qt::QueuedConnection); // Writes in main thread
@@ -109,6 +122,23 @@ void TSystemBus::readBus()
 }
 
 
+void TSystemBus::readRing()
+{
+#ifdef Q_OS_LINUX
+    // Called in the ring's reader thread
+    {
+        QMutexLocker locker(&mutexRead);
+        QByteArray frames = busRing->readAll();
+        if (frames.isEmpty()) {
+            return;
+        }
+        readBuffer += frames;
+    }
+    emit readyReceive();
+#endif
+}
+
+
 void TSystemBus::writeBus()
 {
     QMutexLocker locker(&mutexWrite);
@@ -142,6 +172,21 @@ void TSystemBus::writeBus()
 void TSystemBus::connect()
 {
     busSocket->connectToServer(connectionName());
+
+#ifdef Q_OS_LINUX
+    // Shared memory ring, the local socket is used as fallback
+    int ringSize = Tf::appSettings()->value(Tf::SystemBusRingBufferSize, 0).toInt();
+    if (ringSize > 0 && !busRing) {
+        busRing = new TSystemBusRing(connectionName() + QLatin1String("_ring"), ringSize);
+        if (busRing->isAttached()) {
+            QObject::connect(busRing, SIGNAL(readyRead()), this, SLOT(readRing()), Qt::DirectConnection);
+            busRing->start();
+        } else {
+            delete busRing;
+            busRing = nullptr;
+        }
+    }
+#endif
 }
 
 
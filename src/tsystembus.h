@@ -9,6 +9,7 @@
 #include "tsystemglobal.h"
 
 class TSystemBusMessage;
+class TSystemBusRing;
 
 
 class T_CORE_EXPORT TSystemBus : public QObject
@@ -32,11 +33,13 @@ signals:
 
 protected slots:
     void readBus();
+    void readRing();
     void writeBus();
     void handleError(QLocalSocket::LocalSocketError error);
 
 private:
     QLocalSocket *busSocket {nullptr};
+    TSystemBusRing *busRing {nullptr};
     QByteArray readBuffer;
     QByteArray sendBuffer;
     QMutex mutexRead {QMutex::NonRecursive};
@@ -0,0 +1,48 @@
+#ifndef TSYSTEMBUSRING_H
+#define TSYSTEMBUSRING_H
+
+#include <QThread>
+#include <QByteArray>
+#include <TGlobal>
+
+class QSharedMemory;
+struct TSystemBusRingHeader;
+
+
+class T_CORE_EXPORT TSystemBusRing : public QThread
+{
+    Q_OBJECT
+public:
+    TSystemBusRing(const QString &key, int size);
+    ~TSystemBusRing();
+
+    bool isAttached() const;
+    bool write(const QByteArray &frame);
+    QByteArray readAll();
+    void stop();
+
+signals:
+    void readyRead();
+
+protected:
+    void run() override;
+
+private:
+    TSystemBusRingHeader *header() const;
+    char *data() const;
+    bool lock();
+    void unlock();
+    void copyTo(quint64 pos, const char *src, int len);
+    void copyFrom(quint64 pos, char *dst, int len) const;
+
+    QSharedMemory *shareMem {nullptr};
+    TSystemBusRingHeader *_header {nullptr};
+    quint64 readPos {0};
+    quint32 pid {0};
+    volatile bool stopped {false};
+
+    T_DISABLE_COPY(TSystemBusRing)
+    T_DISABLE_MOVE(TSystemBusRing)
+};
+
+#endif // TSYSTEMBUSRING_H
@@ -0,0 +1,332 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tsystembusring.h"
+#include "tsystemglobal.h"
+#include <QSharedMemory>
+#include <QElapsedTimer>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+constexpr quint32 RING_MAGIC = 0x54465242;  // "TFRB"
+constexpr int RECORD_HEADER_LEN = 8;  // length(32) + pid(32)
+constexpr int MIN_CAPACITY = 64 * 1024;
+constexpr int LOCK_TIMEOUT_MSECS = 100;
+constexpr int WAIT_TIMEOUT_MSECS = 1000;
+
+
+/*
+  Layout of the shared memory
+
+  +--------------------------------+
+  | TSystemBusRingHeader           |
+  +--------------------------------+
+  | data (capacity bytes)          |
+  |  record: length(32) pid(32)    |
+  |          frame (aligned to 8)  |
+  +--------------------------------+
+
+  Producers are serialized by a spinlock in the header. Every process
+  keeps its own read cursor, so a record written once is broadcast to
+  all attached processes. Readers detect records overwritten during
+  their copy by checking 'reserve' afterwards (seqlock style).
+*/
+struct TSystemBusRingHeader
+{
+    std::atomic<quint32> magic;
+    quint32 capacity;
+    std::atomic<quint32> lock;  // pid of the writer
+    std::atomic<quint32> seq;   // futex word
+    std::atomic<quint64> reserve;
+    std::atomic<quint64> head;
+};
+
+
+static inline quint64 alignedLength(int len)
+{
+    return (RECORD_HEADER_LEN + (quint64)len + 7) & ~(quint64)7;
+}
+
+
+static inline void futexWait(std::atomic<quint32> *addr, quint32 value, int msecs)
+{
+    struct timespec ts;
+    ts.tv_sec = msecs / 1000;
+    ts.tv_nsec = (msecs % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<int *>(addr), FUTEX_WAIT, (int)value, &ts, nullptr, 0);
+}
+
+
+static inline void futexWakeAll(std::atomic<quint32> *addr)
+{
+    syscall(SYS_futex, reinterpret_cast<int *>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+
+/*!
+  \class TSystemBusRing
+  \brief The TSystemBusRing class provides a multi-producer broadcast
+  ring buffer on shared memory for the system bus.
+*/
+
+TSystemBusRing::TSystemBusRing(const QString &key, int size) :
+    QThread(),
+    shareMem(new QSharedMemory(key)),
+    pid((quint32)::getpid())
+{
+    quint32 capacity = MIN_CAPACITY;
+    while (capacity < (quint32)size && capacity < (1U << 30)) {
+        capacity <<= 1;  // power of two
+    }
+
+    if (shareMem->create(sizeof(TSystemBusRingHeader) + capacity)) {
+        shareMem->lock();
+        auto *h = new (shareMem->data()) TSystemBusRingHeader();
+        h->capacity = capacity;
+        h->lock.store(0);
+        h->seq.store(0);
+        h->reserve.store(0);
+        h->head.store(0);
+        h->magic.store(RING_MAGIC, std::memory_order_release);
+        shareMem->unlock();
+        _header = h;
+        tSystemDebug("System bus ring created  key:%s  capacity:%u", qPrintable(key), capacity);
+
+    } else if (shareMem->error() == QSharedMemory::AlreadyExists && shareMem->attach()) {
+        auto *h = static_cast<TSystemBusRingHeader *>(shareMem->data());
+        // Waits for the creator to initialize the header
+        for (int i = 0; i < 100 && h->magic.load(std::memory_order_acquire) != RING_MAGIC; ++i) {
+            QThread::msleep(10);
+        }
+
+        if (h->magic.load(std::memory_order_acquire) != RING_MAGIC
+            || (quint64)shareMem->size() < sizeof(TSystemBusRingHeader) + h->capacity) {
+            tSystemError("System bus ring invalid  key:%s  [%s:%d]", qPrintable(key), __FILE__, __LINE__);
+            shareMem->detach();
+        } else {
+            _header = h;
+            readPos = h->head.load(std::memory_order_acquire);
+            tSystemDebug("System bus ring attached  key:%s  capacity:%u", qPrintable(key), h->capacity);
+        }
+    } else {
+        tSystemError("System bus ring error: %s  [%s:%d]", qPrintable(shareMem->errorString()), __FILE__, __LINE__);
+    }
+}
+
+
+TSystemBusRing::~TSystemBusRing()
+{
+    stop();
+    delete shareMem;
+}
+
+
+bool TSystemBusRing::isAttached() const
+{
+    return (bool)_header;
+}
+
+
+TSystemBusRingHeader *TSystemBusRing::header() const
+{
+    return _header;
+}
+
+
+char *TSystemBusRing::data() const
+{
+    return reinterpret_cast<char *>(_header) + sizeof(TSystemBusRingHeader);
+}
+
+
+bool TSystemBusRing::lock()
+{
+    auto *h = header();
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; ; ++i) {
+        quint32 expected = 0;
+        if (h->lock.compare_exchange_weak(expected, pid, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+
+        if (i < 64) {
+            continue;
+        }
+
+        // Recovers the lock held by a dead process
+        if (expected && ::kill((pid_t)expected, 0) < 0 && errno == ESRCH) {
+            if (h->lock.compare_exchange_strong(expected, pid, std::memory_order_acquire, std::memory_order_relaxed)) {
+                tSystemWarn("System bus ring lock recovered from pid:%u", expected);
+                return true;
+            }
+        }
+
+        if (timer.elapsed() > LOCK_TIMEOUT_MSECS) {
+            tSystemWarn("System bus ring lock timeout  [%s:%d]", __FILE__, __LINE__);
+            return false;
+        }
+        sched_yield();
+    }
+}
+
+
+void TSystemBusRing::unlock()
+{
+    header()->lock.store(0, std::memory_order_release);
+}
+
+
+void TSystemBusRing::copyTo(quint64 pos, const char *src, int len)
+{
+    const quint32 capacity = header()->capacity;
+    const quint32 offset = pos & (capacity - 1);
+    const int first = qMin((quint32)len, capacity - offset);
+    std::memcpy(data() + offset, src, first);
+    if (first < len) {
+        std::memcpy(data(), src + first, len - first);
+    }
+}
+
+
+void TSystemBusRing::copyFrom(quint64 pos, char *dst, int len) const
+{
+    const quint32 capacity = header()->capacity;
+    const quint32 offset = pos & (capacity - 1);
+    const int first = qMin((quint32)len, capacity - offset);
+    std::memcpy(dst, data() + offset, first);
+    if (first < len) {
+        std::memcpy(dst + first, data(), len - first);
+    }
+}
+
+
+/*!
+  Writes the \a frame to the ring so that all other processes attached
+  receive it. Returns false if the frame can not be written, in which
+  case the caller should fall back on the local socket.
+*/
+bool TSystemBusRing::write(const QByteArray &frame)
+{
+    auto *h = header();
+    if (!h || frame.isEmpty()) {
+        return false;
+    }
+
+    const quint64 reclen = alignedLength(frame.length());
+    if (reclen > h->capacity / 2) {
+        return false;
+    }
+
+    if (!lock()) {
+        return false;
+    }
+
+    const quint64 pos = h->head.load(std::memory_order_relaxed);
+    h->reserve.store(pos + reclen, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const quint32 rechdr[2] = { (quint32)frame.length(), pid };
+    copyTo(pos, reinterpret_cast<const char *>(rechdr), RECORD_HEADER_LEN);
+    copyTo(pos + RECORD_HEADER_LEN, frame.constData(), frame.length());
+    h->head.store(pos + reclen, std::memory_order_release);
+    unlock();
+
+    h->seq.fetch_add(1, std::memory_order_release);
+    futexWakeAll(&h->seq);
+    return true;
+}
+
+
+/*!
+  Reads all frames written by other processes since the last call.
+  Frames overwritten before being read are discarded.
+*/
+QByteArray TSystemBusRing::readAll()
+{
+    QByteArray ret;
+    auto *h = header();
+    if (!h) {
+        return ret;
+    }
+
+    const quint32 capacity = h->capacity;
+    quint64 head = h->head.load(std::memory_order_acquire);
+
+    if (head - readPos > capacity) {
+        tSystemWarn("System bus ring overrun, messages dropped  lost:%llu bytes  [%s:%d]", head - readPos - capacity, __FILE__, __LINE__);
+        readPos = head;
+        return ret;
+    }
+
+    while (readPos < head) {
+        quint32 rechdr[2];
+        copyFrom(readPos, reinterpret_cast<char *>(rechdr), RECORD_HEADER_LEN);
+        const int len = (int)rechdr[0];
+        const quint64 reclen = alignedLength(len);
+
+        if (len <= 0 || readPos + reclen > head) {
+            tSystemError("System bus ring corrupted  [%s:%d]", __FILE__, __LINE__);
+            readPos = head;
+            break;
+        }
+
+        const int oldlen = ret.length();
+        if (rechdr[1] != pid) {
+            ret.resize(oldlen + len);
+            copyFrom(readPos + RECORD_HEADER_LEN, ret.data() + oldlen, len);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h->reserve.load(std::memory_order_relaxed) > readPos + capacity) {
+            // Overwritten by a producer while copying
+            tSystemWarn("System bus ring overrun, messages dropped  [%s:%d]", __FILE__, __LINE__);
+            ret.resize(oldlen);
+            readPos = h->head.load(std::memory_order_acquire);
+            break;
+        }
+        readPos += reclen;
+    }
+    return ret;
+}
+
+
+void TSystemBusRing::stop()
+{
+    if (isRunning()) {
+        stopped = true;
+        header()->seq.fetch_add(1, std::memory_order_release);
+        futexWakeAll(&header()->seq);
+        wait();
+    }
+}
+
+
+void TSystemBusRing::run()
+{
+    auto *h = header();
+    if (!h) {
+        return;
+    }
+
+    while (!stopped) {
+        quint32 seq = h->seq.load(std::memory_order_acquire);
+        if (h->head.load(std::memory_order_acquire) != readPos) {
+            emit readyRead();
+        }
+        futexWait(&h->seq, seq, WAIT_TIMEOUT_MSECS);
+    }
+}
@@ -8,6 +8,7 @@
 #include "tsystemglobal.h"
 #include "taccesslogstream.h"
 #include "tfileaiowriter.h"
+#include "tqueryprofiler.h"
 #include <TWebApplication>
 #include <TAppSettings>
 #include <TLogger>
@@ -29,6 +30,7 @@ constexpr auto DEFAULT_ACCESSLOG_DATETIME_FORMAT = "yyyy-MM-ddThh:mm:ss";
 namespace {
     TAccessLogStream *accesslogstrm = nullptr;
     TAccessLogStream *sqllogstrm = nullptr;
+    TAccessLogStream *slowlogstrm = nullptr;
     TFileAioWriter systemLog;
     QByteArray syslogLayout = DEFAULT_SYSTEMLOG_LAYOUT;
     QByteArray syslogDateTimeFormat = DEFAULT_SYSTEMLOG_DATETIME_FORMAT;
@@ -103,13 +105,25 @@ void Tf::setupQueryLogger()
     if (!sqllogstrm && !querylogpath.isEmpty()) {
         sqllogstrm = new TAccessLogStream(querylogpath);
     }
+
+    // slow query log
+    QString slowlogpath = Tf::app()->sqlSlowQueryLogFilePath();
+    if (!slowlogstrm && !slowlogpath.isEmpty()) {
+        slowlogstrm = new TAccessLogStream(slowlogpath);
+    }
 }
 
 
 void Tf::releaseQueryLogger()
 {
+    if (slowlogstrm) {
+        TQueryProfiler::writeHistograms();
+    }
+
     delete sqllogstrm;
     sqllogstrm = nullptr;
+    delete slowlogstrm;
+    slowlogstrm = nullptr;
 }
 
 
@@ -179,8 +193,12 @@ void Tf::traceQueryLog(const char *msg, ...)
 }
 
 
-void Tf::writeQueryLog(const QString &query, bool success, const QSqlError &error)
+void Tf::writeQueryLog(const QString &query, bool success, const QSqlError &error, qint64 usecs)
 {
+    if (!sqllogstrm) {
+        return;
+    }
+
     QString q = query;
 
     if (!success) {
@@ -190,7 +208,32 @@ void Tf::writeQueryLog(const QString &query, bool success, const QSqlError &erro
         }
         q = QLatin1String("(Query failed) ") + err + query;
     }
-    Tf::traceQueryLog("%s", qPrintable(q));
+
+    if (usecs >= 0) {
+        Tf::traceQueryLog("(%.3f ms) %s", usecs / 1000.0, qPrintable(q));
+    } else {
+        Tf::traceQueryLog("%s", qPrintable(q));
+    }
+}
+
+/*!
+  Writes the \a message to the slow query log.
+*/
+void Tf::writeSlowQueryLog(const QString &message)
+{
+    if (slowlogstrm) {
+        TLog log(-1, message.toLocal8Bit());
+        QByteArray buf = TLogger::logToByteArray(log, syslogLayout, syslogDateTimeFormat);
+        slowlogstrm->writeLog(buf);
+    }
+}
+
+/*!
+  Returns true if the slow query log is open; otherwise returns false.
+*/
+bool Tf::isSlowQueryLogEnabled()
+{
+    return (bool)slowlogstrm;
 }
 
 
@@ -20,7 +20,9 @@ namespace Tf
     T_CORE_EXPORT void setupQueryLogger();    // internal use
     T_CORE_EXPORT void releaseQueryLogger();  // internal use
     T_CORE_EXPORT void writeAccessLog(const TAccessLog &log);  // write access log
-    T_CORE_EXPORT void writeQueryLog(const QString &query, bool success, const QSqlError &error);
+    T_CORE_EXPORT void writeQueryLog(const QString &query, bool success, const QSqlError &error, qint64 usecs = -1);
+    T_CORE_EXPORT void writeSlowQueryLog(const QString &message);
+    T_CORE_EXPORT bool isSlowQueryLogEnabled();
     T_CORE_EXPORT void traceQueryLog(const char *, ...) // SQL query log
 #if defined(Q_CC_GNU) && !defined(__INSURE__)
         __attribute__ ((format (printf, 1, 2)))
@@ -33,7 +35,8 @@ namespace Tf
         WebSocketSendBinary     = 0x02,
         WebSocketPublishText    = 0x03,
         WebSocketPublishBinary  = 0x04,
-        MaxOpCode               = 0x04,
+        SqlQueryCacheInvalidate = 0x05,
+        MaxOpCode               = 0x05,
     };
 
     T_CORE_EXPORT QMap<QString, QVariant> settingsToMap(QSettings &settings, const QString &env = QString());
@@ -0,0 +1,174 @@
+/* Copyright (c) 2019, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tviewbuffer.h"
+#include "tescapekernel.h"
+
+/*!
+  \class TViewBuffer
+  \brief The TViewBuffer class is a growable buffer of UTF-8 bytes into
+  which a view writes its output.
+
+  The static text of the templates compiled by tmake is appended as
+  UTF-8 byte literals, and strings are encoded as they are appended,
+  so that the output of a view is sent without being transcoded again.
+  \sa TActionView
+*/
+
+/*!
+  Appends the \a len UTF-16 code units of the \a str encoded in UTF-8.
+*/
+TViewBuffer &TViewBuffer::append(const QChar *str, int len)
+{
+    const int oldSize = buffer.size();
+    int i = 0;
+
+    // Fast path for ASCII characters
+    buffer.resize(oldSize + len);
+    char *dst = buffer.data() + oldSize;
+    for (; i < len && str[i].unicode() < 0x80; ++i) {
+        dst[i] = (char)str[i].unicode();
+    }
+
+    if (i < len) {
+        buffer.resize(oldSize + i);
+        buffer += QString::fromRawData(str + i, len - i).toUtf8();
+    }
+    return *this;
+}
+
+/*!
+  Appends the Latin-1 string \a str encoded in UTF-8.
+*/
+TViewBuffer &TViewBuffer::append(QLatin1String str)
+{
+    buffer.reserve(buffer.size() + str.size() * 2);
+    for (int i = 0; i < str.size(); ++i) {
+        const uchar u = (uchar)str.latin1()[i];
+        if (u < 0x80) {
+            buffer += (char)u;
+        } else {
+            buffer += (char)(0xC0 | (u >> 6));
+            buffer += (char)(0x80 | (u & 0x3F));
+        }
+    }
+    return *this;
+}
+
+/*!
+  Appends the string \a str with the HTML special characters converted
+  to entities as THttpUtility::htmlEscape() does, encoded in UTF-8.
+*/
+TViewBuffer &TViewBuffer::appendHtmlEscaped(const QString &str, Tf::EscapeFlag flag)
+{
+    const QChar *src = str.constData();
+    const int len = str.length();
+    int i = TEscapeKernel::indexOfSpecialChar(src, len, flag);
+
+    if (i == len) {
+        return append(str);
+    }
+
+    buffer.reserve(buffer.size() + len + len / 8);
+    int start = 0;
+    while (i < len) {
+        append(QString::fromRawData(src + start, i - start));
+        buffer += TEscapeKernel::htmlEntity(src[i].unicode());
+        start = i + 1;
+        i = start + TEscapeKernel::indexOfSpecialChar(src + start, len - start, flag);
+    }
+    return append(QString::fromRawData(src + start, len - start));
+}
+
+/*!
+  Appends the UTF-8 bytes \a utf8 with the HTML special characters
+  converted to entities as THttpUtility::htmlEscape() does. No byte of a
+  multibyte character in UTF-8 is an ASCII character, so the bytes are
+  escaped without decoding.
+*/
+TViewBuffer &TViewBuffer::appendHtmlEscaped(const QByteArray &utf8, Tf::EscapeFlag flag)
+{
+    const char *src = utf8.constData();
+    const int len = utf8.length();
+    int i = TEscapeKernel::indexOfSpecialChar(src, len, flag);
+    int start = 0;
+
+    buffer.reserve(buffer.size() + len + len / 8);
+    while (i < len) {
+        buffer.append(src + start, i - start);
+        buffer += TEscapeKernel::htmlEntity((uchar)src[i]);
+        start = i + 1;
+        i = start + TEscapeKernel::indexOfSpecialChar(src + start, len - start, flag);
+    }
+    buffer.append(src + start, len - start);
+    return *this;
+}
+
+
+/*!
+  \fn TViewBuffer &TViewBuffer::append(const QString &str)
+  Appends the string \a str encoded in UTF-8.
+*/
+
+/*!
+  \fn TViewBuffer &TViewBuffer::append(char ch)
+  Appends the Latin-1 character \a ch encoded in UTF-8, as
+  QString::append(char) does.
+*/
+
+/*!
+  \fn TViewBuffer::TViewBuffer(const QByteArray &utf8)
+  Constructs a buffer holding the UTF-8 bytes \a utf8.
+*/
+
+/*!
+  \fn const QByteArray &TViewBuffer::toUtf8() const
+  Returns the bytes of the buffer, encoded in UTF-8.
+*/
+
+/*!
+  \fn QString TViewBuffer::toString() const
+  Returns the contents of the buffer decoded as a string.
+*/
+
+/*!
+  \fn TViewBuffer::operator QString() const
+  Returns the contents of the buffer decoded as a string, so that the
+  buffer can be used where a QString is expected.
+*/
+
+/*!
+  Returns the number of UTF-16 code units of the buffer, as
+  QString::length() does.
+*/
+int TViewBuffer::length() const
+{
+    int len = 0;
+    for (uchar c : buffer) {
+        if ((c & 0xC0) != 0x80) {
+            len += (c >= 0xF0) ? 2 : 1;  // surrogate pair for 4 bytes
+        }
+    }
+    return len;
+}
+
+/*!
+  Removes \a n UTF-16 code units from the end of the buffer, as
+  QString::chop() does. A character out of the BMP is removed as a whole.
+*/
+void TViewBuffer::chop(int n)
+{
+    int i = buffer.size();
+    while (n > 0 && i > 0) {
+        --i;
+        const uchar c = buffer.at(i);
+        if ((c & 0xC0) != 0x80) {
+            n -= (c >= 0xF0) ? 2 : 1;
+        }
+    }
+    buffer.truncate(i);
+}
@@ -0,0 +1,74 @@
+#ifndef TVIEWBUFFER_H
+#define TVIEWBUFFER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TViewBuffer
+{
+public:
+    TViewBuffer() { }
+    explicit TViewBuffer(const QByteArray &utf8) : buffer(utf8) { }
+
+    int size() const { return buffer.size(); }
+    bool isEmpty() const { return buffer.isEmpty(); }
+    void reserve(int size) { buffer.reserve(size); }
+    void clear() { buffer.clear(); }
+
+    TViewBuffer &append(const QString &str) { return append(str.constData(), str.length()); }
+    TViewBuffer &append(const QStringRef &str) { return append(str.constData(), str.length()); }
+    TViewBuffer &append(QChar ch) { return append(&ch, 1); }
+    TViewBuffer &append(char ch) { return append(QChar::fromLatin1(ch)); }
+    TViewBuffer &append(QLatin1String str);
+    TViewBuffer &append(const QByteArray &utf8) { buffer += utf8; return *this; }
+    TViewBuffer &append(const char *utf8) { buffer += utf8; return *this; }
+    TViewBuffer &append(const TViewBuffer &other) { buffer += other.buffer; return *this; }
+    TViewBuffer &appendHtmlEscaped(const QString &str, Tf::EscapeFlag flag = Tf::Quotes);
+    TViewBuffer &appendHtmlEscaped(const QByteArray &utf8, Tf::EscapeFlag flag = Tf::Quotes);
+
+    TViewBuffer &operator+=(const QString &str) { return append(str); }
+    TViewBuffer &operator+=(const QStringRef &str) { return append(str); }
+    TViewBuffer &operator+=(QChar ch) { return append(ch); }
+    TViewBuffer &operator+=(char ch) { return append(ch); }
+    TViewBuffer &operator+=(QLatin1String str) { return append(str); }
+    TViewBuffer &operator+=(const QByteArray &utf8) { return append(utf8); }
+    TViewBuffer &operator+=(const char *utf8) { return append(utf8); }
+    TViewBuffer &operator+=(const TViewBuffer &other) { return append(other); }
+    template <typename T> TViewBuffer &operator+=(const T &value);
+
+    const QByteArray &toUtf8() const { return buffer; }
+    QString toString() const { return QString::fromUtf8(buffer); }
+    operator QString() const { return toString(); }
+
+    // Compatible with QString, for the views written to a QString buffer
+    TViewBuffer &operator=(const QString &str) { buffer.clear(); return append(str); }
+    TViewBuffer &prepend(const QString &str) { buffer.prepend(str.toUtf8()); return *this; }
+    TViewBuffer &replace(const QString &before, const QString &after) { buffer.replace(before.toUtf8(), after.toUtf8()); return *this; }
+    bool contains(const QString &str) const { return buffer.contains(str.toUtf8()); }
+    bool startsWith(const QString &str) const { return buffer.startsWith(str.toUtf8()); }
+    bool endsWith(const QString &str) const { return buffer.endsWith(str.toUtf8()); }
+    QString mid(int position, int n = -1) const { return toString().mid(position, n); }
+    int length() const;
+    void chop(int n);
+
+private:
+    TViewBuffer &append(const QChar *str, int len);
+
+    QByteArray buffer;
+};
+
+/*!
+  Appends the string representation of the \a value converted by
+  QVariant::toString(). Characters and strings are appended by the
+  overloads as QString::operator+=() does.
+*/
+template <typename T>
+inline TViewBuffer &TViewBuffer::operator+=(const T &value)
+{
+    return append(QVariant(value).toString());
+}
+
+#endif // TVIEWBUFFER_H
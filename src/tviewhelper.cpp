@@ -10,8 +10,26 @@
 #include <TAppSettings>
 #include <TActionView>
 #include <THttpUtility>
+#include <TPaginator>
 #include <QFileInfo>
 #include <QRegExp>
+#include <QUrlQuery>
+
+constexpr auto CURSOR_PARAMETER_NAME = "cursor";
+
+namespace {
+
+QUrl cursorUrl(const QUrl &url, const QByteArray &cursor)
+{
+    QUrl ret = url;
+    QUrlQuery query(url);
+    query.removeAllQueryItems(CURSOR_PARAMETER_NAME);
+    query.addQueryItem(CURSOR_PARAMETER_NAME, QString::fromLatin1(cursor));
+    ret.setQuery(query);
+    return ret;
+}
+
+}
 
 
 /*!
@@ -19,6 +37,36 @@
   \brief The TViewHelper class provides some functionality for views.
 */
 
+/*!
+  Creates a \<a\> link tag of the given \a text to the previous page of
+  keyset pagination, appending the 'cursor' query parameter of the
+  previous cursor of \a paginator to the URL \a url. If the paginator
+  has no previous cursor, returns the \a text only.
+  \sa TSqlORMapper::seek()
+*/
+QString TViewHelper::linkToPreviousCursor(const QString &text, const TPaginator &paginator, const QUrl &url, const THtmlAttribute &attributes) const
+{
+    if (!paginator.hasPreviousCursor()) {
+        return text;
+    }
+    return linkTo(text, cursorUrl(url, paginator.previousCursor()), attributes);
+}
+
+/*!
+  Creates a \<a\> link tag of the given \a text to the next page of
+  keyset pagination, appending the 'cursor' query parameter of the next
+  cursor of \a paginator to the URL \a url. If the paginator has no next
+  cursor, returns the \a text only.
+  \sa TSqlORMapper::seek()
+*/
+QString TViewHelper::linkToNextCursor(const QString &text, const TPaginator &paginator, const QUrl &url, const THtmlAttribute &attributes) const
+{
+    if (!paginator.hasNextCursor()) {
+        return text;
+    }
+    return linkTo(text, cursorUrl(url, paginator.nextCursor()), attributes);
+}
+
 /*!
   Creates a \<a\> link tag of the given \a text using the given URL
   \a url and HTML attributes \a attributes. If \a method is Tf::Post,
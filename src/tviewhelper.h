@@ -12,6 +12,7 @@
 #include <THtmlAttribute>
 
 class TActionView;
+class TPaginator;
 
 
 class T_CORE_EXPORT TViewHelper
@@ -46,6 +47,12 @@ public:
     QString linkToFunction(const QString &text, const QString &function,
                            const THtmlAttribute &attributes = THtmlAttribute()) const;
 
+    QString linkToPreviousCursor(const QString &text, const TPaginator &paginator, const QUrl &url = QUrl(),
+                                 const THtmlAttribute &attributes = THtmlAttribute()) const;
+
+    QString linkToNextCursor(const QString &text, const TPaginator &paginator, const QUrl &url = QUrl(),
+                             const THtmlAttribute &attributes = THtmlAttribute()) const;
+
     QString buttonToFunction(const QString &text, const QString &function,
                              const THtmlAttribute &attributes = THtmlAttribute()) const;
 
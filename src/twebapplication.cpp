@@ -466,6 +466,20 @@ QString TWebApplication::sqlQueryLogFilePath() const
 }
 
 
+/*!
+  Returns the absolute file path of the slow query log.
+*/
+QString TWebApplication::sqlSlowQueryLogFilePath() const
+{
+    QString path = Tf::appSettings()->value(Tf::SqlQuerySlowLogFile).toString();
+    if (!path.isEmpty()) {
+        QFileInfo fi(path);
+        path = (fi.isAbsolute()) ? fi.absoluteFilePath() : webRootPath() + fi.filePath();
+    }
+    return path;
+}
+
+
 void TWebApplication::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == _timer.timerId()) {
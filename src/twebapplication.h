@@ -66,6 +66,7 @@ public:
     QString systemLogFilePath() const;
     QString accessLogFilePath() const;
     QString sqlQueryLogFilePath() const;
+    QString sqlSlowQueryLogFilePath() const;
     QTextCodec *codecForInternal() const { return _codecInternal; }
     QTextCodec *codecForHttpOutput() const { return _codecHttp; }
     int applicationServerId() const { return _appServerId; }
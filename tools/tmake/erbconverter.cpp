@@ -23,13 +23,19 @@
     "public:\n"                                                 \
     "  %1() : TActionView() { }\n"                              \
     "  QString toString();\n"                                   \
+    "  QByteArray toUtf8();\n"                                  \
     "};\n"                                                      \
     "\n"                                                        \
     "QString %1::toString()\n"                                  \
     "{\n"                                                       \
+    "  return QString::fromUtf8(toUtf8());\n"                   \
+    "}\n"                                                       \
+    "\n"                                                        \
+    "QByteArray %1::toUtf8()\n"                                 \
+    "{\n"                                                       \
     "  responsebody.reserve(%3);\n"                             \
     "%2\n"                                                      \
-    "  return responsebody;\n"                                  \
+    "  return responsebody.toUtf8();\n"                         \
     "}\n"                                                       \
     "\n"                                                        \
     "T_DEFINE_VIEW(%1)\n"                                       \
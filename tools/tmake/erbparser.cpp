@@ -59,9 +59,9 @@ void ErbParser::parse(const QString &erb)
         int i = erbData.indexOf("<%", pos);
         QString text = erbData.mid(pos, i - pos);
         if (!text.isEmpty()) {
-            // HTML output
+            // HTML output, as a UTF-8 byte literal unless translatable
             if (isAsciiString(text)) {
-                srcCode += QLatin1String("  responsebody += QStringLiteral(\"");
+                srcCode += QLatin1String("  responsebody += QByteArrayLiteral(\"");
             } else {
                 srcCode += QLatin1String("  responsebody += tr(\"");
             }
@@ -99,6 +99,11 @@ void ErbParser::parsePercentTag()
     QChar c = erbData[pos++];
     if (c == QLatin1Char('#')) {  // <%#
         startTag += c;
+        int sp = 0;  // spaces before a directive
+        while (pos + sp < erbData.length() && erbData[pos + sp] == QLatin1Char(' ')) {
+            ++sp;
+        }
+
         if (posMatchWith("include ") || posMatchWith("include\t")) {
             startTag += QLatin1String("include");
             // Outputs include-macro
@@ -106,6 +111,20 @@ void ErbParser::parsePercentTag()
             QPair<QString, QString> p = parseEndPercentTag();
             incCode += p.first;
             incCode += QLatin1Char('\n');
+        } else if (posMatchWith("cache ", sp) || posMatchWith("cache\t", sp)) {
+            startTag += QLatin1String("cache");
+            pos += sp + 6;
+            // Begins a fragment cache block
+            QPair<QString, QString> p = parseEndPercentTag();
+            srcCode += QLatin1String("if (beginFragmentCache(");
+            srcCode += semicolonTrim(p.first);
+            srcCode += QLatin1String(")) {\n");
+        } else if (posMatchWith("endcache", sp)) {
+            startTag += QLatin1String("endcache");
+            pos += sp + 8;
+            // Ends the fragment cache block
+            parseEndPercentTag();
+            srcCode += QLatin1String("endFragmentCache(); }\n");
         } else {
             // Outputs comments
             srcCode += QLatin1String("/*");
@@ -161,9 +180,9 @@ void ErbParser::parsePercentTag()
             QPair<QString, QString> p = parseEndPercentTag();
             if (!p.first.isEmpty()) {
                 if (p.second.isEmpty()) {
-                    srcCode += QLatin1String("responsebody += QVariant(");
+                    srcCode += QLatin1String("responsebody += (");
                     srcCode += semicolonTrim(p.first);
-                    srcCode += QLatin1String(").toString();\n");
+                    srcCode += QLatin1String(");\n");
                 } else {
                     srcCode += QLatin1String("{ QString ___s = QVariant(");
                     srcCode += semicolonTrim(p.first);
@@ -178,15 +197,16 @@ void ErbParser::parsePercentTag()
             QPair<QString, QString> p = parseEndPercentTag();
             if (!p.first.isEmpty()) {
                 if (p.second.isEmpty()) {
-                    srcCode += QLatin1String("responsebody += THttpUtility::htmlEscape(");
+                    // Escaped into the buffer without a temporary string
+                    srcCode += QLatin1String("eh(");
                     srcCode += semicolonTrim(p.first);
                     srcCode += QLatin1String(");\n");
                 } else {
                     srcCode += QLatin1String("{ QString ___s = QVariant(");
                     srcCode += semicolonTrim(p.first);
-                    srcCode += QLatin1String(").toString(); responsebody += (___s.isEmpty()) ? THttpUtility::htmlEscape(");
+                    srcCode += QLatin1String(").toString(); if (___s.isEmpty()) { eh(");
                     srcCode += semicolonTrim(p.second);
-                    srcCode += QLatin1String(") : THttpUtility::htmlEscape(___s); }\n");
+                    srcCode += QLatin1String("); } else { eh(___s); } }\n");
                 }
             }
         }
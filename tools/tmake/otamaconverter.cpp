@@ -148,8 +148,27 @@ QString OtamaConverter::convertToErb(const QString &html, const QString &otm, in
     }
 
     for (int i = htmlParser.elementCount() - 1; i > 0; --i) {
+        QString label = htmlParser.at(i).attribute(TF_ATTRIBUTE_NAME);
+        bool scriptArea = htmlParser.parentExists(i, "script");
+
+        // Fragment cache
+        QString val = otmParser.getSrcCode(label, OtmParser::FragmentCache); // & operator
+        if (!val.isEmpty()) {
+            // Wraps the element with the cache block, before the elements
+            // are inserted
+            int parent = htmlParser.at(i).parent;
+            int idx = htmlParser.at(parent).children.indexOf(i);
+            THtmlElement &he1 = htmlParser.insertNewElement(parent, idx);
+            he1.text  = QLatin1String("<%# cache ");
+            he1.text += val;
+            he1.text += (scriptArea ? RIGHT_DELIM_NO_TRIM : RIGHT_DELIM);
+
+            THtmlElement &he2 = htmlParser.insertNewElement(parent, idx + 2);
+            he2.text  = QLatin1String("<%# endcache");
+            he2.text += (scriptArea ? RIGHT_DELIM_NO_TRIM : RIGHT_DELIM);
+        }
+
         THtmlElement &e = htmlParser.at(i);
-        QString label = e.attribute(TF_ATTRIBUTE_NAME);
 
         if (e.hasAttribute(TF_ATTRIBUTE_NAME)) {
             e.removeAttribute(TF_ATTRIBUTE_NAME);
@@ -165,9 +184,7 @@ QString OtamaConverter::convertToErb(const QString &html, const QString &otm, in
             continue;
         }
 
-        QString val;
         OtmParser::EchoOption ech;
-        bool scriptArea = htmlParser.parentExists(i, "script");
 
         // Content assignment
         val = otmParser.getSrcCode(label, OtmParser::ContentAssignment, &ech); // ~ operator
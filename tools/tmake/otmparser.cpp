@@ -27,6 +27,7 @@ public:
         insert(OtmParser::ContentAssignment, "~");
         insert(OtmParser::AttributeSet,      "+");
         insert(OtmParser::TagMerging,        "|==");
+        insert(OtmParser::FragmentCache,     "&");
     }
 };
 Q_GLOBAL_STATIC(OperatorHash, opHash)
@@ -52,7 +53,7 @@ void OtmParser::parse(const QString &text)
             lineCont = false;
             if (!label.isEmpty()) {
                 QString str = value.trimmed();
-                QRegExp rx("[^:~\\+\\|].*"); // anything but ':', '~', '+', '|'
+                QRegExp rx("[^:~\\+\\|&].*"); // anything but ':', '~', '+', '|', '&'
                 if (rx.indexIn(str) == 0) {
                     // Regard empty Otama operator as the ':' operator
                     str = QLatin1Char(':') + str;
@@ -111,7 +112,9 @@ QString OtmParser::getSrcCode(const QString &label, OperatorType op, EchoOption
         if (!opstr.isEmpty() && s.startsWith(opstr) && !s.contains(repMarker)) {
             code = s.mid(opstr.length());
 
-            if (op != TagMerging) {
+            if (op == FragmentCache) {
+                // Arguments of the cache, not a value to echo
+            } else if (op != TagMerging) {
                 Q_ASSERT(EXVAR_ECHO.length() >= EXVAR_ESCAPE_ECHO.length());
                 Q_ASSERT(NORMAL_ECHO.length() >= ESCAPE_ECHO.length());
 
@@ -13,6 +13,7 @@ public:
         ContentAssignment,
         AttributeSet,
         TagMerging,
+        FragmentCache,
     };
 
     enum EchoOption {
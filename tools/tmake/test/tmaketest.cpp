@@ -110,6 +110,7 @@ void TestTfpconverter::otamaconvert_data()
     QTest::newRow("19") << "index19.html" << "logic1.olg" << "res19.html";
     QTest::newRow("19") << "index19.html" << "logic1.olg" << "res19.html";
     QTest::newRow("20") << "index20.html" << "logic1.olg" << "res20.html";
+    QTest::newRow("21") << "index21.html" << "logic1.olg" << "res21.html";
 
     QTest::newRow("c1") << "indexc1.html" << "logic1.olg" << "resc1.html";
     QTest::newRow("c2") << "indexc2.html" << "logic1.olg" << "resc2.html";
@@ -202,67 +203,73 @@ void TestTfpconverter::erbparse_data()
     QTest::addColumn<QString>("expe");
 
     QTest::newRow("1") << "<body>Hello ... \n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello ... \\n</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello ... \\n</body>\");\n";
     QTest::newRow("1-2") << "  <body>Hello ... \n</body> \t"
-                         << "  responsebody += QStringLiteral(\"  <body>Hello ... \\n</body> \t\");\n";
+                         << "  responsebody += QByteArrayLiteral(\"  <body>Hello ... \\n</body> \t\");\n";
     QTest::newRow("2") << "<body>Hello <%# this is comment!! %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("3") << "<body>Hello <%# this is comment!! %>   \n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 
     QTest::newRow("4") << "<body>Hello <%# this is \"comment!!\" %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("5") << "<body>Hello <%# this is \"comment!!\" %>  \r\n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 
     QTest::newRow("6") << "<body>Hello <% int i; %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("7") << "<body>Hello <% QString s(\"%>\"); %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  QString s(\"%>\");\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  QString s(\"%>\");\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("8") << "<body>Hello <%== vvv %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += QVariant(vvv).toString();\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  responsebody += (vvv);\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("9") << "<body>Hello <%= vvv %> \n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\" \\n</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\" \\n</body>\");\n";
     QTest::newRow("10") << "<body>Hello <%= vvv; -%> \n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("11") << "<body>Hello <% int i; -%> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\" </body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\" </body>\");\n";
     QTest::newRow("12") << "<body>Hello <% int i; %> \r\n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("13") << "<body>Hello ... \r\n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello ... \\r\\n</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello ... \\r\\n</body>\");\n";
     QTest::newRow("14") << "<body>Hello <%= vvv; +%> \n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\" \\n</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\" \\n</body>\");\n";
     QTest::newRow("15") << "<body>Hello <%= vvv; +%></body>\r\n"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\"</body>\\r\\n\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"</body>\\r\\n\");\n";
     QTest::newRow("16") << "<body>Hello <% int i; +%> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\" \\r\\n </body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\" \\r\\n </body>\");\n";
 
     /** echo export object **/
     QTest::newRow("17") << "<body>Hello <%=$ hoge -%> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  tehex(hoge);\n  responsebody += QStringLiteral(\" </body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  tehex(hoge);\n  responsebody += QByteArrayLiteral(\" </body>\");\n";
     QTest::newRow("18") << "<body>Hello <%==$ hoge %> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  techoex(hoge);\n  responsebody += QStringLiteral(\" \\r\\n </body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  techoex(hoge);\n  responsebody += QByteArrayLiteral(\" \\r\\n </body>\");\n";
 
     /** Echo a default value on ERB **/
     QTest::newRow("19") << "<body><%# comment. %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  /* comment. */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  /* comment. */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("20") << "<body><%= number %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); responsebody += (___s.isEmpty()) ? THttpUtility::htmlEscape(33) : THttpUtility::htmlEscape(___s); }\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); if (___s.isEmpty()) { eh(33); } else { eh(___s); } }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("21") << "<body><%== number %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); responsebody += (___s.isEmpty()) ? QVariant(33).toString() : ___s; }\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); responsebody += (___s.isEmpty()) ? QVariant(33).toString() : ___s; }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("22") << "<body><%=$number %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  tehex2(number, (33));\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  tehex2(number, (33));\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     // Irregular pattern
     QTest::newRow("23") << "<body><%==$number %|% 33 -%>\t\n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  techoex2(number, (33));\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  techoex2(number, (33));\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("24") << "<body><%== \"  %|%\" %|% \"%|%\" -%> \t \n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  { QString ___s = QVariant(\"  %|%\").toString(); responsebody += (___s.isEmpty()) ? QVariant(\"%|%\").toString() : ___s; }\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  { QString ___s = QVariant(\"  %|%\").toString(); responsebody += (___s.isEmpty()) ? QVariant(\"%|%\").toString() : ___s; }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 
     QTest::newRow("25") << "<body><script>function() { return '\\n'; }</script></body>"
-                        << "  responsebody += QStringLiteral(\"<body><script>function() { return '\\\\n'; }</script></body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body><script>function() { return '\\\\n'; }</script></body>\");\n";
     QTest::newRow("26") << "<body><script>function() { return \"\\n\"; }</script></body>"
-                        << "  responsebody += QStringLiteral(\"<body><script>function() { return \\\"\\\\n\\\"; }</script></body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body><script>function() { return \\\"\\\\n\\\"; }</script></body>\");\n";
+
+    /** Fragment cache **/
+    QTest::newRow("27") << "<body><%# cache \"side\", 60 %><p><%= vvv %></p><%# endcache %></body>"
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  if (beginFragmentCache(\"side\", 60)) {\n  responsebody += QByteArrayLiteral(\"<p>\");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"</p>\");\n  endFragmentCache(); }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
+    QTest::newRow("28") << "<body><%# cache cacheKey(\"post\", post), 300; -%>\n<%== post.body() %><%# endcache -%>\n</body>"
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  if (beginFragmentCache(cacheKey(\"post\", post), 300)) {\n  responsebody += (post.body());\n  endFragmentCache(); }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 }
 
 
@@ -284,69 +291,69 @@ void TestTfpconverter::erbparseStrong_data()
     QTest::addColumn<QString>("expe");
 
     QTest::newRow("1") << "<body>Hello ... \n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello ...\\n</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello ...\\n</body>\");\n";
     QTest::newRow("1-2") << "<body>Hello ... \n \t</body>"
-                         << "  responsebody += QStringLiteral(\"<body>Hello ...\\n</body>\");\n";
+                         << "  responsebody += QByteArrayLiteral(\"<body>Hello ...\\n</body>\");\n";
     QTest::newRow("2") << "<body>Hello <%# this is comment!! %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("3") << "<body>Hello <%# this is comment!! %>   \n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is comment!! */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 
     QTest::newRow("4") << "<body>Hello <%# this is \"comment!!\" %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("5") << "<body>Hello <%# this is \"comment!!\" %>  \r\n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  /* this is \"comment!!\" */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 
     QTest::newRow("6") << "<body>Hello <% int i; %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("7") << "<body>Hello <% QString s(\"%>\"); %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  QString s(\"%>\");\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  QString s(\"%>\");\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("8") << "<body>Hello <%== vvv %></body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += QVariant(vvv).toString();\n  responsebody += QStringLiteral(\"</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  responsebody += (vvv);\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("9") << "<body>Hello <%= vvv %> \n</body>"
-                       << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\"\\n</body>\");\n";
+                       << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"\\n</body>\");\n";
     QTest::newRow("9-2") << "<body>Hello <%= vvv %>　\n</body>"
-                         << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += tr(\"　\\n</body>\");\n";
+                         << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += tr(\"　\\n</body>\");\n";
     QTest::newRow("10") << "<body>Hello <%= vvv; -%>  \n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("11") << "  <body>Hello <% int i; -%> \r\n </body>  "
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("12") << "<body>Hello <% int i; %> \r\n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("13") << "<body>Hello ... \t\r\n\t</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello ...\\n</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello ...\\n</body>\");\n";
     QTest::newRow("14") << "<body>Hello <%= vvv; +%> \n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\"\\n</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"\\n</body>\");\n";
     QTest::newRow("15") << "<body>Hello <%= vvv; +%></body>\t\r\n"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  responsebody += THttpUtility::htmlEscape(vvv);\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  eh(vvv);\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("16") << " \t<body>Hello <% int i; +%> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QStringLiteral(\"\\n</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  int i;\n  responsebody += QByteArrayLiteral(\"\\n</body>\");\n";
 
     /** echo export object **/
     QTest::newRow("17") << " \t <body>Hello <%=$ hoge -%> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  tehex(hoge);\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  tehex(hoge);\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("18") << "<body>Hello <%==$ hoge %> \r\n </body>"
-                        << "  responsebody += QStringLiteral(\"<body>Hello \");\n  techoex(hoge);\n  responsebody += QStringLiteral(\"\\n</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>Hello \");\n  techoex(hoge);\n  responsebody += QByteArrayLiteral(\"\\n</body>\");\n";
 
     /** Echo a default value on ERB **/
     QTest::newRow("19") << "<body><%# comment. %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  /* comment. */\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  /* comment. */\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("20") << "<body><%= number %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); responsebody += (___s.isEmpty()) ? THttpUtility::htmlEscape(33) : THttpUtility::htmlEscape(___s); }\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); if (___s.isEmpty()) { eh(33); } else { eh(___s); } }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("21") << "<body><%== number %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); responsebody += (___s.isEmpty()) ? QVariant(33).toString() : ___s; }\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  { QString ___s = QVariant(number).toString(); responsebody += (___s.isEmpty()) ? QVariant(33).toString() : ___s; }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("22") << "<body><%=$number %|% 33 %></body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  tehex2(number, (33));\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  tehex2(number, (33));\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     // Irregular pattern
     QTest::newRow("23") << "<body><%==$number %|% 33 -%>\t\n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  techoex2(number, (33));\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  techoex2(number, (33));\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
     QTest::newRow("24") << "<body><%== \"  %|%\" %|% \"%|%\" -%> \t \n</body>"
-                        << "  responsebody += QStringLiteral(\"<body>\");\n  { QString ___s = QVariant(\"  %|%\").toString(); responsebody += (___s.isEmpty()) ? QVariant(\"%|%\").toString() : ___s; }\n  responsebody += QStringLiteral(\"</body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body>\");\n  { QString ___s = QVariant(\"  %|%\").toString(); responsebody += (___s.isEmpty()) ? QVariant(\"%|%\").toString() : ___s; }\n  responsebody += QByteArrayLiteral(\"</body>\");\n";
 
     QTest::newRow("25") << "<body><script>function() { return '\\n'; }</script></body>"
-                        << "  responsebody += QStringLiteral(\"<body><script>function() { return '\\\\n'; }</script></body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body><script>function() { return '\\\\n'; }</script></body>\");\n";
     QTest::newRow("26") << "<body><script>function() { return \"\\n\"; }</script></body>"
-                        << "  responsebody += QStringLiteral(\"<body><script>function() { return \\\"\\\\n\\\"; }</script></body>\");\n";
+                        << "  responsebody += QByteArrayLiteral(\"<body><script>function() { return \\\"\\\\n\\\"; }</script></body>\");\n";
 }
 
 
@@ -23,6 +23,7 @@ constexpr auto MODEL_HEADER_FILE_TEMPLATE =              \
     "#include <QStringList>\n"                           \
     "#include <QDateTime>\n"                             \
     "#include <QVariant>\n"                              \
+    "#include <QHash>\n"                                 \
     "#include <QSharedDataPointer>\n"                    \
     "#include <TGlobal>\n"                               \
     "#include <TAbstractModel>\n"                        \
@@ -174,6 +175,7 @@ constexpr auto USER_MODEL_HEADER_FILE_TEMPLATE =         \
     "#include <QStringList>\n"                           \
     "#include <QDateTime>\n"                             \
     "#include <QVariant>\n"                              \
+    "#include <QHash>\n"                                 \
     "#include <QSharedDataPointer>\n"                    \
     "#include <TGlobal>\n"                               \
     "#include <TAbstractUser>\n"                         \
@@ -639,12 +641,36 @@ QPair<ModelGenerator::PlaceholderList, ModelGenerator::PlaceholderList> ModelGen
              << pair("10", getOptImpl)
              << pair("11", ((objectType == Mongo) ? "Mongo" : ""));
 
+    // Creates accessors for eager loading by the foreign keys
+    QString relDecl, relImpl;
+    if (objectType == Sql) {
+        for (int i = 0; i < fields.count(); ++i) {
+            const QPair<QString, QVariant::Type> &field = fields[i];
+            if (i == pkidx || !field.first.endsWith(QLatin1String("_id"), Qt::CaseInsensitive)) {
+                continue;
+            }
+
+            if (field.second != QVariant::Int && field.second != QVariant::LongLong && field.second != QVariant::String) {
+                continue;
+            }
+
+            QString type = QVariant::typeToName(field.second);
+            QString enumName = fieldNameToEnumName(field.first);
+            QString var = fieldNameToVariableName(field.first);
+            relDecl += QString("    static QHash<%1, QList<%2>> getListsGroupedBy%3(const QList<%1> &%4s);\n").arg(type, modelName, enumName, var);
+            relImpl += QString("QHash<%1, QList<%2>> %2::getListsGroupedBy%3(const QList<%1> &%4s)\n" \
+                               "{\n"                                       \
+                               "    return tfGetModelListsGroupedBy<%2, %2Object>(%2Object::%3, %4s);\n" \
+                               "}\n\n").arg(type, modelName, enumName, var);
+        }
+    }
+
     headerList << pair("7", "class QJsonArray;\n")
-               << pair("8", "    static QJsonArray getAllJson();\n");
+               << pair("8", QLatin1String("    static QJsonArray getAllJson();\n") + relDecl);
 
     switch (objectType) {
     case Sql:
-        implList << pair("12", replaceholder(MODEL_IMPL_GETALLJSON, pair("model", modelName)));
+        implList << pair("12", replaceholder(MODEL_IMPL_GETALLJSON, pair("model", modelName)) + relImpl);
         implList << pair("objdir", "sqlobjects/");
         break;
 
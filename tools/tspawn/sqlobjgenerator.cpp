@@ -9,6 +9,7 @@
 #include "global.h"
 #include "filewriter.h"
 #include "tableschema.h"
+#include <QMap>
 
 constexpr auto SQLOBJECT_HEADER_TEMPLATE =                   \
     "#ifndef %1OBJECT_H\n"                                   \
@@ -60,6 +61,35 @@ inline bool isBoolType(const QString &typeName)
 }
 
 
+static QString metaTypeEnumName(const QString &typeName)
+{
+    static const QMap<QString, QString> enumNames {
+        {"int", "Int"},
+        {"uint", "UInt"},
+        {"qlonglong", "LongLong"},
+        {"qulonglong", "ULongLong"},
+        {"double", "Double"},
+        {"float", "Float"},
+        {"bool", "Bool"},
+        {"short", "Short"},
+        {"ushort", "UShort"},
+        {"char", "Char"},
+        {"uchar", "UChar"},
+    };
+
+    int id = QMetaType::type(typeName.toLatin1());
+    if (id == QMetaType::UnknownType || id >= QMetaType::User) {
+        return QString::number(id);
+    }
+
+    QString name = QMetaType::typeName(id);
+    if (name.startsWith('Q')) {
+        return QLatin1String("QMetaType::") + name;
+    }
+    return enumNames.contains(name) ? QLatin1String("QMetaType::") + enumNames.value(name) : QString::number(id);
+}
+
+
 SqlObjGenerator::SqlObjGenerator(const QString &model, const QString &table)
     : tableSch(new TableSchema(table))
 {
@@ -133,6 +163,47 @@ QString SqlObjGenerator::generate(const QString &dstDir)
     output += tableSch->tableName();
     output += QLatin1String("\"); }\n\n");
 
+    // Column descriptors and accessors
+    output += QLatin1String("    static TSqlColumnList columnList()\n    {\n        static constexpr TSqlColumn list[] = {\n");
+    it.toFront();
+    while (it.hasNext()) {
+        const QPair<QString, QString> &p = it.next();
+        const QString name = p.first.toLower();
+        QStringList roles;
+        if (p.first == pkName) {
+            roles << QLatin1String("TSql::PrimaryKeyColumn");
+        }
+        if (p.first == autoValue) {
+            roles << QLatin1String("TSql::AutoValueColumn");
+        }
+        if (name == QLatin1String("created_at")) {
+            roles << QLatin1String("TSql::CreatedAtColumn");
+        } else if (name == QLatin1String("updated_at") || name == QLatin1String("modified_at")) {
+            roles << QLatin1String("TSql::UpdatedAtColumn");
+        } else if (name == QLatin1String("lock_revision")) {
+            roles << QLatin1String("TSql::LockRevisionColumn");
+        }
+        output += QString("            {%1, \"%2\", %3, %4},\n").arg(fieldNameToEnumName(p.first), p.first, metaTypeEnumName(p.second), (roles.isEmpty() ? QString("0") : roles.join(" | ")));
+    }
+    output += QLatin1String("        };\n        return TSqlColumnList(list);\n    }\n");
+    output += QLatin1String("    TSqlColumnList columns() const override { return columnList(); }\n\n");
+
+    output += QLatin1String("    QVariant columnValue(int index) const override\n    {\n        switch (index) {\n");
+    it.toFront();
+    while (it.hasNext()) {
+        const QPair<QString, QString> &p = it.next();
+        output += QString("        case %1: return QVariant::fromValue(%2);\n").arg(fieldNameToEnumName(p.first), p.first);
+    }
+    output += QLatin1String("        default: return QVariant();\n        }\n    }\n\n");
+
+    output += QLatin1String("    void setColumnValue(int index, const QVariant &value) override\n    {\n        switch (index) {\n");
+    it.toFront();
+    while (it.hasNext()) {
+        const QPair<QString, QString> &p = it.next();
+        output += QString("        case %1: %2 = value.value<%3>(); break;\n").arg(fieldNameToEnumName(p.first), p.first, p.second);
+    }
+    output += QLatin1String("        default: break;\n        }\n    }\n\n");
+
     // Property macros part
     output += QLatin1String("private:    /*** Don't modify below this line ***/\n    Q_OBJECT\n");
     it.toFront();